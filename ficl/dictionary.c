@@ -114,7 +114,10 @@ void ficlDictionaryAbortDefinition(ficlDictionary *dict)
   ficlWord *word = dict->smudge;
 
   if (word->flags & FICL_WORD_SMUDGED)
+  {
+    fth_symbol_forget(word->name);	/* [ms] */
     CELL_VOIDP_SET(dict->here, word->name);
+  }
 }
 
 /**************************************************************************
@@ -250,6 +253,133 @@ char *ficlDictionaryAppendString(ficlDictionary *dict, ficlString s)
   return ficlDictionaryAppendData(dict, data, length);
 }
 
+/**************************************************************************
+ **              d i c t C o m p i l e I n s t r u c t i o n
+ ** Append instruction i to the definition in process.  If i and the
+ ** instruction compiled just before it form one of the frequent pairs
+ ** (see .bigrams in tools.c), rewrite the previous one to a
+ ** superinstruction instead.  The superinstruction takes the arguments
+ ** of both in order, so the caller appends the arguments of i as usual
+ ** and no ficlCell already compiled moves.  Fusing requires that
+ ** nothing but the arguments of the previous instruction was appended
+ ** since; code that takes "here" as a branch target calls
+ ** ficlDictionaryCompileBarrier() first.  [ms]
+ **************************************************************************/
+#if FICL_WANT_SUPERINSTRUCTIONS
+static int ficlInstructionArguments(ficlInteger i)
+{
+  switch (i)
+  {
+  case ficlInstructionLiteralParen:
+  case ficlInstructionLinkParen:
+  case ficlInstructionToLocalParen:
+  case ficlInstructionGetLocalParen:
+  case ficlInstructionDupBranch0Paren:
+  case ficlInstructionLiteralPlus:
+  case ficlInstructionLiteralMinus:
+  case ficlInstructionLiteralStar:
+  case ficlInstructionLiteralEquals:
+  case ficlInstructionLiteralNotEquals:
+  case ficlInstructionLiteralLess:
+  case ficlInstructionLiteralGreaterThan:
+    return 1;
+  case ficlInstructionLiteralLinkParen:
+    return 2;
+  case ficlInstructionLiteralLinkToLocalParen:
+    return 3;
+  default:
+    return 0;
+  }
+}
+#endif
+
+void ficlDictionaryCompileInstruction(ficlDictionary *dict, ficlInstruction i)
+{
+#if FICL_WANT_SUPERINSTRUCTIONS
+  ficlCell *last = dict->compiled;
+  ficlInteger prev;
+  ficlInstruction fused = ficlInstructionInvalid;
+
+  if (last == NULL)
+    goto APPEND;
+  prev = CELL_INT_REF(last);
+  if (dict->here != last + 1 + ficlInstructionArguments(prev))
+    goto APPEND;
+
+  switch (i)
+  {
+  case ficlInstructionLinkParen:
+    /* the dummy local of every fth definition, see ficl_init_locals() */
+    if (prev == ficlInstructionLiteralParen)
+      fused = ficlInstructionLiteralLinkParen;
+    break;
+  case ficlInstructionToLocalParen:
+    if (prev == ficlInstructionLiteralLinkParen)
+      fused = ficlInstructionLiteralLinkToLocalParen;
+    break;
+  case ficlInstructionOver:
+    if (prev == ficlInstructionOver)
+      fused = ficlInstruction2Dup;
+    break;
+  case ficlInstructionBranch0ParenWithCheck:
+    if (prev == ficlInstructionDup)
+      fused = ficlInstructionDupBranch0Paren;
+    break;
+  case ficlInstructionPlus:
+    fused = ficlInstructionLiteralPlus;
+    goto LITERAL;
+  case ficlInstructionMinus:
+    fused = ficlInstructionLiteralMinus;
+    goto LITERAL;
+  case ficlInstructionStar:
+    fused = ficlInstructionLiteralStar;
+    goto LITERAL;
+  case ficlInstructionEquals:
+    fused = ficlInstructionLiteralEquals;
+    goto LITERAL;
+  case ficl_not_eql:
+    fused = ficlInstructionLiteralNotEquals;
+    goto LITERAL;
+  case ficlInstructionLess:
+    fused = ficlInstructionLiteralLess;
+    goto LITERAL;
+  case ficlInstructionGreaterThan:
+    fused = ficlInstructionLiteralGreaterThan;
+  LITERAL:
+    if (prev == ficlInstructionLiteralParen)
+      break;
+    /* small constants have no argument cell, append it now */
+    if (prev >= ficlInstruction1 && prev < ficlInstruction0)
+      ficlDictionaryAppendInteger(dict, prev);
+    else if (prev >= ficlInstruction0 && prev <= ficlInstructionNeg16)
+      ficlDictionaryAppendInteger(dict, ficlInstruction0 - prev);
+    else
+      fused = ficlInstructionInvalid;
+    break;
+  default:
+    break;
+  }
+
+  if (fused != ficlInstructionInvalid)
+  {
+    CELL_INT_SET(last, fused);
+    return;
+  }
+APPEND:
+  dict->compiled = dict->here;
+#endif
+  ficlDictionaryAppendUnsigned(dict, (ficlUnsigned)i);
+}
+
+/*
+** "here" becomes a branch target: the next instruction must not be
+** fused with the previous one.
+*/
+void ficlDictionaryCompileBarrier(ficlDictionary *dict)
+{
+  dict->compiled = NULL;
+}
+
 ficlWord *ficlDictionaryAppendConstantInstruction(ficlDictionary *dict,
 						  ficlString name,
 						  ficlInstruction inst,
@@ -399,6 +529,7 @@ ficlWord *ficlDictionaryAppendWord(ficlDictionary *dict,
   nameCopy[name.length] = '\0';
   word               = (ficlWord *)dict->here;
   dict->smudge       = word;
+  dict->compiled     = NULL;
   word->hash         = ficlHashCode(name);
   word->code         = code;
   word->semiParen    = ficlInstructionSemiParen;
@@ -567,6 +698,12 @@ void ficlDictionaryEmpty(ficlDictionary *dict, unsigned bucketCount)
 {
   ficlHash *hash;
 
+  /* [ms] free a grown table of the old forth wordlist */
+  hash = dict->forthWordlist;
+
+  if (hash != NULL && hash->table != hash->buckets)
+    FTH_FREE(hash->table);
+
   dict->here = dict->base;
   ficlDictionaryAlign(dict);
   hash = (ficlHash *)dict->here;
@@ -575,6 +712,7 @@ void ficlDictionaryEmpty(ficlDictionary *dict, unsigned bucketCount)
   ficlHashReset(hash);
   dict->forthWordlist = hash;
   dict->smudge = NULL;
+  dict->compiled = NULL;
   ficlDictionaryResetSearchOrder(dict);
 }
 
@@ -760,7 +898,9 @@ void ficlDictionarySee(ficlDictionary *dict, ficlWord *wrd)
       break;
       case FICL_WORDKIND_BRANCH0:
 	c = *++cell;
-	fth_printf("branch0 %d", (int)(cell + CELL_INT_REF(&c) - param0));
+	fth_printf("%sbranch0 %d",
+		   (long)word == ficlInstructionDupBranch0Paren ? "dup " : "",
+		   (int)(cell + CELL_INT_REF(&c) - param0));
 	break;                                                           
       case FICL_WORDKIND_BRANCH:
 	c = *++cell;
@@ -865,20 +1005,8 @@ void ficlDictionaryUnsmudge(ficlDictionary *dict)
   /*
   ** :noname words never get linked into the list...
   */
-  if (word->length > 0) {
-  /* [ms] ficlHashInsertWord is only called here.
-   * ficlHashInsertWord(hash, word);
-   */
-    ficlWord **pList;
-
-    if (hash->size == 1)
-      pList = hash->table;
-    else
-      pList = hash->table + (word->hash % hash->size);
-
-    word->link = *pList;
-    *pList = word;
-  }
+  if (word->length > 0)
+    ficlHashInsertWord(hash, word);
   word->flags &= ~(FICL_WORD_SMUDGED);
 }
 
@@ -166,7 +166,10 @@ Example:\n\
 
   if (FICL_COUNTED_STRING_GET_LENGTH(*counted) > 0)
   {
-    int returnValue = system(FICL_COUNTED_STRING_GET_POINTER(*counted));
+    int returnValue;
+
+    fth_port_flush_output();	/* [ms] */
+    returnValue = system(FICL_COUNTED_STRING_GET_POINTER(*counted));
 
     returnValue = fth_set_exit_status(returnValue);
     if (returnValue)
@@ -283,6 +283,39 @@ typedef float ficlFloat;
 */
 /* FICL_ROBUST removed [ms] */
 
+/*
+** FICL_WANT_THREADED: if 1, ficlVmInnerLoop() dispatches instructions
+** with computed goto (labels as values, GCC and Clang) instead of the
+** switch statement.  Compile with -DFICL_WANT_THREADED=0 to get the
+** switch loop. [ms]
+*/
+#if !defined(FICL_WANT_THREADED)
+#if defined(__GNUC__)
+#define FICL_WANT_THREADED	1
+#else
+#define FICL_WANT_THREADED	0
+#endif
+#endif
+
+/*
+** FICL_WANT_BIGRAMS: if 1, ficlVmInnerLoop() counts pairs of executed
+** instructions for the word .bigrams.  The counts show which pairs
+** are worth a superinstruction, see ficlDictionaryCompileInstruction().
+** Costs a table update per instruction, default 0. [ms]
+*/
+#if !defined(FICL_WANT_BIGRAMS)
+#define FICL_WANT_BIGRAMS	0
+#endif
+
+/*
+** FICL_WANT_SUPERINSTRUCTIONS: if 1, the compiler fuses frequent pairs
+** of instructions into one, see ficlDictionaryCompileInstruction().
+** Default 1. [ms]
+*/
+#if !defined(FICL_WANT_SUPERINSTRUCTIONS)
+#define FICL_WANT_SUPERINSTRUCTIONS	1
+#endif
+
 /*
 ** FICL_DEFAULT_STACK_SIZE Specifies the default size (in CELLs) of
 ** a new virtual machine's stacks, unless overridden at 
@@ -361,6 +394,14 @@ typedef float ficlFloat;
 #define FICL_HASH_SIZE		(241)
 #endif
 
+/*
+** [ms] Hashed wordlists double their bucket count when they hold
+** more than FICL_HASH_LOAD words per bucket.
+*/
+#if !defined (FICL_HASH_LOAD)
+#define FICL_HASH_LOAD		(2)
+#endif
+
 /*
 ** Default number of USER flags.
 */
@@ -949,6 +990,9 @@ ficlString	ficlVmGetWord(ficlVm *);
 ficlString	ficlVmGetWord0(ficlVm *);
 int		ficlVmGetWordToPad(ficlVm *);
 void		ficlVmInnerLoop(ficlVm *, ficlWord *volatile);
+#if FICL_WANT_BIGRAMS
+extern ficlUnsigned ficlVmBigrams[][ficlInstructionLast + 1];
+#endif
 ficlString	ficlVmParseString(ficlVm *, char);
 ficlString	ficlVmParseStringEx(ficlVm *, char, int);
 ficlCell	ficlVmPop(ficlVm *);
@@ -1219,11 +1263,14 @@ typedef struct ficlHash {
 	char           *name;	/* optional pointer to \0 terminated wordlist
 				 * name */
 	unsigned	size;	/* number of buckets in the hash */
-	ficlWord       *table[1];
+	unsigned	count;	/* number of words in the hash [ms] */
+	ficlWord      **table;	/* buckets, initially or grown [ms] */
+	ficlWord       *buckets[1];	/* initial buckets [ms] */
 } ficlHash;
 
 void		ficlHashForget(ficlHash *, void *);
 ficlUnsigned	ficlHashCode(ficlString);
+ficlHash       *ficlHashGrownTable(void *);
 void		ficlHashInsertWord(ficlHash *, ficlWord *);
 ficlWord       *ficlHashLookup(ficlHash *, ficlString, ficlUnsigned);
 void		ficlHashReset(ficlHash *);
@@ -1272,6 +1319,8 @@ struct ficlDictionary {
 	ficlInteger	wordlistCount;
 	ficlUnsigned	size;	/* Number of cells in dictionary (total) */
 	ficlSystem     *system;	/* used for debugging */
+	ficlCell       *compiled;	/* last instruction compiled by
+				 * ficlDictionaryCompileInstruction() */
 	ficlCell	base[1];	/* Base of dictionary memory */
 };
 
@@ -1286,6 +1335,9 @@ void		ficlDictionaryAppendFTH(ficlDictionary *, FTH);
 void		ficlDictionaryAppendCharacter(ficlDictionary *, char);
 void		ficlDictionaryAppendUnsigned(ficlDictionary *, ficlUnsigned);
 void           *ficlDictionaryAppendData(ficlDictionary *, void *, ficlInteger);
+void		ficlDictionaryCompileInstruction(ficlDictionary *,
+		    ficlInstruction);
+void		ficlDictionaryCompileBarrier(ficlDictionary *);
 char           *ficlDictionaryAppendString(ficlDictionary *, ficlString);
 ficlWord       *ficlDictionaryAppendWord(ficlDictionary *,
 		    ficlString, ficlPrimitive, ficlUnsigned);
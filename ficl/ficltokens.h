@@ -266,4 +266,17 @@ FICL_INSTRUCTION_TOKEN(ficlInstructionFDup,            "fdup",              FICL
 FICL_INSTRUCTION_TOKEN(ficlInstructionFSwap,           "fswap",             FICL_WORD_DEFAULT)
 FICL_INSTRUCTION_TOKEN(ficlInstructionFRot,            "frot",       	    FICL_WORD_DEFAULT)
 
+/* superinstructions, see ficlDictionaryCompileInstruction() [ms] */
+FICL_TOKEN(ficlInstructionLiteralLinkParen,        "(literal-link)")
+FICL_TOKEN(ficlInstructionLiteralLinkToLocalParen, "(literal-link-toLocal)")
+FICL_TOKEN(ficlInstructionUnlinkExitParen,         "(unlink-exit)")
+FICL_TOKEN(ficlInstructionDupBranch0Paren,         "(dup-branch0)")
+FICL_TOKEN(ficlInstructionLiteralPlus,             "(literal+)")
+FICL_TOKEN(ficlInstructionLiteralMinus,            "(literal-)")
+FICL_TOKEN(ficlInstructionLiteralStar,             "(literal*)")
+FICL_TOKEN(ficlInstructionLiteralEquals,           "(literal=)")
+FICL_TOKEN(ficlInstructionLiteralNotEquals,        "(literal<>)")
+FICL_TOKEN(ficlInstructionLiteralLess,             "(literal<)")
+FICL_TOKEN(ficlInstructionLiteralGreaterThan,      "(literal>)")
+
 FICL_TOKEN(ficlInstructionExitInnerLoop, "** exit inner loop **")
@@ -63,8 +63,15 @@
  * @(#)hash.c	1.17 10/17/13
  */
 
-#include "ficl.h"
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
 #include <ctype.h>
+#include <stdlib.h>
+#include "ficl.h"
+
+#include "fth.h"
 
 #define FICL_ASSERT_PHASH(expression) FICL_ASSERT((expression) != NULL)
 
@@ -87,7 +94,10 @@ void ficlHashForget(ficlHash *hash, void *where)
     pWord = hash->table[i];
 
     while ((void *)pWord >= where)
+    {
       pWord = pWord->link;
+      hash->count--;
+    }
 
     hash->table[i] = pWord;
   }
@@ -96,37 +106,109 @@ void ficlHashForget(ficlHash *hash, void *where)
 /**************************************************************************
  **                      h a s h H a s h C o d e
  ** 
- ** Generate a 16 bit hashcode from a character string using a rolling
- ** shift and add stolen from PJ Weinberger of Bell Labs fame. Case folds
- ** the name before hashing it...
+ ** Generate a 32 bit hashcode from a character string with FNV-1a.
+ ** Case folds the name before hashing it and hashes at most
+ ** FICL_NAME_LENGTH chars, the part ficlHashLookup() compares.
+ ** [ms] Replaces the 16 bit PJW hash which clustered badly on the
+ ** thousands of similar fth names.
  ** N O T E : If string has zero length, returns zero.
  **************************************************************************/
 ficlUnsigned ficlHashCode(ficlString s)
 {   
-  /* hashPJW */
   ficlUnsigned8 *trace;
-  ficlUnsigned16 code = (ficlUnsigned16)s.length;
-  ficlUnsigned16 shift = 0;
+  unsigned int code = 2166136261U;
+  ficlUnsigned length = s.length;
 
-  if (s.length == 0)
+  if (length == 0)
     return 0;
 
-  /* changed to run without errors under Purify -- lch */
-  for (trace = (ficlUnsigned8 *)s.text; s.length && *trace; trace++, s.length--)
-  {
-    code = (ficlUnsigned16)((code << 4) + tolower(*trace));
-    shift = (ficlUnsigned16)(code & 0xf000);
+  if (length > FICL_NAME_LENGTH)
+    length = FICL_NAME_LENGTH;
 
-    if (shift)
-    {
-      code ^= (shift >> (ficlUnsigned16)8);
-      code ^= shift;
-    }
+  for (trace = (ficlUnsigned8 *)s.text; length && *trace; trace++, length--)
+  {
+    code ^= (unsigned int)tolower(*trace);
+    code *= 16777619U;
   }
 
   return ((ficlUnsigned)code);
 }
 
+/*
+ * [ms] Chains are kept in descending address order which FORGET
+ * depends on.  Rehashing pushes the words in ascending address order
+ * to the front of the new chains to keep that order.
+ */
+static int ficlHashCompareWords(const void *a, const void *b)
+{
+  ficlWord *wa = *(ficlWord * const *)a;
+  ficlWord *wb = *(ficlWord * const *)b;
+
+  return ((wa > wb) - (wa < wb));
+}
+
+/*
+ * [ms] Hashes whose table ficlHashGrow() moved out of the dictionary.
+ * A dictionary image has to save those tables separately.
+ */
+static ficlHash **grownHashes;
+static unsigned grownCount;
+
+/*
+ * [ms] Return the hash whose table member is at CELL if its table
+ * lives outside the dictionary, otherwise NULL.
+ */
+ficlHash *ficlHashGrownTable(void *cell)
+{
+  unsigned i;
+
+  for (i = 0; i < grownCount; i++)
+    if ((void *)&grownHashes[i]->table == cell &&
+        grownHashes[i]->table != grownHashes[i]->buckets)
+      return grownHashes[i];
+
+  return NULL;
+}
+
+static void ficlHashGrow(ficlHash *hash)
+{
+  ficlWord **words, **table, *word;
+  unsigned i, n, size;
+
+  if (hash->table == hash->buckets)
+  {
+    grownHashes = FTH_REALLOC(grownHashes, (grownCount + 1) * sizeof(ficlHash *));
+    grownHashes[grownCount++] = hash;
+  }
+
+  words = FTH_MALLOC(hash->count * sizeof(ficlWord *));
+  n = 0;
+
+  for (i = 0; i < hash->size; i++)
+    for (word = hash->table[i]; word != NULL && n < hash->count; word = word->link)
+      words[n++] = word;
+
+  qsort(words, n, sizeof(ficlWord *), ficlHashCompareWords);
+  size = hash->size * 2 + 1;
+  table = FTH_CALLOC(size, sizeof(ficlWord *));
+
+  for (i = 0; i < n; i++)
+  {
+    word = words[i];
+    word->link = table[word->hash % size];
+    table[word->hash % size] = word;
+  }
+
+  FTH_FREE(words);
+
+  if (hash->table != hash->buckets)
+    FTH_FREE(hash->table);
+
+  hash->table = table;
+  hash->size = size;
+  hash->count = n;
+}
+
 /**************************************************************************
  **                      h a s h I n s e r t W o r d
  ** Put a word into the hash table using the word's hashcode as
@@ -150,6 +232,13 @@ void ficlHashInsertWord(ficlHash *hash, ficlWord *word)
 
   word->link = *pList;
   *pList = word;
+
+  /*
+  ** [ms] Wordlists with more than one bucket grow with their
+  ** population to keep the chains short.
+  */
+  if (++hash->count > FICL_HASH_LOAD * hash->size && hash->size > 1)
+    ficlHashGrow(hash);
 }
 
 /**************************************************************************
@@ -178,7 +267,8 @@ ficlWord *ficlHashLookup(ficlHash *hash, ficlString name, ficlUnsigned hashCode)
       hashIdx = 0;
 
     for (word = hash->table[hashIdx]; word != NULL; word = word->link)
-      if ((word->length == name.length) &&
+      if ((word->hash == hashCode) &&
+	  (word->length == name.length) &&
 	  (ficlStrincmp(name.text, word->name, nCmp) == 0))
 	return word;
   }
@@ -195,9 +285,12 @@ void ficlHashReset(ficlHash *hash)
 
   FICL_ASSERT_PHASH(hash);
 
+  hash->table = hash->buckets;
+
   for (i = 0; i < hash->size; i++)
     hash->table[i] = NULL;
 
+  hash->count = 0;
   hash->link = NULL;
   hash->name = NULL;
 }
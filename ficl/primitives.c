@@ -110,6 +110,7 @@ static char fallthroughTag[] = "fallthrough";
 */
 static void markBranch(ficlDictionary *dict, ficlVm *vm, char *tag)
 {
+  ficlDictionaryCompileBarrier(dict);
   ficlStackPushPointer(vm->dataStack, dict->here);
   ficlStackPushPointer(vm->dataStack, tag);
 }
@@ -165,6 +166,7 @@ static void resolveForwardBranch(ficlDictionary *dict, ficlVm *vm, char *tag)
   patchAddr = (ficlCell *)ficlStackPopPointer(vm->dataStack);
   offset = dict->here - patchAddr;
   CELL_INT_SET(patchAddr, offset);
+  ficlDictionaryCompileBarrier(dict);
 }
 
 /*
@@ -188,6 +190,7 @@ static void resolveAbsBranch(ficlDictionary *dict, ficlVm *vm, char *wantTag)
 	"unmatched control structure \"%s\"", wantTag);
   patchAddr = (ficlCell *)ficlStackPopPointer(vm->dataStack);
   CELL_VOIDP_SET(patchAddr, dict->here);
+  ficlDictionaryCompileBarrier(dict);
 }
 
 /**************************************************************************
@@ -230,7 +233,7 @@ static void ficlPrimitiveSemicolonCoIm(ficlVm *vm)
 
     locals = ficlSystemGetLocals(vm->callback.system);
     ficlDictionaryEmpty(locals, locals->forthWordlist->size);
-    PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionUnlinkParen);
+    PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionUnlinkExitParen);
   }
   vm->callback.system->localsCount = 0;
   PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionSemiParen);
@@ -259,8 +262,9 @@ the end of a colon definition, even if it uses EXIT."
   ficlDictionary *dict = ficlVmGetDictionary(vm);
 
   if (vm->callback.system->localsCount > 0)
-    PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionUnlinkParen);
-  PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionExitParen);
+    PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionUnlinkExitParen);
+  else
+    PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionExitParen);
 }
 
 /**************************************************************************
@@ -626,7 +630,7 @@ and pushes the branch patch address on the stack for later \
 patching by ELSE or THEN/ENDIF."
   ficlDictionary *dict = ficlVmGetDictionary(vm);
 
-  PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionBranch0ParenWithCheck);
+  ficlDictionaryCompileInstruction(dict, ficlInstructionBranch0ParenWithCheck);
   markBranch(dict, vm, origTag);
   PRIMITIVE_APPEND_UNSIGNED(dict, 1);
 }
@@ -1001,7 +1005,7 @@ into the dictionary preceded by the code for (LITERAL)."
   case 14:
   case 15:
   case 16:
-    PRIMITIVE_APPEND_UNSIGNED(dict, value);
+    ficlDictionaryCompileInstruction(dict, (ficlInstruction)value);
     break;
 
   case 0:
@@ -1021,10 +1025,11 @@ into the dictionary preceded by the code for (LITERAL)."
   case -14:
   case -15:
   case -16:
-    PRIMITIVE_APPEND_UNSIGNED(dict, (ficlInteger)ficlInstruction0 - value);
+    ficlDictionaryCompileInstruction(dict,
+	(ficlInstruction)(ficlInstruction0 - value));
     break;
   default:
-    PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionLiteralParen);
+    ficlDictionaryCompileInstruction(dict, ficlInstructionLiteralParen);
     PRIMITIVE_APPEND_UNSIGNED(dict, value);
     break;
   }
@@ -1152,11 +1157,14 @@ static void ficlPrimitiveAllot(ficlVm *vm)
   i = (int)ficlStackPopInteger(vm->dataStack);
   ficlVmDictionaryCheck(dict, i);
   ficlVmDictionaryAllot(dict, i);
+  if (i < 0)
+    fth_symbol_forget(dict->here);	/* [ms] */
 }
 
 static void ficlPrimitiveHere(ficlVm *vm)
 {
   FICL_STACK_CHECK(vm->dataStack, 0, 1);
+  ficlDictionaryCompileBarrier(ficlVmGetDictionary(vm));
   ficlStackPushPointer(vm->dataStack, ficlVmGetDictionary(vm)->here);
 }
 
@@ -1866,7 +1874,7 @@ static void ficlPrimitiveUntilCoIm(ficlVm *vm)
 {
   ficlDictionary *dict = ficlVmGetDictionary(vm);
 
-  PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionBranch0ParenWithCheck);
+  ficlDictionaryCompileInstruction(dict, ficlInstructionBranch0ParenWithCheck);
   resolveBackBranch(dict, vm, destTag);
 }
 
@@ -1875,7 +1883,7 @@ static void ficlPrimitiveWhileCoIm(ficlVm *vm)
   ficlDictionary *dict = ficlVmGetDictionary(vm);
 
   FICL_STACK_CHECK(vm->dataStack, 2, 5);
-  PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionBranch0ParenWithCheck);
+  ficlDictionaryCompileInstruction(dict, ficlInstructionBranch0ParenWithCheck);
   markBranch(dict, vm, origTag);
   /* equivalent to 2swap */
   ficlStackRoll(vm->dataStack, 3L);
@@ -2565,13 +2573,13 @@ exists when local is executed while in interpretation state."
 
     if (vm->callback.system->localsCount == 0)
     {   /* FICL_VM_STATE_COMPILE code to create a local stack frame */
-      PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionLinkParen);
+      ficlDictionaryCompileInstruction(dict, ficlInstructionLinkParen);
       /* save location in dictionary for #locals */
       vm->callback.system->localsFixup = dict->here;
       ficlDictionaryAppendInteger(dict, vm->callback.system->localsCount);
     }
 
-    PRIMITIVE_APPEND_UNSIGNED(dict, ficlInstructionToLocalParen);
+    ficlDictionaryCompileInstruction(dict, ficlInstructionToLocalParen);
     ficlDictionaryAppendInteger(dict,  vm->callback.system->localsCount);
     vm->callback.system->localsCount += 1;
   }
@@ -178,9 +178,10 @@ definition is immediate, minus-one (-1) otherwise."
   ficlString name;
   ficlUnsigned hashCode;
   ficlWord *word;
-  ficlHash *hash = ficlStackPopPointer(vm->dataStack);
+  ficlHash *hash;
 
   FICL_STACK_CHECK(vm->dataStack, 3, 1);
+  hash = ficlStackPopPointer(vm->dataStack);
   name.length = ficlStackPopUnsigned(vm->dataStack);
   name.text   = ficlStackPopPointer(vm->dataStack);
   hashCode    = ficlHashCode(name);
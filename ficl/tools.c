@@ -705,6 +705,7 @@ static void ficlPrimitiveForgetWid(ficlVm *vm)
 
   hash = (ficlHash *)ficlStackPopPointer(vm->dataStack);
   ficlHashForget(hash, dictionary->here);
+  fth_symbol_forget(dictionary->here);	/* [ms] */
 }
 
 /**************************************************************************
@@ -735,6 +736,7 @@ An ambiguous condition exists if the compilation word list is deleted."
   ficlPrimitiveTick(vm);
   where = ((ficlWord *)ficlStackPopPointer(vm->dataStack))->name;
   ficlHashForget(hash, where);
+  fth_symbol_forget(where);	/* [ms] */
   dictionary->here = FICL_POINTER_TO_CELL(where);
 }
 
@@ -862,6 +864,71 @@ allow Ficl code to set environment constants."
   ficlDictionaryAppendConstant(ficlSystemGetEnvironment(vm->callback.system), vm->pad, (ficlInteger)value);
 }
 
+#if FICL_WANT_BIGRAMS
+typedef struct {
+  ficlUnsigned count;
+  int first;
+  int second;
+} ficlBigram;
+
+static int
+ficlBigramCompare(const void *a, const void *b)
+{
+  ficlUnsigned ca = ((const ficlBigram *)a)->count;
+  ficlUnsigned cb = ((const ficlBigram *)b)->count;
+
+  return (ca < cb) ? 1 : (ca > cb) ? -1 : 0;
+}
+
+static char *
+ficlBigramName(int i)
+{
+  return (i == ficlInstructionLast) ? "(word)" : ficlDictionaryInstructionNames[i];
+}
+
+/* [ms] */
+static void ficlPrimitiveBigrams(ficlVm *vm)
+{
+#define h_ficlPrimitiveBigrams "( n -- )  print instruction pairs\n\
+20 .bigrams\n\
+Print the N most frequent pairs of instructions executed so far, \
+words other than instructions show as (word).  \
+Candidates for superinstructions come from this list.  \
+Requires Ficl compiled with FICL_WANT_BIGRAMS=1."
+  ficlBigram *pairs;
+  ficlUnsigned total = 0;
+  ficlInteger n;
+  int i, j, len = 0;
+
+  FICL_STACK_CHECK(vm->dataStack, 1, 0);
+  n = ficlStackPopInteger(vm->dataStack);
+  pairs = FTH_MALLOC(sizeof(ficlBigram) *
+      (ficlInstructionLast + 1) * (ficlInstructionLast + 1));
+
+  for (i = 0; i <= ficlInstructionLast; i++)
+    for (j = 0; j <= ficlInstructionLast; j++)
+      if (ficlVmBigrams[i][j] > 0)
+      {
+	pairs[len].count = ficlVmBigrams[i][j];
+	pairs[len].first = i;
+	pairs[len].second = j;
+	total += pairs[len].count;
+	len++;
+      }
+
+  qsort(pairs, (size_t)len, sizeof(ficlBigram), ficlBigramCompare);
+
+  for (i = 0; i < len && i < n; i++)
+    fth_printf("%12lu %5.2f%%  %s %s\n",
+	       (unsigned long)pairs[i].count,
+	       100.0 * pairs[i].count / total,
+	       ficlBigramName(pairs[i].first),
+	       ficlBigramName(pairs[i].second));
+
+  FTH_FREE(pairs);
+}
+#endif
+
 /**************************************************************************
  **                      f i c l C o m p i l e T o o l s
  ** Builds wordset for debugger and TOOLS optional word set
@@ -906,4 +973,7 @@ void ficlSystemCompileTools(ficlSystem *system)
   FICL_PRIM_DOC(dict, "forget-wid",    ficlPrimitiveForgetWid);
   FICL_PRIM_DOC(dict, "see-xt",        ficlPrimitiveSeeXT);
   FICL_PRIM_DOC(dict, ".hash-summary", ficlPrimitiveHashSummary);
+#if FICL_WANT_BIGRAMS
+  FICL_PRIM_DOC(dict, ".bigrams",      ficlPrimitiveBigrams);
+#endif
 }
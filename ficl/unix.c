@@ -91,6 +91,7 @@ ficlCallbackDefaultTextIn(ficlCallback *callback)
 	static char buf[BUFSIZ];
   
 	(void)callback;
+	fth_port_flush_output();	/* [ms] */
 	return fgets(buf, BUFSIZ, stdin);
 }
 
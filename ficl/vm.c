@@ -212,14 +212,21 @@ inline void ficlStackCheckNospill(ficlStack *stack, ficlCell *top, int popCells,
 }
 #endif
 
-#define _CHECK_STACK(stack_vm, top_vm, in_vm, out_vm)	\
-  do {							\
-    ficlStack *__stack__ = (ficlStack *)(stack_vm);	\
-    ficlCell *__old_top__ = __stack__->top;		\
-							\
-    __stack__->top = (top_vm);				\
-    ficlStackCheck(__stack__, (in_vm), (out_vm));	\
-    (stack_vm)->top = __old_top__;			\
+/*
+ * [ms] Check the local copy of top inline; only the error path spills
+ * and calls ficlStackCheck() for the exception.  This keeps dataTop
+ * and returnTop in registers.
+ */
+#define _CHECK_STACK(stack_vm, top_vm, in_vm, out_vm)			\
+  do {									\
+    ficlStack *__stack__ = (ficlStack *)(stack_vm);			\
+    ficlInteger __depth__ = (ficlInteger)((top_vm) - __stack__->base) + 1; \
+									\
+    if ((in_vm) > __depth__ ||						\
+	(out_vm) - (in_vm) > (ficlInteger)__stack__->size - __depth__) { \
+      LOCAL_VARIABLE_SPILL();						\
+      ficlStackCheck(__stack__, (in_vm), (out_vm));			\
+    }									\
   } while (0)
 
 #define CHECK_STACK(pop, push)          _CHECK_STACK(vm->dataStack, dataTop, pop, push)
@@ -288,28 +295,120 @@ inline void ficlStackCheckNospill(ficlStack *stack, ficlCell *top, int popCells,
     frame = vm->returnStack->frame;		\
   } while (0)
 
-void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
+#if FICL_WANT_BIGRAMS
+/*
+ * [ms] Pairs of instructions executed one after the other and
+ * adjacent in the definition, i.e. at most three argument cells
+ * between them; only these can be fused.  All words other than
+ * instructions count as ficlInstructionLast.
+ */
+ficlUnsigned ficlVmBigrams[ficlInstructionLast + 1][ficlInstructionLast + 1];
+
+#define BIGRAM_COUNT(x)							\
+  do {									\
+    ficlUnsigned __x__ = (ficlUnsigned)(x);				\
+									\
+    if (__x__ > ficlInstructionLast)					\
+      __x__ = ficlInstructionLast;					\
+    if (bigramIp != NULL && ip > bigramIp && ip - bigramIp <= 4)	\
+      ficlVmBigrams[bigram][__x__]++;					\
+    bigram = __x__;							\
+    bigramIp = ip;							\
+  } while (0)
+#else
+#define BIGRAM_COUNT(x)
+#endif
+
+#if FICL_WANT_THREADED
+/*
+ * [ms] Threaded code: every instruction ends with its own indirect
+ * jump through a table of label addresses (GCC's labels as values).
+ * The table has one entry per ficlInstruction plus the entry for
+ * words at ficlInstructionLast.  Running a single word (FW != NULL),
+ * the table of the following dispatch only leads to INNER_DONE.
+ *
+ * The exception handler can't use the local copies after longjmp(),
+ * they aren't volatile here.  Code throwing directly from the loop
+ * spills them before; everything else spills before calling out.  Only
+ * the locals assigned by the labels themselves (VM_CLOBBERED) stay
+ * volatile, as GCC can't see that setjmp() isn't returned to after
+ * they changed.
+ */
+#define VM_VOLATILE
+#define VM_CLOBBERED		volatile
+#define CASE(x)			case x: L_##x:
+#define DISPATCH(table, x)						\
+  goto *(table)[(ficlUnsigned)(x) < ficlInstructionLast ?		\
+		(ficlUnsigned)(x) : ficlInstructionLast]
+#define NEXT()								\
+  do {									\
+    if (ip == NULL)							\
+      goto INNER_QUIT;							\
+    instruction = *ip++;						\
+    fw = (ficlWord *)instruction;					\
+    BIGRAM_COUNT(instruction);						\
+    DISPATCH(dispatch, instruction);					\
+  } while (0)
+#else
+#define VM_VOLATILE		volatile
+#define VM_CLOBBERED		volatile
+#define CASE(x)			case x:
+#define NEXT()			continue
+#endif
+
+/* The case labels come from CASE(), where a comment can't mark them. */
+#if defined(__has_attribute)
+#if __has_attribute(__fallthrough__)
+#define FALLTHROUGH		__attribute__((__fallthrough__))
+#endif
+#endif
+#if !defined(FALLTHROUGH)
+#define FALLTHROUGH		do { } while (0)
+#endif
+
+void ficlVmInnerLoop(ficlVm *vm, ficlWord *VM_CLOBBERED fw)
 {
-  ficlInstruction *volatile ip = NULL;
-  ficlCell *volatile dataTop;
-  ficlCell *volatile returnTop;
-  ficlCell *volatile frame;
+  ficlInstruction *VM_VOLATILE ip = NULL;
+  ficlCell *VM_VOLATILE dataTop;
+  ficlCell *VM_VOLATILE returnTop;
+  ficlCell *VM_CLOBBERED frame;
   jmp_buf *volatile oldExceptionHandler;
   jmp_buf exceptionHandler;
   volatile int except;
+#if FICL_WANT_THREADED
+  static void *const labels[] = {
+#define FICL_TOKEN(token, description)                    &&L_##token,
+#define FICL_INSTRUCTION_TOKEN(token, description, flags) &&L_##token,
+#include "ficltokens.h"
+#undef FICL_TOKEN
+#undef FICL_INSTRUCTION_TOKEN
+    &&L_ficlInstructionLast
+  };
+  static void *const once[] = {
+    [0 ... ficlInstructionLast] = &&INNER_DONE
+  };
+  void *const *dispatch;
+#else
   volatile int once;
   volatile int count = 0;
-  volatile ficlInstruction instruction = 0;
-  volatile ficlInteger i;
-  volatile ficlUnsigned u;
-  volatile ficlFloat df;
-  volatile ficlCell c;
-  ficlCountedString *volatile s;
-  char *volatile cp;
+#endif
+  VM_CLOBBERED ficlInstruction instruction = 0;
+  VM_VOLATILE ficlInteger i;
+  VM_VOLATILE ficlUnsigned u;
+  VM_VOLATILE ficlFloat df;
+  VM_VOLATILE ficlCell c;
+  ficlCountedString *VM_CLOBBERED s;
+  char *VM_VOLATILE cp;
   ficlCell *cell = NULL;
+#if FICL_WANT_BIGRAMS
+  ficlUnsigned bigram = ficlInstructionLast;
+  ficlInstruction *bigramIp = NULL;
+#endif
 
+#if !FICL_WANT_THREADED
   if ((once = (fw != NULL)))
     count = 1;
+#endif
 
   LOCAL_VARIABLE_REFILL();
   oldExceptionHandler = vm->exceptionHandler;
@@ -318,13 +417,33 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
 
   if (except)
   {
+#if !FICL_WANT_THREADED
     LOCAL_VARIABLE_SPILL();
+#endif
     vm->exceptionHandler = oldExceptionHandler;
     ficlVmThrow(vm, except);
   }
 
+#if FICL_WANT_THREADED
+  if (fw != NULL)
+  {
+    dispatch = once;
+    instruction = (ficlInstruction)((void *)fw);
+    DISPATCH(labels, instruction);
+  }
+  dispatch = labels;
+  NEXT();
+
+INNER_QUIT:
+  if (dispatch == once)
+    goto INNER_DONE;
+  LOCAL_VARIABLE_SPILL();
+  ficlVmThrow(vm, FICL_VM_STATUS_QUIT);
+#endif
+
   for (;;)
   {
+#if !FICL_WANT_THREADED
     if (once)
     {
       if (!count--)
@@ -338,67 +457,70 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
       {
 	instruction = *ip++;
 	fw = (ficlWord *)instruction;
+	BIGRAM_COUNT(instruction);
       }
       else
 	ficlVmThrow(vm, FICL_VM_STATUS_QUIT);
     }
       
   AGAIN:
+#endif
     switch (instruction)
     {
-    case ficlInstructionInvalid:
+    CASE(ficlInstructionInvalid)
+      LOCAL_VARIABLE_SPILL();
       ficlVmThrowError(vm, "invalid instruction detected");
       return;
 
-    case ficlInstruction1:
-    case ficlInstruction2:
-    case ficlInstruction3:
-    case ficlInstruction4:
-    case ficlInstruction5:
-    case ficlInstruction6:
-    case ficlInstruction7:
-    case ficlInstruction8:
-    case ficlInstruction9:
-    case ficlInstruction10:
-    case ficlInstruction11:
-    case ficlInstruction12:
-    case ficlInstruction13:
-    case ficlInstruction14:
-    case ficlInstruction15:
-    case ficlInstruction16:
+    CASE(ficlInstruction1)
+    CASE(ficlInstruction2)
+    CASE(ficlInstruction3)
+    CASE(ficlInstruction4)
+    CASE(ficlInstruction5)
+    CASE(ficlInstruction6)
+    CASE(ficlInstruction7)
+    CASE(ficlInstruction8)
+    CASE(ficlInstruction9)
+    CASE(ficlInstruction10)
+    CASE(ficlInstruction11)
+    CASE(ficlInstruction12)
+    CASE(ficlInstruction13)
+    CASE(ficlInstruction14)
+    CASE(ficlInstruction15)
+    CASE(ficlInstruction16)
       CHECK_STACK(0, 1);
       ++dataTop;
       VM_STACK_INT_SET(dataTop, instruction);
-      continue;
-
-    case ficlInstruction0:
-    case ficlInstructionNeg1:
-    case ficlInstructionNeg2:
-    case ficlInstructionNeg3:
-    case ficlInstructionNeg4:
-    case ficlInstructionNeg5:
-    case ficlInstructionNeg6:
-    case ficlInstructionNeg7:
-    case ficlInstructionNeg8:
-    case ficlInstructionNeg9:
-    case ficlInstructionNeg10:
-    case ficlInstructionNeg11:
-    case ficlInstructionNeg12:
-    case ficlInstructionNeg13:
-    case ficlInstructionNeg14:
-    case ficlInstructionNeg15:
-    case ficlInstructionNeg16:
+      NEXT();
+
+    CASE(ficlInstruction0)
+    CASE(ficlInstructionNeg1)
+    CASE(ficlInstructionNeg2)
+    CASE(ficlInstructionNeg3)
+    CASE(ficlInstructionNeg4)
+    CASE(ficlInstructionNeg5)
+    CASE(ficlInstructionNeg6)
+    CASE(ficlInstructionNeg7)
+    CASE(ficlInstructionNeg8)
+    CASE(ficlInstructionNeg9)
+    CASE(ficlInstructionNeg10)
+    CASE(ficlInstructionNeg11)
+    CASE(ficlInstructionNeg12)
+    CASE(ficlInstructionNeg13)
+    CASE(ficlInstructionNeg14)
+    CASE(ficlInstructionNeg15)
+    CASE(ficlInstructionNeg16)
       CHECK_STACK(0, 1);
       ++dataTop;
       VM_STACK_INT_SET(dataTop, ficlInstruction0 - instruction);
-      continue;
+      NEXT();
 
       /**************************************************************************
        ** stringlit: Fetch the count from the dictionary, then push the address
        ** and count on the stack. Finally, update ip to point to the first
        ** aligned address after the string text.
        **************************************************************************/
-    case ficlInstructionStringLiteralParen:
+    CASE(ficlInstructionStringLiteralParen)
     {
       ficlUnsigned length;
 
@@ -422,10 +544,10 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
       cp += length + 1;
       cp = ficlAlignPointer(cp);
       ip = (void *)cp;
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionCStringLiteralParen:
+    CASE(ficlInstructionCStringLiteralParen)
       CHECK_STACK(0, 1);
       s = (ficlCountedString *)(ip);
 
@@ -437,25 +559,35 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
       ip = (void *)cp;
       ++dataTop;
       VM_STACK_VOIDP_SET(dataTop, s);
-      continue;
+      NEXT();
 
-#define PUSH_CELL_POINTER(cp)        cell = (cp); *++dataTop = *cell; continue
-#define POP_CELL_POINTER(cp)         cell = (cp); *cell = *dataTop--; continue
+#define PUSH_CELL_POINTER(cp)        cell = (cp); *++dataTop = *cell; NEXT()
+#define POP_CELL_POINTER(cp)         cell = (cp); *cell = *dataTop--; NEXT()
       
-#define BRANCH()                     if (ip) ip += *(long *)ip; continue
-#define EXIT_FUNCTION() ip = (ficlInstruction *)(VM_STACK_VOIDP_REF(returnTop)); returnTop--; continue
+#if !defined(_WIN32)
+/* [ms] pending interrupt, see fth_signal_deliver() */
+#define SIGNAL_CHECK()							\
+  if (fth_signal_pending) {						\
+    LOCAL_VARIABLE_SPILL();						\
+    fth_signal_deliver(vm);						\
+  }
+#else
+#define SIGNAL_CHECK()
+#endif
+#define BRANCH()                     SIGNAL_CHECK(); if (ip) ip += *(long *)ip; NEXT()
+#define EXIT_FUNCTION() ip = (ficlInstruction *)(VM_STACK_VOIDP_REF(returnTop)); returnTop--; NEXT()
 
       /**************************************************************************
        ** This is the runtime for (literal). It assumes that it is part of a colon
        ** definition, and that the next ficlCell contains a value to be pushed on the
        ** parameter stack at runtime. This code is compiled by "literal".
        **************************************************************************/
-    case ficlInstructionLiteralParen:
+    CASE(ficlInstructionLiteralParen)
       CHECK_STACK(0, 1);
       ++dataTop;
       VM_STACK_INT_SET(dataTop, *ip);
       ip++;
-      continue;
+      NEXT();
 
       /**************************************************************************
        ** Link a frame on the return stack, reserving nCells of space for
@@ -465,7 +597,7 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
        ** 2) frame = returnTop
        ** 3) returnTop += nCells
        **************************************************************************/
-    case ficlInstructionLinkParen:
+    CASE(ficlInstructionLinkParen)
     {
       ficlInteger nCells = *ip++;
 
@@ -473,7 +605,7 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
       VM_STACK_VOIDP_SET(returnTop, frame);
       frame = returnTop + 1;
       returnTop += nCells;
-      continue;
+      NEXT();
     }
 
     /**************************************************************************
@@ -481,28 +613,28 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
      ** 1) dataTop = frame
      ** 2) frame = pop()
      *******************************************************************/
-    case ficlInstructionUnlinkParen:
+    CASE(ficlInstructionUnlinkParen)
       returnTop = frame - 1;
       frame = VM_STACK_VOIDP_REF(returnTop);
       returnTop--;
-      continue;
+      NEXT();
 
       /**************************************************************************
        ** Immediate - cfa of a local while compiling - when executed, compiles
        ** code to fetch the value of a local given the local's index in the
        ** word's pfa
        **************************************************************************/
-    case ficlInstructionGetLocalParen:
+    CASE(ficlInstructionGetLocalParen)
       PUSH_CELL_POINTER(frame + *ip++);
 
       /*
       ** Silly little minor optimizations.
       ** --lch
       */
-    case ficlInstructionGetLocal0:
+    CASE(ficlInstructionGetLocal0)
       PUSH_CELL_POINTER(frame);
 
-    case ficlInstructionGetLocal1:
+    CASE(ficlInstructionGetLocal1)
       PUSH_CELL_POINTER(frame + 1);
 
       /**************************************************************************
@@ -510,13 +642,13 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
        ** code to store the value of a local given the local's index in the
        ** word's pfa
        **************************************************************************/
-    case ficlInstructionToLocalParen:
+    CASE(ficlInstructionToLocalParen)
       POP_CELL_POINTER(frame + *ip++);
 
-    case ficlInstructionToLocal0:
+    CASE(ficlInstructionToLocal0)
       POP_CELL_POINTER(frame);
 
-    case ficlInstructionToLocal1:
+    CASE(ficlInstructionToLocal1)
       POP_CELL_POINTER(frame + 1);
 
 #define POP_LOCAL_VAR_ADD(cp)					\
@@ -538,17 +670,17 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
        * plus-store local vars [ms]
        * +to ( val "name" -- )
        */
-    case ficlInstructionPlusToLocalParen:
+    CASE(ficlInstructionPlusToLocalParen)
       POP_LOCAL_VAR_ADD(frame + *ip++);
-      continue;
+      NEXT();
 
-    case ficlInstructionPlusToLocal0:
+    CASE(ficlInstructionPlusToLocal0)
       POP_LOCAL_VAR_ADD(frame);
-      continue;
+      NEXT();
 
-    case ficlInstructionPlusToLocal1:
+    CASE(ficlInstructionPlusToLocal1)
       POP_LOCAL_VAR_ADD(frame + 1);
-      continue;
+      NEXT();
 
 #define POP_LOCAL_VAR_FADD(cp)					\
       do {							\
@@ -567,29 +699,29 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
        * fplus-store local vars [ms]
        * f+to ( val "name" -- )
        */
-    case ficlInstructionFPlusToLocalParen:
+    CASE(ficlInstructionFPlusToLocalParen)
       POP_LOCAL_VAR_FADD(frame + *ip++);
-      continue;
+      NEXT();
 
-    case ficlInstructionFPlusToLocal0:
+    CASE(ficlInstructionFPlusToLocal0)
       POP_LOCAL_VAR_FADD(frame);
-      continue;
+      NEXT();
 
-    case ficlInstructionFPlusToLocal1:
+    CASE(ficlInstructionFPlusToLocal1)
       POP_LOCAL_VAR_FADD(frame + 1);
-      continue;
+      NEXT();
 
-    case ficlInstructionDup:
-    case ficlInstructionFDup:
+    CASE(ficlInstructionDup)
+    CASE(ficlInstructionFDup)
       CHECK_STACK(1, 2);
       i = VM_STACK_INT_REF(dataTop);
       ++dataTop;
       VM_STACK_INT_SET(dataTop, i);
-      continue;
+      NEXT();
 
     /* WITHIN for all numbers. */
     /* [ms] ( test low high -- flag ) */
-    case ficlInstructionWithin:
+    CASE(ficlInstructionWithin)
     {
       FTH test, low, high;
       int flag;
@@ -602,10 +734,10 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
       test = ficl_to_fth(VM_STACK_FTH_REF(dataTop));
       flag = !fth_number_less_p(test, low) && fth_number_less_p(test, high);
       VM_STACK_BOOL_SET(dataTop, flag);
-      continue;
+      NEXT();
     }
 	
-    case ficlInstructionQuestionDup:
+    CASE(ficlInstructionQuestionDup)
       CHECK_STACK(1, 2);
 
       if (VM_NOT_FALSE_P(VM_STACK_FTH_REF(dataTop)))
@@ -613,10 +745,10 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
 	dataTop[1] = dataTop[0];
 	dataTop++;
       }
-      continue;
+      NEXT();
 
-    case ficlInstructionSwap:
-    case ficlInstructionFSwap:
+    CASE(ficlInstructionSwap)
+    CASE(ficlInstructionFSwap)
     {
       ficlCell swap;
 
@@ -624,23 +756,23 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
       swap = dataTop[0];
       dataTop[0] = dataTop[-1];
       dataTop[-1] = swap;
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionDrop:
-    case ficlInstructionFDrop:
+    CASE(ficlInstructionDrop)
+    CASE(ficlInstructionFDrop)
       CHECK_STACK(1, 0);
       dataTop--;
-      continue;
+      NEXT();
 
       /* [ms] ( y x -- x ) */
-    case ficlInstructionNip:
+    CASE(ficlInstructionNip)
       CHECK_STACK(2, 1);
       dataTop[-1] = dataTop[0];
       dataTop--;
-      continue;
+      NEXT();
       /* [ms] ( y x -- x y x ) */
-    case ficlInstructionTuck:
+    CASE(ficlInstructionTuck)
     {
       ficlCell swap;
 	  
@@ -649,50 +781,50 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
       dataTop[-1] = dataTop[1] = dataTop[0]; /* x */
       dataTop[0] = swap;			 /* y */
       dataTop++;
-      continue;
+      NEXT();
     }
 
-    case ficlInstruction2Drop:
+    CASE(ficlInstruction2Drop)
       CHECK_STACK(2, 0);
       dataTop -= 2;
-      continue;
+      NEXT();
 
-    case ficlInstruction2Dup:
+    CASE(ficlInstruction2Dup)
       CHECK_STACK(2, 4);
       dataTop[1] = dataTop[-1];
       dataTop[2] = *dataTop;
       dataTop += 2;
-      continue;
+      NEXT();
 
-    case ficlInstructionOver:
-    case ficlInstructionFOver:
+    CASE(ficlInstructionOver)
+    CASE(ficlInstructionFOver)
       CHECK_STACK(2, 3);
       dataTop[1] = dataTop[-1];
       dataTop++;
-      continue;
+      NEXT();
 
-    case ficlInstruction2Over:
+    CASE(ficlInstruction2Over)
       CHECK_STACK(4, 6);
       dataTop[1] = dataTop[-3];
       dataTop[2] = dataTop[-2];
       dataTop += 2;
-      continue;
+      NEXT();
 
-    case ficlInstructionPick:
+    CASE(ficlInstructionPick)
       CHECK_STACK(1, 0);
       i = VM_STACK_INT_REF(dataTop);
       if (i < 0)
-	continue;
+	NEXT();
       CHECK_STACK((int)i + 1, (int)i + 2);
       *dataTop = dataTop[-i];
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do stack rot.
        ** rot ( 1 2 3  -- 2 3 1 )
        *******************************************************************/
-    case ficlInstructionRot:
-    case ficlInstructionFRot:
+    CASE(ficlInstructionRot)
+    CASE(ficlInstructionFRot)
       i = 2;
       goto ROLL;
 
@@ -700,24 +832,24 @@ void ficlVmInnerLoop(ficlVm *vm, ficlWord *volatile fw)
        ** Do stack roll.
        ** roll ( n -- )
        *******************************************************************/
-    case ficlInstructionRoll:
+    CASE(ficlInstructionRoll)
       CHECK_STACK(1, 0);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       if (i < 1)
-	continue;
+	NEXT();
 ROLL:
       CHECK_STACK((int)i + 1, (int)i + 2);
       c = dataTop[-i];
       memmove(dataTop - i, dataTop - (i - 1), (size_t)i * sizeof(ficlCell));
       *dataTop = c;
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do stack -rot.
        ** -rot ( 1 2 3  -- 3 1 2 )
        *******************************************************************/
-    case ficlInstructionMinusRot:
+    CASE(ficlInstructionMinusRot)
       i = 2;
       goto MINUSROLL;
 
@@ -725,24 +857,24 @@ ROLL:
        ** Do stack -roll.
        ** -roll ( n -- )
        *******************************************************************/
-    case ficlInstructionMinusRoll:
+    CASE(ficlInstructionMinusRoll)
       CHECK_STACK(1, 0);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       if (i < 1)
-	continue;
+	NEXT();
 MINUSROLL:
       CHECK_STACK((int)i + 1, (int)i + 2);
       c = *dataTop;
       memmove(dataTop - (i - 1), dataTop - i, (size_t)i * sizeof(ficlCell));
       dataTop[-i] = c;
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do stack 2swap
        ** 2swap ( 1 2 3 4  -- 3 4 1 2 )
        *******************************************************************/
-    case ficlInstruction2Swap:
+    CASE(ficlInstruction2Swap)
     {
       ficlCell c2;
 
@@ -753,10 +885,10 @@ MINUSROLL:
       dataTop[-1] = dataTop[-3];
       dataTop[-2] = c;
       dataTop[-3] = c2;
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionPlusStore:
+    CASE(ficlInstructionPlusStore)
     {
       FTH x;
 	    
@@ -772,19 +904,19 @@ MINUSROLL:
 	CELL_INT_REF(cell) += VM_STACK_INT_REF(dataTop);
       dataTop--;
     }
-    continue;
+    NEXT();
 
-    case ficlInstructionCFetch:
+    CASE(ficlInstructionCFetch)
     {
       ficlUnsigned8 *integer8;
 
       CHECK_STACK(1, 1);
       integer8 = (ficlUnsigned8 *)VM_STACK_VOIDP_REF(dataTop);
       VM_STACK_UINT_SET(dataTop, *integer8);
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionCStore:
+    CASE(ficlInstructionCStore)
     {
       ficlUnsigned8 *integer8;
 
@@ -793,10 +925,10 @@ MINUSROLL:
       dataTop--;
       *integer8 = (ficlUnsigned8)VM_STACK_UINT_REF(dataTop);
       dataTop--;
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionAnd:
+    CASE(ficlInstructionAnd)
       CHECK_STACK(2, 1);
       if (fth_instance_p(VM_STACK_FTH_REF(dataTop)))
       {
@@ -817,9 +949,9 @@ MINUSROLL:
 	dataTop--;
 	VM_STACK_INT_REF(dataTop) &= i;
       }
-      continue;
+      NEXT();
 
-    case ficlInstructionOr:
+    CASE(ficlInstructionOr)
       CHECK_STACK(2, 1);
       if (fth_instance_p(VM_STACK_FTH_REF(dataTop)))
       {
@@ -842,64 +974,64 @@ MINUSROLL:
 	dataTop--;
 	VM_STACK_INT_REF(dataTop) |= i;
       }
-      continue;
+      NEXT();
 
-    case ficlInstructionXor:
+    CASE(ficlInstructionXor)
       CHECK_STACK(2, 1);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       VM_STACK_INT_REF(dataTop) ^= i;
-      continue;
+      NEXT();
 
-    case ficlInstructionInvert:
+    CASE(ficlInstructionInvert)
       CHECK_STACK(1, 1);
       VM_STACK_INT_REF(dataTop) = ~VM_STACK_INT_REF(dataTop);
-      continue;
+      NEXT();
 
       /**************************************************************************
        ** r e t u r n   s t a c k
        ** 
        **************************************************************************/
-    case ficlInstructionToRStack:
+    CASE(ficlInstructionToRStack)
       CHECK_STACK(1, 0);
       CHECK_RETURN_STACK(0, 1);
       *++returnTop = *dataTop--;
-      continue;
+      NEXT();
 
-    case ficlInstructionFromRStack:
+    CASE(ficlInstructionFromRStack)
       CHECK_STACK(0, 1);
       CHECK_RETURN_STACK(1, 0);
       *++dataTop = *returnTop--;
-      continue;
+      NEXT();
 
-    case ficlInstructionFetchRStack:
+    CASE(ficlInstructionFetchRStack)
       CHECK_STACK(0, 1);
       CHECK_RETURN_STACK(1, 1);
       *++dataTop = *returnTop;
-      continue;
+      NEXT();
 
-    case ficlInstruction2ToR:
+    CASE(ficlInstruction2ToR)
       CHECK_STACK(2, 0);
       CHECK_RETURN_STACK(0, 2);
       *++returnTop = dataTop[-1];
       *++returnTop = dataTop[0];
       dataTop -= 2;
-      continue;
+      NEXT();
 
-    case ficlInstruction2RFrom:
+    CASE(ficlInstruction2RFrom)
       CHECK_STACK(0, 2);
       CHECK_RETURN_STACK(2, 0);
       *++dataTop = returnTop[-1];
       *++dataTop = returnTop[0];
       returnTop -= 2;
-      continue;
+      NEXT();
 
-    case ficlInstruction2RFetch:
+    CASE(ficlInstruction2RFetch)
       CHECK_STACK(0, 2);
       CHECK_RETURN_STACK(2, 2);
       *++dataTop = returnTop[-1];
       *++dataTop = returnTop[0];
-      continue;
+      NEXT();
 
       /**************************************************************************
        **				f i l l
@@ -907,7 +1039,7 @@ MINUSROLL:
        ** If u is greater than zero, store char in each of u consecutive
        ** characters of memory beginning at c-addr. 
        **************************************************************************/
-    case ficlInstructionFill:
+    CASE(ficlInstructionFill)
     {
       char ch;
       char *memory;
@@ -921,7 +1053,7 @@ MINUSROLL:
       dataTop--;
       /* memset() is faster than the previous hand-rolled solution.  --lch */
       memset(memory, ch, u);
-      continue;
+      NEXT();
     }
 
     /**************************************************************************
@@ -934,7 +1066,7 @@ MINUSROLL:
      ** NOTE! This implementation assumes that a char is the same size as
      **       an address unit.
      **************************************************************************/
-    case ficlInstructionMove:
+    CASE(ficlInstructionMove)
     {
       char *addr2;
       char *addr1;
@@ -948,14 +1080,14 @@ MINUSROLL:
       dataTop--;
 
       if (u == 0) 
-	continue;
+	NEXT();
       /*
       ** Do the copy carefully, so as to be
       ** correct even if the two ranges overlap
       */
       /* Which ANSI C's memmove() does for you!  Yay!  --lch */
       memmove(addr2, addr1, u);
-      continue;
+      NEXT();
     }
 
     /**************************************************************************
@@ -972,11 +1104,11 @@ MINUSROLL:
      ** lesser numeric value than the corresponding character in the string specified
      ** by c-addr2 u2 and one (1) otherwise. 
      **************************************************************************/
-    case ficlInstructionCompare:
+    CASE(ficlInstructionCompare)
       i = FICL_FALSE;
       goto COMPARE;
 
-    case ficlInstructionCompareInsensitive:
+    CASE(ficlInstructionCompareInsensitive)
       i = FICL_TRUE;
       goto COMPARE;
     COMPARE:
@@ -1020,7 +1152,7 @@ MINUSROLL:
 
 	++dataTop;
 	VM_STACK_INT_SET(dataTop, n);
-	continue;
+	NEXT();
       }
 
     /**************************************************************************
@@ -1030,8 +1162,8 @@ MINUSROLL:
      ** are in two different functions so that "see" can correctly identify
      ** the end of a colon definition, even if it uses "exit".
      **************************************************************************/
-    case ficlInstructionExitParen:
-    case ficlInstructionSemiParen:
+    CASE(ficlInstructionExitParen)
+    CASE(ficlInstructionSemiParen)
       EXIT_FUNCTION();
 
       /**************************************************************************
@@ -1039,7 +1171,7 @@ MINUSROLL:
        ** see if we're jumping to another unconditional jump.  If so, just jump
        ** directly there.
        **************************************************************************/
-    case ficlInstructionBranchParenWithCheck:
+    CASE(ficlInstructionBranchParenWithCheck)
       LOCAL_VARIABLE_SPILL();
       ficlVmOptimizeJumpToJump(vm, vm->ip - 1);
       LOCAL_VARIABLE_REFILL();
@@ -1048,7 +1180,7 @@ MINUSROLL:
       /**************************************************************************
        ** Same deal with branch0.
        **************************************************************************/
-    case ficlInstructionBranch0ParenWithCheck:
+    CASE(ficlInstructionBranch0ParenWithCheck)
       LOCAL_VARIABLE_SPILL();
       ficlVmOptimizeJumpToJump(vm, vm->ip - 1);
       LOCAL_VARIABLE_REFILL();
@@ -1058,8 +1190,8 @@ MINUSROLL:
        ** Runtime code for "(branch0)"; pop a flag from the stack,
        ** branch if 0. fall through otherwise.  The heart of "if" and "until".
        **************************************************************************/
-      /* fall through */
-    case ficlInstructionBranch0Paren:
+      FALLTHROUGH;
+    CASE(ficlInstructionBranch0Paren)
     {
       FTH val;
 	    
@@ -1071,7 +1203,7 @@ MINUSROLL:
       {
 	/* don't branch, but skip over branch relative address */
 	ip += 1;
-	continue;
+	NEXT();
       }
     }
     /* otherwise, take branch (to else/endif/begin) */
@@ -1081,14 +1213,14 @@ MINUSROLL:
      ** Runtime for "(branch)" -- expects a literal offset in the next
      ** compilation address, and branches to that location.
      **************************************************************************/
-    /* fall through */
-    case ficlInstructionBranchParen:
+    FALLTHROUGH;
+    CASE(ficlInstructionBranchParen)
     {
     BRANCH_PAREN:
       BRANCH();
     }
 
-    case ficlInstructionOfParen:
+    CASE(ficlInstructionOfParen)
     {
       ficlUnsigned a, b;
 
@@ -1109,10 +1241,10 @@ MINUSROLL:
 	/* take branch to next of or endcase */
 	BRANCH();
       }
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionDoParen:
+    CASE(ficlInstructionDoParen)
     {
       ficlCell index, limit;
 
@@ -1126,10 +1258,10 @@ MINUSROLL:
       *++returnTop = limit;
       *++returnTop = index;
       gc_push(vm->runningWord);	/* [ms] okay */
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionQDoParen:
+    CASE(ficlInstructionQDoParen)
     {
       volatile ficlCell index, limit, leave;
 
@@ -1149,11 +1281,11 @@ MINUSROLL:
 	*++returnTop = index;
 	gc_push(vm->runningWord); /* [ms] okay */
       }
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionLoopParen:
-    case ficlInstructionPlusLoopParen:
+    CASE(ficlInstructionLoopParen)
+    CASE(ficlInstructionPlusLoopParen)
     {
       ficl2Integer index;
       ficl2Integer limit;
@@ -1191,7 +1323,7 @@ MINUSROLL:
 	  VM_STACK_LONG_SET(returnTop, index);
 	BRANCH();
       }
-      continue;
+      NEXT();
     }
 
     /*
@@ -1199,30 +1331,30 @@ MINUSROLL:
     ** Drop the loop control variables; the branch address
     ** past "loop" is next on the return stack.
     */
-    case ficlInstructionLeave:
+    CASE(ficlInstructionLeave)
       /* almost unloop */
       returnTop -= 2;
       /* exit */
       gc_pop();			/* [ms] okay */
       EXIT_FUNCTION();
 
-    case ficlInstructionUnloop:
+    CASE(ficlInstructionUnloop)
       returnTop -= 3;
-      continue;
+      NEXT();
 
-    case ficlInstructionI:
+    CASE(ficlInstructionI)
       *++dataTop = *returnTop;
-      continue;
+      NEXT();
 
-    case ficlInstructionJ:
+    CASE(ficlInstructionJ)
       *++dataTop = returnTop[-3];
-      continue;
+      NEXT();
 
-    case ficlInstructionK:
+    CASE(ficlInstructionK)
       *++dataTop = returnTop[-6];
-      continue;
+      NEXT();
 
-    case ficlInstructionDoesParen:
+    CASE(ficlInstructionDoesParen)
     {
       ficlDictionary *dict = ficlVmGetDictionary(vm);
 
@@ -1231,10 +1363,10 @@ MINUSROLL:
       ip = (ficlInstruction *)(VM_STACK_VOIDP_REF(returnTop));
       returnTop--;
       /* [ms] DOES>: ends init part starting at `:' */
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionDoDoes:
+    CASE(ficlInstructionDoDoes)
     {
       ficlIp tempIP;
 
@@ -1248,7 +1380,7 @@ MINUSROLL:
       VM_STACK_VOIDP_SET(returnTop, ip);
       ip = (ficlInstruction *)tempIP;
       /* [ms] DOES>: starts body up to `;' */
-      continue;
+      NEXT();
     }
 
     /*
@@ -1256,16 +1388,16 @@ MINUSROLL:
     **
     ** x is the value stored at a-addr.
     */
-    case ficlInstructionFetch:
+    CASE(ficlInstructionFetch)
       CHECK_STACK(1, 1);
       *dataTop = *((ficlCell *)VM_STACK_VOIDP_REF(dataTop));
-      continue;
+      NEXT();
 
       /*
       ** store        CORE ( x a-addr -- )
       ** Store x at a-addr. 
       */
-    case ficlInstructionStore:
+    CASE(ficlInstructionStore)
     {
       FTH out;
       
@@ -1275,10 +1407,10 @@ MINUSROLL:
       out = ficl_to_fth(CELL_FTH_REF(cell));
       *cell = *dataTop--;
       fth_gc_protect_set(out, ficl_to_fth(CELL_FTH_REF(cell)));
-      continue;
+      NEXT();
     }
 
-    case ficl_execute_trace_var:
+    CASE(ficl_execute_trace_var)
     {
       ficlWord *word;
       FTH out;
@@ -1293,11 +1425,11 @@ MINUSROLL:
       fth_gc_protect_set(out, ficl_to_fth(CELL_FTH_REF(cell)));
       if (FTH_TRACE_VAR_P(word))
 	fth_trace_var_execute(word);
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionComma:
-    case ficlInstructionCompileComma:
+    CASE(ficlInstructionComma)
+    CASE(ficlInstructionCompileComma)
     {
       ficlDictionary *dict;
 
@@ -1306,10 +1438,10 @@ MINUSROLL:
       cell = dataTop--;
       fth_gc_permanent(ficl_to_fth(CELL_FTH_REF(cell)));
       ficlDictionaryAppendCell(dict, *cell);
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionCComma:
+    CASE(ficlInstructionCComma)
     {
       ficlDictionary *dict;
       char ch;
@@ -1319,7 +1451,7 @@ MINUSROLL:
       ch = (char)VM_STACK_INT_REF(dataTop);
       dataTop--;
       ficlDictionaryAppendCharacter(dict, ch);
-      continue;
+      NEXT();
     }
 
     /**************************************************************************
@@ -1336,7 +1468,7 @@ MINUSROLL:
      ** ambiguous condition exists if u is greater than or equal to the
      ** number of bits in a ficlCell. 
      **************************************************************************/
-    case ficlInstructionLShift:
+    CASE(ficlInstructionLShift)
     {
       ficlUnsigned nBits;
 
@@ -1344,10 +1476,10 @@ MINUSROLL:
       nBits = VM_STACK_UINT_REF(dataTop);
       dataTop--;
       VM_STACK_UINT_REF(dataTop) <<= nBits;
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionRShift:
+    CASE(ficlInstructionRShift)
     {
       ficlUnsigned nBits;
 
@@ -1355,10 +1487,10 @@ MINUSROLL:
       nBits = VM_STACK_UINT_REF(dataTop);
       dataTop--;
       VM_STACK_UINT_REF(dataTop) >>= nBits;
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionMax:
+    CASE(ficlInstructionMax)
     {
       ficlInteger n2;
       ficlInteger n1;
@@ -1368,10 +1500,10 @@ MINUSROLL:
       dataTop--;
       n1 = VM_STACK_INT_REF(dataTop);
       VM_STACK_INT_SET(dataTop, FICL_MAX(n1, n2));
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionMin:
+    CASE(ficlInstructionMin)
     {
       ficlInteger n2;
       ficlInteger n1;
@@ -1381,46 +1513,46 @@ MINUSROLL:
       dataTop--;
       n1 = VM_STACK_INT_REF(dataTop);
       VM_STACK_INT_SET(dataTop, FICL_MIN(n1, n2));
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionCells:
+    CASE(ficlInstructionCells)
       CHECK_STACK(1, 1);
       VM_STACK_INT_REF(dataTop) *= (ficlInteger)sizeof(ficlCell);
-      continue;
+      NEXT();
 
-    case ficlInstructionCellPlus:
+    CASE(ficlInstructionCellPlus)
       CHECK_STACK(1, 1);
       VM_STACK_INT_REF(dataTop) += (ficlInteger)sizeof(ficlCell);
-      continue;
+      NEXT();
 
     /**************************************************************************
      ** l o g i c   a n d   c o m p a r i s o n s
      ** 
      **************************************************************************/
-    case ficlInstructionEquals:
+    CASE(ficlInstructionEquals)
       CHECK_STACK(2, 1);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) == i);
-      continue;
+      NEXT();
 
     /* <> ( n -- f ) */
-    case ficl_not_eql:
+    CASE(ficl_not_eql)
       CHECK_STACK(2, 1);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) != i);
-      continue;
+      NEXT();
 
-    case ficlInstructionLess:
+    CASE(ficlInstructionLess)
       CHECK_STACK(2, 1);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) < i);
-      continue;
+      NEXT();
 
-    case ficlInstructionGreaterThan:
+    CASE(ficlInstructionGreaterThan)
     {
       ficlInteger x, y;
 
@@ -1429,132 +1561,132 @@ MINUSROLL:
       dataTop--;
       x = VM_STACK_INT_REF(dataTop);
       VM_STACK_BOOL_SET(dataTop, x > y);
-      continue;
+      NEXT();
     }
 
       /* <= ( n1 n2 -- f ) */
-    case ficl_less_eql:
+    CASE(ficl_less_eql)
       CHECK_STACK(2, 1);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) <= i);
-      continue;
+      NEXT();
 
       /* >= ( n1 n2 -- f ) */
-    case ficl_greater_eql:
+    CASE(ficl_greater_eql)
       CHECK_STACK(2, 1);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) >= i);
-      continue;
+      NEXT();
  
    /* zero? ( n -- f ) */
-    case ficl_zero_p:
-    case ficlInstruction0Equals:
+    CASE(ficl_zero_p)
+    CASE(ficlInstruction0Equals)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) == 0);
-      continue;
+      NEXT();
 
       /* 0<> ( n -- f ) */
-    case ficl_0_not_eql:
+    CASE(ficl_0_not_eql)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) != 0);
-      continue;
+      NEXT();
 
       /* negative? ( n -- f ) */
-    case ficl_negative_p:
-    case ficlInstruction0Less:
+    CASE(ficl_negative_p)
+    CASE(ficlInstruction0Less)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) < 0);
-      continue;
+      NEXT();
 
-    case ficlInstruction0Greater:
+    CASE(ficlInstruction0Greater)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) > 0);
-      continue;
+      NEXT();
 
       /* 0<= ( n -- f ) */
-    case ficl_0_less_eql:
+    CASE(ficl_0_less_eql)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) <= 0);
-      continue;
+      NEXT();
 
       /* positive? ( n -- f ) */
       /* 0>= ( n -- f ) */
-    case ficl_positive_p:
-    case ficl_0_greater_eql:
+    CASE(ficl_positive_p)
+    CASE(ficl_0_greater_eql)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) >= 0);
-      continue;
+      NEXT();
 
-    case ficlInstructionPlus:
+    CASE(ficlInstructionPlus)
       CHECK_STACK(2, 1);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       VM_STACK_INT_REF(dataTop) += i;
-      continue;
+      NEXT();
 
-    case ficlInstructionMinus:
+    CASE(ficlInstructionMinus)
       CHECK_STACK(2, 1);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       VM_STACK_INT_REF(dataTop) -= i;
-      continue;
+      NEXT();
 
-    case ficlInstructionStar:
+    CASE(ficlInstructionStar)
       CHECK_STACK(2, 1);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       VM_STACK_INT_REF(dataTop) *= i;
-      continue;
+      NEXT();
 
-    case ficlInstructionSlash:
+    CASE(ficlInstructionSlash)
       CHECK_STACK(2, 1);
       i = VM_STACK_INT_REF(dataTop);
       dataTop--;
       VM_STACK_INT_REF(dataTop) /= i;
-      continue;
+      NEXT();
 
-    case ficlInstruction1Plus:
+    CASE(ficlInstruction1Plus)
       CHECK_STACK(1, 1);
       VM_STACK_INT_REF(dataTop)++;
-      continue;
+      NEXT();
 
-    case ficlInstruction1Minus:
+    CASE(ficlInstruction1Minus)
       CHECK_STACK(1, 1);
       VM_STACK_INT_REF(dataTop)--;
-      continue;
+      NEXT();
 
-    case ficlInstruction2Plus:
+    CASE(ficlInstruction2Plus)
       CHECK_STACK(1, 1);
       VM_STACK_INT_REF(dataTop) += 2;
-      continue;
+      NEXT();
 
-    case ficlInstruction2Minus:
+    CASE(ficlInstruction2Minus)
       CHECK_STACK(1, 1);
       VM_STACK_INT_REF(dataTop) -= 2;
-      continue;
+      NEXT();
 
-    case ficlInstruction2Star:
+    CASE(ficlInstruction2Star)
       CHECK_STACK(1, 1);
       VM_STACK_INT_REF(dataTop) <<= 1;
-      continue;
+      NEXT();
 
-    case ficlInstruction2Slash:
+    CASE(ficlInstruction2Slash)
       CHECK_STACK(1, 1);
       VM_STACK_INT_REF(dataTop) >>= 1;
-      continue;
+      NEXT();
 
-    case ficlInstructionNegate:
+    CASE(ficlInstructionNegate)
       CHECK_STACK(1, 1);
       VM_STACK_INT_SET(dataTop, -VM_STACK_INT_REF(dataTop));
-      continue;
+      NEXT();
 
       /* abs ( n1 -- n2 ) */
-    case ficl_abs:
+    CASE(ficl_abs)
       CHECK_STACK(1, 1);
       VM_STACK_INT_SET(dataTop, abs((int)VM_STACK_INT_REF(dataTop)));
-      continue;
+      NEXT();
 
       /*
       ** slash-mod        CORE ( n1 n2 -- n3 n4 )
@@ -1565,7 +1697,7 @@ MINUSROLL:
       ** >R S>D R> FM/MOD or the phrase >R S>D R> SM/REM . 
       ** NOTE: Ficl complies with the second phrase (symmetric division)
       */
-    case ficlInstructionSlashMod:
+    CASE(ficlInstructionSlashMod)
     {
       ficl2Integer d1;
       ficlInteger n2;
@@ -1579,10 +1711,10 @@ MINUSROLL:
       VM_STACK_INT_SET(dataTop, qr.remainder);
       dataTop++;
       VM_STACK_INT_SET(dataTop, (ficlInteger)qr.quotient);
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionStarSlash:
+    CASE(ficlInstructionStarSlash)
     {
       ficlInteger x, y, z;
       ficl2IntegerQR qr;
@@ -1595,10 +1727,10 @@ MINUSROLL:
       x = VM_STACK_INT_REF(dataTop);
       qr = ficl2IntegerDivideSymmetric((ficl2Integer)(x * y), z);
       VM_STACK_INT_SET(dataTop, (ficlInteger)qr.quotient);
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionStarSlashMod:
+    CASE(ficlInstructionStarSlashMod)
     {
       ficlInteger x, y, z;
       ficl2IntegerQR qr;
@@ -1613,85 +1745,85 @@ MINUSROLL:
       VM_STACK_INT_SET(dataTop, qr.remainder);
       dataTop++;
       VM_STACK_INT_SET(dataTop, (ficlInteger)qr.quotient);
-      continue;
+      NEXT();
     }
 
-    case ficlInstructionF0:
+    CASE(ficlInstructionF0)
       CHECK_STACK(0, 1);
       ++dataTop;
       VM_STACK_FLOAT_SET(dataTop, 0.0);
-      continue;
+      NEXT();
 
-    case ficlInstructionF1:
+    CASE(ficlInstructionF1)
       CHECK_STACK(0, 1);
       ++dataTop;
       VM_STACK_FLOAT_SET(dataTop, 1.0);
-      continue;
+      NEXT();
 
-    case ficlInstructionFNeg1:
+    CASE(ficlInstructionFNeg1)
       CHECK_STACK(0, 1);
       ++dataTop;
       VM_STACK_FLOAT_SET(dataTop, -1.0);
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do float addition r1 + r2.
        ** f+ ( r1 r2 -- r )
        *******************************************************************/
-    case ficlInstructionFPlus:
+    CASE(ficlInstructionFPlus)
       CHECK_STACK(2, 1);
       df = VM_STACK_FLOAT_REF(dataTop);
       dataTop--;
       VM_STACK_FLOAT_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) + df);
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do float subtraction r1 - r2.
        ** f- ( r1 r2 -- r )
        *******************************************************************/
-    case ficlInstructionFMinus:
+    CASE(ficlInstructionFMinus)
       CHECK_STACK(2, 1);
       df = VM_STACK_FLOAT_REF(dataTop);
       dataTop--;
       VM_STACK_FLOAT_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) - df);
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do float multiplication r1 * r2.
        ** f* ( r1 r2 -- r )
        *******************************************************************/
-    case ficlInstructionFStar:
+    CASE(ficlInstructionFStar)
       CHECK_STACK(2, 1);
       df = VM_STACK_FLOAT_REF(dataTop);
       dataTop--;
       VM_STACK_FLOAT_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) * df);
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do float negation.
        ** fnegate ( r -- r )
        *******************************************************************/
-    case ficlInstructionFNegate:
+    CASE(ficlInstructionFNegate)
       CHECK_STACK(1, 1);
       VM_STACK_FLOAT_SET(dataTop, -(VM_STACK_FLOAT_REF(dataTop)));
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do float division r1 / r2.
        ** f/ ( r1 r2 -- r )
        *******************************************************************/
-    case ficlInstructionFSlash:
+    CASE(ficlInstructionFSlash)
       CHECK_STACK(2, 1);
       df = VM_STACK_FLOAT_REF(dataTop);
       dataTop--;
       VM_STACK_FLOAT_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) / df);
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Add a floating point number to contents of a variable.
        ** f+! ( r n -- )
        *******************************************************************/
-    case ficlInstructionFPlusStore:
+    CASE(ficlInstructionFPlusStore)
     {
       ficlCell *ce;
       FTH x;
@@ -1705,7 +1837,7 @@ MINUSROLL:
       else
 	VM_STACK_FLOAT_SET(ce, VM_STACK_FLOAT_REF(ce) + VM_STACK_FLOAT_REF(dataTop));
       dataTop--;
-      continue;
+      NEXT();
     }
 
     /*******************************************************************
@@ -1713,64 +1845,64 @@ MINUSROLL:
      ** f0= ( r -- T/F )
      *******************************************************************/
     /* fzero? ( r -- f ) */
-    case ficl_f_zero_p:
-    case ficlInstructionF0Equals:
+    CASE(ficl_f_zero_p)
+    CASE(ficlInstructionF0Equals)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) == 0.0);
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do float 0< comparison r < 0.0.
        ** f0< ( r -- T/F )
        *******************************************************************/
       /* fnegative? ( r -- f ) */
-    case ficl_f_negative_p:
-    case ficlInstructionF0Less:
+    CASE(ficl_f_negative_p)
+    CASE(ficlInstructionF0Less)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) < 0.0f);
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do float 0> comparison r > 0.0.
        ** f0> ( r -- T/F )
        *******************************************************************/
-    case ficlInstructionF0Greater:
+    CASE(ficlInstructionF0Greater)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) > 0.0);
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do float = comparison r1 = r2.
        ** f= ( r1 r2 -- T/F )
        *******************************************************************/
-    case ficlInstructionFEquals:
+    CASE(ficlInstructionFEquals)
       CHECK_STACK(2, 1);
       df = VM_STACK_FLOAT_REF(dataTop);
       dataTop--;
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) == df);
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do float < comparison r1 < r2.
        ** f< ( r1 r2 -- T/F )
        *******************************************************************/
-    case ficlInstructionFLess:
+    CASE(ficlInstructionFLess)
       CHECK_STACK(2, 1);
       df = VM_STACK_FLOAT_REF(dataTop);
       dataTop--;
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) < df);
-      continue;
+      NEXT();
 
       /*******************************************************************
        ** Do float > comparison r1 > r2.
        ** f> ( r1 r2 -- T/F )
        *******************************************************************/
-    case ficlInstructionFGreater:
+    CASE(ficlInstructionFGreater)
       CHECK_STACK(2, 1);
       df = VM_STACK_FLOAT_REF(dataTop);
       dataTop--;
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) > df);
-      continue;
+      NEXT();
 
       /**************************************************************************
        **				c o l o n P a r e n
@@ -1783,26 +1915,27 @@ MINUSROLL:
        ** turn.
        **
        **************************************************************************/
-    case ficlInstructionColonParen:
+    CASE(ficlInstructionColonParen)
+      SIGNAL_CHECK();
       ++returnTop;
       VM_STACK_VOIDP_SET(returnTop, ip);
       FICL_FW_CHECK(fw);
       ip = (ficlInstruction *)(fw->param);
-      continue;
+      NEXT();
 
-    case ficlInstructionCreateParen:
+    CASE(ficlInstructionCreateParen)
       CHECK_STACK(0, 1);
       FICL_FW_CHECK(fw);
       ++dataTop;
       VM_STACK_VOIDP_SET(dataTop, fw->param + 1);
-      continue;
+      NEXT();
 
-    case ficlInstructionVariableParen:
+    CASE(ficlInstructionVariableParen)
       CHECK_STACK(0, 1);
       FICL_FW_CHECK(fw);
       ++dataTop;
       VM_STACK_VOIDP_SET(dataTop, fw->param);
-      continue;
+      NEXT();
 
       /*
        * [ms]
@@ -1818,7 +1951,7 @@ MINUSROLL:
        * The next entry in instruction pointer is tempFW, file and
        * line number.
        */
-    case ficl_word_location:
+    CASE(ficl_word_location)
     {
       ficlWord *word, *next;
       FTH file;
@@ -1832,11 +1965,11 @@ MINUSROLL:
       next->current_word = word;
       next->current_file = file;
       next->current_line = line;
-      continue;
+      NEXT();
     }
 
     /* Executes C functions (0 to 20 args). */
-    case ficl_execute_func:
+    CASE(ficl_execute_func)
     {
       FTH ret = FTH_FALSE;
       FTH args[20] = {FTH_UNDEF, FTH_UNDEF, FTH_UNDEF, FTH_UNDEF, FTH_UNDEF,
@@ -1945,11 +2078,11 @@ MINUSROLL:
       }
       ++dataTop;
       VM_STACK_FTH_SET(dataTop, fth_to_ficl(ret));
-      continue;
+      NEXT();
     }
 
     /* Executes void C functions (0 to 10 args). */
-    case ficl_execute_void_func:
+    CASE(ficl_execute_void_func)
     {
       FTH args[10] = {FTH_UNDEF, FTH_UNDEF, FTH_UNDEF, FTH_UNDEF, FTH_UNDEF,
 		      FTH_UNDEF, FTH_UNDEF, FTH_UNDEF, FTH_UNDEF, FTH_UNDEF};
@@ -2013,7 +2146,7 @@ MINUSROLL:
       default:
 	break;
       }
-      continue;
+      NEXT();
     }
 
     /**************************************************************************
@@ -2022,34 +2155,34 @@ MINUSROLL:
      ** contents of its word's first data ficlCell.
      **
      **************************************************************************/
-    case ficlInstructionConstantParen:
+    CASE(ficlInstructionConstantParen)
       CHECK_STACK(0, 1);
       FICL_FW_CHECK(fw);
       PUSH_CELL_POINTER(fw->param);
 
-    case ficlInstructionUserParen:
+    CASE(ficlInstructionUserParen)
       FICL_FW_CHECK(fw);
       ++dataTop;
       VM_STACK_VOIDP_SET(dataTop, &vm->user[CELL_INT_REF(fw->param)]);
-      continue;
+      NEXT();
  
       /* === Begin of FTH Additions === */
       /* false ( -- 0 ) */
-    case ficl_bool_false:
+    CASE(ficl_bool_false)
       CHECK_STACK(0, 1);
       ++dataTop;
       VM_STACK_INT_SET(dataTop, FICL_FALSE);
-      continue;
+      NEXT();
 
       /* true ( -- -1 ) */
-    case ficl_bool_true:
+    CASE(ficl_bool_true)
       CHECK_STACK(0, 1);
       ++dataTop;
       VM_STACK_INT_SET(dataTop, FICL_TRUE);
-      continue;
+      NEXT();
 
       /* && ( obj1 obj2 -- obj2|#f ) */
-    case ficl_bool_and:
+    CASE(ficl_bool_and)
     {
       FTH val1, val2;
 
@@ -2061,11 +2194,11 @@ MINUSROLL:
 	VM_STACK_FTH_SET(dataTop, val2);
       else
 	VM_STACK_FTH_SET(dataTop, FTH_FALSE);
-      continue;
+      NEXT();
     }
 
     /* || ( obj1 obj2 -- obj1|2|#f ) */
-    case ficl_bool_or:
+    CASE(ficl_bool_or)
     {
       FTH val1, val2;
 
@@ -2079,17 +2212,17 @@ MINUSROLL:
 	VM_STACK_FTH_SET(dataTop, val2);
       else
 	VM_STACK_FTH_SET(dataTop, FTH_FALSE);
-      continue;
+      NEXT();
     }
 
     /* not ( obj -- f ) */
-    case ficl_bool_not:
+    CASE(ficl_bool_not)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_FALSE_OR_NULL_P(VM_STACK_FTH_REF(dataTop)));
-      continue;
+      NEXT();
 
       /* fmax ( r1 r2 -- r1|r2 ) */
-    case ficl_f_max:
+    CASE(ficl_f_max)
     {
       ficlFloat f1;
       ficlFloat f2;
@@ -2099,11 +2232,11 @@ MINUSROLL:
       dataTop--;
       f1 = VM_STACK_FLOAT_REF(dataTop);
       VM_STACK_FLOAT_SET(dataTop, (f1 > f2) ? f1 : f2);
-      continue;
+      NEXT();
     }
 
     /* fmin ( r1 r2 -- r1|r2 ) */
-    case ficl_f_min:
+    CASE(ficl_f_min)
     {
       ficlFloat f1;
       ficlFloat f2;
@@ -2113,73 +2246,174 @@ MINUSROLL:
       dataTop--;
       f1 = VM_STACK_FLOAT_REF(dataTop);
       VM_STACK_FLOAT_SET(dataTop, (f1 < f2) ? f1 : f2);
-      continue;
+      NEXT();
     }
 
     /* f0<> ( r -- f ) */
-    case ficl_f0_not_eql:
+    CASE(ficl_f0_not_eql)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) != 0.0);
-      continue;
+      NEXT();
 
       /* f0<= ( r -- f ) */
-    case ficl_f0_less_eql:
+    CASE(ficl_f0_less_eql)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) <= 0.0);
-      continue;
+      NEXT();
 
       /* fpositive? ( r -- f ) */
       /* f0>= ( r -- f ) */
-    case ficl_f_positive_p:
-    case ficl_f0_greater_eql:
+    CASE(ficl_f_positive_p)
+    CASE(ficl_f0_greater_eql)
       CHECK_STACK(1, 1);
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) >= 0.0);
-      continue;
+      NEXT();
 
       /* f>= ( r1 r2 -- f ) */
-    case ficl_f_greater_eql:
+    CASE(ficl_f_greater_eql)
       CHECK_STACK(2, 1);
       df = VM_STACK_FLOAT_REF(dataTop);
       dataTop--;
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) >= df);
-      continue;
+      NEXT();
 
       /* f<= ( r1 r2 -- f ) */
-    case ficl_f_less_eql:
+    CASE(ficl_f_less_eql)
       CHECK_STACK(2, 1);
       df = VM_STACK_FLOAT_REF(dataTop);
       dataTop--;
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) <= df);
-      continue;
+      NEXT();
 
       /* f<> ( r1 r2 -- f ) */
-    case ficl_f_not_eql:
+    CASE(ficl_f_not_eql)
       CHECK_STACK(2, 1);
       df = VM_STACK_FLOAT_REF(dataTop);
       dataTop--;
       VM_STACK_BOOL_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) != df);
-      continue;
+      NEXT();
 
       /* f2* ( r -- r*2.0 ) */
-    case ficl_f2_star:
+    CASE(ficl_f2_star)
       CHECK_STACK(1, 1);
       VM_STACK_FLOAT_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) * 2.0);
-      continue;
+      NEXT();
 
       /* f2/ ( r -- r/2.0 ) */
-    case ficl_f2_slash:
+    CASE(ficl_f2_slash)
       CHECK_STACK(1, 1);
       VM_STACK_FLOAT_SET(dataTop, VM_STACK_FLOAT_REF(dataTop) * 0.5);
-      continue;
+      NEXT();
 
       /* 1/f ( r -- 1.0/r ) */
-    case ficl_1_slash_f:
+    CASE(ficl_1_slash_f)
       CHECK_STACK(1, 1);
       VM_STACK_FLOAT_SET(dataTop, 1.0 / VM_STACK_FLOAT_REF(dataTop));
-      continue;
+      NEXT();
+
+      /**************************************************************************
+       ** Superinstructions compiled by ficlDictionaryCompileInstruction().
+       ** Each one does exactly what its parts did in sequence, arguments
+       ** in the same order.
+       **************************************************************************/
+      /* (literal) (link) ( -- x ) */
+    CASE(ficlInstructionLiteralLinkParen)
+      CHECK_STACK(0, 1);
+      ++dataTop;
+      VM_STACK_INT_SET(dataTop, *ip);
+      ip++;
+      i = *ip++;
+      ++returnTop;
+      VM_STACK_VOIDP_SET(returnTop, frame);
+      frame = returnTop + 1;
+      returnTop += i;
+      NEXT();
+
+      /* (literal) (link) (toLocal), the prologue of fth definitions */
+    CASE(ficlInstructionLiteralLinkToLocalParen)
+    {
+      ficlCell c;
+
+      CELL_INT_SET(&c, *ip);
+      ip++;
+      i = *ip++;
+      ++returnTop;
+      VM_STACK_VOIDP_SET(returnTop, frame);
+      frame = returnTop + 1;
+      returnTop += i;
+      frame[*ip++] = c;
+      NEXT();
+    }
+
+      /* (unlink) (;) */
+    CASE(ficlInstructionUnlinkExitParen)
+      returnTop = frame - 1;
+      frame = VM_STACK_VOIDP_REF(returnTop);
+      returnTop--;
+      EXIT_FUNCTION();
+
+      /* dup (branch0) ( x -- x ) */
+    CASE(ficlInstructionDupBranch0Paren)
+    {
+      FTH val;
+
+      CHECK_STACK(1, 1);
+      val = VM_STACK_FTH_REF(dataTop);
+
+      if (VM_NOT_FALSE_P(val))
+      {
+	ip += 1;
+	NEXT();
+      }
+      BRANCH();
+    }
+
+      /* (literal) + ( n -- n+x ) */
+    CASE(ficlInstructionLiteralPlus)
+      CHECK_STACK(1, 1);
+      VM_STACK_INT_REF(dataTop) += (ficlInteger)*ip++;
+      NEXT();
+
+    CASE(ficlInstructionLiteralMinus)
+      CHECK_STACK(1, 1);
+      VM_STACK_INT_REF(dataTop) -= (ficlInteger)*ip++;
+      NEXT();
+
+    CASE(ficlInstructionLiteralStar)
+      CHECK_STACK(1, 1);
+      VM_STACK_INT_REF(dataTop) *= (ficlInteger)*ip++;
+      NEXT();
+
+    CASE(ficlInstructionLiteralEquals)
+      CHECK_STACK(1, 1);
+      i = *ip++;
+      VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) == i);
+      NEXT();
+
+    CASE(ficlInstructionLiteralNotEquals)
+      CHECK_STACK(1, 1);
+      i = *ip++;
+      VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) != i);
+      NEXT();
+
+    CASE(ficlInstructionLiteralLess)
+      CHECK_STACK(1, 1);
+      i = *ip++;
+      VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) < i);
+      NEXT();
+
+    CASE(ficlInstructionLiteralGreaterThan)
+      CHECK_STACK(1, 1);
+      i = *ip++;
+      VM_STACK_BOOL_SET(dataTop, VM_STACK_INT_REF(dataTop) > i);
+      NEXT();
       /* === End of FTH Additions === */
 
+    CASE(ficlInstructionExitInnerLoop)
     default:
+#if FICL_WANT_THREADED
+    L_ficlInstructionLast:
+#endif
       /*
       ** Clever hack, or evil coding?  You be the judge.
       **
@@ -2191,7 +2425,11 @@ MINUSROLL:
       if (fw && ((ficlInstruction)fw->code < ficlInstructionLast))
       {
 	instruction = (ficlInstruction)fw->code;
+#if FICL_WANT_THREADED
+	goto *labels[instruction];
+#else
 	goto AGAIN;
+#endif
       }
 
       LOCAL_VARIABLE_SPILL();
@@ -2199,9 +2437,15 @@ MINUSROLL:
       vm->runningWord = fw;
       fw->code(vm);
       LOCAL_VARIABLE_REFILL();
-      continue;
+      NEXT();
     }
   }
+#if FICL_WANT_THREADED
+INNER_DONE:
+  /* single word done, undo the fetch of NEXT() */
+  if (ip != NULL)
+    ip--;
+#endif
   LOCAL_VARIABLE_SPILL();
   vm->exceptionHandler = oldExceptionHandler;
 }
@@ -2494,6 +2738,11 @@ ficlVmSetErrorOut(ficlVm *vm, ficlOutputFunction errorOut)
 void
 ficlVmThrow(ficlVm *vm, int except)
 {
+#if !defined(_WIN32)
+	/* [ms] leaving the call which set fth_sig_toplevel */
+	if (fth_toplevel_p && vm->exceptionHandler == fth_toplevel_catch)
+		fth_toplevel_p = 0;
+#endif
 	if (vm->exceptionHandler)
 		longjmp(*(vm->exceptionHandler), except);
 }
@@ -2944,7 +3193,7 @@ int ficlVmParseWord(ficlVm *vm, ficlString name)
       else
       {
 	if (tempFW->flags & FICL_WORD_INSTRUCTION)
-	  ficlDictionaryAppendPointer(dict, (void *)tempFW->code);
+	  ficlDictionaryCompileInstruction(dict, (ficlInstruction)tempFW->code);
 	else
 	{
 	  /* Preparation for word location, see also primitive.c.  [ms] */
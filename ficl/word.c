@@ -122,6 +122,13 @@ IS_INSTRUCTION:
   case ficlInstructionConstantParen:
     return FICL_WORDKIND_CONSTANT;
   case ficlInstructionToLocalParen:
+  case ficlInstructionLiteralPlus:
+  case ficlInstructionLiteralMinus:
+  case ficlInstructionLiteralStar:
+  case ficlInstructionLiteralEquals:
+  case ficlInstructionLiteralNotEquals:
+  case ficlInstructionLiteralLess:
+  case ficlInstructionLiteralGreaterThan:
     return FICL_WORDKIND_INSTRUCTION_WITH_ARGUMENT;
   case ficlInstructionUserParen:
     return FICL_WORDKIND_USER;
@@ -146,6 +153,7 @@ IS_INSTRUCTION:
     return FICL_WORDKIND_BRANCH;
   case ficlInstructionBranch0ParenWithCheck:
   case ficlInstructionBranch0Paren:
+  case ficlInstructionDupBranch0Paren:
     return FICL_WORDKIND_BRANCH0;
   case ficlInstructionLiteralParen:
     return FICL_WORDKIND_LITERAL;
@@ -46,6 +46,7 @@ typedef struct {
 	ficlInteger 	top;	/* begin of actual array in buffer */
 	FTH            *data;	/* actual array */
 	FTH            *buf;	/* entire array buffer */
+	FTH 		key_id;	/* acell: hash id of data[0] */
 } FArray;
 
 #define MAKE_ARRAY_MEMBER(Type, Member)	MAKE_MEMBER(FArray, ary, Type, Member)
@@ -68,6 +69,7 @@ MAKE_ARRAY_MEMBER(Integer, top)
 #define FTH_ARRAY_TOP(Obj)	FTH_ARRAY_OBJECT(Obj)->top
 #define FTH_ARRAY_DATA(Obj)	FTH_ARRAY_OBJECT(Obj)->data
 #define FTH_ARRAY_BUF(Obj)	FTH_ARRAY_OBJECT(Obj)->buf
+#define FTH_ARRAY_KEY_ID(Obj)	FTH_ARRAY_OBJECT(Obj)->key_id
 
 #define FTH_ARY_ARRAY		0x01
 #define FTH_ARY_LIST		0x02
@@ -89,12 +91,16 @@ static FTH 	ary_dump(FTH);
 static FTH 	ary_dump_each(FTH, FTH);
 static FTH 	ary_equal_p(FTH, FTH);
 static void 	ary_free(FTH);
+static void 	ary_grow(FTH, ficlInteger);
+static FTH 	ary_hash(FTH);
 static FTH 	ary_inspect(FTH);
 static FTH 	ary_inspect_each(FTH, FTH);
 static FTH 	ary_length(FTH);
 static void 	ary_mark(FTH);
 static FTH 	ary_ref(FTH, FTH);
+static void 	ary_resize(FTH, ficlInteger);
 static FTH 	ary_set(FTH, FTH, FTH);
+static void 	ary_shrink(FTH);
 static FTH 	ary_to_array(FTH);
 static FTH 	ary_to_string(FTH);
 static FTH 	ary_uniq_each(FTH, FTH);
@@ -113,6 +119,7 @@ static void 	ficl_array_member_p(ficlVm *);
 static void 	ficl_array_p(ficlVm *);
 static void 	ficl_array_ref(ficlVm *);
 static void 	ficl_array_reject(ficlVm *);
+static void 	ficl_array_reserve(ficlVm *);
 static void 	ficl_array_reverse(ficlVm *);
 static void 	ficl_array_set(ficlVm *);
 static void 	ficl_array_sort(ficlVm *);
@@ -135,7 +142,9 @@ static FTH 	acl_to_string(FTH);
 /*
  * Assoc
  */
-static FTH 	assoc_insert(FTH, FTH, FTH);
+static FTH 	acell_key_id(FTH);
+static ficlInteger assoc_bound(FTH, FTH);
+static FTH 	assoc_insert(FTH, FTH);
 static void 	ficl_assoc_p(ficlVm *);
 static void 	ficl_values_to_assoc(ficlVm *);
 static ficlInteger assoc_index(FTH, FTH);
@@ -204,6 +213,7 @@ array-push     	    ( ary val -- ary' )\n\
 array-ref      	    ( ary idx -- val )\n\
 array-reject        ( ary1 prc args -- ary2 )\n\
 array-reject!       ( ary prc args -- ary' )\n\
+array-reserve       ( ary len -- ary' )\n\
 array-reverse  	    ( ary1 -- ary2 )\n\
 array-reverse! 	    ( ary -- ary' )\n\
 array-set!     	    ( ary idx val -- )\n\
@@ -425,6 +435,21 @@ ary_equal_p(FTH self, FTH obj)
 	return (FTH_FALSE);
 }
 
+static FTH
+ary_hash(FTH self)
+{
+	ficlInteger 	i;
+	ficlUnsigned 	h;
+
+	h = (ficlUnsigned) FTH_ARRAY_LENGTH(self);
+
+	for (i = 0; i < FTH_ARRAY_LENGTH(self); i++)
+		h = fth_hash_combine(h,
+		    (ficlUnsigned) FIX_TO_INT(fth_hash_id(FTH_ARRAY_DATA(self)[i])));
+
+	return (FTH_HASH_ID_TO_FIX(h));
+}
+
 static FTH
 ary_length(FTH self)
 {
@@ -458,6 +483,22 @@ fth_array_length(FTH obj)
 	return (-1);
 }
 
+/*
+ * Return the array, list and assoc flags of array OBJ and set them to
+ * TYPE; used by image.c to re-create saved arrays.
+ */
+int
+fth_array_type_ref(FTH obj)
+{
+	return (FTH_ARRAY_TYPE(obj));
+}
+
+void
+fth_array_type_set(FTH obj, int type)
+{
+	FTH_ARRAY_TYPE(obj) = type;
+}
+
 static void
 ficl_array_length(ficlVm *vm)
 {
@@ -500,11 +541,57 @@ make_array(ficlInteger len)
 	ary->length = len;
 	ary->buf_length = buf_len;
 	ary->top = top_len;
+	ary->key_id = FTH_FALSE;
 	ary->buf = FTH_CALLOC(ary->buf_length, sizeof(FTH));
 	ary->data = ary->buf + ary->top;
 	return (ary);
 }
 
+static void
+ary_resize(FTH array, ficlInteger len)
+{
+	size_t 		size;
+
+	if (len > MAX_SEQ_LENGTH)
+		FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, len, "too long");
+
+	FTH_ARRAY_BUF_LENGTH(array) = len;
+	size = sizeof(FTH) * (size_t) len;
+	FTH_ARRAY_BUF(array) = FTH_REALLOC(FTH_ARRAY_BUF(array), size);
+	FTH_ARRAY_DATA(array) = FTH_ARRAY_BUF(array) + FTH_ARRAY_TOP(array);
+}
+
+/*
+ * Make room for NEW_BUF_LEN cells including top.
+ */
+static void
+ary_grow(FTH array, ficlInteger new_buf_len)
+{
+	ficlInteger 	len;
+
+	if (new_buf_len <= FTH_ARRAY_BUF_LENGTH(array))
+		return;
+
+	len = GROW_SEQ_LENGTH(FTH_ARRAY_BUF_LENGTH(array), new_buf_len);
+
+	if (len > MAX_SEQ_LENGTH)
+		len = NEW_SEQ_LENGTH(new_buf_len);
+
+	ary_resize(array, len);
+}
+
+static void
+ary_shrink(FTH array)
+{
+	ficlInteger 	len;
+
+	len = SHRINK_SEQ_LENGTH(FTH_ARRAY_BUF_LENGTH(array),
+	    FTH_ARRAY_TOP(array) + FTH_ARRAY_LENGTH(array));
+
+	if (len < FTH_ARRAY_BUF_LENGTH(array))
+		ary_resize(array, len);
+}
+
 static FTH
 make_array_instance(FArray *ary)
 {
@@ -839,28 +926,9 @@ fth_array_push(FTH array, FTH value)
 #( 0 1 2 ) 10 array-push => #( 0 1 2 10 )\n\
 Append VAL to ARY.\n\
 See also array-pop, array-unshift, array-shift."
-	ficlInteger 	new_buf_len, lenp1;
-
 	FTH_ASSERT_ARGS(FTH_ARRAY_P(array), array, FTH_ARG1, "an array");
 	/* HINT: top + length + 1 is the new length (thanks Bill!) */
-	lenp1 = FTH_ARRAY_LENGTH(array) + 1;
-	new_buf_len = FTH_ARRAY_TOP(array) + lenp1;
-
-	if (new_buf_len > FTH_ARRAY_BUF_LENGTH(array)) {
-		ficlInteger 	len;
-		size_t 		size;
-
-		len = NEW_SEQ_LENGTH(new_buf_len);
-
-		if (len > MAX_SEQ_LENGTH)
-			FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, len, "too long");
-
-		FTH_ARRAY_BUF_LENGTH(array) = len;
-		size = sizeof(FTH) * (size_t) len;
-		FTH_ARRAY_BUF(array) = FTH_REALLOC(FTH_ARRAY_BUF(array), size);
-		FTH_ARRAY_DATA(array) = FTH_ARRAY_BUF(array) +
-		    FTH_ARRAY_TOP(array);
-	}
+	ary_grow(array, FTH_ARRAY_TOP(array) + FTH_ARRAY_LENGTH(array) + 1);
 	FTH_ARRAY_DATA(array)[FTH_ARRAY_LENGTH(array)] = value;
 	FTH_ARRAY_LENGTH(array)++;
 	FTH_INSTANCE_CHANGED(array);
@@ -880,7 +948,6 @@ Remove and return last element from ARY.  \
 If ARY is empty, return #f.\n\
 See also array-push, array-unshift, array-shift."
 	FTH 		result;
-	ficlInteger 	len;
 
 	FTH_ASSERT_ARGS(FTH_ARRAY_P(array), array, FTH_ARG1, "an array");
 
@@ -889,17 +956,7 @@ See also array-push, array-unshift, array-shift."
 
 	FTH_ARRAY_LENGTH(array)--;
 	result = FTH_ARRAY_DATA(array)[FTH_ARRAY_LENGTH(array)];
-	len = NEW_SEQ_LENGTH(FTH_ARRAY_TOP(array) + FTH_ARRAY_LENGTH(array));
-
-	if (len < FTH_ARRAY_BUF_LENGTH(array)) {
-		size_t 		size;
-
-		FTH_ARRAY_BUF_LENGTH(array) = len;
-		size = sizeof(FTH) * (size_t) len;
-		FTH_ARRAY_BUF(array) = FTH_REALLOC(FTH_ARRAY_BUF(array), size);
-		FTH_ARRAY_DATA(array) = FTH_ARRAY_BUF(array) +
-		    FTH_ARRAY_TOP(array);
-	}
+	ary_shrink(array);
 	FTH_INSTANCE_CHANGED(array);
 	return (result);
 }
@@ -914,8 +971,7 @@ ary 20 array-unshift drop\n\
 ary => #( 20 10 0 1 2 )\n\
 Prepend VAL to ARY.\n\
 See also array-push, array-pop, array-shift."
-	ficlInteger 	len, new_top, new_len, new_buf_len;
-	size_t 		size;
+	ficlInteger 	new_top, new_len, new_buf_len;
 
 	FTH_ASSERT_ARGS(FTH_ARRAY_P(array), array, FTH_ARG1, "an array");
 	new_top = FTH_ARRAY_TOP(array) - 1;
@@ -924,37 +980,13 @@ See also array-push, array-pop, array-shift."
 
 	if (new_top < 1) {
 		new_top = FTH_ARRAY_BUF_LENGTH(array) / 3;
-		new_buf_len = new_top + new_len;
-
-		if (new_buf_len > FTH_ARRAY_BUF_LENGTH(array)) {
-			len = NEW_SEQ_LENGTH(new_buf_len);
-
-			if (len > MAX_SEQ_LENGTH)
-				FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, len,
-				    "too long");
-
-			FTH_ARRAY_BUF_LENGTH(array) = len;
-			size = sizeof(FTH) * (size_t) len;
-			FTH_ARRAY_BUF(array) = FTH_REALLOC(FTH_ARRAY_BUF(array),
-			    size);
-			FTH_ARRAY_DATA(array) = FTH_ARRAY_BUF(array) +
-			    FTH_ARRAY_TOP(array);
-		}
+		ary_grow(array, new_top + new_len);
 		memmove(FTH_ARRAY_BUF(array) + new_top + 1,
 		    FTH_ARRAY_DATA(array),
 		    sizeof(FTH) * (size_t) FTH_ARRAY_LENGTH(array));
-	} else if (new_buf_len > FTH_ARRAY_BUF_LENGTH(array)) {
-		len = NEW_SEQ_LENGTH(new_buf_len);
-
-		if (len > MAX_SEQ_LENGTH)
-			FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, len, "too long");
+	} else
+		ary_grow(array, new_buf_len);
 
-		FTH_ARRAY_BUF_LENGTH(array) = len;
-		size = sizeof(FTH) * (size_t) len;
-		FTH_ARRAY_BUF(array) = FTH_REALLOC(FTH_ARRAY_BUF(array), size);
-		FTH_ARRAY_DATA(array) = FTH_ARRAY_BUF(array) +
-		    FTH_ARRAY_TOP(array);
-	}
 	FTH_ARRAY_TOP(array) = new_top;
 	FTH_ARRAY_LENGTH(array) = new_len;
 	FTH_ARRAY_DATA(array) = FTH_ARRAY_BUF(array) + FTH_ARRAY_TOP(array);
@@ -976,7 +1008,6 @@ Remove and return first element from ARY.  \
 If ARY is empty, return #f.\n\
 See also array-push, array-pop, array-unshift."
 	FTH 		result;
-	ficlInteger 	len;
 
 	FTH_ASSERT_ARGS(FTH_ARRAY_P(array), array, FTH_ARG1, "an array");
 
@@ -992,21 +1023,47 @@ See also array-push, array-pop, array-unshift."
 		    sizeof(FTH) * (size_t) FTH_ARRAY_LENGTH(array));
 	}
 	FTH_ARRAY_LENGTH(array)--;
-	len = NEW_SEQ_LENGTH(FTH_ARRAY_TOP(array) + FTH_ARRAY_LENGTH(array));
 	FTH_ARRAY_TOP(array)++;
-
-	if (len < FTH_ARRAY_BUF_LENGTH(array)) {
-		size_t 		size;
-
-		FTH_ARRAY_BUF_LENGTH(array) = len;
-		size = sizeof(FTH) * (size_t) len;
-		FTH_ARRAY_BUF(array) = FTH_REALLOC(FTH_ARRAY_BUF(array), size);
-	}
 	FTH_ARRAY_DATA(array) = FTH_ARRAY_BUF(array) + FTH_ARRAY_TOP(array);
+	ary_shrink(array);
 	FTH_INSTANCE_CHANGED(array);
 	return (result);
 }
 
+FTH
+fth_array_reserve(FTH array, ficlInteger len)
+{
+#define h_array_reserve "( ary len -- ary' )  make room for LEN elements\n\
+#() 1000000 array-reserve value ary\n\
+ary length => 0\n\
+Make room for at least LEN elements in ARY \
+so that the next pushes up to LEN elements don't reallocate.  \
+ARY's length and content don't change.  \
+Raise OUT-OF-RANGE exception if LEN < 0.\n\
+See also array-push."
+	FTH_ASSERT_ARGS(FTH_ARRAY_P(array), array, FTH_ARG1, "an array");
+
+	if (len < 0)
+		FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG2, len, "negative");
+
+	if (FTH_ARRAY_TOP(array) + len > FTH_ARRAY_BUF_LENGTH(array))
+		ary_resize(array, NEW_SEQ_LENGTH(FTH_ARRAY_TOP(array) + len));
+
+	return (array);
+}
+
+static void
+ficl_array_reserve(ficlVm *vm)
+{
+	ficlInteger 	len;
+	FTH 		ary;
+
+	FTH_STACK_CHECK(vm, 2, 1);
+	len = ficlStackPopInteger(vm->dataStack);
+	ary = fth_pop_ficl_cell(vm);
+	ficlStackPushFTH(vm->dataStack, fth_array_reserve(ary, len));
+}
+
 FTH
 fth_array_append(FTH array, FTH value)
 {
@@ -1072,6 +1129,7 @@ See also array-reverse."
 	for (i = 0, j = len - 1; i < len; i++, j--)
 		FTH_ARRAY_DATA(array)[i] = FTH_ARRAY_DATA(tmp)[j];
 
+	FTH_INSTANCE_CHANGED(array);
 	return (array);
 }
 
@@ -1126,22 +1184,7 @@ fth_array_insert(FTH array, ficlInteger idx, FTH value)
 	ins_len = FTH_ARRAY_LENGTH(ins);
 	res_len = ary_len + ins_len;
 	new_buf_len = FTH_ARRAY_TOP(array) + res_len;
-
-	if (new_buf_len > FTH_ARRAY_BUF_LENGTH(array)) {
-		ficlInteger 	len;
-		size_t 		size;
-
-		len = NEW_SEQ_LENGTH(new_buf_len);
-
-		if (len > MAX_SEQ_LENGTH)
-			FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, len, "too long");
-
-		FTH_ARRAY_BUF_LENGTH(array) = len;
-		size = sizeof(FTH) * (size_t) len;
-		FTH_ARRAY_BUF(array) = FTH_REALLOC(FTH_ARRAY_BUF(array), size);
-		FTH_ARRAY_DATA(array) = FTH_ARRAY_BUF(array) +
-		    FTH_ARRAY_TOP(array);
-	}
+	ary_grow(array, new_buf_len);
 	memmove(FTH_ARRAY_DATA(array) + idx + ins_len,
 	    FTH_ARRAY_DATA(array) + idx,
 	    sizeof(FTH) * (size_t) (ary_len - idx));
@@ -1201,7 +1244,7 @@ FTH
 fth_array_delete(FTH array, ficlInteger idx)
 {
 	FTH 		value;
-	ficlInteger 	len, cur_len;
+	ficlInteger 	cur_len;
 
 	FTH_ASSERT_ARGS(fth_array_length(array) > 0,
 	    array, FTH_ARG1, "a nonempty array");
@@ -1221,18 +1264,10 @@ fth_array_delete(FTH array, ficlInteger idx)
 
 	value = FTH_ARRAY_DATA(array)[idx];
 	FTH_ARRAY_LENGTH(array)--;
-	len = NEW_SEQ_LENGTH(FTH_ARRAY_TOP(array) + FTH_ARRAY_LENGTH(array));
-
-	if (len < FTH_ARRAY_BUF_LENGTH(array)) {
-		FTH_ARRAY_BUF_LENGTH(array) = len;
-		FTH_ARRAY_BUF(array) = FTH_REALLOC(FTH_ARRAY_BUF(array),
-		    sizeof(FTH) * (size_t) len);
-		FTH_ARRAY_DATA(array) = FTH_ARRAY_BUF(array) +
-		    FTH_ARRAY_TOP(array);
-	}
 	memmove(FTH_ARRAY_DATA(array) + idx,
 	    FTH_ARRAY_DATA(array) + idx + 1,
 	    sizeof(FTH) * (size_t) (FTH_ARRAY_LENGTH(array) - idx));
+	ary_shrink(array);
 	FTH_INSTANCE_CHANGED(array);
 	return (value);
 }
@@ -1797,6 +1832,7 @@ fth_make_acell(FTH key, FTH value)
 	ary->data = ary->buf;
 	ary->data[0] = key;
 	ary->data[1] = value;
+	ary->key_id = FTH_FALSE;
 	return (fth_make_instance(acell_tag, ary));
 }
 
@@ -1819,37 +1855,76 @@ fth_acell_value(FTH cell)
 
 /*
  * ASSOC: sorted associative arrays as an alternative to hashs.
+ *
+ * The elements are sorted by the hash id of their keys.  Each acell
+ * keeps the hash id of its key, computed on first use and again after
+ * the acell was changed, so a probe doesn't hash the visited keys.
+ * Different keys may share a hash id; such entries are neighbours and
+ * a hit is confirmed with fth_object_equal_p.
+ */
+static FTH
+acell_key_id(FTH cell)
+{
+	if (!FTH_ACELL_P(cell))
+		return (fth_hash_id(FTH_FALSE));
+
+	if (FTH_INSTANCE_CHANGED_P(cell) & FTH_CHANGED_KEY) {
+		FTH_ARRAY_KEY_ID(cell) = fth_hash_id(FTH_ACELL_KEY(cell));
+		FTH_INSTANCE_CHANGED_P(cell) &= ~FTH_CHANGED_KEY;
+	}
+	return (FTH_ARRAY_KEY_ID(cell));
+}
+
+/*
+ * Return index of the first element whose hash id is not less than ID.
  */
 static ficlInteger
-assoc_index(FTH assoc, FTH key)
+assoc_bound(FTH assoc, FTH id)
 {
-	FTH 		id, kid;
 	ficlInteger 	i, beg, end;
+	FTH 		kid;
+
+	beg = 0;
+	end = FTH_ARRAY_LENGTH(assoc);
+
+	while (beg < end) {
+		i = beg + (end - beg) / 2;
+		kid = acell_key_id(FTH_ARRAY_DATA(assoc)[i]);
+
+		if (kid < id)
+			beg = i + 1;
+		else
+			end = i;
+	}
+	return (beg);
+}
+
+static ficlInteger
+assoc_index(FTH assoc, FTH key)
+{
+	FTH 		id, cell;
+	ficlInteger 	i, len;
 
 	if (FTH_NIL_P(assoc) || FTH_FALSE_P(assoc))
 		return (-1);
 
 	FTH_ASSERT_ARGS(FTH_ARRAY_P(assoc), assoc, FTH_ARG1, "an array");
+	len = FTH_ARRAY_LENGTH(assoc);
 
-	if (FTH_ARRAY_LENGTH(assoc) == 0)
+	if (len == 0)
 		return (-1);
 
-	beg = 0;
-	end = FTH_ARRAY_LENGTH(assoc) - 1;
 	id = fth_hash_id(key);
 
-	while (beg <= end) {
-		i = (beg + end) / 2;
-		kid = fth_hash_id(fth_acell_key(FTH_ARRAY_DATA(assoc)[i]));
+	for (i = assoc_bound(assoc, id); i < len; i++) {
+		cell = FTH_ARRAY_DATA(assoc)[i];
+
+		if (acell_key_id(cell) != id)
+			break;
 
-		if (id == kid)
+		if (fth_object_equal_p(fth_acell_key(cell), key))
 			return (i);
-		else if (id < kid)
-			end = i - 1;
-		else
-			beg = i + 1;
 	}
-
 	return (-1);
 }
 
@@ -1906,10 +1981,14 @@ Raise OUT-OF-RANGE exception if LEN < 0 or not even."
 	ficlStackPushFTH(vm->dataStack, assoc);
 }
 
+/*
+ * Insert acell VAL before the elements with the same hash id, so a new
+ * pair shadows older pairs with the same key.
+ */
 static FTH
-assoc_insert(FTH assoc, FTH id, FTH val)
+assoc_insert(FTH assoc, FTH val)
 {
-	ficlInteger 	i, len, alen;
+	ficlInteger 	i, alen;
 
 	FTH_ASSERT_ARGS(FTH_ARRAY_P(assoc), assoc, FTH_ARG1, "an array");
 
@@ -1917,25 +1996,8 @@ assoc_insert(FTH assoc, FTH id, FTH val)
 		FTH_ASSOC_SET(assoc);
 
 	alen = FTH_ARRAY_LENGTH(assoc);
-
-	for (i = 0; i < alen; i++)
-		if (id < fth_hash_id(fth_acell_key(FTH_ARRAY_DATA(assoc)[i])))
-			break;
-
-	len = NEW_SEQ_LENGTH(FTH_ARRAY_TOP(assoc) + alen + 1);
-
-	if (len > MAX_SEQ_LENGTH)
-		FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, len, "too long");
-
-	if (len > FTH_ARRAY_BUF_LENGTH(assoc)) {
-		size_t 		size;
-
-		FTH_ARRAY_BUF_LENGTH(assoc) = len;
-		size = sizeof(FTH) * (size_t) len;
-		FTH_ARRAY_BUF(assoc) = FTH_REALLOC(FTH_ARRAY_BUF(assoc), size);
-		FTH_ARRAY_DATA(assoc) = FTH_ARRAY_BUF(assoc) +
-		    FTH_ARRAY_TOP(assoc);
-	}
+	i = assoc_bound(assoc, acell_key_id(val));
+	ary_grow(assoc, FTH_ARRAY_TOP(assoc) + alen + 1);
 	memmove(FTH_ARRAY_DATA(assoc) + i + 1,
 	    FTH_ARRAY_DATA(assoc) + i,
 	    sizeof(FTH) * (size_t) (FTH_ARRAY_LENGTH(assoc) - i));
@@ -1964,7 +2026,7 @@ See also array-assoc, array-assoc-ref, array-assoc-set!, array-assoc-remove!."
 		FTH_ASSOC_SET(assoc);
 		return (assoc);
 	}
-	return (assoc_insert(assoc, fth_hash_id(key), val));
+	return (assoc_insert(assoc, val));
 }
 
 FTH
@@ -3041,7 +3103,7 @@ Raise OUT-OF-RANGE exception if LEN < 0 or not even."
 	for (i = 0; i < len; i++) {
 		val = fth_pop_ficl_cell(vm);
 		key = fth_pop_ficl_cell(vm);
-		assoc_insert(alist, fth_hash_id(key), fth_make_acell(key, val));
+		assoc_insert(alist, fth_make_acell(key, val));
 	}
 
 	ficlStackPushFTH(vm->dataStack, alist);
@@ -3065,7 +3127,8 @@ See also list-assoc, list-assoc-ref, list-assoc-set!, list-assoc-remove!."
 	if (FTH_NIL_P(alist))
 		ls = fth_make_list_var(1, val);
 	else if (FTH_CONS_P(alist))
-		ls = fth_array_unshift(alist, val);
+		/* keep the list sorted for list-assoc */
+		ls = assoc_insert(alist, val);
 	else
 		ls = fth_make_list_var(2, val, alist);
 
@@ -3136,7 +3199,7 @@ If KEY matches, set key-value pair, otherwise add new pair to ALIST."
 		if (idx >= 0)
 			fth_array_set(alist, idx, val);
 		else
-			assoc_insert(alist, fth_hash_id(key), val);
+			assoc_insert(alist, val);
 	} else {
 		alist = fth_make_list_var(1, val);
 		FTH_ASSOC_SET(alist);
@@ -3177,6 +3240,7 @@ init_array_type(void)
 	fth_set_object_value_ref(array_tag, ary_ref);
 	fth_set_object_value_set(array_tag, ary_set);
 	fth_set_object_equal_p(array_tag, ary_equal_p);
+	fth_set_object_hash(array_tag, ary_hash);
 	fth_set_object_length(array_tag, ary_length);
 	fth_set_object_mark(array_tag, ary_mark);
 	fth_set_object_free(array_tag, ary_free);
@@ -3220,6 +3284,7 @@ init_array(void)
 	FTH_PROC("array-unshift", fth_array_unshift, 2, 0, 0, h_array_unshift);
 	FTH_PROC("array-shift", fth_array_shift, 1, 0, 0, h_array_shift);
 	FTH_PROC("array-append", fth_array_append, 2, 0, 0, h_array_append);
+	FTH_PRI1("array-reserve", ficl_array_reserve, h_array_reserve);
 	FTH_PRI1("array-reverse", ficl_array_reverse, h_array_reverse);
 	FTH_PROC("array-reverse!", fth_array_reverse, 1, 0, 0, h_ary_rev_bang);
 	FTH_PRI1("array-insert", ficl_array_insert, h_array_insert);
@@ -959,6 +959,7 @@ See also file-shell and exit-status."
 		/* NOTREACHED */
 		return;
 	}
+	fth_port_flush_output();
 	flag = fth_set_exit_status(system(fth_string_ref(fs))) == 0;
 	ficlStackPushBoolean(vm->dataStack, flag);
 }
@@ -1007,6 +1008,7 @@ See also close-pipe, open-file, close-file."
 
 	cmd = FTH_CALLOC(len + 1, sizeof(char));
 	strncpy(cmd, str, len);
+	fth_port_flush_output();
 	fp = popen(cmd, mode);
 
 	if (fp == NULL) {
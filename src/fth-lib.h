@@ -34,6 +34,15 @@
 #define DEFAULT_SEQ_LENGTH	128
 #define NEW_SEQ_LENGTH(Len) 						\
 	((((Len) / DEFAULT_SEQ_LENGTH) + 1) * DEFAULT_SEQ_LENGTH)
+/*
+ * Array and string buffers grow by at least half of their size, so
+ * appending N elements copies O(N) elements in total, and shrink only
+ * if less than a quarter is used.
+ */
+#define GROW_SEQ_LENGTH(Buf, Len)					\
+	NEW_SEQ_LENGTH(FICL_MAX((Len), (Buf) + (Buf) / 2))
+#define SHRINK_SEQ_LENGTH(Buf, Len)					\
+	((Len) < (Buf) / 4 ? NEW_SEQ_LENGTH((Len) * 2) : (Buf))
 /*-
  * 1 cells 20 lshift
  * 1 cells 8 = (64bit addr): 0x800000
@@ -57,9 +66,11 @@
 #define FTH_STR_BIGNUM		"bignum"
 #define FTH_STR_BOOLEAN		"boolean"
 #define FTH_STR_COMPLEX		"complex"
+#define FTH_STR_F64_VECTOR	"f64-vector"
 #define FTH_STR_FLOAT		"float"
 #define FTH_STR_HASH		"hash"
 #define FTH_STR_HOOK		"hook"
+#define FTH_STR_I64_VECTOR	"i64-vector"
 #define FTH_STR_IO		"io"
 #define FTH_STR_LIST		"list"
 #define FTH_STR_LLONG		"llong"
@@ -67,38 +78,101 @@
 #define FTH_STR_RATIO		"ratio"
 #define FTH_STR_REGEXP		"regexp"
 #define FTH_STR_STRING		"string"
+#define FTH_STR_VECTOR		"vector"
+
+/*
+ * Cached handles of the predefined symbols, keywords and exceptions.
+ * The table in symbol.c lists the names in the same order.
+ */
+enum {
+	FTH_PRE_SYMBOL_DOCUMENTATION,
+	FTH_PRE_SYMBOL_LAST_MESSAGE,
+	FTH_PRE_SYMBOL_MESSAGE,
+	FTH_PRE_SYMBOL_SOURCE,
+	FTH_PRE_SYMBOL_TRACE_VAR,
+	FTH_PRE_KEYWORD_CLOSE,
+	FTH_PRE_KEYWORD_COMMAND,
+	FTH_PRE_KEYWORD_COUNT,
+	FTH_PRE_KEYWORD_DOMAIN,
+	FTH_PRE_KEYWORD_FAM,
+	FTH_PRE_KEYWORD_FILENAME,
+	FTH_PRE_KEYWORD_FLUSH,
+	FTH_PRE_KEYWORD_IF_EXISTS,
+	FTH_PRE_KEYWORD_INIT,
+	FTH_PRE_KEYWORD_N,
+	FTH_PRE_KEYWORD_PORT,
+	FTH_PRE_KEYWORD_PORT_NAME,
+	FTH_PRE_KEYWORD_RANGE,
+	FTH_PRE_KEYWORD_READ_CHAR,
+	FTH_PRE_KEYWORD_READ_LINE,
+	FTH_PRE_KEYWORD_REPS,
+	FTH_PRE_KEYWORD_SOCKET,
+	FTH_PRE_KEYWORD_SOFT_PORT,
+	FTH_PRE_KEYWORD_START,
+	FTH_PRE_KEYWORD_STRING,
+	FTH_PRE_KEYWORD_WHENCE,
+	FTH_PRE_KEYWORD_WRITE_CHAR,
+	FTH_PRE_KEYWORD_WRITE_LINE,
+	FTH_PRE_BAD_ARITY,
+	FTH_PRE_BAD_SYNTAX,
+	FTH_PRE_BIGNUM_ERROR,
+	FTH_PRE_CATCH_ERROR,
+	FTH_PRE_EVAL_ERROR,
+	FTH_PRE_FICL_ERROR,
+	FTH_PRE_FORTH_ERROR,
+	FTH_PRE_LOAD_ERROR,
+	FTH_PRE_MATH_ERROR,
+	FTH_PRE_NO_MEMORY_ERROR,
+	FTH_PRE_NULL_STRING,
+	FTH_PRE_OPTKEY_ERROR,
+	FTH_PRE_OUT_OF_RANGE,
+	FTH_PRE_REGEXP_ERROR,
+	FTH_PRE_SIGNAL_CAUGHT,
+	FTH_PRE_SOCKET_ERROR,
+	FTH_PRE_SO_FILE_ERROR,
+	FTH_PRE_SYSTEM_ERROR,
+	FTH_PRE_WRONG_NUMBER_OF_ARGS,
+	FTH_PRE_WRONG_TYPE_ARG,
+	FTH_PRE_LAST
+};
+
+#define FTH_PREDEFINED(Idx, Kind)					\
+	((fth_predefined[FTH_PRE_ ## Idx] != 0 &&				\
+	  FICL_WORD_TYPE(fth_predefined[FTH_PRE_ ## Idx]) == (Kind)) ?	\
+	 fth_predefined[FTH_PRE_ ## Idx] :					\
+	 fth_predefined_ref(FTH_PRE_ ## Idx))
 
 /* Predefined symbols. */
-#define FTH_SYMBOL_DOCUMENTATION fth_symbol("documentation")
-#define FTH_SYMBOL_LAST_MESSAGE	fth_symbol("last-message")
-#define FTH_SYMBOL_MESSAGE	fth_symbol("message")
-#define FTH_SYMBOL_SOURCE	fth_symbol("source")
-#define FTH_SYMBOL_TRACE_VAR	fth_symbol("trace-var-hook")
+#define FTH_SYMBOL_DOCUMENTATION FTH_PREDEFINED(SYMBOL_DOCUMENTATION, FW_SYMBOL)
+#define FTH_SYMBOL_LAST_MESSAGE	FTH_PREDEFINED(SYMBOL_LAST_MESSAGE, FW_SYMBOL)
+#define FTH_SYMBOL_MESSAGE	FTH_PREDEFINED(SYMBOL_MESSAGE, FW_SYMBOL)
+#define FTH_SYMBOL_SOURCE	FTH_PREDEFINED(SYMBOL_SOURCE, FW_SYMBOL)
+#define FTH_SYMBOL_TRACE_VAR	FTH_PREDEFINED(SYMBOL_TRACE_VAR, FW_SYMBOL)
 
 /* Predefined keywords. */
-#define FTH_KEYWORD_CLOSE	fth_keyword("close")
-#define FTH_KEYWORD_COMMAND	fth_keyword("command")
-#define FTH_KEYWORD_COUNT	fth_keyword("count")
-#define FTH_KEYWORD_DOMAIN	fth_keyword("domain")
-#define FTH_KEYWORD_FAM		fth_keyword("fam")
-#define FTH_KEYWORD_FILENAME	fth_keyword("filename")
-#define FTH_KEYWORD_FLUSH	fth_keyword("flush")
-#define FTH_KEYWORD_IF_EXISTS	fth_keyword("if-exists")
-#define FTH_KEYWORD_INIT	fth_keyword("initial-element")
-#define FTH_KEYWORD_N		fth_keyword("n")
-#define FTH_KEYWORD_PORT	fth_keyword("port")
-#define FTH_KEYWORD_PORT_NAME	fth_keyword("port-name")
-#define FTH_KEYWORD_RANGE	fth_keyword("range")
-#define FTH_KEYWORD_READ_CHAR	fth_keyword("read-char")
-#define FTH_KEYWORD_READ_LINE	fth_keyword("read-line")
-#define FTH_KEYWORD_REPS	fth_keyword("reps")
-#define FTH_KEYWORD_SOCKET	fth_keyword("socket")
-#define FTH_KEYWORD_SOFT_PORT	fth_keyword("soft-port")
-#define FTH_KEYWORD_START	fth_keyword("start")
-#define FTH_KEYWORD_STRING	fth_keyword("string")
-#define FTH_KEYWORD_WHENCE	fth_keyword("whence")
-#define FTH_KEYWORD_WRITE_CHAR	fth_keyword("write-char")
-#define FTH_KEYWORD_WRITE_LINE	fth_keyword("write-line")
+#define FTH_KEYWORD_CLOSE	FTH_PREDEFINED(KEYWORD_CLOSE, FW_KEYWORD)
+#define FTH_KEYWORD_COMMAND	FTH_PREDEFINED(KEYWORD_COMMAND, FW_KEYWORD)
+#define FTH_KEYWORD_COUNT	FTH_PREDEFINED(KEYWORD_COUNT, FW_KEYWORD)
+#define FTH_KEYWORD_DOMAIN	FTH_PREDEFINED(KEYWORD_DOMAIN, FW_KEYWORD)
+#define FTH_KEYWORD_FAM		FTH_PREDEFINED(KEYWORD_FAM, FW_KEYWORD)
+#define FTH_KEYWORD_FILENAME	FTH_PREDEFINED(KEYWORD_FILENAME, FW_KEYWORD)
+#define FTH_KEYWORD_FLUSH	FTH_PREDEFINED(KEYWORD_FLUSH, FW_KEYWORD)
+#define FTH_KEYWORD_IF_EXISTS	FTH_PREDEFINED(KEYWORD_IF_EXISTS, FW_KEYWORD)
+#define FTH_KEYWORD_INIT	FTH_PREDEFINED(KEYWORD_INIT, FW_KEYWORD)
+#define FTH_KEYWORD_N		FTH_PREDEFINED(KEYWORD_N, FW_KEYWORD)
+#define FTH_KEYWORD_PORT	FTH_PREDEFINED(KEYWORD_PORT, FW_KEYWORD)
+#define FTH_KEYWORD_PORT_NAME	FTH_PREDEFINED(KEYWORD_PORT_NAME, FW_KEYWORD)
+#define FTH_KEYWORD_RANGE	FTH_PREDEFINED(KEYWORD_RANGE, FW_KEYWORD)
+#define FTH_KEYWORD_READ_CHAR	FTH_PREDEFINED(KEYWORD_READ_CHAR, FW_KEYWORD)
+#define FTH_KEYWORD_READ_LINE	FTH_PREDEFINED(KEYWORD_READ_LINE, FW_KEYWORD)
+#define FTH_KEYWORD_REPS	FTH_PREDEFINED(KEYWORD_REPS, FW_KEYWORD)
+#define FTH_KEYWORD_SOCKET	FTH_PREDEFINED(KEYWORD_SOCKET, FW_KEYWORD)
+#define FTH_KEYWORD_SOFT_PORT	FTH_PREDEFINED(KEYWORD_SOFT_PORT, FW_KEYWORD)
+#define FTH_KEYWORD_START	FTH_PREDEFINED(KEYWORD_START, FW_KEYWORD)
+#define FTH_KEYWORD_STRING	FTH_PREDEFINED(KEYWORD_STRING, FW_KEYWORD)
+#define FTH_KEYWORD_WHENCE	FTH_PREDEFINED(KEYWORD_WHENCE, FW_KEYWORD)
+#define FTH_KEYWORD_WRITE_CHAR	FTH_PREDEFINED(KEYWORD_WRITE_CHAR, FW_KEYWORD)
+#define FTH_KEYWORD_WRITE_LINE	FTH_PREDEFINED(KEYWORD_WRITE_LINE, FW_KEYWORD)
 
 /* Predefined exceptions. */
 #define STR_BAD_ARITY		"bad-arity"
@@ -122,30 +196,29 @@
 #define STR_WRONG_NUMBER_OF_ARGS "wrong-number-of-args"
 #define STR_WRONG_TYPE_ARG	"wrong-type-arg"
 
-#define FTH_BAD_ARITY		fth_exception(STR_BAD_ARITY)
-#define FTH_BAD_SYNTAX		fth_exception(STR_BAD_SYNTAX)
-#define FTH_BIGNUM_ERROR	fth_exception(STR_BIGNUM_ERROR)
-#define FTH_CATCH_ERROR		fth_exception(STR_CATCH_ERROR)
-#define FTH_EVAL_ERROR		fth_exception(STR_EVAL_ERROR)
-#define FTH_FICL_ERROR		fth_exception(STR_FICL_ERROR)
-#define FTH_FORTH_ERROR		fth_exception(STR_FORTH_ERROR)
-#define FTH_LOAD_ERROR		fth_exception(STR_LOAD_ERROR)
-#define FTH_MATH_ERROR		fth_exception(STR_MATH_ERROR)
-#define FTH_NO_MEMORY_ERROR	fth_exception(STR_NO_MEMORY_ERROR)
-#define FTH_NULL_STRING		fth_exception(STR_NULL_STRING)
-#define FTH_OPTKEY_ERROR	fth_exception(STR_OPTKEY_ERROR)
-#define FTH_OUT_OF_RANGE	fth_exception(STR_OUT_OF_RANGE)
-#define FTH_REGEXP_ERROR	fth_exception(STR_REGEXP_ERROR)
-#define FTH_SIGNAL_CAUGHT	fth_exception(STR_SIGNAL_CAUGHT)
-#define FTH_SOCKET_ERROR	fth_exception(STR_SOCKET_ERROR)
-#define FTH_SO_FILE_ERROR	fth_exception(STR_SO_FILE_ERROR)
-#define FTH_SYSTEM_ERROR	fth_exception(STR_SYSTEM_ERROR)
-#define FTH_WRONG_NUMBER_OF_ARGS fth_exception(STR_WRONG_NUMBER_OF_ARGS)
-#define FTH_WRONG_TYPE_ARG	fth_exception(STR_WRONG_TYPE_ARG)
+#define FTH_BAD_ARITY		FTH_PREDEFINED(BAD_ARITY, FW_EXCEPTION)
+#define FTH_BAD_SYNTAX		FTH_PREDEFINED(BAD_SYNTAX, FW_EXCEPTION)
+#define FTH_BIGNUM_ERROR	FTH_PREDEFINED(BIGNUM_ERROR, FW_EXCEPTION)
+#define FTH_CATCH_ERROR		FTH_PREDEFINED(CATCH_ERROR, FW_EXCEPTION)
+#define FTH_EVAL_ERROR		FTH_PREDEFINED(EVAL_ERROR, FW_EXCEPTION)
+#define FTH_FICL_ERROR		FTH_PREDEFINED(FICL_ERROR, FW_EXCEPTION)
+#define FTH_FORTH_ERROR		FTH_PREDEFINED(FORTH_ERROR, FW_EXCEPTION)
+#define FTH_LOAD_ERROR		FTH_PREDEFINED(LOAD_ERROR, FW_EXCEPTION)
+#define FTH_MATH_ERROR		FTH_PREDEFINED(MATH_ERROR, FW_EXCEPTION)
+#define FTH_NO_MEMORY_ERROR	FTH_PREDEFINED(NO_MEMORY_ERROR, FW_EXCEPTION)
+#define FTH_NULL_STRING		FTH_PREDEFINED(NULL_STRING, FW_EXCEPTION)
+#define FTH_OPTKEY_ERROR	FTH_PREDEFINED(OPTKEY_ERROR, FW_EXCEPTION)
+#define FTH_OUT_OF_RANGE	FTH_PREDEFINED(OUT_OF_RANGE, FW_EXCEPTION)
+#define FTH_REGEXP_ERROR	FTH_PREDEFINED(REGEXP_ERROR, FW_EXCEPTION)
+#define FTH_SIGNAL_CAUGHT	FTH_PREDEFINED(SIGNAL_CAUGHT, FW_EXCEPTION)
+#define FTH_SOCKET_ERROR	FTH_PREDEFINED(SOCKET_ERROR, FW_EXCEPTION)
+#define FTH_SO_FILE_ERROR	FTH_PREDEFINED(SO_FILE_ERROR, FW_EXCEPTION)
+#define FTH_SYSTEM_ERROR	FTH_PREDEFINED(SYSTEM_ERROR, FW_EXCEPTION)
+#define FTH_WRONG_NUMBER_OF_ARGS FTH_PREDEFINED(WRONG_NUMBER_OF_ARGS, FW_EXCEPTION)
+#define FTH_WRONG_TYPE_ARG	FTH_PREDEFINED(WRONG_TYPE_ARG, FW_EXCEPTION)
 
 /* ANS Exception. */
-#define __ANS_EXC(Exc) 							\
-	fth_exception(ficl_ans_exc_name(FICL_VM_STATUS_ ## Exc))
+#define __ANS_EXC(Exc)		ficl_ans_exception(FICL_VM_STATUS_ ## Exc)
 #define FTH_ABORT		__ANS_EXC(ABORT)
 #define FTH_ABORTQ		__ANS_EXC(ABORTQ)
 #define FTH_ALIGNMENT_ERROR	__ANS_EXC(ALIGNMENT_ERROR)
@@ -365,6 +438,8 @@ typedef enum {
 	FTH_NIL_T,
 	FTH_REGEXP_T,
 	FTH_STRING_T,
+	FTH_F64_VECTOR_T,
+	FTH_I64_VECTOR_T,
 	/* number types */
 	FTH_LLONG_T,
 	FTH_FLOAT_T,
@@ -387,6 +462,7 @@ typedef struct {
 	FTH             (*value_ref)(FTH self, FTH index);
 	FTH             (*value_set)(FTH self, FTH index, FTH value);
 	FTH             (*equal_p)(FTH self, FTH obj);
+	FTH             (*hash)(FTH self);
 	FTH             (*length)(FTH self);
 	void            (*mark)(FTH self);
 	void            (*free)(FTH self);
@@ -399,10 +475,14 @@ typedef struct {
 	FTH		value_ref_proc;
 	FTH		value_set_proc;
 	FTH		equal_p_proc;
+	FTH		hash_proc;
 	FTH		length_proc;
 	FTH		mark_proc;
 	FTH		free_proc;
 	FTH		apply;	/* proc object */
+	/* gc-statistics */
+	ficlUnsigned	allocated;	/* instances */
+	ficlUnsigned	freed;
 } FObject;
 
 #define FTH_OBJECT_REF(Obj)	((FObject *)(Obj))
@@ -434,8 +514,10 @@ typedef struct FInstance {
 	FTH		values;
 	FTH		debug_hook;	/* ( inspect-string obj -- str ) */
 	ficlInteger	cycle;
-	int		changed_p;
+	int		changed_p;	/* FTH_CHANGED_* bits */
 	int		extern_p;
+	unsigned int	slot;		/* index in the instance slabs */
+	ficlUnsigned	hash_id;	/* valid if !FTH_CHANGED_HASH */
 	union {
 		ficlInteger	i;
 		ficlUnsigned	u;
@@ -456,6 +538,13 @@ typedef struct FInstance {
 
 #define FTH_INSTANCE_REF(Obj)		((FInstance *)(Obj))
 
+/* changed_p bits, cleared by the consumer of the cached value */
+#define FTH_CHANGED_VALUES	0x01	/* inst->values (object->array) */
+#define FTH_CHANGED_HASH	0x02	/* inst->hash_id (hash-id) */
+#define FTH_CHANGED_KEY		0x04	/* hash id of an acell's key */
+#define FTH_CHANGED_ALL							\
+	(FTH_CHANGED_VALUES | FTH_CHANGED_HASH | FTH_CHANGED_KEY)
+
 #define FTH_INSTANCE_CELL_TYPE(Obj)	FTH_INSTANCE_REF(Obj)->type
 #define FTH_INSTANCE_CELL_TYPE_SET(Obj, Type)				\
 	(FTH_INSTANCE_CELL_TYPE(Obj) = (instance_t)(Type))
@@ -522,7 +611,8 @@ typedef struct FInstance {
 #define FTH_INSTANCE_PROPERTIES(Obj)	FTH_INSTANCE_REF(Obj)->properties
 #define FTH_INSTANCE_DEBUG_HOOK(Obj)	FTH_INSTANCE_REF(Obj)->debug_hook
 #define FTH_INSTANCE_CHANGED_P(Obj)	FTH_INSTANCE_REF(Obj)->changed_p
-#define FTH_INSTANCE_CHANGED(Obj)	(FTH_INSTANCE_REF(Obj)->changed_p = 1)
+#define FTH_INSTANCE_CHANGED(Obj)					\
+	(FTH_INSTANCE_REF(Obj)->changed_p = FTH_CHANGED_ALL)
 #define FTH_INSTANCE_CHANGED_CLR(Obj)	(FTH_INSTANCE_REF(Obj)->changed_p = 0)
 
 /* === Word === */
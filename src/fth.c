@@ -35,13 +35,21 @@ const char fth_sccsid[] = "@(#)fth.c	2.1 1/2/18";
 #include "fth.h"
 #include "utils.h"
 #include <getopt.h>
+#if defined(HAVE_SYS_STAT_H)
+#include <sys/stat.h>
+#endif
+#if defined(HAVE_SYS_WAIT_H)
+#include <sys/wait.h>
+#endif
+#if defined(HAVE_FCNTL_H)
+#include <fcntl.h>
+#endif
 
 #define FTH_COPYRIGHT	"(c) 2004-2018 Michael Scholz"
 
 static FTH 	eval_with_error_exit(void *, int);
-static void 	repl_in_place(char *, FTH, ficlWord *, int, int, int);
 static ficlWord *source_to_word(const char *);
-static FTH 	string_split(char *, char *);
+static FTH 	string_split(const char *, size_t, const char *);
 
 enum {
 	REPL_COMPILE,
@@ -137,87 +145,440 @@ eval_with_error_exit(void *p, int kind)
 	return (val);
 }
 
+/*
+ * Split STR of LEN bytes at any char of DELIM; empty fields are
+ * skipped (like strsep(3) in a loop).
+ */
 static FTH
-string_split(char *str, char *delim)
+string_split(const char *str, size_t len, const char *delim)
 {
-	char           *p, *s, *t;
+	const char     *p, *end;
+	size_t 		n;
 	FTH 		result;
 
-	s = t = FTH_STRDUP(str);
 	result = fth_make_empty_array();
+	end = str + len;
 
-	while ((p = strsep(&s, delim)) != NULL)
-		if (*p != '\0')
-			fth_array_push(result, fth_make_string(p));
+	for (p = str; p < end; p += n) {
+		n = strcspn(p, delim);
 
-	FTH_FREE(t);
+		if (p + n > end)
+			n = (size_t) (end - p);
+
+		if (n > 0)
+			fth_array_push(result,
+			    fth_make_string_len(p, (ficlInteger) n));
+		else
+			n = 1;
+	}
 	return (result);
 }
 
 static char 	fth_scratch[BUFSIZ];
 
+/*
+ * Implicit-loop state.  The variables are looked up once, not per
+ * record.  *farray* is split only when the loop body asks for it: while
+ * the loop runs with -a, the word *farray* executes ficl_lazy_farray()
+ * instead of pushing its value.
+ */
+static ficlWord *loop_line;
+static ficlWord *loop_fnr;
+static ficlWord *loop_nr;
+static ficlWord *loop_farray;
+static const char *loop_delim;
+static FTH 	loop_split;	/* *line* to split or #f if done */
+
+static void
+lazy_farray_update(void)
+{
+	if (FTH_NOT_FALSE_P(loop_split)) {
+		fth_var_set((FTH) loop_farray,
+		    string_split(fth_string_ref(loop_split),
+		    (size_t) fth_string_length(loop_split), loop_delim));
+		loop_split = FTH_FALSE;
+	}
+}
+
 static void
-repl_in_place(char *in, FTH out, ficlWord *word, int auto_split_p, int print_p, int chomp_p)
+ficl_lazy_farray(ficlVm *vm)
 {
-	char           *delim, *buf;
-	size_t 		len;
+	lazy_farray_update();
+	ficlStackPush(vm->dataStack, loop_farray->param[0]);
+}
+
+/*
+ * Options of the implicit loop (-a, -i, -l, -n, -p).
+ */
+typedef struct {
+	ficlWord       *word;		/* last -e PATTERN */
+	char           *suffix;		/* -i SUFFIX */
+	int 		in_place_p;	/* -i */
+	int 		auto_split_p;	/* -a */
+	int 		print_p;	/* -p */
+	int 		chomp_p;	/* -l */
+} FLoop;
+
+/*
+ * Run LP->WORD on every line of IN (stdin if NULL), restricted to LEN
+ * bytes from START if LEN is not -1.  If OUT is not NULL, string
+ * results are written to it (-i).
+ */
+static void
+repl_in_place(char *in, off_t start, off_t len, FILE *out, FLoop *lp)
+{
+	FLineReader    *rd;
+	size_t 		n;
 	ficlInteger 	line_no;
+	ficlPrimitive 	farray_code;
 	FTH 		line;
-	FILE           *ifp;
 
-	ifp = stdin;
+	rd = fth_line_reader_open(in, FTH_LOOP_BLOCK_SIZE);
 
-	if (in != NULL) {
-		ifp = fopen(in, "r");
+	if (rd == NULL)
+		return;
+
+	if (len != -1)
+		fth_line_reader_range(rd, start, len);
 
-		if (ifp == NULL) {
-			FTH_SYSTEM_ERROR_ARG_THROW(fopen, in);
-			return;
-		}
-	}
 	gc_push(FTH_FICL_VM()->runningWord);
-	delim = fth_string_ref(fth_variable_ref("*fs*"));
+	loop_line = FICL_WORD_NAME_REF("*line*");
+	loop_fnr = FICL_WORD_NAME_REF("*fnr*");
+	loop_nr = FICL_WORD_NAME_REF("*nr*");
+	loop_farray = FICL_WORD_NAME_REF("*farray*");
+	loop_delim = fth_string_ref(fth_variable_ref("*fs*"));
+	loop_split = FTH_FALSE;
+	farray_code = loop_farray->code;
+
+	if (lp->auto_split_p)
+		loop_farray->code = ficl_lazy_farray;
+
 	line_no = 0;
-	buf = fth_scratch;
 
-	while (fgets(buf, BUFSIZ, ifp) != NULL) {
-		if (print_p)
-			fth_print(buf);
+	while ((n = fth_line_reader_next(rd)) > 0) {
+		if (lp->print_p)
+			fth_print(rd->line);
 
-		if (chomp_p) {
-			len = fth_strlen(buf);
-			if (buf[len - 1] == '\n')
-				buf[len - 1] = '\0';
-		}
-		if (auto_split_p)
-			fth_variable_set("*farray*", string_split(buf, delim));
+		if (lp->chomp_p && rd->line[n - 1] == '\n')
+			rd->line[--n] = '\0';
+
+		line = fth_make_string_len(rd->line, (ficlInteger) n);
+		fth_var_set((FTH) loop_line, line);
+		fth_var_set((FTH) loop_fnr, fth_make_int(line_no++));
 
-		fth_variable_set("*line*", fth_make_string(buf));
-		fth_variable_set("*fnr*", fth_make_int(line_no++));
-		line = eval_with_error_exit(word, REPL_COMPILE);
-		fth_variable_set("*nr*",
-		    fth_number_add(fth_variable_ref("*nr*"), FTH_ONE));
+		if (lp->auto_split_p)
+			loop_split = line;
 
-		if (FTH_NOT_FALSE_P(out))
-			fth_array_push(out, line);
+		line = eval_with_error_exit(lp->word, REPL_COMPILE);
+		fth_var_set((FTH) loop_nr,
+		    fth_number_add(fth_var_ref((FTH) loop_nr), FTH_ONE));
+
+		/* -i: write the result instead of collecting it */
+		if (out != NULL && fth_string_length(line) > 0)
+			if (fputs(fth_string_ref(line), out) == EOF)
+				FTH_SYSTEM_ERROR_ARG_THROW(fputs, in);
 
 		gc_loop_reset();
 	}
 
+	lazy_farray_update();
+	loop_farray->code = farray_code;
 	gc_pop();
+	fth_line_reader_close(rd);
+}
+
+/*
+ * Process IN_FILE or with LEN != -1 the part of it described by START
+ * and LEN.  With -i, stream the output to a temporary file beside
+ * IN_FILE and replace it at the end.
+ */
+static void
+loop_file(char *in_file, off_t start, off_t len, FLoop *lp)
+{
+	char 		tmp_file[MAXPATHLEN], out_file[MAXPATHLEN];
+	struct stat 	st;
+	FILE           *out;
+	int 		fd;
+
+	fth_variable_set("*fname*", fth_make_string(in_file));
+
+	if (!lp->in_place_p) {
+		repl_in_place(in_file, start, len, NULL, lp);
+		return;
+	}
+	fth_strcpy(tmp_file, sizeof(tmp_file), in_file);
+	fth_strcat(tmp_file, sizeof(tmp_file), ".XXXXXX");
+	fd = mkstemp(tmp_file);
+
+	if (fd == -1 || (out = fdopen(fd, "w")) == NULL)
+		FTH_SYSTEM_ERROR_ARG_THROW(mkstemp, tmp_file);
+
+	if (stat(in_file, &st) == 0)
+		fchmod(fd, st.st_mode & 07777);
+
+	repl_in_place(in_file, start, len, out, lp);
+	fclose(out);
+
+	if (lp->suffix != NULL) {	/* -i SUFFIX */
+		fth_strcpy(out_file, sizeof(out_file), in_file);
+		fth_strcat(out_file, sizeof(out_file), lp->suffix);
+		fth_file_rename(in_file, out_file);
+	}
+	fth_file_rename(tmp_file, in_file);
+}
+
+#if defined(HAVE_FORK) && defined(HAVE_WAITPID)
+/*-
+ * -j JOBS: process FILES with JOBS forked interpreters.
+ *
+ * Work units are whole files, or if there are fewer files than jobs
+ * (and no -i), byte ranges of a file split at line boundaries.  The
+ * parent hands out unit numbers over a pipe, one at a time to an idle
+ * worker.  A worker writes the output of each unit to its own file in
+ * a directory the parent created with mkdtemp(3) and reports the unit
+ * back; the parent copies finished units to stdout in order.  *nr*
+ * counts per worker and *fnr* per unit.
+ */
+typedef struct {
+	char           *file;
+	off_t 		start;
+	off_t 		len;		/* -1: whole file */
+	int 		done_p;
+} FLoopUnit;
+
+/* Return the offset after the first newline at or after POS. */
+static off_t
+loop_line_start(int fd, off_t pos, off_t size)
+{
+	char 		buf[BUFSIZ], *nl;
+	ssize_t 	got;
+
+	while (pos < size) {
+		got = pread(fd, buf, sizeof(buf), pos);
+
+		if (got <= 0)
+			return (size);
+
+		nl = memchr(buf, '\n', (size_t) got);
+
+		if (nl != NULL)
+			return (pos + (nl - buf) + 1);
+
+		pos += got;
+	}
+	return (size);
+}
+
+static FLoopUnit *
+loop_make_units(char **files, int jobs, int in_place_p, int *units_len)
+{
+	FLoopUnit      *units;
+	struct stat 	st;
+	off_t 		pos, next;
+	int 		i, k, n, files_len, chunks, fd;
+
+	for (files_len = 0; files[files_len] != NULL; files_len++)
+		;
+
+	units = FTH_MALLOC(sizeof(FLoopUnit) * (size_t) (files_len * jobs));
+	n = 0;
+
+	for (i = 0; i < files_len; i++) {
+		chunks = 1;
+		fd = -1;
+
+		if (!in_place_p && files_len < jobs &&
+		    (fd = open(files[i], O_RDONLY)) != -1 &&
+		    fstat(fd, &st) == 0 &&
+		    st.st_size >= 2 * FTH_LOOP_BLOCK_SIZE)
+			chunks = jobs;
+
+		if (chunks == 1) {
+			units[n].file = files[i];
+			units[n].start = 0;
+			units[n].len = -1;
+			units[n++].done_p = 0;
+		} else
+			for (k = 0, pos = 0; k < chunks; k++, pos = next) {
+				next = (k == chunks - 1) ? st.st_size :
+				    loop_line_start(fd,
+				    st.st_size / chunks * (k + 1), st.st_size);
+
+				if (next < pos)
+					next = pos;
+				units[n].file = files[i];
+				units[n].start = pos;
+				units[n].len = next - pos;
+				units[n++].done_p = 0;
+			}
+
+		if (fd != -1)
+			close(fd);
+	}
+	*units_len = n;
+	return (units);
+}
 
-	if (in != NULL)
-		fclose(ifp);
+/* DIR of MAXPATHLEN, a slash and the unit number */
+#define LOOP_UNIT_NAME_SIZE	(MAXPATHLEN + 16)
+
+/* The output of unit K goes to DIR, a private directory of the parent. */
+static void
+loop_unit_name(char *buf, size_t size, const char *dir, int k)
+{
+	snprintf(buf, size, "%s/%d", dir, k);
 }
 
+static void
+loop_worker(FLoopUnit *units, int queue, int done, const char *dir,
+    FLoop *lp)
+{
+	char 		name[LOOP_UNIT_NAME_SIZE];
+	int 		k, fd;
+
+	while (read(queue, &k, sizeof(k)) == sizeof(k)) {
+		loop_unit_name(name, sizeof(name), dir, k);
+		fd = open(name, O_WRONLY | O_CREAT | O_EXCL, 0600);
+
+		if (fd == -1)
+			FTH_SYSTEM_ERROR_ARG_THROW(open, name);
+
+		fflush(stdout);
+		dup2(fd, STDOUT_FILENO);
+		close(fd);
+		loop_file(units[k].file, units[k].start, units[k].len, lp);
+		fflush(stdout);
+
+		if (write(done, &k, sizeof(k)) != sizeof(k))
+			break;
+	}
+	_exit(EXIT_SUCCESS);
+}
+
+/* Append the output of unit K to stdout and remove it. */
+static void
+loop_unit_flush(const char *dir, int k)
+{
+	char 		name[LOOP_UNIT_NAME_SIZE], buf[FTH_LOOP_BLOCK_SIZE];
+	ssize_t 	got;
+	int 		fd;
+
+	loop_unit_name(name, sizeof(name), dir, k);
+	fd = open(name, O_RDONLY);
+
+	if (fd == -1)
+		return;
+
+	while ((got = read(fd, buf, sizeof(buf))) > 0)
+		if (write(STDOUT_FILENO, buf, (size_t) got) != got)
+			break;
+
+	close(fd);
+	unlink(name);
+}
+
+static int
+loop_parallel(char **files, int jobs, FLoop *lp)
+{
+	FLoopUnit      *units;
+	char 		dir[MAXPATHLEN];
+	pid_t 		pid;
+	int 		queue[2], done[2];
+	int 		i, k, units_len, next, flushed, status, ret;
+
+	units = loop_make_units(files, jobs, lp->in_place_p, &units_len);
+
+	if (jobs > units_len)
+		jobs = units_len;
+
+	if (pipe(queue) == -1 || pipe(done) == -1)
+		FTH_SYSTEM_ERROR_THROW(pipe);
+
+	snprintf(dir, sizeof(dir), "%s/fth-j.XXXXXX",
+	    fth_getenv("TMPDIR", "/tmp"));
+
+	if (mkdtemp(dir) == NULL)
+		FTH_SYSTEM_ERROR_ARG_THROW(mkdtemp, dir);
+
+	fflush(stdout);
+	fflush(stderr);
+
+	for (i = 0; i < jobs; i++) {
+		pid = fork();
+
+		if (pid == -1)
+			FTH_SYSTEM_ERROR_THROW(fork);
+
+		if (pid == 0) {
+			close(queue[1]);
+			close(done[0]);
+			loop_worker(units, queue[0], done[1], dir, lp);
+		}
+	}
+	close(queue[0]);
+	close(done[1]);
+
+	/* one unit per worker, the next one when a unit is done */
+	for (next = 0; next < jobs; next++)
+		if (write(queue[1], &next, sizeof(next)) != sizeof(next))
+			break;
+
+	flushed = 0;
+
+	while (flushed < units_len &&
+	    read(done[0], &k, sizeof(k)) == sizeof(k)) {
+		units[k].done_p = 1;
+
+		if (next < units_len) {
+			if (write(queue[1], &next, sizeof(next)) ==
+			    sizeof(next))
+				next++;
+		} else if (next == units_len) {
+			close(queue[1]);
+			next++;
+		}
+		while (flushed < units_len && units[flushed].done_p)
+			loop_unit_flush(dir, flushed++);
+	}
+
+	if (next <= units_len)
+		close(queue[1]);
+
+	close(done[0]);
+	ret = EXIT_SUCCESS;
+
+	while (waitpid(-1, &status, 0) != -1)
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+			ret = EXIT_FAILURE;
+
+	/* remove output of units a failed worker left behind */
+	for (k = flushed; k < units_len; k++) {
+		char 		name[LOOP_UNIT_NAME_SIZE];
+
+		loop_unit_name(name, sizeof(name), dir, k);
+		unlink(name);
+		ret = EXIT_FAILURE;
+	}
+	rmdir(dir);
+	FTH_FREE(units);
+	return (ret);
+}
+#endif				/* HAVE_FORK && HAVE_WAITPID */
+
 #define LIBSLEN		48
 #define WARN_STR	"#<warning: too much calls for -%c, ignoring \"%s\">\n"
 #define FTH_USAGE	"\
 usage: fth [-DdQqrv] [-C so-lib-path] [-Ee pattern] [-F fs] [-f init-file]\n\
-           [-I fs-path] [-S \"lib init\"] [-s file] [file ...]\n\
-       fth [-al] [-i [suffix]] [-n | -p] -e pattern [file | -]\n\
+           [-I fs-path] [-S \"lib init\"] [-s file] [--image file]\n\
+           [file ...]\n\
+       fth [-al] [-i [suffix]] [-j jobs] [-n | -p] -e pattern [file | -]\n\
+       fth --save-image file\n\
        fth -V\n"
 
+/* long options without short equivalent */
+#define FTH_OPT_IMAGE		256
+#define FTH_OPT_SAVE_IMAGE	257
+
 extern char    *optarg;
 extern int 	opterr;
 extern int 	optind;
@@ -232,7 +593,8 @@ main(int argc, char **argv)
 	int 		script_p, finish_getopt;
 	int 		i, c, exit_value, stay_in_repl, verbose;
 	int 		lp_len, llp_len, bufs_len, libs_len;
-	char           *field_separator, *init_file, *suffix, *script;
+	int 		save_image, jobs;
+	char           *field_separator, *init_file, *suffix, *script, *image;
 	char           *buffers[LIBSLEN], *load_lib_paths[LIBSLEN];
 	char           *libraries[LIBSLEN], *load_paths[LIBSLEN];
 	FTH 		ret;
@@ -244,7 +606,7 @@ main(int argc, char **argv)
 	 *
 	 * optional arguments: append two colons x:: (see i:: in char *args)
 	 */
-	char           *args = "C:DE:F:I:QS:Vade:f:i::lnpqrs:v";
+	char           *args = "C:DE:F:I:QS:Vade:f:i::j:lnpqrs:v";
 
 	/*
 	 * Long options are gone with version 1.3.3 but --eval and
@@ -254,6 +616,8 @@ main(int argc, char **argv)
 	struct option 	opts[] = {
 		{"eval", required_argument, NULL, 'e'},
 		{"no-init-file", no_argument, NULL, 'Q'},
+		{"image", required_argument, NULL, FTH_OPT_IMAGE},
+		{"save-image", required_argument, NULL, FTH_OPT_SAVE_IMAGE},
 		{0, 0, 0, 0}
 	};
 
@@ -278,6 +642,7 @@ main(int argc, char **argv)
 	init_file = NULL;	/* -f file */
 	in_place_p = 0;		/* -i[suffix] */
 	suffix = NULL;		/* -isuffix */
+	jobs = 1;		/* -j jobs */
 	line_end = 0;		/* -l */
 	implicit_loop = 0;	/* -n || -p */
 	loop_print = 0;		/* -n 0 || -p 1 */
@@ -285,6 +650,8 @@ main(int argc, char **argv)
 	script_p = 0;		/* -s */
 	finish_getopt = 0;	/* -s */
 	script = NULL;		/* -s file */
+	image = NULL;		/* --image file, --save-image file */
+	save_image = 0;		/* --save-image */
 
 	/*-
 	 * verbose:		-1 not set --> true in interactive repl
@@ -359,6 +726,11 @@ main(int argc, char **argv)
 			if (optarg)
 				suffix = optarg;
 			break;
+		case 'j':	/* -j JOBS */
+			jobs = (int) strtol(optarg, NULL, 10);
+			if (jobs < 1)
+				jobs = 1;
+			break;
 		case 'l':	/* -l */
 			line_end = 1;
 			break;
@@ -386,6 +758,14 @@ main(int argc, char **argv)
 		case 'v':	/* -v */
 			verbose = 1;
 			break;
+		case FTH_OPT_IMAGE:	/* --image FILE */
+			image = optarg;
+			save_image = 0;
+			break;
+		case FTH_OPT_SAVE_IMAGE:	/* --save-image FILE */
+			image = optarg;
+			save_image = 1;
+			break;
 		case '?':
 		default:
 			fprintf(stderr, FTH_USAGE);
@@ -420,8 +800,17 @@ main(int argc, char **argv)
 	/*
 	 * Finish init forth.
 	 */
+	if (image != NULL)
+		fth_image_set(image, save_image);
+
 	forth_init();
 
+	/*
+	 * Write the image and exit (see image.c).
+	 */
+	if (save_image)
+		exit(fth_image_save() ? EXIT_SUCCESS : EXIT_FAILURE);
+
 	/*
 	 * Adjust command line array.
 	 */
@@ -462,9 +851,7 @@ main(int argc, char **argv)
 	 * In-place or implicit-loop action and exit.
 	 */
 	if (in_place_p || implicit_loop) {	/* -inp */
-		ficlWord       *word;
-		char           *in_file, out_file[MAXPATHLEN];
-		FTH 		out;
+		FLoop 		lp;
 
 		if (bufs_len < 1) {
 			fth_errorf("#<%s: in-place require -e PATTERN!>\n",
@@ -486,40 +873,33 @@ main(int argc, char **argv)
 		/*
 		 * Last or only -e: compile and use it for in-place.
 		 */
-		word = source_to_word(buffers[i]);
+		lp.word = source_to_word(buffers[i]);
+		lp.suffix = suffix;
+		lp.in_place_p = in_place_p;
+		lp.auto_split_p = auto_split;
+		lp.print_p = loop_print;
+		lp.chomp_p = line_end;
 
 		/*
 		 * Read from stdin ...
 		 */
 		if (*argv == NULL) {
-			repl_in_place(NULL, FTH_FALSE, word,
-			    auto_split, loop_print, line_end);
+			repl_in_place(NULL, 0, -1, NULL, &lp);
 			fth_exit(EXIT_SUCCESS);
 		}
+#if defined(HAVE_FORK) && defined(HAVE_WAITPID)
+		/*
+		 * ... or let JOBS workers process the files ...
+		 */
+		if (jobs > 1)
+			fth_exit(loop_parallel(argv, jobs, &lp));
+#endif
 		/*
 		 * ... or process all remaining files in order.
 		 */
-		for (i = 0; argv[i]; i++) {
-			in_file = argv[i];
-			fth_variable_set("*fname*", fth_make_string(in_file));
-
-			if (in_place_p) {	/* -i [SUFFIX] */
-				out = fth_make_empty_array();
-				repl_in_place(in_file, out, word,
-				    auto_split, loop_print, line_end);
-
-				if (suffix != NULL) {	/* -i SUFFIX */
-					fth_strcpy(out_file, sizeof(out_file),
-					    in_file);
-					fth_strcat(out_file, sizeof(out_file),
-					    suffix);
-					fth_file_rename(in_file, out_file);
-				}
-				fth_writelines(in_file, out);
-			} else
-				repl_in_place(in_file, FTH_FALSE, word,
-				    auto_split, loop_print, line_end);
-		}
+		for (i = 0; argv[i]; i++)
+			loop_file(argv[i], 0, -1, &lp);
+
 		fth_exit(EXIT_SUCCESS);
 	}
 	/*
@@ -545,8 +925,14 @@ main(int argc, char **argv)
 
 			buf = fth_scratch;
 
-			while (fgets(buf, BUFSIZ, stdin) != NULL)
+			for (;;) {
+				fth_port_flush_output();
+
+				if (fgets(buf, BUFSIZ, stdin) == NULL)
+					break;
+
 				eval_with_error_exit(buf, REPL_INTERPRET);
+			}
 
 			fth_exit(EXIT_SUCCESS);
 		} else {
@@ -256,6 +256,9 @@ extern out_cb 	fth_print_hook;
 extern out_cb 	fth_error_hook;
 extern exit_cb 	fth_exit_hook;
 
+/* defined in symbol.c, indexed by FTH_PRE_* */
+extern FTH	fth_predefined[];
+
 /* === Predicates === */
 #define FTH_INSTANCE_FLAG_P(Obj, Type)	fth_instance_flag_p(Obj, Type)
 #define FTH_INSTANCE_TYPE_P(Obj, Type)	fth_instance_type_p(Obj, Type)
@@ -274,6 +277,8 @@ extern exit_cb 	fth_exit_hook;
 #define FTH_IO_P(Obj)		FTH_INSTANCE_TYPE_P(Obj, FTH_IO_T)
 #define FTH_REGEXP_P(Obj)	FTH_INSTANCE_TYPE_P(Obj, FTH_REGEXP_T)
 #define FTH_STRING_P(Obj)	FTH_INSTANCE_TYPE_P(Obj, FTH_STRING_T)
+#define FTH_F64_VECTOR_P(Obj)	FTH_INSTANCE_TYPE_P(Obj, FTH_F64_VECTOR_T)
+#define FTH_I64_VECTOR_P(Obj)	FTH_INSTANCE_TYPE_P(Obj, FTH_I64_VECTOR_T)
 
 #define FTH_ASSOC_P(Obj)	FTH_ARRAY_P(Obj)
 #define FTH_CONS_P(Obj)		FTH_ARRAY_P(Obj)
@@ -488,6 +493,7 @@ FTH		fth_array_pop(FTH);
 FTH		fth_array_push(FTH, FTH);
 FTH		fth_array_ref(FTH, ficlInteger);
 FTH		fth_array_reject(FTH, FTH, FTH);
+FTH		fth_array_reserve(FTH, ficlInteger);
 FTH		fth_array_reverse(FTH);
 FTH		fth_array_set(FTH, ficlInteger, FTH);
 FTH		fth_array_shift(FTH);
@@ -594,6 +600,8 @@ FTH		fth_hash_ref(FTH, FTH);
 void		fth_hash_set(FTH, FTH, FTH);
 FTH		fth_hash_to_array(FTH);
 FTH		fth_hash_values(FTH);
+FTH		fth_make_flat_hash(void);
+FTH		fth_make_flat_hash_len(int);
 FTH		fth_make_hash(void);
 FTH		fth_make_hash_len(int);
 /* properties */
@@ -629,6 +637,9 @@ FTH		fth_run_hook(FTH, int,...);
 FTH		fth_run_hook_again(FTH, int,...);
 FTH		fth_run_hook_bool(FTH, int,...);
 
+/* === image.c === */
+void		fth_load_cache_taint(void);
+
 /* === io.c === */
 /* io */
 void		fth_io_close(FTH);
@@ -779,6 +790,7 @@ FTH		fth_gc_on(void);
 FTH		fth_gc_permanent(FTH);
 FTH		fth_gc_protect(FTH);
 FTH		fth_gc_protect_set(FTH, FTH);
+FTH		fth_gc_statistics(void);
 void		fth_gc_unmark(FTH);
 FTH		fth_gc_unprotect(FTH);
 /* object */
@@ -799,6 +811,7 @@ FTH		fth_set_object_copy(FTH, FTH (*) (FTH));
 FTH		fth_set_object_dump(FTH, FTH (*) (FTH));
 FTH		fth_set_object_equal_p(FTH, FTH (*) (FTH, FTH));
 FTH		fth_set_object_free(FTH, void (*) (FTH));
+FTH		fth_set_object_hash(FTH, FTH (*) (FTH));
 FTH		fth_set_object_inspect(FTH, FTH (*) (FTH));
 FTH		fth_set_object_length(FTH, FTH (*) (FTH));
 FTH		fth_set_object_mark(FTH, void (*) (FTH));
@@ -977,6 +990,7 @@ FTH		fth_string_pop(FTH);
 FTH		fth_string_push(FTH, FTH);
 char           *fth_string_ref(FTH);
 FTH		fth_string_replace(FTH, FTH, FTH);
+FTH		fth_string_reserve(FTH, ficlInteger);
 FTH		fth_string_reverse(FTH);
 FTH		fth_string_scat(FTH, const char *);
 FTH		fth_string_sformat(FTH, const char *,...);
@@ -1014,6 +1028,9 @@ FTH		fth_make_exception(const char *, const char *);
 int		fth_symbol_or_exception_p(FTH);
 FTH		fth_symbol_or_exception_ref(FTH);
 FTH		fth_symbol_to_exception(FTH);
+/* predefined */
+FTH		ficl_ans_exception(int);
+FTH		fth_predefined_ref(int);
 
 /* === utils.c === */
 void           *fth_calloc(size_t, size_t);
@@ -1038,6 +1055,28 @@ char	       *pop_cstring(ficlVm *);
 void		push_cstring(ficlVm *, char *);
 FTH		fth_set_argv(int, int, char **);
 
+/* === vector.c === */
+FTH		fth_array_to_f64_vector(FTH);
+FTH		fth_array_to_i64_vector(FTH);
+ficlFloat      *fth_f64_vector_data(FTH);
+ficlFloat	fth_f64_vector_ref(FTH, ficlInteger);
+void		fth_f64_vector_set(FTH, ficlInteger, ficlFloat);
+ficl2Integer   *fth_i64_vector_data(FTH);
+ficl2Integer	fth_i64_vector_ref(FTH, ficlInteger);
+void		fth_i64_vector_set(FTH, ficlInteger, ficl2Integer);
+FTH		fth_make_f64_vector(ficlInteger, ficlFloat);
+FTH		fth_make_i64_vector(ficlInteger, ficl2Integer);
+FTH		fth_vector_add(FTH, FTH);
+FTH		fth_vector_copy(FTH);
+FTH		fth_vector_dot(FTH, FTH);
+FTH		fth_vector_fill(FTH, FTH);
+ficlInteger	fth_vector_length(FTH);
+FTH		fth_vector_max(FTH);
+FTH		fth_vector_min(FTH);
+FTH		fth_vector_scale(FTH, FTH);
+FTH		fth_vector_sum(FTH);
+FTH		fth_vector_to_array(FTH);
+
 __END_DECLS
 
 #endif				/* _FTH_H_ */
@@ -36,28 +36,83 @@
 /* === HASH === */
 
 static FTH	hash_tag;
-#define FTH_DEFAULT_HASH_SIZE	101
+
+/*
+ * The bucket array is always a power of two.  When a new key is added,
+ * it grows if there are more entries than buckets.  It shrinks if an
+ * insertion or deletion leaves less than one eighth of the buckets
+ * used.  Resizing doesn't move all entries at once: the old bucket
+ * array is kept and HASH_REHASH_STEPS of its buckets are moved to the
+ * new one on every insertion and deletion.
+ */
+#define FTH_DEFAULT_HASH_SIZE	16
+#define FTH_MIN_HASH_SIZE	8
+#define FTH_MAX_HASH_SIZE	(1 << 30)
+#define HASH_REHASH_STEPS	4
 
 typedef struct FItem {
 	struct FItem   *next;
 	FTH		key;
 	FTH		value;
+	ficlUnsigned	hval;
 } FItem;
 
+/*
+ * A flat hash (make-flat-hash) has no items and no bucket lists.  Its
+ * entries live in the parallel slot arrays keys, values and hvals and
+ * are found by linear probing.  Insertion is Robin Hood style: a new
+ * entry takes the slot of one that is closer to its home slot, so a
+ * lookup can stop at the first entry closer to home than the key
+ * would be.  Deletion shifts the following entries back instead of
+ * leaving tombstones.  The slot arrays grow at 3/4 load, shrink like
+ * the bucket array and are rebuilt at once.
+ *
+ * Deletion doesn't resize either kind of table while fth_hash_each()
+ * or fth_hash_map() walks it, so the current entry of hash-each can be
+ * deleted without moving the others.  The table shrinks when the walk
+ * is done; if an exception leaves the walk, the next insertion does.
+ */
 typedef struct {
-	int		hash_size;
-	ficlInteger	length;
+	int		hash_size;	/* buckets in data or flat slots */
+	ficlInteger	length;		/* entries in data and old_data */
 	FItem         **data;
+	int		old_size;	/* buckets in old_data */
+	int		rehash_idx;	/* next old bucket to move or -1 */
+	FItem         **old_data;
+	int		flat_p;
+	FTH            *keys;		/* flat slots, 0 if empty */
+	FTH            *values;
+	ficlUnsigned   *hvals;
+	int		walking;	/* running each and map calls */
+	int		shrink_p;	/* deleted while walking */
 } FHash;
 
+/* Cursor for hash_next(), the same for both kinds of tables. */
+typedef struct {
+	int		t;
+	int		i;
+	int		start;		/* flat: first slot or -1 */
+	FItem          *entry;
+	FTH		key;
+	FTH		value;
+	ficlUnsigned	hval;
+} FHashIter;
+
 #define FTH_HASH_OBJECT(Obj)	FTH_INSTANCE_REF_GEN(Obj, FHash)
-#define FTH_HASH_HASH_SIZE(Obj)	FTH_HASH_OBJECT(Obj)->hash_size
 #define FTH_HASH_LENGTH(Obj)	FTH_HASH_OBJECT(Obj)->length
 #define FTH_HASH_DATA(Obj)	FTH_HASH_OBJECT(Obj)->data
 
-#define hash_key_to_val(Hash, Key)					\
-	((unsigned int)(fth_hash_id(Key) %				\
-	    (unsigned int)FTH_HASH_HASH_SIZE(Hash)))
+/* T == 0: current bucket array, T == 1: old array while rehashing */
+#define HASH_TABLE(H, T)	((T) == 0 ? (H)->data : (H)->old_data)
+#define HASH_TABLE_SIZE(H, T)	((T) == 0 ? (H)->hash_size : (H)->old_size)
+#define HASH_REHASHING_P(H)	((H)->rehash_idx >= 0)
+
+#define HASH_ITER_INIT(It)						\
+	((It)->t = 0, (It)->i = 0, (It)->start = -1, (It)->entry = NULL)
+
+/* Distance of flat slot I from the home slot of its entry. */
+#define FLAT_DIST(H, I)							\
+	(((ficlUnsigned)(I) - (H)->hvals[I]) & (ficlUnsigned)((H)->hash_size - 1))
 
 static void	ficl_hash_each(ficlVm *);
 static void	ficl_hash_equal_p(ficlVm *);
@@ -86,8 +141,23 @@ static FTH	hs_to_array(FTH);
 static FTH	hs_to_array_each(FTH, FTH, FTH);
 static FTH	hs_to_string(FTH);
 static FTH	hs_values_each(FTH, FTH, FTH);
-static FItem   *make_item(FItem *, FTH, FTH);
-static FHash   *make_hash(int);
+static ficlUnsigned hash_code(FTH);
+static FItem  **hash_bucket(FHash *, ficlUnsigned);
+static FTH     *hash_lookup(FHash *, FTH, ficlUnsigned, FTH *);
+static int	hash_next(FHash *, FHashIter *);
+static void	hash_rehash_step(FHash *, ficlInteger);
+static void	hash_resize(FHash *, ficlInteger);
+static int	hash_round_size(ficlInteger);
+static void	hash_shrink(FHash *);
+static void	hash_free_items(FHash *);
+static void	flat_alloc(FHash *, int);
+static void	flat_delete(FHash *, ficlInteger);
+static ficlInteger flat_find(FHash *, FTH, ficlUnsigned);
+static void	flat_insert(FHash *, FTH, FTH, ficlUnsigned);
+static void	flat_resize(FHash *, int);
+static FItem   *make_item(FItem *, FTH, FTH, ficlUnsigned);
+static FHash   *make_hash(ficlInteger, int);
+static FTH	make_hash_like(FHash *, ficlInteger);
 
 #define h_list_of_hash_functions "\
 *** HASH PRIMITIVES ***\n\
@@ -109,6 +179,7 @@ hash-values         ( hash -- values )\n\
 hash=               ( obj1 obj2 -- f )\n\
 hash?               ( obj -- f )\n\
 make-hash           ( -- hash )\n\
+make-flat-hash      ( -- hash )\n\
 make-hash-with-len  ( size -- hash )\n\
 *** Properties:\n\
 object-properties   ( obj -- props )\n\
@@ -129,16 +200,17 @@ fth_hash_each(FTH hash,
     FTH (*func) (FTH key, FTH value, FTH data),
     FTH data)
 {
-	ficlInteger i;
-	FItem *entry;
+	FHash *h;
+	FHashIter it;
 
 	FTH_ASSERT_ARGS(FTH_HASH_P(hash), hash, FTH_ARG1, "a hash");
-	for (i = 0; i < FTH_HASH_HASH_SIZE(hash); i++)
-		for (entry = FTH_HASH_DATA(hash)[i];
-		    entry != NULL;
-		    entry = entry->next)
-			if (entry->key)
-				data = (*func) (entry->key, entry->value, data);
+	h = FTH_HASH_OBJECT(hash);
+	h->walking++;
+	HASH_ITER_INIT(&it);
+	while (hash_next(h, &it))
+		data = (*func) (it.key, it.value, data);
+	if (--h->walking == 0 && h->shrink_p)
+		hash_shrink(h);
 	return (data);
 }
 
@@ -150,19 +222,19 @@ fth_hash_map(FTH hash,
     FTH (*func) (FTH key, FTH value, FTH data),
     FTH data)
 {
-	ficlInteger i;
 	FTH hs;
-	FItem *entry;
+	FHash *h;
+	FHashIter it;
 
 	FTH_ASSERT_ARGS(FTH_HASH_P(hash), hash, FTH_ARG1, "a hash");
-	hs = fth_make_hash_len(FTH_HASH_HASH_SIZE(hash));
-	for (i = 0; i < FTH_HASH_HASH_SIZE(hash); i++)
-		for (entry = FTH_HASH_DATA(hash)[i];
-		    entry != NULL;
-		    entry = entry->next)
-			if (entry->key)
-				fth_hash_set(hs, entry->key,
-				    (*func) (entry->key, entry->value, data));
+	h = FTH_HASH_OBJECT(hash);
+	hs = make_hash_like(h, h->length);
+	h->walking++;
+	HASH_ITER_INIT(&it);
+	while (hash_next(h, &it))
+		fth_hash_set(hs, it.key, (*func) (it.key, it.value, data));
+	if (--h->walking == 0 && h->shrink_p)
+		hash_shrink(h);
 	return (hs);
 }
 
@@ -191,23 +263,18 @@ hs_to_string(FTH self)
 
 	fs = fth_make_string("#{");
 	if (FTH_HASH_LENGTH(self) > 0) {
-		ficlInteger i, len, n;
-		FItem *entry;
+		ficlInteger i, len;
+		FHash *h;
+		FHashIter it;
 
-		len = FTH_HASH_LENGTH(self);
+		h = FTH_HASH_OBJECT(self);
+		len = h->length;
 		/* Negative fth_print_length shows all entries! */
 		if (fth_print_length >= 0 && len > fth_print_length)
 			len = FICL_MIN(len, fth_print_length);
-		for (i = 0, n = 0; n < FTH_HASH_HASH_SIZE(self); n++) {
-			for (entry = FTH_HASH_DATA(self)[n];
-			    entry != NULL && i < len;
-			    entry = entry->next)
-				if (entry->key) {
-					fth_string_sformat(fs, " %M => %M ",
-					    entry->key, entry->value);
-					i++;
-				}
-		}
+		HASH_ITER_INIT(&it);
+		for (i = 0; i < len && hash_next(h, &it); i++)
+			fth_string_sformat(fs, " %M => %M ", it.key, it.value);
 		if (len < FTH_HASH_LENGTH(self))
 			fth_string_sformat(fs, "... ");
 	}
@@ -247,21 +314,16 @@ static FTH
 hs_copy(FTH self)
 {
 	FTH new;
-
-	new = fth_make_hash_len(FTH_HASH_HASH_SIZE(self));
-	if (FTH_HASH_LENGTH(self) > 0) {
-		ficlInteger i;
-		FItem *entry;
-
-		for (i = 0; i < FTH_HASH_HASH_SIZE(self); i++)
-			for (entry = FTH_HASH_DATA(self)[i];
-			    entry != NULL;
-			    entry = entry->next)
-				if (entry->key)
-					fth_hash_set(new,
-					    fth_object_copy(entry->key),
-					    fth_object_copy(entry->value));
-	}
+	FHash *h;
+	FHashIter it;
+
+	h = FTH_HASH_OBJECT(self);
+	new = make_hash_like(h, h->length);
+	HASH_ITER_INIT(&it);
+	while (hash_next(h, &it))
+		fth_hash_set(new,
+		    fth_object_copy(it.key),
+		    fth_object_copy(it.value));
 	return (new);
 }
 
@@ -295,29 +357,45 @@ hs_set(FTH self, FTH idx, FTH value)
 static FTH
 hs_equal_p(FTH self, FTH obj)
 {
-	if (FTH_HASH_HASH_SIZE(self) == FTH_HASH_HASH_SIZE(obj) &&
-	    FTH_HASH_LENGTH(self) == FTH_HASH_LENGTH(obj)) {
-		FItem *entry;
-		FTH tmp;
-		int i;
-
-		for (i = 0; i < FTH_HASH_HASH_SIZE(self); i++) {
-			for (entry = FTH_HASH_DATA(self)[i];
-			    entry;
-			    entry = entry->next)
-				if (entry->key) {
-					tmp = fth_hash_find(obj, entry->key);
-					if (FTH_FALSE_P(tmp) ||
-					    !fth_object_equal_p(entry->value,
-					    fth_array_ref(tmp, 1L)))
-						return (FTH_FALSE);
-				}
+	if (FTH_HASH_LENGTH(self) == FTH_HASH_LENGTH(obj)) {
+		FHash *h, *o;
+		FHashIter it;
+		FTH *value;
+
+		h = FTH_HASH_OBJECT(self);
+		o = FTH_HASH_OBJECT(obj);
+		HASH_ITER_INIT(&it);
+		while (hash_next(h, &it)) {
+			value = hash_lookup(o, it.key, it.hval, NULL);
+			if (value == NULL ||
+			    !fth_object_equal_p(it.value, *value))
+				return (FTH_FALSE);
 		}
 		return (FTH_TRUE);
 	}
 	return (FTH_FALSE);
 }
 
+/*
+ * Sum over all entries to be independent of the insertion order.  The
+ * key part is the hval cached in the item.
+ */
+static FTH
+hs_hash(FTH self)
+{
+	FHash *h;
+	FHashIter it;
+	ficlUnsigned hval;
+
+	h = FTH_HASH_OBJECT(self);
+	hval = (ficlUnsigned)FTH_HASH_LENGTH(self);
+	HASH_ITER_INIT(&it);
+	while (hash_next(h, &it))
+		hval += fth_hash_combine(it.hval,
+		    (ficlUnsigned)FIX_TO_INT(fth_hash_id(it.value)));
+	return (FTH_HASH_ID_TO_FIX(hval));
+}
+
 static FTH
 hs_length(FTH self)
 {
@@ -340,48 +418,418 @@ hs_mark(FTH self)
 
 static void
 hs_free(FTH self)
+{
+	FHash *h;
+
+	h = FTH_HASH_OBJECT(self);
+	hash_free_items(h);
+	if (h->flat_p)
+		FTH_FREE(h->keys);
+	else
+		FTH_FREE(h->data);
+	FTH_FREE(h);
+}
+
+/*
+ * Mix the bits of the hash id; the bucket index takes only the lowest
+ * bits and the lowest bit of a hash id is always the fixnum flag.
+ */
+static ficlUnsigned
+hash_code(FTH key)
+{
+	ficlUnsigned hval;
+
+	hval = (ficlUnsigned)fth_hash_id(key) >> 1;
+	hval ^= hval >> 16;
+	hval *= 0x45d9f3bUL;
+	hval ^= hval >> 16;
+	return (hval);
+}
+
+/*
+ * Return the bucket where HVAL lives.  While rehashing, old buckets
+ * below rehash_idx are already moved to the new bucket array.
+ */
+static FItem **
+hash_bucket(FHash *h, ficlUnsigned hval)
+{
+	ficlUnsigned idx;
+
+	if (HASH_REHASHING_P(h)) {
+		idx = hval & (ficlUnsigned)(h->old_size - 1);
+		if (idx >= (ficlUnsigned)h->rehash_idx)
+			return (&h->old_data[idx]);
+	}
+	return (&h->data[hval & (ficlUnsigned)(h->hash_size - 1)]);
+}
+
+/*
+ * Return the address of the value stored with KEY or NULL.  If KEYP
+ * isn't NULL, it gets the stored key.
+ */
+static FTH *
+hash_lookup(FHash *h, FTH key, ficlUnsigned hval, FTH *keyp)
+{
+	FItem *entry;
+	ficlInteger i;
+
+	if (h->flat_p) {
+		i = flat_find(h, key, hval);
+		if (i < 0)
+			return (NULL);
+		if (keyp != NULL)
+			*keyp = h->keys[i];
+		return (&h->values[i]);
+	}
+	for (entry = *hash_bucket(h, hval); entry != NULL; entry = entry->next)
+		if (entry->hval == hval && entry->key &&
+		    fth_object_equal_p(key, entry->key)) {
+			if (keyp != NULL)
+				*keyp = entry->key;
+			return (&entry->value);
+		}
+	return (NULL);
+}
+
+/*
+ * Set IT to the next entry and return 1 or return 0 at the end.  The
+ * entry may be deleted before the next call, other entries may not.
+ *
+ * A flat hash is walked from the slot after an empty one, which stays
+ * empty, so the backward shift of a deletion never wraps around to
+ * slots already seen.  If the current slot was refilled by the shift,
+ * it's visited again.
+ */
+static int
+hash_next(FHash *h, FHashIter *it)
+{
+	FItem *entry;
+	int i, mask;
+
+	if (h->flat_p) {
+		mask = h->hash_size - 1;
+		if (it->start < 0) {
+			for (i = 0; h->keys[i]; i++)
+				/* empty */ ;
+			it->start = i + 1;
+		} else if (it->i > 0) {
+			i = (it->start + it->i - 1) & mask;
+			if (h->keys[i] && h->keys[i] != it->key)
+				it->i--;
+		}
+		while (it->i < h->hash_size) {
+			i = (it->start + it->i++) & mask;
+			if (h->keys[i]) {
+				it->key = h->keys[i];
+				it->value = h->values[i];
+				it->hval = h->hvals[i];
+				return (1);
+			}
+		}
+		return (0);
+	}
+	for (;;) {
+		while ((entry = it->entry) != NULL) {
+			it->entry = entry->next;
+			if (entry->key) {
+				it->key = entry->key;
+				it->value = entry->value;
+				it->hval = entry->hval;
+				return (1);
+			}
+		}
+		if (it->i >= HASH_TABLE_SIZE(h, it->t)) {
+			if (it->t == 1)
+				return (0);
+			it->t = 1;
+			it->i = 0;
+			continue;
+		}
+		it->entry = HASH_TABLE(h, it->t)[it->i++];
+	}
+}
+
+/*
+ * Move up to STEPS nonempty old buckets to the new bucket array.
+ */
+static void
+hash_rehash_step(FHash *h, ficlInteger steps)
+{
+	FItem *entry, *next;
+	ficlInteger empty;
+	ficlUnsigned idx, mask;
+
+	if (!HASH_REHASHING_P(h))
+		return;
+	mask = (ficlUnsigned)(h->hash_size - 1);
+	empty = steps * 10;
+	while (steps > 0 && h->rehash_idx < h->old_size) {
+		entry = h->old_data[h->rehash_idx];
+		if (entry == NULL) {
+			h->rehash_idx++;
+			if (--empty <= 0)
+				break;
+			continue;
+		}
+		for (; entry != NULL; entry = next) {
+			next = entry->next;
+			idx = entry->hval & mask;
+			entry->next = h->data[idx];
+			h->data[idx] = entry;
+		}
+		h->old_data[h->rehash_idx++] = NULL;
+		steps--;
+	}
+	if (h->rehash_idx >= h->old_size) {
+		FTH_FREE(h->old_data);
+		h->old_data = NULL;
+		h->old_size = 0;
+		h->rehash_idx = -1;
+	}
+}
+
+/*
+ * Start moving all entries to a new bucket array large enough for LEN
+ * entries.  A pending rehash will be finished first.
+ */
+static void
+hash_resize(FHash *h, ficlInteger len)
+{
+	int size;
+
+	size = hash_round_size(len);
+	if (size == h->hash_size)
+		return;
+	if (HASH_REHASHING_P(h))
+		hash_rehash_step(h, (ficlInteger)h->old_size);
+	if (h->length == 0) {
+		/* nothing to move */
+		FTH_FREE(h->data);
+		h->hash_size = size;
+		h->data = FTH_CALLOC(size, sizeof(FItem *));
+		return;
+	}
+	h->old_data = h->data;
+	h->old_size = h->hash_size;
+	h->rehash_idx = 0;
+	h->hash_size = size;
+	h->data = FTH_CALLOC(size, sizeof(FItem *));
+}
+
+static int
+hash_round_size(ficlInteger len)
+{
+	int size;
+
+	size = FTH_MIN_HASH_SIZE;
+	while (size < len && size < FTH_MAX_HASH_SIZE)
+		size <<= 1;
+	return (size);
+}
+
+/*
+ * Shrink the table of H if less than one eighth of it is used.
+ */
+static void
+hash_shrink(FHash *h)
+{
+	h->shrink_p = 0;
+	if (h->hash_size <= FTH_MIN_HASH_SIZE ||
+	    h->length >= h->hash_size / 8)
+		return;
+	if (h->flat_p)
+		flat_resize(h, hash_round_size((h->length + 1) * 2));
+	else
+		hash_resize(h, h->length * 2);
+}
+
+static void
+hash_free_items(FHash *h)
 {
 	FItem *p, *entry;
-	int i;
-
-	for (i = 0; i < FTH_HASH_HASH_SIZE(self); i++) {
-		entry = FTH_HASH_DATA(self)[i];
-		while (entry != NULL) {
-			p = entry;
-			entry = entry->next;
-			FTH_FREE(p);
+	int i, t;
+
+	if (h->flat_p) {
+		memset(h->keys, 0, sizeof(FTH) * (size_t)h->hash_size);
+		memset(h->values, 0, sizeof(FTH) * (size_t)h->hash_size);
+		h->length = 0;
+		return;
+	}
+	for (t = 0; t < 2; t++)
+		for (i = 0; i < HASH_TABLE_SIZE(h, t); i++) {
+			entry = HASH_TABLE(h, t)[i];
+			while (entry != NULL) {
+				p = entry;
+				entry = entry->next;
+				FTH_FREE(p);
+			}
+			HASH_TABLE(h, t)[i] = NULL;
+		}
+	if (HASH_REHASHING_P(h)) {
+		FTH_FREE(h->old_data);
+		h->old_data = NULL;
+		h->old_size = 0;
+		h->rehash_idx = -1;
+	}
+	h->length = 0;
+}
+
+/*
+ * The three slot arrays of a flat hash share one allocation.
+ */
+static void
+flat_alloc(FHash *h, int size)
+{
+	h->hash_size = size;
+	h->keys = FTH_CALLOC(size, 2 * sizeof(FTH) + sizeof(ficlUnsigned));
+	h->values = h->keys + size;
+	h->hvals = (ficlUnsigned *)(h->values + size);
+}
+
+/*
+ * Return the slot of KEY or -1.
+ */
+static ficlInteger
+flat_find(FHash *h, FTH key, ficlUnsigned hval)
+{
+	ficlUnsigned i, d, mask;
+
+	mask = (ficlUnsigned)(h->hash_size - 1);
+	for (i = hval & mask, d = 0; h->keys[i]; i = (i + 1) & mask, d++) {
+		if (FLAT_DIST(h, i) < d)
+			break;
+		if (h->hvals[i] == hval &&
+		    fth_object_equal_p(key, h->keys[i]))
+			return ((ficlInteger)i);
+	}
+	return (-1);
+}
+
+/*
+ * Insert a new KEY; there must be at least one free slot.
+ */
+static void
+flat_insert(FHash *h, FTH key, FTH value, ficlUnsigned hval)
+{
+	ficlUnsigned i, d, sd, mask, th;
+	FTH tk, tv;
+
+	mask = (ficlUnsigned)(h->hash_size - 1);
+	for (i = hval & mask, d = 0;; i = (i + 1) & mask, d++) {
+		if (!h->keys[i]) {
+			h->keys[i] = key;
+			h->values[i] = value;
+			h->hvals[i] = hval;
+			return;
+		}
+		sd = FLAT_DIST(h, i);
+		if (sd < d) {
+			tk = h->keys[i];
+			tv = h->values[i];
+			th = h->hvals[i];
+			h->keys[i] = key;
+			h->values[i] = value;
+			h->hvals[i] = hval;
+			key = tk;
+			value = tv;
+			hval = th;
+			d = sd;
 		}
 	}
-	FTH_FREE(FTH_HASH_DATA(self));
-	FTH_FREE(FTH_HASH_OBJECT(self));
+}
+
+/*
+ * Remove slot I and move the following displaced entries one back.
+ */
+static void
+flat_delete(FHash *h, ficlInteger i)
+{
+	ficlUnsigned j, mask;
+
+	mask = (ficlUnsigned)(h->hash_size - 1);
+	for (j = ((ficlUnsigned)i + 1) & mask;
+	    h->keys[j] && FLAT_DIST(h, j) > 0;
+	    i = (ficlInteger)j, j = (j + 1) & mask) {
+		h->keys[i] = h->keys[j];
+		h->values[i] = h->values[j];
+		h->hvals[i] = h->hvals[j];
+	}
+	h->keys[i] = 0;
+	h->values[i] = 0;
+}
+
+static void
+flat_resize(FHash *h, int size)
+{
+	FTH *keys, *values;
+	ficlUnsigned *hvals;
+	int i, old_size;
+
+	if (size == h->hash_size)
+		return;
+	keys = h->keys;
+	values = h->values;
+	hvals = h->hvals;
+	old_size = h->hash_size;
+	flat_alloc(h, size);
+	for (i = 0; i < old_size; i++)
+		if (keys[i])
+			flat_insert(h, keys[i], values[i], hvals[i]);
+	FTH_FREE(keys);
 }
 
 static FItem *
-make_item(FItem *next, FTH key, FTH value)
+make_item(FItem *next, FTH key, FTH value, ficlUnsigned hval)
 {
 	FItem *item;
 
 	item = FTH_MALLOC(sizeof(FItem));
 	item->key = key;
 	item->value = value;
+	item->hval = hval;
 	item->next = next;
 	return (item);
 }
 
 static FHash *
-make_hash(int hashsize)
+make_hash(ficlInteger len, int flat_p)
 {
 	FHash *h;
 
-	if (hashsize < 1)
-		hashsize = FTH_DEFAULT_HASH_SIZE;
+	if (len < 1)
+		len = FTH_DEFAULT_HASH_SIZE;
 	h = FTH_MALLOC(sizeof(FHash));
 	h->length = 0;
-	h->hash_size = hashsize;
-	h->data = FTH_CALLOC(h->hash_size, sizeof(FItem *));
+	h->old_size = 0;
+	h->rehash_idx = -1;
+	h->old_data = NULL;
+	h->flat_p = flat_p;
+	h->walking = 0;
+	h->shrink_p = 0;
+	if (flat_p) {
+		h->data = NULL;
+		flat_alloc(h, hash_round_size(len + len / 3 + 1));
+	} else {
+		h->keys = h->values = NULL;
+		h->hvals = NULL;
+		h->hash_size = hash_round_size(len);
+		h->data = FTH_CALLOC(h->hash_size, sizeof(FItem *));
+	}
 	return (h);
 }
 
+/*
+ * Return a new hash of the same kind as H with room for LEN entries.
+ */
+static FTH
+make_hash_like(FHash *h, ficlInteger len)
+{
+	len = FICL_MIN(len, FTH_MAX_HASH_SIZE);
+	return (h->flat_p ?
+	    fth_make_flat_hash_len((int)len) :
+	    fth_make_hash_len((int)len));
+}
+
 static void
 ficl_hash_p(ficlVm *vm)
 {
@@ -399,14 +847,14 @@ Return #t if OBJ is a hash object, otherwise #f."
 /*
  * Don't confuse it with make-hash-with-len below!
  *
- * Return new hash object of HASHSIZE buckets.  HASHSIZE should be a
- * prime number.  If HASHSIZE is less than one, FTH_DEFAULT_HASH_SIZE
- * will be used.
+ * Return new hash object with room for HASHSIZE entries before the
+ * first resize.  If HASHSIZE is less than one, FTH_DEFAULT_HASH_SIZE
+ * will be used.  The hash grows and shrinks as needed.
  */
 FTH
 fth_make_hash_len(int hashsize)
 {
-	return (fth_make_instance(hash_tag, make_hash(hashsize)));
+	return (fth_make_instance(hash_tag, make_hash(hashsize, 0)));
 }
 
 FTH
@@ -418,6 +866,37 @@ Return empty hash object."
 	return (fth_make_hash_len(FTH_DEFAULT_HASH_SIZE));
 }
 
+/*
+ * Like fth_make_hash_len but the new hash uses open addressing
+ * instead of linked lists.  See the comment above FHash.
+ */
+FTH
+fth_make_flat_hash_len(int hashsize)
+{
+	return (fth_make_instance(hash_tag, make_hash(hashsize, 1)));
+}
+
+FTH
+fth_make_flat_hash(void)
+{
+#define h_make_flat_hash "( -- hash )  create a flat hash\n\
+make-flat-hash => #{}\n\
+Return empty hash object which keeps its entries in flat arrays \
+(open addressing) instead of linked lists.  \
+All hash words work with it; lookups are faster for large hashes.\n\
+See also make-hash."
+	return (fth_make_flat_hash_len(FTH_DEFAULT_HASH_SIZE));
+}
+
+/*
+ * Return 1 if HASH uses open addressing (see fth_make_flat_hash).
+ */
+int
+fth_hash_flat_p(FTH hash)
+{
+	return (FTH_HASH_OBJECT(hash)->flat_p);
+}
+
 static void
 ficl_make_hash_with_len(ficlVm *vm)
 {
@@ -430,7 +909,7 @@ Keys are 0, 1, 2, ... and values are NIL."
 
 	FTH_STACK_CHECK(vm, 1, 1);
 	len = ficlStackPopInteger(vm->dataStack);
-	hash = fth_make_hash();
+	hash = fth_make_hash_len((int)FICL_MIN(len, FTH_MAX_HASH_SIZE));
 	while (len-- > 0)
 		fth_hash_set(hash, fth_make_int(len), FTH_NIL);
 	ficlStackPushFTH(vm->dataStack, hash);
@@ -525,16 +1004,15 @@ fth_hash_ref(FTH hash, FTH key)
 h1 'bar hash-ref => 1\n\
 h1 'baz hash-ref => #f\n\
 Return associated value or #f if not found."
-	FItem *entry;
-	unsigned hval;
+	FTH *value;
 
 	FTH_ASSERT_ARGS(FTH_HASH_P(hash), hash, FTH_ARG1, "a hash");
-	hval = hash_key_to_val(hash, key);
-	for (entry = FTH_HASH_DATA(hash)[hval];
-	    entry != NULL;
-	    entry = entry->next)
-		if (entry->key && fth_object_equal_p(key, entry->key))
-			return (entry->value);
+	if (FTH_HASH_LENGTH(hash) > 0) {
+		value = hash_lookup(FTH_HASH_OBJECT(hash),
+		    key, hash_code(key), NULL);
+		if (value != NULL)
+			return (*value);
+	}
 	return (FTH_FALSE);
 }
 
@@ -548,22 +1026,42 @@ h1 'baz hash-ref => 2\n\
 Set KEY-VALUE pair of HASH.  \
 If key exists, overwrite existing value, \
 otherwise create new key-value entry."
-	FItem *entry;
-	unsigned hval;
+	FHash *h;
+	FItem **bucket;
+	FTH *old;
+	ficlUnsigned hval;
 
 	FTH_ASSERT_ARGS(FTH_HASH_P(hash), hash, FTH_ARG1, "a hash");
-	hval = hash_key_to_val(hash, key);
+	h = FTH_HASH_OBJECT(hash);
+	hval = hash_code(key);
 	FTH_INSTANCE_CHANGED(hash);
-	for (entry = FTH_HASH_DATA(hash)[hval];
-	    entry != NULL;
-	    entry = entry->next)
-		if (entry->key && fth_object_equal_p(key, entry->key)) {
-			entry->value = value;
-			return;
-		}
-	FTH_HASH_DATA(hash)[hval] = make_item(FTH_HASH_DATA(hash)[hval],
-	    key, value);
-	FTH_HASH_OBJECT(hash)->length++;
+	old = hash_lookup(h, key, hval, NULL);
+	if (old != NULL) {
+		*old = value;
+		return;
+	}
+	if (h->flat_p) {
+		if ((h->length + 1) * 4 > (ficlInteger)h->hash_size * 3)
+			flat_resize(h, h->hash_size * 2);
+		else
+			hash_shrink(h);
+		flat_insert(h, key, value, hval);
+		h->length++;
+		return;
+	}
+	bucket = hash_bucket(h, hval);
+	*bucket = make_item(*bucket, key, value, hval);
+	h->length++;
+	/*
+	 * Inside hash-each only new keys move the table, so hash-set! on
+	 * existing keys and hash-delete! of the current key are safe.
+	 */
+	if (HASH_REHASHING_P(h))
+		hash_rehash_step(h, HASH_REHASH_STEPS);
+	else if (h->length > h->hash_size)
+		hash_resize(h, (ficlInteger)h->hash_size * 2);
+	else
+		hash_shrink(h);
 }
 
 FTH
@@ -577,30 +1075,47 @@ Delete key-value pair associated with KEY \
 and return key-value array or #f if not found."
 	FTH_ASSERT_ARGS(FTH_HASH_P(hash), hash, FTH_ARG1, "a hash");
 	if (FTH_HASH_LENGTH(hash) > 0) {
-		unsigned hval;
-		FItem *entry, *prev;
+		FHash *h;
+		FItem *entry, **bucket;
+		ficlUnsigned hval;
 		FTH vals;
 
-		hval = hash_key_to_val(hash, key);
-
-		for (prev = entry = FTH_HASH_DATA(hash)[hval];
-		    entry != NULL;
-		    entry = entry->next) {
-			if (entry->key &&
+		h = FTH_HASH_OBJECT(hash);
+		hval = hash_code(key);
+		if (h->flat_p) {
+			ficlInteger i;
+
+			i = flat_find(h, key, hval);
+			if (i < 0)
+				return (FTH_FALSE);
+			vals = FTH_LIST_2(h->keys[i], h->values[i]);
+			flat_delete(h, i);
+			FTH_INSTANCE_CHANGED(hash);
+			h->length--;
+			if (h->walking > 0)
+				h->shrink_p = 1;
+			else
+				hash_shrink(h);
+			return (vals);
+		}
+		for (bucket = hash_bucket(h, hval);
+		    (entry = *bucket) != NULL;
+		    bucket = &entry->next) {
+			if (entry->hval == hval && entry->key &&
 			    fth_object_equal_p(key, entry->key)) {
 				vals = FTH_LIST_2(entry->key, entry->value);
-
-				if (entry == prev)
-					FTH_HASH_DATA(hash)[hval] = entry->next;
-				else
-					prev->next = entry->next;
-
+				*bucket = entry->next;
 				FTH_INSTANCE_CHANGED(hash);
 				FTH_FREE(entry);
-				FTH_HASH_OBJECT(hash)->length--;
+				h->length--;
+				if (h->walking > 0)
+					h->shrink_p = 1;
+				else if (HASH_REHASHING_P(h))
+					hash_rehash_step(h, HASH_REHASH_STEPS);
+				else
+					hash_shrink(h);
 				return (vals);
 			}
-			prev = entry;
 		}
 	}
 	return (FTH_FALSE);
@@ -609,17 +1124,9 @@ and return key-value array or #f if not found."
 int
 fth_hash_member_p(FTH hash, FTH key)
 {
-	if (FTH_HASH_P(hash) && FTH_HASH_LENGTH(hash) > 0) {
-		unsigned hval;
-		FItem *entry;
-
-		hval = hash_key_to_val(hash, key);
-		for (entry = FTH_HASH_DATA(hash)[hval];
-		    entry != NULL;
-		    entry = entry->next)
-			if (entry->key && fth_object_equal_p(key, entry->key))
-				return (1);
-	}
+	if (FTH_HASH_P(hash) && FTH_HASH_LENGTH(hash) > 0)
+		return (hash_lookup(FTH_HASH_OBJECT(hash),
+		    key, hash_code(key), NULL) != NULL);
 	return (0);
 }
 
@@ -649,15 +1156,12 @@ h1 'bar hash-find => #( 'bar 1 )\n\
 Return key-value array if KEY exist or #f if not found."
 	FTH_ASSERT_ARGS(FTH_HASH_P(hash), hash, FTH_ARG1, "a hash");
 	if (FTH_HASH_LENGTH(hash) > 0) {
-		unsigned hval;
-		FItem *entry;
-
-		hval = hash_key_to_val(hash, key);
-		for (entry = FTH_HASH_DATA(hash)[hval];
-		    entry != NULL;
-		    entry = entry->next)
-			if (entry->key && fth_object_equal_p(key, entry->key))
-				return (FTH_LIST_2(entry->key, entry->value));
+		FTH *value, k;
+
+		value = hash_lookup(FTH_HASH_OBJECT(hash),
+		    key, hash_code(key), &k);
+		if (value != NULL)
+			return (FTH_LIST_2(k, *value));
 	}
 	return (FTH_FALSE);
 }
@@ -719,24 +1223,18 @@ fth_hash_clear(FTH hash)
 h1 hash-clear\n\
 h1 .$ => #{}\n\
 Remove all entries from HASH, HASH's length is zero."
-	FTH_ASSERT_ARGS(FTH_HASH_P(hash), hash, FTH_ARG1, "a hash");
-	if (FTH_HASH_LENGTH(hash) > 0) {
-		FItem *p, *entry;
-		int i;
+	FHash *h;
 
-		for (i = 0; i < FTH_HASH_HASH_SIZE(hash); i++) {
-			entry = FTH_HASH_DATA(hash)[i];
-			
-			while (entry != NULL) {
-				p = entry;
-				entry = entry->next;
-				FTH_FREE(p);
-			}
-			FTH_HASH_DATA(hash)[i] = NULL;
-		}
-		FTH_HASH_LENGTH(hash) = 0;
+	FTH_ASSERT_ARGS(FTH_HASH_P(hash), hash, FTH_ARG1, "a hash");
+	h = FTH_HASH_OBJECT(hash);
+	if (h->length > 0) {
+		hash_free_items(h);
 		FTH_INSTANCE_CHANGED(hash);
 	}
+	if (h->walking > 0)
+		h->shrink_p = 1;
+	else
+		hash_shrink(h);
 }
 
 static FTH
@@ -755,7 +1253,8 @@ h1 lambda: <{ key value -- }>\n\
   \"%s=%s\\n\" #( key value ) fth-print\n\
 ; hash-each\n\
 Run PROC-OR-XT for each key-value pair.  \
-PROC-OR-XT's stack effect must be ( key value -- ).\n\
+PROC-OR-XT's stack effect must be ( key value -- ).  \
+It may delete KEY from HASH but not add new keys.\n\
 See also hash-map."
 	FTH hash, proc;
 
@@ -802,7 +1301,7 @@ See also hash-each."
 
 #if PROPERTY_IS_HASH_P
 #define PROPERTY_P(Obj)		FTH_HASH_P(Obj)
-#define MAKE_PROPERTY()		fth_make_hash()
+#define MAKE_PROPERTY()		fth_make_flat_hash()
 #define PROPERTY_REF(Obj, Key)	fth_hash_ref(Obj, Key)
 #define PROPERTY_SET(Obj, Key, Value)	fth_hash_set(Obj, Key, Value)
 #else
@@ -974,6 +1473,7 @@ init_hash_type(void)
 	fth_set_object_value_ref(hash_tag, hs_ref);
 	fth_set_object_value_set(hash_tag, hs_set);
 	fth_set_object_equal_p(hash_tag, hs_equal_p);
+	fth_set_object_hash(hash_tag, hs_hash);
 	fth_set_object_length(hash_tag, hs_length);
 	fth_set_object_mark(hash_tag, hs_mark);
 	fth_set_object_free(hash_tag, hs_free);
@@ -989,6 +1489,8 @@ init_hash(void)
 	FTH_PRI1("hash?", ficl_hash_p, h_hash_p);
 	FTH_PROC("make-hash", fth_make_hash, 0, 0, 0, h_make_hash);
 	FTH_PRI1("make-hash-with-len", ficl_make_hash_with_len, h_mhwl);
+	FTH_PROC("make-flat-hash", fth_make_flat_hash, 0, 0, 0,
+	    h_make_flat_hash);
 	FTH_PRI1(">hash", ficl_values_to_hash, h_values_to_hash);
 	FTH_PROC("#{}", fth_make_hash, 0, 0, 0, h_make_hash);
 	FTH_PRI1(".hash", ficl_hash_print, h_hash_print);
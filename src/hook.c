@@ -468,9 +468,10 @@ Raise BAD-ARITY exception if PROC-OR-XT's arity doesn't match HOOK's arity."
 	}
 	if (FTH_HOOK_REQ(hook) == FICL_WORD_REQ(proc) &&
 	    FTH_HOOK_OPT(hook) == FICL_WORD_OPT(proc) &&
-	    FTH_HOOK_REST(hook) == FICL_WORD_REST(proc))
+	    FTH_HOOK_REST(hook) == FICL_WORD_REST(proc)) {
 		simple_array_push(FTH_HOOK_DATA(hook), (void *) proc);
-	else
+		fth_load_cache_taint();
+	} else
 		FTH_BAD_ARITY_ERROR_ARGS(FTH_ARG2, proc,
 		    FTH_HOOK_REQ(hook),
 		    FTH_HOOK_OPT(hook),
@@ -494,6 +495,7 @@ PROC-OR-NAME can be a string, an xt or a proc."
 	ficlWord *word;
 
 	FTH_ASSERT_ARGS(FTH_HOOK_P(hook), hook, FTH_ARG1, "a hook");
+	fth_load_cache_taint();
 	if (FICL_WORD_P(proc_or_name)) {
 		word = FICL_WORD_REF(proc_or_name);
 		return ((FTH)simple_array_delete(FTH_HOOK_DATA(hook), word));
@@ -728,6 +730,7 @@ hk1 hook-clear\n\
 Remove all hook procedures from HOOK."
 	FTH_ASSERT_ARGS(FTH_HOOK_P(hook), hook, FTH_ARG1, "a hook");
 	simple_array_clear(FTH_HOOK_DATA(hook));
+	fth_load_cache_taint();
 }
 
 FTH
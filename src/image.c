@@ -0,0 +1,1590 @@
+/*-
+ * Copyright (c) 2005-2018 Michael Scholz <mi-scholz@users.sourceforge.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * @(#)image.c	1.1 10/18/26
+ */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "fth.h"
+#include "utils.h"
+
+#if defined(HAVE_SYS_STAT_H)
+#include <sys/stat.h>
+#endif
+#if defined(HAVE_FCNTL_H)
+#include <fcntl.h>
+#endif
+#if defined(_POSIX_MAPPED_FILES) && (_POSIX_MAPPED_FILES > 0)
+#include <sys/mman.h>
+#define IMAGE_MMAP	1
+#endif
+
+/*-
+ * Dictionary images.
+ *
+ * forth_init() loads the Ficl and Fth source files (softcore.fr ...
+ * fth.fs) after the C part of the dictionary is built.  An image made
+ * with 'fth --save-image FILE' keeps what these files add and 'fth
+ * --image FILE' restores it instead of interpreting the files again:
+ *
+ *   - the dictionary and environment cells above the C part,
+ *   - changed cells of the C part (hash buckets, word properties),
+ *   - the objects the cells refer to (strings, regexps, numbers, arrays,
+ *     hashes and their properties),
+ *   - new object-types, interned symbols and the loaded file names,
+ *   - search order, parse steps and the wordlist tables which grew out
+ *     of the dictionary.
+ *
+ * The C part itself is still built by C code; its layout must be the
+ * same as when the image was saved, which the fingerprint checks (fth
+ * version, cell and struct sizes, code addresses, and the names of all
+ * C words).  Pointers are relative to the dictionary bases and to
+ * forth_init() for code; objects are rebuilt and made permanent.
+ *
+ * If the image doesn't fit or one of the source files changed (path,
+ * mtime, size), forth_init() warns and loads the files as usual.
+ *
+ * The load cache (*load-cache*) uses the same format for single files:
+ * load_file() restores FILE from a cache entry made when FILE was last
+ * loaded on top of the same dictionary, or loads the text and writes
+ * a new entry.  The key of an entry is the fingerprint of the
+ * dictionary before loading, the *loaded-files* and the file name.
+ * Changes outside of the dictionary, e.g. add-hook! or at-exit, call
+ * fth_load_cache_taint() and no entry is written for the files being
+ * loaded.  Neither is one written if an object the dictionary referred
+ * to before loading was changed in place, e.g. with array-push.
+ */
+
+#define IMAGE_MAGIC		"FTHIMG01"
+#define IMAGE_FNV_OFFSET	((ficlUnsigned)14695981039346656037ULL)
+#define IMAGE_FNV_PRIME		((ficlUnsigned)1099511628211ULL)
+#define IMAGE_DICTS		2	/* dictionary and environment */
+#define IMAGE_CODE_BASE		((ficlUnsigned)forth_init)
+#define IMAGE_PROCS		13	/* *_proc members and apply */
+
+/* references to cell values */
+enum {
+	REF_RAW,		/* value as is */
+	REF_DICT,		/* offset in the dictionary */
+	REF_ENV,		/* offset in the environment */
+	REF_CODE,		/* offset from IMAGE_CODE_BASE */
+	REF_CONST,		/* #f, #t, nil, undef */
+	REF_OBJ,		/* object record */
+	REF_TYPE,		/* object-type index */
+	REF_TABLE		/* wordlist table outside the dictionary */
+};
+
+/* object records */
+enum {
+	OBJ_STRING,
+	OBJ_FLOAT,
+	OBJ_LLONG,
+	OBJ_ARRAY,
+	OBJ_HASH,
+	OBJ_REGEXP,
+	OBJ_OPAQUE		/* only for digests */
+};
+
+typedef struct {
+	char           *data;
+	size_t		len;
+	size_t		size;
+} FImageBuf;
+
+typedef struct {
+	FImageBuf	objs;	/* object records */
+	ficlUnsigned	nobjs;
+	FTH            *keys;	/* instance to object id */
+	ficlUnsigned   *ids;
+	size_t		size;	/* power of 2 */
+	int		digest_p;	/* image_digest() */
+	FTH		failed;	/* object we can't save */
+} FImageSave;
+
+typedef struct {
+	const ficlUnsigned *p;
+	const ficlUnsigned *end;
+} FImageIn;
+
+/* state before loading source files */
+typedef struct {
+	ficlUnsigned	mark[IMAGE_DICTS];
+	ficlCell       *cells[IMAGE_DICTS];
+	ficlUnsigned   *digest[IMAGE_DICTS];
+	ficlInteger	files;
+	int		types;
+	ficlUnsigned	key;	/* image_fingerprint() or cache_key() */
+	ficlUnsigned	taints;	/* cache_taints before loading */
+	char           *file;	/* image or cache file */
+} FImageSnap;
+
+/* restore results */
+enum {
+	IMAGE_MISSING = -1,	/* no such file */
+	IMAGE_STALE,		/* other key or changed source file */
+	IMAGE_RESTORED
+};
+
+static char    *image_name;
+static int	image_save_p;
+static FImageSnap image_snap;	/* --save-image */
+static const char *image_file;	/* file in image_restore() */
+static ficlUnsigned code_lo;
+static ficlUnsigned code_hi;
+
+/* load-cache-statistics */
+static struct {
+	ficlUnsigned	hits;
+	ficlUnsigned	misses;
+	ficlUnsigned	stale;
+	ficlUnsigned	writes;
+	ficlUnsigned	failed;
+	ficlUnsigned	tainted;
+} cache_stats;
+
+/* changes a cache entry can't restore, see fth_load_cache_taint() */
+static ficlUnsigned cache_taints;
+
+static void	buf_put(FImageBuf *, const void *, size_t);
+static void	buf_str(FImageBuf *, const char *, size_t);
+static void	buf_u(FImageBuf *, ficlUnsigned);
+static FTH	cache_file(const char *);
+static ficlUnsigned cache_key(const char *);
+static void	code_bound(ficlUnsigned);
+static void	ficl_load_cache_statistics(ficlVm *);
+static int	image_changed(FImageSnap *);
+static void	image_corrupt(void);
+static ficlDictionary *image_dict(int);
+static ficlUnsigned image_digest(FTH);
+static ficlUnsigned image_fingerprint(void);
+static ficlUnsigned image_hash(ficlUnsigned, const void *, size_t);
+static int	image_kind(FImageSave *, ficlUnsigned, ficlUnsigned *);
+static ficlUnsigned image_object(FImageSave *, FTH);
+static void	image_put_ref(FImageSave *, FImageBuf *, void *, ficlUnsigned);
+static int	image_read(FImageSnap *, int);
+static int	image_restore(const ficlUnsigned *, size_t, ficlUnsigned, int);
+static ficlUnsigned image_ref(FImageIn *, FTH *, void *);
+static ficlCell **image_roots(int *);
+static void	image_save_free(FImageSave *);
+static void	image_snap_free(FImageSnap *);
+static void	image_snapshot(FImageSnap *);
+static int	image_write(FImageSnap *, int);
+static const char *in_str(FImageIn *, size_t *);
+static ficlUnsigned in_u(FImageIn *);
+static int	memo_ref(FImageSave *, FTH, ficlUnsigned *);
+static void	memo_set(FImageSave *, FTH, ficlUnsigned);
+
+/*
+ * Remember image FILE; with SAVE_P forth_init() snapshots the
+ * dictionary for fth_image_save(), otherwise it tries to restore FILE.
+ */
+void
+fth_image_set(const char *file, int save_p)
+{
+	image_name = (char *) file;
+	image_save_p = save_p;
+}
+
+/* === Output === */
+
+static void
+buf_put(FImageBuf *b, const void *p, size_t n)
+{
+	if (b->len + n > b->size) {
+		b->size = FICL_MAX(b->size * 2, b->len + n + 4096);
+		b->data = FTH_REALLOC(b->data, b->size);
+	}
+	memcpy(b->data + b->len, p, n);
+	b->len += n;
+}
+
+static void
+buf_u(FImageBuf *b, ficlUnsigned u)
+{
+	buf_put(b, &u, sizeof(u));
+}
+
+/* Strings are padded to whole words. */
+static void
+buf_str(FImageBuf *b, const char *s, size_t n)
+{
+	ficlUnsigned 	pad;
+
+	buf_u(b, (ficlUnsigned) n);
+	buf_put(b, s, n);
+	pad = 0;
+	n %= sizeof(ficlUnsigned);
+
+	if (n > 0)
+		buf_put(b, &pad, sizeof(ficlUnsigned) - n);
+}
+
+/* === Input === */
+
+static void
+image_corrupt(void)
+{
+	fth_errorf("#<image %s: corrupt, giving up>\n", image_file);
+	fth_exit(EXIT_FAILURE);
+}
+
+static ficlUnsigned
+in_u(FImageIn *in)
+{
+	if (in->p >= in->end)
+		image_corrupt();
+	return (*in->p++);
+}
+
+static const char *
+in_str(FImageIn *in, size_t *len)
+{
+	const char     *s;
+	size_t 		words;
+
+	*len = (size_t) in_u(in);
+	words = (*len + sizeof(ficlUnsigned) - 1) / sizeof(ficlUnsigned);
+
+	if (words > (size_t) (in->end - in->p))
+		image_corrupt();
+
+	s = (const char *) in->p;
+	in->p += words;
+	return (s);
+}
+
+/* === Helpers === */
+
+static ficlUnsigned
+image_hash(ficlUnsigned h, const void *p, size_t len)
+{
+	const unsigned char *s;
+	size_t 		i;
+
+	s = p;
+
+	for (i = 0; i < len; i++)
+		h = (h ^ s[i]) * IMAGE_FNV_PRIME;
+
+	return (h);
+}
+
+static ficlDictionary *
+image_dict(int d)
+{
+	return (d == 0 ? FTH_FICL_DICT() : FTH_FICL_ENV());
+}
+
+/*
+ * Cells outside the dictionaries which the source files may change.
+ */
+static ficlCell **
+image_roots(int *len)
+{
+	static ficlCell *roots[IMAGE_DICTS * (FICL_MAX_WORDLISTS + 4) +
+	    FICL_MAX_PARSE_STEPS + 1];
+	ficlDictionary *dict;
+	ficlSystem     *sys;
+	int 		d, i, n;
+
+	n = 0;
+
+	for (d = 0; d < IMAGE_DICTS; d++) {
+		dict = image_dict(d);
+		roots[n++] = (ficlCell *) & dict->smudge;
+		roots[n++] = (ficlCell *) & dict->compilationWordlist;
+		roots[n++] = (ficlCell *) & dict->wordlistCount;
+		roots[n++] = (ficlCell *) & dict->compiled;
+
+		for (i = 0; i < FICL_MAX_WORDLISTS; i++)
+			roots[n++] = (ficlCell *) & dict->wordlists[i];
+	}
+	sys = FTH_FICL_SYSTEM();
+
+	for (i = 0; i < FICL_MAX_PARSE_STEPS; i++)
+		roots[n++] = (ficlCell *) & sys->parseList[i];
+
+	roots[n++] = (ficlCell *) & sys->interpretWord;
+	*len = n;
+	return (roots);
+}
+
+/*
+ * Identifies the C part of the dictionary; see the comment above.
+ */
+static ficlUnsigned
+image_fingerprint(void)
+{
+	ficlDictionary *dict;
+	ficlHash       *hash;
+	ficlWord       *word;
+	ficlUnsigned 	h, v[8];
+	int 		d;
+	unsigned 	i;
+
+	h = image_hash(IMAGE_FNV_OFFSET, fth_version(),
+	    (size_t) fth_strlen(fth_version()));
+	v[0] = sizeof(ficlCell);
+	v[1] = sizeof(ficlWord);
+	v[2] = sizeof(FObject);
+	v[3] = sizeof(FInstance);
+	v[4] = ficlInstructionLast;
+	v[5] = (ficlUnsigned) fth_image_save - IMAGE_CODE_BASE;
+
+	for (d = 0; d < IMAGE_DICTS; d++) {
+		dict = image_dict(d);
+		v[6 + d] = (ficlUnsigned) (dict->here - dict->base);
+	}
+	h = image_hash(h, v, sizeof(v));
+	hash = FTH_FICL_DICT()->forthWordlist;
+
+	for (i = 0; i < hash->size; i++)
+		for (word = hash->table[i]; word != NULL; word = word->link) {
+			h = image_hash(h, word->name, (size_t) word->length);
+			h = image_hash(h, &word->flags, sizeof(word->flags));
+		}
+
+	return (h);
+}
+
+/* === Save === */
+
+static void
+code_bound(ficlUnsigned v)
+{
+	/* smaller values are instruction numbers */
+	if (v <= 0xffff)
+		return;
+
+	if (v < code_lo)
+		code_lo = v;
+
+	if (v > code_hi)
+		code_hi = v;
+}
+
+static int
+memo_ref(FImageSave *sv, FTH obj, ficlUnsigned *id)
+{
+	size_t 		i, mask;
+
+	if (sv->size == 0)
+		return (0);
+
+	mask = sv->size - 1;
+
+	for (i = (size_t) ((obj >> 4) * 0x9e3779b9UL) & mask;
+	    sv->keys[i] != 0; i = (i + 1) & mask)
+		if (sv->keys[i] == obj) {
+			*id = sv->ids[i];
+			return (1);
+		}
+
+	return (0);
+}
+
+static void
+memo_set(FImageSave *sv, FTH obj, ficlUnsigned id)
+{
+	size_t 		i, mask;
+
+	if ((sv->nobjs + 1) * 2 > sv->size) {
+		FTH            *keys;
+		ficlUnsigned   *ids;
+		size_t 		j, size;
+
+		keys = sv->keys;
+		ids = sv->ids;
+		size = sv->size;
+		sv->size = size == 0 ? 64 : size * 2;
+		sv->keys = FTH_CALLOC(sv->size, sizeof(FTH));
+		sv->ids = FTH_CALLOC(sv->size, sizeof(ficlUnsigned));
+
+		for (j = 0; j < size; j++)
+			if (keys[j] != 0)
+				memo_set(sv, keys[j], ids[j]);
+
+		FTH_FREE(keys);
+		FTH_FREE(ids);
+	}
+	mask = sv->size - 1;
+
+	for (i = (size_t) ((obj >> 4) * 0x9e3779b9UL) & mask;
+	    sv->keys[i] != 0; i = (i + 1) & mask)
+		/* empty */ ;
+
+	sv->keys[i] = obj;
+	sv->ids[i] = id;
+}
+
+static void
+image_save_free(FImageSave *sv)
+{
+	FTH_FREE(sv->objs.data);
+	FTH_FREE(sv->keys);
+	FTH_FREE(sv->ids);
+}
+
+/*
+ * Append the record of OBJ and of the objects it contains to
+ * SV->OBJS and return its id.
+ */
+static ficlUnsigned
+image_object(FImageSave *sv, FTH obj)
+{
+	FImageBuf 	refs = {NULL, 0, 0};
+	ficlUnsigned 	id, u[4];
+	ficlInteger 	i, len;
+	size_t 		n;
+
+	if (memo_ref(sv, obj, &id))
+		return (id);
+
+	id = sv->nobjs;
+	memo_set(sv, obj, id);
+	sv->nobjs++;
+	u[1] = id;
+	n = 2;
+
+	if (FTH_STRING_P(obj))
+		u[0] = OBJ_STRING;
+	else if (FTH_REGEXP_P(obj))
+		u[0] = OBJ_REGEXP;
+	else if (FTH_INSTANCE_TYPE_P(obj, FTH_FLOAT_T)) {
+		ficlFloat 	f;
+
+		f = fth_float_ref(obj);
+		u[0] = OBJ_FLOAT;
+		memcpy(&u[2], &f, sizeof(f));
+		n = 3;
+	} else if (FTH_INSTANCE_TYPE_P(obj, FTH_LLONG_T)) {
+		u[0] = OBJ_LLONG;
+		u[2] = (ficlUnsigned) fth_long_long_ref(obj);
+		n = 3;
+	} else if (FTH_ARRAY_P(obj)) {
+		len = fth_array_length(obj);
+
+		for (i = 0; i < len; i++)
+			image_put_ref(sv, &refs, NULL,
+			    (ficlUnsigned) fth_array_fast_ref(obj, i));
+
+		u[0] = OBJ_ARRAY;
+		u[2] = (ficlUnsigned) fth_array_type_ref(obj);
+		u[3] = (ficlUnsigned) len;
+		n = 4;
+	} else if (FTH_HASH_P(obj)) {
+		FTH 		pairs, pair;
+
+		pairs = fth_hash_to_array(obj);
+		len = fth_array_length(pairs);
+
+		for (i = 0; i < len; i++) {
+			pair = fth_array_fast_ref(pairs, i);
+			image_put_ref(sv, &refs, NULL,
+			    (ficlUnsigned) fth_array_fast_ref(pair, 0));
+			image_put_ref(sv, &refs, NULL,
+			    (ficlUnsigned) fth_array_fast_ref(pair, 1));
+		}
+
+		u[0] = OBJ_HASH;
+		u[2] = (ficlUnsigned) fth_hash_flat_p(obj);
+		u[3] = (ficlUnsigned) len;
+		n = 4;
+	} else if (sv->digest_p) {
+		u[0] = OBJ_OPAQUE;
+		u[2] = (ficlUnsigned) obj;
+		buf_put(&sv->objs, u, 3 * sizeof(ficlUnsigned));
+		return (id);
+	} else {
+		if (sv->failed == 0)
+			sv->failed = obj;
+		return (id);
+	}
+
+	/* object-properties follow the contents */
+	image_put_ref(sv, &refs, NULL,
+	    (ficlUnsigned) FTH_INSTANCE_PROPERTIES(obj));
+	buf_put(&sv->objs, u, n * sizeof(ficlUnsigned));
+
+	if (u[0] == OBJ_STRING)
+		buf_str(&sv->objs, fth_string_ref(obj),
+		    (size_t) fth_string_length(obj));
+	else if (u[0] == OBJ_REGEXP) {
+		FTH 		fs;
+
+		/* recompiled like regexp-copy, "/re/" */
+		fs = fth_object_to_string(obj);
+		buf_str(&sv->objs, fth_string_ref(fs) + 1,
+		    (size_t) fth_string_length(fs) - 2);
+	}
+
+	buf_put(&sv->objs, refs.data, refs.len);
+	FTH_FREE(refs.data);
+	return (id);
+}
+
+static int
+image_kind(FImageSave *sv, ficlUnsigned v, ficlUnsigned *payload)
+{
+	ficlDictionary *dict;
+	ficlUnsigned 	lo;
+	int 		d, i;
+
+	*payload = v;
+
+	if (v == 0)
+		return (REF_RAW);
+
+	if ((FTH) v == FTH_FALSE || (FTH) v == FTH_TRUE ||
+	    (FTH) v == FTH_NIL || (FTH) v == FTH_UNDEF) {
+		*payload = (FTH) v == FTH_FALSE ? 0 :
+		    (FTH) v == FTH_TRUE ? 1 :
+		    (FTH) v == FTH_NIL ? 2 : 3;
+		return (REF_CONST);
+	}
+	for (d = 0; d < IMAGE_DICTS; d++) {
+		dict = image_dict(d);
+		lo = (ficlUnsigned) dict->base;
+
+		if (v >= lo && v <= lo + dict->size * sizeof(ficlCell)) {
+			*payload = v - lo;
+			return (d == 0 ? REF_DICT : REF_ENV);
+		}
+	}
+
+	if (fth_instance_p((FTH) v)) {
+		*payload = image_object(sv, (FTH) v);
+		return (REF_OBJ);
+	}
+	if ((i = fth_object_type_index((FTH) v)) >= 0) {
+		*payload = (ficlUnsigned) i;
+		return (REF_TYPE);
+	}
+	if (v >= code_lo && v <= code_hi) {
+		*payload = v - IMAGE_CODE_BASE;
+		return (REF_CODE);
+	}
+	return (REF_RAW);
+}
+
+/*
+ * Append a reference to V, the content of CELL (or NULL), to B.
+ */
+static void
+image_put_ref(FImageSave *sv, FImageBuf *b, void *cell, ficlUnsigned v)
+{
+	ficlHash       *hash;
+	ficlUnsigned 	payload;
+	unsigned 	i;
+
+	if (cell != NULL && (hash = ficlHashGrownTable(cell)) != NULL) {
+		buf_u(b, REF_TABLE);
+		buf_u(b, hash->size);
+
+		for (i = 0; i < hash->size; i++)
+			image_put_ref(sv, b, NULL,
+			    (ficlUnsigned) hash->table[i]);
+		return;
+	}
+	buf_u(b, (ficlUnsigned) image_kind(sv, v, &payload));
+	buf_u(b, payload);
+}
+
+/*
+ * Digest of OBJ and its contents for finding changed objects.
+ */
+static ficlUnsigned
+image_digest(FTH obj)
+{
+	FImageSave 	sv;
+	FImageBuf 	b = {NULL, 0, 0};
+	ficlUnsigned 	h;
+
+	memset(&sv, 0, sizeof(sv));
+	sv.digest_p = 1;
+	image_put_ref(&sv, &b, NULL, (ficlUnsigned) obj);
+	h = image_hash(IMAGE_FNV_OFFSET, b.data, b.len);
+	h = image_hash(h, sv.objs.data, sv.objs.len);
+	FTH_FREE(b.data);
+	image_save_free(&sv);
+	return (h);
+}
+
+/*
+ * Remember the dictionary before loading source files.
+ */
+static void
+image_snapshot(FImageSnap *sn)
+{
+	ficlDictionary *dict;
+	ficlHash       *hash;
+	ficlWord       *word;
+	ficlUnsigned 	i, n, v;
+	FTH 		files;
+	int 		d;
+
+	fth_gc_off();
+	files = fth_variable_ref("*loaded-files*");
+
+	if (code_hi == 0) {
+		code_lo = ~(ficlUnsigned) 0;
+		hash = FTH_FICL_DICT()->forthWordlist;
+
+		/* func and vfunc may be data, e.g. repl-cb */
+		for (i = 0; i < hash->size; i++)
+			for (word = hash->table[i]; word != NULL;
+			    word = word->link)
+				code_bound((ficlUnsigned) word->code);
+	}
+
+	for (d = 0; d < IMAGE_DICTS; d++) {
+		dict = image_dict(d);
+		n = (ficlUnsigned) (dict->here - dict->base);
+		sn->mark[d] = n;
+		sn->cells[d] = FTH_MALLOC(n * sizeof(ficlCell));
+		memcpy(sn->cells[d], dict->base, n * sizeof(ficlCell));
+		sn->digest[d] = FTH_CALLOC(n, sizeof(ficlUnsigned));
+
+		/*
+		 * Objects, e.g. word properties or the array of a value,
+		 * may change without changing the cell.  *loaded-files*
+		 * has its own record.
+		 */
+		for (i = 0; i < n; i++) {
+			v = dict->base[i].u;
+
+			if (v != 0 && fth_instance_p((FTH) v) &&
+			    (FTH) v != files)
+				sn->digest[d][i] = image_digest((FTH) v);
+		}
+	}
+
+	sn->files = fth_array_length(files);
+
+	for (sn->types = 0; fth_object_type_ref(sn->types) != 0; sn->types++)
+		/* empty */ ;
+
+	fth_gc_on();
+}
+
+/*
+ * Return 1 if an object the dictionary referred to at image_snapshot()
+ * was changed in place since.
+ */
+static int
+image_changed(FImageSnap *sn)
+{
+	ficlDictionary *dict;
+	ficlUnsigned 	i, v;
+	int 		d, ret;
+
+	fth_gc_off();
+	ret = 0;
+
+	for (d = 0; d < IMAGE_DICTS && ret == 0; d++) {
+		dict = image_dict(d);
+
+		for (i = 0; i < sn->mark[d]; i++) {
+			v = dict->base[i].u;
+
+			if (sn->digest[d][i] != 0 && v == sn->cells[d][i].u &&
+			    image_digest((FTH) v) != sn->digest[d][i]) {
+				ret = 1;
+				break;
+			}
+		}
+	}
+	fth_gc_on();
+	return (ret);
+}
+
+static void
+image_snap_free(FImageSnap *sn)
+{
+	int 		d;
+
+	for (d = 0; d < IMAGE_DICTS; d++) {
+		FTH_FREE(sn->cells[d]);
+		FTH_FREE(sn->digest[d]);
+		sn->cells[d] = NULL;
+		sn->digest[d] = NULL;
+	}
+	FTH_FREE(sn->file);
+	sn->file = NULL;
+}
+
+/*
+ * Write what the source files added since image_snapshot() to
+ * SN->FILE.  Return 1 on success.
+ */
+static int
+image_write(FImageSnap *sn, int verbose)
+{
+	FImageSave 	sv;
+	FImageBuf 	out = {NULL, 0, 0};
+	FImageBuf 	types = {NULL, 0, 0};
+	FImageBuf 	relocs = {NULL, 0, 0};
+	ficlDictionary *dict;
+	ficlCell      **roots;
+	ficlUnsigned 	i, n, nrelocs, v, here[IMAGE_DICTS];
+	ficlInteger 	j, len;
+	FTH 		files, words, fs;
+	FILE           *fp;
+	char           *tmp;
+	int 		d, k, nroots;
+
+	fth_gc_off();
+	memset(&sv, 0, sizeof(sv));
+	nrelocs = 0;
+
+	/* cells of the dictionaries */
+	for (d = 0; d < IMAGE_DICTS; d++) {
+		dict = image_dict(d);
+		here[d] = (ficlUnsigned) (dict->here - dict->base);
+
+		for (i = 0; i < here[d]; i++) {
+			ficlCell       *cell;
+			ficlUnsigned 	payload;
+
+			cell = dict->base + i;
+			v = cell->u;
+
+			if (i < sn->mark[d]) {
+				/* changed hashes are saved again */
+				if (v == sn->cells[d][i].u &&
+				    ficlHashGrownTable(cell) == NULL &&
+				    (sn->digest[d][i] == 0 ||
+					!FTH_HASH_P((FTH) v) ||
+					image_digest((FTH) v) ==
+					sn->digest[d][i]))
+					continue;
+			} else if (ficlHashGrownTable(cell) == NULL &&
+			    image_kind(&sv, v, &payload) == REF_RAW)
+				continue;
+
+			buf_u(&relocs, (ficlUnsigned) d);
+			buf_u(&relocs, i);
+			image_put_ref(&sv, &relocs, cell, v);
+			nrelocs++;
+		}
+	}
+
+	/* object-types created by the source files */
+	n = 0;
+
+	for (k = sn->types; fth_object_type_ref(k) != 0; k++) {
+		FObject        *obj;
+		FTH            *procs;
+		int 		p;
+
+		obj = FTH_OBJECT_REF(fth_object_type_ref(k));
+		buf_u(&types, (ficlUnsigned) k);
+		buf_str(&types, obj->name, (size_t) fth_strlen(obj->name));
+		procs = &obj->inspect_proc;
+
+		for (p = 0; p < IMAGE_PROCS; p++)
+			image_put_ref(&sv, &types, NULL,
+			    (ficlUnsigned) procs[p]);
+		n++;
+	}
+
+	if (sv.failed != 0) {
+		if (verbose)
+			fth_warning("%s: can't save %I in an image",
+			    sn->file, sv.failed);
+		goto failed;
+	}
+	buf_put(&out, IMAGE_MAGIC, 8);
+	buf_u(&out, 0);		/* checksum */
+	buf_u(&out, sn->key);
+
+	for (d = 0; d < IMAGE_DICTS; d++) {
+		buf_u(&out, sn->mark[d]);
+		buf_u(&out, here[d] - sn->mark[d]);
+	}
+
+	/* source files */
+	files = fth_variable_ref("*loaded-files*");
+	len = fth_array_length(files);
+	buf_u(&out, (ficlUnsigned) (len - sn->files));
+
+	for (j = sn->files; j < len; j++) {
+		struct stat 	st;
+
+		fs = fth_array_fast_ref(files, j);
+		buf_str(&out, fth_string_ref(fs),
+		    (size_t) fth_string_length(fs));
+
+		if (stat(fth_string_ref(fs), &st) == -1)
+			goto failed;
+
+		buf_u(&out, (ficlUnsigned) st.st_mtime);
+		buf_u(&out, (ficlUnsigned) st.st_size);
+	}
+
+	buf_u(&out, sv.nobjs);
+	buf_u(&out, (ficlUnsigned) sv.objs.len);
+	buf_put(&out, sv.objs.data, sv.objs.len);
+	buf_u(&out, n);
+	buf_put(&out, types.data, types.len);
+
+	for (d = 0; d < IMAGE_DICTS; d++) {
+		dict = image_dict(d);
+		buf_put(&out, dict->base + sn->mark[d],
+		    (here[d] - sn->mark[d]) * sizeof(ficlCell));
+	}
+
+	buf_u(&out, nrelocs);
+	buf_put(&out, relocs.data, relocs.len);
+
+	/* objects met after the object section are an error */
+	n = sv.nobjs;
+	roots = image_roots(&nroots);
+	buf_u(&out, (ficlUnsigned) nroots);
+
+	for (k = 0; k < nroots; k++)
+		image_put_ref(&sv, &out, NULL, roots[k]->u);
+
+	if (sv.nobjs != n) {
+		if (verbose)
+			fth_warning("%s: objects outside the dictionary",
+			    sn->file);
+		goto failed;
+	}
+	dict = FTH_FICL_DICT();
+	words = fth_symbol_interned(dict->base + sn->mark[0], dict->here);
+	len = fth_array_length(words);
+	buf_u(&out, (ficlUnsigned) len);
+
+	for (j = 0; j < len; j++)
+		buf_u(&out, (ficlUnsigned) fth_array_fast_ref(words, j) -
+		    (ficlUnsigned) dict->base);
+
+	v = image_hash(IMAGE_FNV_OFFSET, out.data + 16, out.len - 16);
+	memcpy(out.data + 8, &v, sizeof(v));
+	tmp = fth_format("%s.tmp", sn->file);
+	fp = fopen(tmp, "wb");
+
+	if (fp == NULL || fwrite(out.data, out.len, 1, fp) != 1 ||
+	    fclose(fp) != 0 || rename(tmp, sn->file) == -1) {
+		if (verbose)
+			fth_warning("%s: %s", sn->file, strerror(errno));
+
+		if (fp != NULL)
+			unlink(tmp);
+		FTH_FREE(tmp);
+		goto failed;
+	}
+	FTH_FREE(tmp);
+	FTH_FREE(out.data);
+	FTH_FREE(types.data);
+	FTH_FREE(relocs.data);
+	image_save_free(&sv);
+	fth_gc_on();
+	return (1);
+
+failed:
+	FTH_FREE(out.data);
+	FTH_FREE(types.data);
+	FTH_FREE(relocs.data);
+	image_save_free(&sv);
+	fth_gc_on();
+	return (0);
+}
+
+/* === Load === */
+
+/*
+ * Return the value of the next reference in IN; OBJS are the restored
+ * objects.  CELL is the cell which gets the value, the old wordlist
+ * table in it is freed.
+ */
+static ficlUnsigned
+image_ref(FImageIn *in, FTH *objs, void *cell)
+{
+	ficlUnsigned 	tag, v;
+
+	tag = in_u(in);
+	v = in_u(in);
+
+	switch (tag) {
+	case REF_RAW:
+		return (v);
+	case REF_DICT:
+		return ((ficlUnsigned) FTH_FICL_DICT()->base + v);
+	case REF_ENV:
+		return ((ficlUnsigned) FTH_FICL_ENV()->base + v);
+	case REF_CODE:
+		return (IMAGE_CODE_BASE + v);
+	case REF_CONST:
+		return ((ficlUnsigned) (v == 0 ? FTH_FALSE :
+			v == 1 ? FTH_TRUE :
+			v == 2 ? FTH_NIL : FTH_UNDEF));
+	case REF_OBJ:
+		if (objs == NULL || objs[v] == 0)
+			image_corrupt();
+		return ((ficlUnsigned) objs[v]);
+	case REF_TYPE:
+		if (fth_object_type_ref((int) v) == 0)
+			image_corrupt();
+		return ((ficlUnsigned) fth_object_type_ref((int) v));
+	case REF_TABLE:
+		{
+			ficlHash       *hash;
+			ficlWord      **table;
+			ficlUnsigned 	i;
+
+			if (cell == NULL || v == 0)
+				image_corrupt();
+
+			hash = (ficlHash *) ((char *) cell -
+			    offsetof(ficlHash, table));
+			table = FTH_CALLOC(v, sizeof(ficlWord *));
+
+			for (i = 0; i < v; i++)
+				table[i] = (ficlWord *) image_ref(in, objs, NULL);
+
+			if (hash->table != hash->buckets)
+				FTH_FREE(hash->table);
+			return ((ficlUnsigned) table);
+		}
+	default:
+		image_corrupt();
+		break;
+	}
+	return (0);
+}
+
+/*
+ * Restore the image DATA of WORDS ficlUnsigned if it was made with KEY.
+ * Return IMAGE_RESTORED or IMAGE_STALE.
+ */
+static int
+image_restore(const ficlUnsigned *data, size_t words, ficlUnsigned key,
+    int verbose)
+{
+	FImageIn 	in;
+	ficlDictionary *dict;
+	ficlCell      **roots;
+	ficlUnsigned 	i, n, len, mark[IMAGE_DICTS], size[IMAGE_DICTS];
+	const ficlUnsigned *objs_start;
+	FTH            *objs;
+	int 		d, k, nroots;
+
+	in.p = data;
+	in.end = data + words;
+
+	if (words < 3 || memcmp(data, IMAGE_MAGIC, 8) != 0) {
+		if (verbose)
+			fth_warning("%s: not an image", image_file);
+		return (IMAGE_STALE);
+	}
+	in.p++;
+
+	if (in_u(&in) != image_hash(IMAGE_FNV_OFFSET, data + 2,
+		(words - 2) * sizeof(ficlUnsigned))) {
+		if (verbose)
+			fth_warning("%s: bad checksum", image_file);
+		return (IMAGE_STALE);
+	}
+	if (in_u(&in) != key) {
+		if (verbose)
+			fth_warning("%s: made by another fth", image_file);
+		return (IMAGE_STALE);
+	}
+	for (d = 0; d < IMAGE_DICTS; d++) {
+		dict = image_dict(d);
+		mark[d] = in_u(&in);
+		size[d] = in_u(&in);
+
+		if (mark[d] != (ficlUnsigned) (dict->here - dict->base) ||
+		    mark[d] + size[d] > dict->size) {
+			if (verbose)
+				fth_warning("%s: doesn't fit the dictionary",
+				    image_file);
+			return (IMAGE_STALE);
+		}
+	}
+
+	/* source files */
+	n = in_u(&in);
+
+	for (i = 0; i < n; i++) {
+		struct stat 	st;
+		char 		path[MAXPATHLEN];
+		const char     *s;
+		ficlUnsigned 	mtime, fsize;
+
+		s = in_str(&in, &len);
+		mtime = in_u(&in);
+		fsize = in_u(&in);
+
+		if (len >= sizeof(path))
+			image_corrupt();
+
+		memcpy(path, s, len);
+		path[len] = '\0';
+
+		if (stat(path, &st) == -1 ||
+		    (ficlUnsigned) st.st_mtime != mtime ||
+		    (ficlUnsigned) st.st_size != fsize) {
+			if (verbose)
+				fth_warning("%s: %s changed", image_file, path);
+			return (IMAGE_STALE);
+		}
+	}
+
+	/*
+	 * From here on the image is used.  Create the objects first and
+	 * fill arrays and hashes when all exist.
+	 */
+	fth_gc_off();
+	n = in_u(&in);
+	len = in_u(&in) / sizeof(ficlUnsigned);
+
+	if (len > (ficlUnsigned) (in.end - in.p))
+		image_corrupt();
+
+	objs = FTH_CALLOC(n + 1, sizeof(FTH));
+	objs_start = in.p;
+
+	for (i = 0; i < n; i++) {
+		ficlUnsigned 	kind, id, u;
+		const char     *s;
+		size_t 		slen;
+		FTH 		obj;
+
+		kind = in_u(&in);
+		id = in_u(&in);
+
+		if (id >= n)
+			image_corrupt();
+
+		switch (kind) {
+		case OBJ_STRING:
+			s = in_str(&in, &slen);
+			obj = fth_make_string_len(s, (ficlInteger) slen);
+			break;
+		case OBJ_REGEXP:
+			s = in_str(&in, &slen);
+			obj = fth_make_regexp(fth_string_ref(
+				fth_make_string_len(s, (ficlInteger) slen)));
+			break;
+		case OBJ_FLOAT:
+			{
+				ficlFloat 	f;
+
+				u = in_u(&in);
+				memcpy(&f, &u, sizeof(f));
+				obj = fth_make_float(f);
+			}
+			break;
+		case OBJ_LLONG:
+			obj = fth_make_llong((ficl2Integer) in_u(&in));
+			break;
+		case OBJ_ARRAY:
+			u = in_u(&in);
+			len = in_u(&in);
+			obj = fth_make_array_len((ficlInteger) len);
+			fth_array_type_set(obj, (int) u);
+			in.p += 2 * len;
+			break;
+		case OBJ_HASH:
+			u = in_u(&in);
+			len = in_u(&in);
+			obj = u ? fth_make_flat_hash_len((int) len) :
+			    fth_make_hash_len((int) len);
+			in.p += 4 * len;
+			break;
+		default:
+			image_corrupt();
+			return (0);
+		}
+		in.p += 2;	/* properties */
+		objs[id] = fth_gc_permanent(obj);
+	}
+
+	/* fill arrays and hashes */
+	in.p = objs_start;
+
+	for (i = 0; i < n; i++) {
+		ficlUnsigned 	kind, id, j;
+		size_t 		slen;
+		FTH 		obj, key;
+
+		kind = in_u(&in);
+		id = in_u(&in);
+		obj = objs[id];
+
+		switch (kind) {
+		case OBJ_STRING:
+		case OBJ_REGEXP:
+			(void) in_str(&in, &slen);
+			break;
+		case OBJ_FLOAT:
+		case OBJ_LLONG:
+			(void) in_u(&in);
+			break;
+		case OBJ_ARRAY:
+			(void) in_u(&in);
+			len = in_u(&in);
+
+			for (j = 0; j < len; j++)
+				fth_array_fast_set(obj, (ficlInteger) j,
+				    (FTH) image_ref(&in, objs, NULL));
+			break;
+		case OBJ_HASH:
+			(void) in_u(&in);
+			len = in_u(&in);
+
+			for (j = 0; j < len; j++) {
+				key = (FTH) image_ref(&in, objs, NULL);
+				fth_hash_set(obj, key,
+				    (FTH) image_ref(&in, objs, NULL));
+			}
+			break;
+		}
+		FTH_INSTANCE_PROPERTIES(obj) = (FTH) image_ref(&in, objs, NULL);
+	}
+
+	/* object-types */
+	n = in_u(&in);
+
+	for (i = 0; i < n; i++) {
+		FObject        *obj;
+		FTH            *procs, tp;
+		char 		name[sizeof(obj->name)];
+		const char     *s;
+		int 		index, p;
+
+		index = (int) in_u(&in);
+		s = in_str(&in, &len);
+
+		if (len >= sizeof(name))
+			image_corrupt();
+
+		memcpy(name, s, len);
+		name[len] = '\0';
+		tp = fth_object_type_restore(index, name);
+
+		if (tp == 0)
+			image_corrupt();
+
+		obj = FTH_OBJECT_REF(tp);
+		procs = &obj->inspect_proc;
+
+		for (p = 0; p < IMAGE_PROCS; p++)
+			procs[p] = (FTH) image_ref(&in, objs, NULL);
+	}
+
+	/* dictionary cells */
+	for (d = 0; d < IMAGE_DICTS; d++) {
+		dict = image_dict(d);
+
+		if (size[d] > (ficlUnsigned) (in.end - in.p))
+			image_corrupt();
+
+		memcpy(dict->base + mark[d], in.p, size[d] * sizeof(ficlCell));
+		in.p += size[d];
+		dict->here = dict->base + mark[d] + size[d];
+	}
+
+	n = in_u(&in);
+
+	for (i = 0; i < n; i++) {
+		ficlCell       *cell;
+		ficlUnsigned 	index;
+
+		d = (int) in_u(&in);
+		index = in_u(&in);
+
+		if (d < 0 || d >= IMAGE_DICTS || index >= mark[d] + size[d])
+			image_corrupt();
+
+		cell = image_dict(d)->base + index;
+		cell->u = image_ref(&in, objs, cell);
+	}
+
+	roots = image_roots(&nroots);
+
+	if (in_u(&in) != (ficlUnsigned) nroots)
+		image_corrupt();
+
+	for (k = 0; k < nroots; k++)
+		roots[k]->u = image_ref(&in, objs, NULL);
+
+	/* symbols, keywords and exceptions */
+	n = in_u(&in);
+	dict = FTH_FICL_DICT();
+
+	for (i = 0; i < n; i++)
+		fth_symbol_restore((ficlWord *) ((char *) dict->base +
+			in_u(&in)));
+
+	/* names of the source files */
+	in.p = data + 3 + 2 * IMAGE_DICTS;
+	n = in_u(&in);
+
+	for (i = 0; i < n; i++) {
+		char 		path[MAXPATHLEN];
+		const char     *s;
+
+		s = in_str(&in, &len);
+		memcpy(path, s, len);
+		path[len] = '\0';
+		fth_add_loaded_files(path);
+		in.p += 2;
+	}
+
+	FTH_FREE(objs);
+	fth_gc_on();
+	return (IMAGE_RESTORED);
+}
+
+/*
+ * Map SN->FILE and restore it if it was made with SN->KEY.  Return
+ * IMAGE_MISSING, IMAGE_STALE or IMAGE_RESTORED.
+ */
+static int
+image_read(FImageSnap *sn, int verbose)
+{
+	void           *data;
+	struct stat 	st;
+	int 		fd, ret;
+
+	image_file = sn->file;
+	fd = open(sn->file, O_RDONLY);
+
+	if (fd == -1 || fstat(fd, &st) == -1) {
+		if (verbose)
+			fth_warning("%s: %s", sn->file, strerror(errno));
+
+		if (fd != -1)
+			close(fd);
+		return (IMAGE_MISSING);
+	}
+	if (st.st_size < 8 || st.st_size % sizeof(ficlUnsigned) != 0) {
+		if (verbose)
+			fth_warning("%s: not an image", sn->file);
+		close(fd);
+		return (IMAGE_STALE);
+	}
+#if defined(IMAGE_MMAP)
+	data = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	if (data == MAP_FAILED) {
+		if (verbose)
+			fth_warning("%s: %s", sn->file, strerror(errno));
+		close(fd);
+		return (IMAGE_MISSING);
+	}
+#else
+	data = FTH_MALLOC((size_t) st.st_size);
+
+	if (read(fd, data, (size_t) st.st_size) != (ssize_t) st.st_size) {
+		if (verbose)
+			fth_warning("%s: %s", sn->file, strerror(errno));
+		FTH_FREE(data);
+		close(fd);
+		return (IMAGE_MISSING);
+	}
+#endif
+	close(fd);
+	ret = image_restore(data, (size_t) st.st_size / sizeof(ficlUnsigned),
+	    sn->key, verbose);
+#if defined(IMAGE_MMAP)
+	munmap(data, (size_t) st.st_size);
+#else
+	FTH_FREE(data);
+#endif
+	return (ret);
+}
+
+/*
+ * Called by forth_init() before it loads the source files.  Return 1
+ * if the image given with --image replaced loading them.
+ */
+int
+fth_image_load(void)
+{
+	if (image_name == NULL)
+		return (0);
+
+	image_snap.key = image_fingerprint();
+	image_snap.file = FTH_STRDUP(image_name);
+
+	if (image_save_p) {
+		image_snapshot(&image_snap);
+		return (0);
+	}
+	return (image_read(&image_snap, 1) == IMAGE_RESTORED);
+}
+
+/*
+ * Write what the source files added to the dictionary to the image
+ * file given with --save-image.  Return 1 on success.
+ */
+int
+fth_image_save(void)
+{
+	if (image_name == NULL || !image_save_p || image_snap.cells[0] == NULL)
+		return (0);
+
+	return (image_write(&image_snap, 1));
+}
+
+/* === Load Cache === */
+
+/*
+ * Return the cache file name of source file NAME or #f if *load-cache*
+ * is off.  With #t it's NAME plus "c" (hello.fs -> hello.fsc), with a
+ * directory the full path of NAME with '/' replaced by '%' in this
+ * directory.
+ */
+static FTH
+cache_file(const char *name)
+{
+	FTH 		dir, fs;
+	char           *p;
+
+	dir = fth_variable_ref("*load-cache*");
+
+	if (FTH_TRUE_P(dir))
+		return (fth_make_string_format("%sc", name));
+
+	if (!FTH_STRING_P(dir) || fth_string_length(dir) == 0)
+		return (FTH_FALSE);
+
+	fs = fth_file_realpath(name);
+
+	for (p = fth_string_ref(fs); *p != '\0'; p++)
+		if (*p == '/')
+			*p = '%';
+
+	return (fth_make_string_format("%S/%Sc", dir, fs));
+}
+
+/*
+ * The dictionary before loading NAME, what was loaded before and NAME.
+ */
+static ficlUnsigned
+cache_key(const char *name)
+{
+	ficlUnsigned 	h;
+	ficlInteger 	i, len;
+	FTH 		files, fs;
+
+	h = image_fingerprint();
+	h = image_hash(h, name, (size_t) fth_strlen(name) + 1);
+	files = fth_variable_ref("*loaded-files*");
+	len = fth_array_length(files);
+
+	for (i = 0; i < len; i++) {
+		fs = fth_array_fast_ref(files, i);
+		h = image_hash(h, fth_string_ref(fs),
+		    (size_t) fth_string_length(fs) + 1);
+	}
+	return (h);
+}
+
+/*
+ * Called by load_file() before loading source file NAME.  Return 1 if
+ * NAME was restored from the load cache.  Otherwise return 0 and set
+ * *UNIT to a snapshot for fth_load_cache_end() or to NULL if the cache
+ * is off.
+ */
+int
+fth_load_cache_begin(const char *name, void **unit)
+{
+	FImageSnap     *sn;
+	FTH 		fs;
+	int 		ret;
+
+	*unit = NULL;
+
+	/* the image snapshot covers the library files */
+	if (image_name != NULL && image_save_p)
+		return (0);
+
+	fs = cache_file(name);
+
+	if (!FTH_STRING_P(fs))
+		return (0);
+
+	sn = FTH_CALLOC(1, sizeof(FImageSnap));
+	sn->file = FTH_STRDUP(fth_string_ref(fs));
+	sn->key = cache_key(name);
+	ret = image_read(sn, 0);
+
+	if (ret == IMAGE_RESTORED) {
+		cache_stats.hits++;
+		image_snap_free(sn);
+		FTH_FREE(sn);
+		return (1);
+	}
+	if (ret == IMAGE_MISSING)
+		cache_stats.misses++;
+	else
+		cache_stats.stale++;
+
+	image_snapshot(sn);
+	sn->taints = cache_taints;
+	*unit = sn;
+	return (0);
+}
+
+/*
+ * Called by load_file() after loading source file with UNIT from
+ * fth_load_cache_begin().  If OK_P, write the cache file unless the
+ * file had effects a cache entry can't restore; an outdated entry is
+ * removed then.
+ */
+void
+fth_load_cache_end(void *unit, int ok_p)
+{
+	FImageSnap     *sn;
+
+	sn = unit;
+
+	if (sn == NULL)
+		return;
+
+	if (ok_p && (sn->taints != cache_taints || image_changed(sn))) {
+		cache_stats.tainted++;
+		unlink(sn->file);
+	} else if (ok_p) {
+		if (image_write(sn, 0))
+			cache_stats.writes++;
+		else
+			cache_stats.failed++;
+	}
+	image_snap_free(sn);
+	FTH_FREE(sn);
+}
+
+/*
+ * Called by C functions which change something a cache entry doesn't
+ * hold, like hook procedures, at-exit procedures or *load-path*.  The
+ * files being loaded won't be cached.
+ */
+void
+fth_load_cache_taint(void)
+{
+	cache_taints++;
+}
+
+#define CACHE_STATS_SET(Hash, Name, Value)				\
+	fth_hash_set(Hash, fth_symbol(Name), fth_make_unsigned(Value))
+
+static void
+ficl_load_cache_statistics(ficlVm *vm)
+{
+#define h_load_cache_statistics "( -- hash )  return load cache statistics\n\
+load-cache-statistics => #{ 'hits => 12 'misses => 0 ... }\n\
+Return hash of load cache statistics since start.\n\
+HITS: files restored from the cache\n\
+MISSES: files without cache entry\n\
+STALE: files with outdated cache entry\n\
+WRITES: cache entries written\n\
+FAILED: cache entries which couldn't be written\n\
+TAINTED: files not cached because of effects outside of the dictionary, \
+e.g. add-hook!, at-exit or array-push on an existing array\n\
+See also *load-cache*."
+	FTH 		hs;
+
+	FTH_STACK_CHECK(vm, 0, 1);
+	hs = fth_make_hash();
+	CACHE_STATS_SET(hs, "hits", cache_stats.hits);
+	CACHE_STATS_SET(hs, "misses", cache_stats.misses);
+	CACHE_STATS_SET(hs, "stale", cache_stats.stale);
+	CACHE_STATS_SET(hs, "writes", cache_stats.writes);
+	CACHE_STATS_SET(hs, "failed", cache_stats.failed);
+	CACHE_STATS_SET(hs, "tainted", cache_stats.tainted);
+	ficlStackPushFTH(vm->dataStack, hs);
+}
+
+/*
+ * Per-user cache directory $XDG_CACHE_HOME/fth or ~/.cache/fth,
+ * created if missing.  Return #f if there is no home.
+ */
+static FTH
+cache_user_dir(void)
+{
+	FTH 		dir;
+	char           *base, *home;
+
+	base = fth_getenv("XDG_CACHE_HOME", NULL);
+
+	if (base == NULL || *base == '\0') {
+		home = fth_getenv("HOME", NULL);
+
+		if (home == NULL || *home == '\0')
+			return (FTH_FALSE);
+
+		dir = fth_make_string_format("%s/.cache", home);
+		mkdir(fth_string_ref(dir), 0700);
+		base = fth_string_ref(dir);
+	}
+	dir = fth_make_string_format("%s/fth", base);
+	mkdir(fth_string_ref(dir), 0700);
+	return (dir);
+}
+
+void
+init_image(void)
+{
+	FTH 		cache;
+	char           *env;
+
+	env = fth_getenv(FTH_ENV_LOAD_CACHE, NULL);
+
+	if (env == NULL)
+		cache = FTH_FALSE;
+	else if (*env == '\0')
+		cache = cache_user_dir();
+	else
+		cache = fth_make_string(env);
+
+	fth_define_variable("*load-cache*", cache,
+	    "( -- f|dir )  \
+If #t, cache compiled source files next to them (hello.fs -> hello.fsc), \
+if a directory name, cache them in this directory.  \
+Default is #f (no caching) or the value of $FTH_LOAD_CACHE; \
+if it's empty, $XDG_CACHE_HOME/fth or ~/.cache/fth.\n\
+A cached file is restored without reading its text if it and the files \
+it loaded are unchanged and the dictionary is the same as when it was \
+cached.  Files with effects outside of the dictionary, like add-hook! \
+or at-exit, or which change objects existing before, are not cached.\n\
+See also load-cache-statistics.");
+	FTH_PRI1("load-cache-statistics", ficl_load_cache_statistics,
+	    h_load_cache_statistics);
+}
+
+/*
+ * image.c ends here
+ */
@@ -33,6 +33,10 @@
 #include "fth.h"
 #include "utils.h"
 
+#if defined(HAVE_FCNTL_H)
+#include <fcntl.h>
+#endif
+
 #if !defined(WEXITSTATUS)
 #define WEXITSTATUS(stat_val)	((unsigned)(stat_val) >> 8)
 #endif
@@ -83,9 +87,24 @@ static FTH 	io_tag;
 
 /* --- SOCKET IO --- */
 
+#define IO_SOCKET_BUFSIZE	(16 * 1024)
+
+/*
+ * Socket IO reads and writes through buffers.  Output goes out if the
+ * buffer is full, on io-flush, before a read which has to wait for
+ * input, and on close.
+ */
 typedef struct {
 	int 		fd;	/* file descriptor */
 	FTH 		host;	/* host name */
+	int 		eof_p;	/* peer closed connection */
+	size_t 		rpos;	/* next char of rbuf */
+	size_t 		rlen;	/* chars in rbuf */
+	size_t 		wlen;	/* chars in wbuf */
+	char           *line;	/* last line read */
+	size_t 		line_size;
+	char 		rbuf[IO_SOCKET_BUFSIZE];
+	char 		wbuf[IO_SOCKET_BUFSIZE];
 } FIO_Socket;
 
 #define SOCKET_REF(Obj)		((FIO_Socket *)(Obj))
@@ -189,6 +208,8 @@ static int 	socket_bind(const char *, int, int, int);
 static void 	socket_close(void *);
 static int 	socket_connect(const char *, int, int, int);
 static int 	socket_eof_p(void *);
+static ssize_t	socket_fill(FIO_Socket *, int);
+static void 	socket_flush(void *);
 static int 	socket_open(int, int);
 static int 	socket_read_char(void *);
 static char    *socket_read_line(void *);
@@ -198,6 +219,7 @@ static ficl2Integer socket_tell(void *);
 static void 	socket_unlink(const char *);
 static void 	socket_write_char(void *, int);
 static void 	socket_write_line(void *, const char *);
+static int 	socket_write_out(FIO_Socket *, const char *, size_t);
 static int 	string_eof_p(void *);
 static int 	string_read_char(void *);
 static char    *string_read_line(void *);
@@ -555,6 +577,10 @@ file_read_char(void *ptr)
 	int 		c;
 
 	fp = (FILE *) ptr;
+
+	if (fp == stdin)
+		fth_port_flush_output();
+
 	c = fgetc(fp);
 
 	if (c == EOF) {
@@ -576,6 +602,10 @@ file_write_char(void *ptr, int c)
 
 	fp = (FILE *) ptr;
 
+	/* stdout may be buffered, see port-flush-policy */
+	if (fp == stderr)
+		fflush(stdout);
+
 	if (fputc(c, fp) == EOF)
 		if (ferror(fp)) {
 			clearerr(fp);
@@ -592,6 +622,10 @@ file_read_line(void *ptr)
 	char           *p;
 
 	fp = (FILE *) ptr;
+
+	if (fp == stdin)
+		fth_port_flush_output();
+
 	p = fgets(io_scratch, (int) sizeof(io_scratch), fp);
 
 	if (p != NULL)
@@ -616,6 +650,9 @@ file_write_line(void *ptr, const char *line)
 
 	fp = (FILE *) ptr;
 
+	if (fp == stderr)
+		fflush(stdout);
+
 	if (fputs(line, fp) == EOF)
 		if (ferror(fp)) {
 			clearerr(fp);
@@ -740,6 +777,7 @@ fth_io_popen(FTH cmd, int fam)
 		/* NOTREACHED */
 		return (FTH_FALSE);
 	}
+	fth_port_flush_output();
 	fp = popen(name, fam_to_mode(fam));
 
 	if (fp == NULL) {
@@ -1607,90 +1645,220 @@ See also io-sopen."
 
 /* === SOCKET-IO === */
 
+/*
+ * Write the buffered output and LEN chars of BUF, both with one
+ * writev(2) if possible.  Return -1 on error.
+ */
 static int
-socket_read_char(void *ptr)
+socket_write_out(FIO_Socket *s, const char *buf, size_t len)
+{
+#if defined(HAVE_SYS_UIO_H)
+	struct iovec 	iov[2];
+	ssize_t 	n;
+	int 		i;
+
+	iov[0].iov_base = s->wbuf;
+	iov[0].iov_len = s->wlen;
+	iov[1].iov_base = (void *) buf;
+	iov[1].iov_len = len;
+	s->wlen = 0;
+	i = (iov[0].iov_len == 0);
+
+	while (i < 2) {
+		n = writev(s->fd, iov + i, 2 - i);
+
+		if (n == -1) {
+			if (errno == EINTR)
+				continue;
+			return (-1);
+		}
+		for (; i < 2 && (size_t) n >= iov[i].iov_len; i++)
+			n -= (ssize_t) iov[i].iov_len;
+
+		if (i < 2) {
+			iov[i].iov_base = (char *) iov[i].iov_base + n;
+			iov[i].iov_len -= (size_t) n;
+		}
+	}
+	return (0);
+#else				/* !HAVE_SYS_UIO_H */
+	const char     *p;
+	size_t 		plen;
+	ssize_t 	n;
+	int 		i;
+
+	for (i = 0; i < 2; i++) {
+		p = (i == 0) ? s->wbuf : buf;
+		plen = (i == 0) ? s->wlen : len;
+
+		while (plen > 0) {
+			n = send(s->fd, p, plen, 0);
+
+			if (n == -1) {
+				if (errno == EINTR)
+					continue;
+				s->wlen = 0;
+				return (-1);
+			}
+			p += n;
+			plen -= (size_t) n;
+		}
+	}
+	s->wlen = 0;
+	return (0);
+#endif				/* HAVE_SYS_UIO_H */
+}
+
+/*
+ * Flush the output and read as much as available into the empty read
+ * buffer.  FLAGS are recv(2) flags.  Return the number of chars read,
+ * 0 on end of file or -1 if FLAGS include MSG_DONTWAIT and nothing is
+ * available.
+ */
+static ssize_t
+socket_fill(FIO_Socket *s, int flags)
 {
-	char 		msg[2];
 	ssize_t 	len;
 
-	msg[0] = '\0';
-	len = recv(FTH_IO_SOCKET_FD(ptr), msg, 1L, 0);
+	if (s->wlen > 0 && socket_write_out(s, NULL, 0) == -1)
+		IO_SOCKET_ERROR(writev);
+
+	s->rpos = s->rlen = 0;
+
+	do {
+		len = recv(s->fd, s->rbuf, sizeof(s->rbuf), flags);
+	} while (len == -1 && errno == EINTR);
 
 	if (len == -1) {
+		if (flags != 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+			return (-1);
 		IO_SOCKET_ERROR(recv);
 		/* NOTREACHED */
 		return (-1);
 	}
-	if (len == 1)
-		return ((int) msg[0]);
+	if (len == 0)
+		s->eof_p = 1;
 
-	return (-1);
+	s->rlen = (size_t) len;
+	return (len);
+}
+
+static int
+socket_read_char(void *ptr)
+{
+	FIO_Socket     *s;
+
+	s = SOCKET_REF(ptr);
+
+	if (s->rpos == s->rlen && (s->eof_p || socket_fill(s, 0) <= 0))
+		return (-1);
+
+	return ((int) (unsigned char) s->rbuf[s->rpos++]);
 }
 
 static void
 socket_write_char(void *ptr, int c)
 {
-	char 		msg[2];
+	FIO_Socket     *s;
 
-	msg[0] = (char) c;
-	msg[1] = '\0';
+	s = SOCKET_REF(ptr);
 
-	if (send(FTH_IO_SOCKET_FD(ptr), msg, 1L, 0) == -1)
-		IO_SOCKET_ERROR(send);
+	if (s->wlen == sizeof(s->wbuf) && socket_write_out(s, NULL, 0) == -1)
+		IO_SOCKET_ERROR(writev);
+
+	s->wbuf[s->wlen++] = (char) c;
 }
 
+/*
+ * Return the next line including the newline or what's left before
+ * end of file, or NULL at end of file.
+ */
 static char    *
 socket_read_line(void *ptr)
 {
-	char           *line;
-	size_t 		size;
-	ssize_t 	len;
-	socklen_t 	slen;
+	FIO_Socket     *s;
+	char           *p, *nl;
+	size_t 		len, n;
 
-	line = io_scratch;
-	size = sizeof(io_scratch);
-	len = recvfrom(FTH_IO_SOCKET_FD(ptr), line, size, 0, NULL, &slen);
+	s = SOCKET_REF(ptr);
+	len = 0;
 
-	if (len == -1) {
-		IO_SOCKET_ERROR(recvfrom);
-		/* NOTREACHED */
-		return (NULL);
-	}
-	if (len > 0) {
-		line[len] = '\0';
-		return (line);
+	for (;;) {
+		if (s->rpos == s->rlen && (s->eof_p || socket_fill(s, 0) <= 0))
+			break;
+
+		p = s->rbuf + s->rpos;
+		n = s->rlen - s->rpos;
+		nl = memchr(p, '\n', n);
+
+		if (nl != NULL)
+			n = (size_t) (nl - p) + 1;
+
+		if (len + n + 1 > s->line_size) {
+			s->line_size = len + n + 1 + BUFSIZ;
+			s->line = FTH_REALLOC(s->line, s->line_size);
+		}
+		memcpy(s->line + len, p, n);
+		len += n;
+		s->rpos += n;
+
+		if (nl != NULL)
+			break;
 	}
-	return (NULL);
+	if (len == 0)
+		return (NULL);
+
+	s->line[len] = '\0';
+	return (s->line);
 }
 
 static void
 socket_write_line(void *ptr, const char *line)
 {
-	if (send(FTH_IO_SOCKET_FD(ptr), line, fth_strlen(line), 0) == -1)
-		IO_SOCKET_ERROR(send);
+	FIO_Socket     *s;
+	size_t 		len;
+
+	s = SOCKET_REF(ptr);
+	len = fth_strlen(line);
+
+	if (s->wlen + len <= sizeof(s->wbuf)) {
+		memcpy(s->wbuf + s->wlen, line, len);
+		s->wlen += len;
+	} else if (socket_write_out(s, line, len) == -1)
+		IO_SOCKET_ERROR(writev);
 }
 
-static int
-socket_eof_p(void *ptr)
+static void
+socket_flush(void *ptr)
 {
-	int 		fd;
-	off_t 		cur, end;
+	FIO_Socket     *s;
 
-	fd = FTH_IO_SOCKET_FD(ptr);
-	cur = lseek(fd, (off_t) 0, SEEK_CUR);
+	s = SOCKET_REF(ptr);
 
-	if (cur == -1)
-		IO_SOCKET_ERROR(lseek);
+	if (s->wlen > 0 && socket_write_out(s, NULL, 0) == -1)
+		IO_SOCKET_ERROR(writev);
+}
 
-	end = lseek(fd, (off_t) 0, SEEK_END);
+/*
+ * Without waiting: at end of file if nothing is buffered and the peer
+ * closed the connection.
+ */
+static int
+socket_eof_p(void *ptr)
+{
+	FIO_Socket     *s;
 
-	if (end == -1)
-		IO_SOCKET_ERROR(lseek);
+	s = SOCKET_REF(ptr);
 
-	if (lseek(fd, cur, SEEK_SET) == -1)
-		IO_SOCKET_ERROR(lseek);
+	if (s->rpos < s->rlen)
+		return (0);
 
-	return (cur == end);
+	if (!s->eof_p) {
+#if defined(MSG_DONTWAIT)
+		socket_fill(s, MSG_DONTWAIT);
+#endif
+	}
+	return (s->eof_p);
 }
 
 static ficl2Integer
@@ -1733,7 +1901,19 @@ socket_unlink(const char *host)
 static void
 socket_close(void *ptr)
 {
-	if (close(FTH_IO_SOCKET_FD(ptr)) == -1)
+	FIO_Socket     *s;
+
+	s = SOCKET_REF(ptr);
+
+	/* Called from io_free() too, don't throw before close. */
+	if (s->wlen > 0)
+		socket_write_out(s, NULL, 0);
+
+	FTH_FREE(s->line);
+	s->line = NULL;
+	s->line_size = 0;
+
+	if (close(s->fd) == -1)
 		IO_SOCKET_ERROR(close);
 	socket_unlink(IO_STRING_REF(FTH_IO_SOCKET_HOST(ptr)));
 }
@@ -1879,6 +2059,10 @@ make_socket_io(const char *host, int port, int domain, int fd)
 	s = FTH_MALLOC(sizeof(FIO_Socket));
 	s->fd = fd;
 	s->host = fth_make_string(host);
+	s->eof_p = 0;
+	s->rpos = s->rlen = s->wlen = 0;
+	s->line = NULL;
+	s->line_size = 0;
 	io = make_io_base(FICL_FAM_READ | FICL_FAM_WRITE);
 	FTH_IO_TYPE(io) = FTH_IO_SOCKET;
 	FTH_IO_FILENAME(io) = s->host;
@@ -1891,6 +2075,7 @@ make_socket_io(const char *host, int port, int domain, int fd)
 	FTH_IO_OBJECT(io)->eof_p = socket_eof_p;
 	FTH_IO_OBJECT(io)->tell = socket_tell;
 	FTH_IO_OBJECT(io)->seek = socket_seek;
+	FTH_IO_OBJECT(io)->flush = socket_flush;
 	FTH_IO_OBJECT(io)->rewind = socket_rewind;
 	FTH_IO_OBJECT(io)->close = socket_close;
 	return (io);
@@ -2779,6 +2964,118 @@ fth_readlines(const char *name)
 	return (array);
 }
 
+/*
+ * Line reader for load_file() and the implicit-loop options of fth(1).
+ * The file (or stdin if NAME is NULL) is read in blocks of BLOCK bytes
+ * and every line is copied into one reused buffer; no Fth objects are
+ * created.
+ */
+FLineReader *
+fth_line_reader_open(const char *name, size_t block)
+{
+	FLineReader    *rd;
+	int 		fd;
+
+	if (name == NULL)
+		fd = STDIN_FILENO;
+	else {
+		fd = open(name, O_RDONLY);
+
+		/* without exception handler fth_throw() returns */
+		if (fd == -1) {
+			IO_FILE_ERROR_ARG(open, name);
+			return (NULL);
+		}
+	}
+	rd = FTH_MALLOC(sizeof(FLineReader));
+	rd->fd = fd;
+	rd->size = 128;
+	rd->line = FTH_MALLOC(rd->size);
+	rd->block = FTH_MALLOC(block);
+	rd->block_size = block;
+	rd->pos = rd->end = rd->block;
+	rd->remain = -1;
+	return (rd);
+}
+
+/*
+ * Restrict RD to LEN bytes starting at offset START.  START should be
+ * the beginning of a line.
+ */
+void
+fth_line_reader_range(FLineReader *rd, off_t start, off_t len)
+{
+	if (lseek(rd->fd, start, SEEK_SET) == -1)
+		IO_FILE_ERROR(lseek);
+
+	rd->pos = rd->end = rd->block;
+	rd->remain = len;
+}
+
+void
+fth_line_reader_close(FLineReader *rd)
+{
+	if (rd->fd != STDIN_FILENO)
+		close(rd->fd);
+
+	FTH_FREE(rd->block);
+	FTH_FREE(rd->line);
+	FTH_FREE(rd);
+}
+
+/*
+ * Read the next line including its newline into RD->LINE and return
+ * its length or 0 at end of file.  Lines have no length limit.
+ */
+size_t
+fth_line_reader_next(FLineReader *rd)
+{
+	char           *nl;
+	size_t 		len, n;
+	ssize_t 	got;
+
+	len = 0;
+
+	for (;;) {
+		if (rd->pos == rd->end) {
+			n = rd->block_size;
+
+			if (rd->remain >= 0 && (off_t) n > rd->remain)
+				n = (size_t) rd->remain;
+
+			if (n == 0)
+				break;
+
+			got = read(rd->fd, rd->block, n);
+
+			if (got <= 0)
+				break;
+
+			if (rd->remain >= 0)
+				rd->remain -= got;
+			rd->pos = rd->block;
+			rd->end = rd->block + got;
+		}
+		nl = memchr(rd->pos, '\n', (size_t) (rd->end - rd->pos));
+		n = (nl != NULL ? (size_t) (nl + 1 - rd->pos) :
+		    (size_t) (rd->end - rd->pos));
+
+		if (len + n >= rd->size) {
+			while (len + n >= rd->size)
+				rd->size *= 2;
+			rd->line = FTH_REALLOC(rd->line, rd->size);
+		}
+		memcpy(rd->line + len, rd->pos, n);
+		len += n;
+		rd->pos += n;
+
+		if (nl != NULL)
+			break;
+	}
+	rd->line[len] = '\0';
+	return (len);
+}
+
 static void
 ficl_readlines(ficlVm *vm)
 {
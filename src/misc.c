@@ -161,6 +161,7 @@ static FTH 	load_file(const char *, const char *);
 #if defined(HAVE_DLOPEN)
 static FTH	load_lib(const char *, const char *, const char *);
 #endif
+static void 	load_pop(void);
 static void 	run_at_exit(void);
 static void 	set_and_show_signal_backtrace(int);
 
@@ -177,12 +178,42 @@ exit_cb 	fth_exit_hook;
 
 #if !defined(_WIN32)
 sigjmp_buf 	fth_sig_toplevel;
+int 		fth_toplevel_p;		/* fth_sig_toplevel is set */
+jmp_buf        *fth_toplevel_catch;	/* exception handler outside */
+volatile sig_atomic_t fth_signal_pending;
 
+/*
+ * While Forth code runs, interrupts only set fth_signal_pending; the
+ * inner interpreter checks it on branches and calls.  A second
+ * interrupt before that, e.g. while waiting in a system call, and
+ * faults jump to the outermost fth_execute_xt() or fth_evaluate().
+ */
 static RETSIGTYPE
 fth_toplevel_handler(int sig)
 {
+	if (fth_signal_pending == 0 &&
+	    FTH_FICL_VM()->exceptionHandler != NULL &&
+	    (sig == SIGINT || sig == SIGQUIT || sig == SIGUSR1)) {
+		fth_signal_pending = sig;
+		return;
+	}
 	siglongjmp(fth_sig_toplevel, sig);
 }
+
+/*
+ * Called by the inner interpreter for a pending interrupt; aborts the
+ * running code if signal_check() doesn't exit.
+ */
+void
+fth_signal_deliver(ficlVm *vm)
+{
+	int 		sig;
+
+	sig = (int) fth_signal_pending;
+	fth_signal_pending = 0;
+	signal_check(sig);
+	ficlVmThrow(vm, FICL_VM_STATUS_ABORT);
+}
 #endif
 
 #if !defined(HAVE_SIG_T)
@@ -216,8 +247,10 @@ set_and_show_signal_backtrace(int kind)
 		break;
 	case EXIT_ABORT:
 	default:
-		if (fth_die_on_signal_p || !fth_interactive_p)
+		if (fth_die_on_signal_p || !fth_interactive_p) {
+			fth_port_flush_output();
 			abort();
+		}
 		break;
 	}
 }
@@ -348,9 +381,21 @@ static FTH 	before_load_hook;
 static FTH 	after_load_hook;
 static FTH 	eval_string;
 static FTH 	fth_at_exit_procs;
+static int 	require_p;	/* set by fth_require_file() for load_file() */
 static simple_array *depth_array;
 static simple_array *loop_array;
 
+/* files being read by load_file(), innermost first */
+typedef struct FLoad {
+	FLineReader    *rd;
+	void           *unit;	/* fth_load_cache_begin() */
+	FTH 		old_file;
+	ficlInteger 	old_line;
+	struct FLoad   *outer;
+} FLoad;
+
+static FLoad   *load_stack;
+
 static char 	misc_scratch[MAXPATHLEN];
 static char 	misc_scratch_02[MAXPATHLEN];
 static char 	misc_scratch_03[MAXPATHLEN];
@@ -481,6 +526,7 @@ forth_pre_init(void)
 	init_io_type();
 	init_hook_type();
 	init_string_type();
+	init_vector_type();
 	init_regexp_type();
 	init_number_types();
 	b_istr_false = fth_gc_permanent(fth_make_string(B_ISTR_FALSE));
@@ -608,6 +654,8 @@ after-load-hook lambda: <{ fname -- }>\n\
 	init_regexp();
 	init_symbol();
 	init_utils();
+	init_vector();
+	init_image();
 	fth_define_variable("*fth-verbose*", FTH_FALSE, NULL);
 	fth_define_variable("*fth-debug*", FTH_FALSE, NULL);
 	fth_current_file = fth_make_string("-");
@@ -690,6 +738,7 @@ fth_exit(int n)
 {
 	if (fth_exit_hook != NULL)
 		(*fth_exit_hook) (n);
+	fth_port_flush_output();
 	exit(n);
 }
 
@@ -703,9 +752,7 @@ fth_catch_exec(ficlWord *word)
 	if (word == NULL)
 		return (FTH_OKAY);
 
-	gc_push(word);
-	status = ficlVmExecuteXT(FTH_FICL_VM(), word);
-	gc_pop();
+	status = fth_execute_xt(FTH_FICL_VM(), word);
 
 	switch (status) {
 	case FICL_VM_STATUS_INNER_EXIT:
@@ -745,7 +792,7 @@ fth_catch_eval(const char *buffer)
 	buf = FTH_STRDUP(buffer);
 	FICL_STRING_SET_FROM_CSTRING(s, buf);
 	gc_push(vm->runningWord);
-	status = ficlVmExecuteString(vm, s);
+	status = fth_execute_string(vm, s);
 	gc_pop();
 	FTH_FREE(buf);
 	vm->sourceId = id;
@@ -962,6 +1009,7 @@ void
 fth_add_load_path(const char *path)
 {
 	ADD_TO_LOAD_PATH(load_path, push, path);
+	fth_load_cache_taint();
 }
 
 /*
@@ -972,6 +1020,7 @@ void
 fth_unshift_load_path(const char *path)
 {
 	ADD_TO_LOAD_PATH(load_path, unshift, path);
+	fth_load_cache_taint();
 }
 
 /*
@@ -982,6 +1031,7 @@ void
 fth_add_load_lib_path(const char *path)
 {
 	ADD_TO_LOAD_PATH(load_lib_path, push, path);
+	fth_load_cache_taint();
 }
 
 /*
@@ -992,6 +1042,7 @@ void
 fth_unshift_load_lib_path(const char *path)
 {
 	ADD_TO_LOAD_PATH(load_lib_path, unshift, path);
+	fth_load_cache_taint();
 }
 
 /*
@@ -1050,6 +1101,46 @@ Prepend string PATH to *load-lib-path* array if not already there."
 	fth_current_line = old_line;					\
 } while (0)
 
+/* Close the reader of the innermost file being loaded. */
+static void
+load_pop(void)
+{
+	FLoad          *ld;
+
+	ld = load_stack;
+	load_stack = ld->outer;
+	fth_line_reader_close(ld->rd);
+	FTH_FREE(ld);
+}
+
+/*
+ * Return the innermost file being loaded for fth_load_unwind().
+ */
+void           *
+fth_load_mark(void)
+{
+	return (load_stack);
+}
+
+/*
+ * A signal jumps from the depths to the outermost execute_toplevel()
+ * and leaves load_file() calls without return.  Close their readers
+ * and drop their cache units down to MARK from fth_load_mark().
+ */
+void
+fth_load_unwind(void *mark)
+{
+	FLoad          *ld;
+
+	while (load_stack != NULL && load_stack != mark) {
+		ld = load_stack;
+		fth_current_file = ld->old_file;
+		fth_current_line = ld->old_line;
+		fth_load_cache_end(ld->unit, 0);
+		load_pop();
+	}
+}
+
 /*-
  * load_file(name, caller)
  *
@@ -1068,14 +1159,22 @@ static FTH
 load_file(const char *name, const char *caller)
 {
 	ficlVm         *vm;
-	ficlInteger 	old_line, len, i, status;
-	FTH 		fname, old_file, content, ret, fs;
+	ficlInteger 	old_line, status;
+	FTH 		fname, old_file, ret, fs;
 	ficlCell 	old_source_id;
 	ficlString 	s;
+	FLineReader    *rd;
+	FLoad          *ld;
+	size_t 		len;
+	void           *unit;
+	int 		cache_p;
 
 	if (name == NULL)
 		return (FTH_FALSE);
 
+	cache_p = require_p;
+	require_p = 0;
+
 	fname = fth_make_string(name);
 
 	if (!fth_hook_empty_p(before_load_hook)) {
@@ -1083,21 +1182,44 @@ load_file(const char *name, const char *caller)
 		if (FTH_FALSE_P(ret))
 			return (FTH_FALSE);
 	}
+	/*
+	 * Restore required files from the load cache (see image.c);
+	 * scripts are run for their side effects and always read.
+	 */
+	unit = NULL;
+	if (cache_p && fth_load_cache_begin(name, &unit)) {
+		if (!fth_hook_empty_p(after_load_hook))
+			fth_run_hook(after_load_hook, 1, fname);
+		return (FTH_TRUE);
+	}
 	old_line = fth_current_line;
 	old_file = fth_current_file;
-	content = fth_readlines(name);
-	len = fth_array_length(content);
+	rd = fth_line_reader_open(name, FTH_LOAD_BLOCK_SIZE);
+
+	if (rd == NULL) {
+		fth_load_cache_end(unit, 0);
+		return (FTH_FALSE);
+	}
+	ld = FTH_MALLOC(sizeof(FLoad));
+	ld->rd = rd;
+	ld->unit = unit;
+	ld->old_file = old_file;
+	ld->old_line = old_line;
+	ld->outer = load_stack;
+	load_stack = ld;
 	vm = FTH_FICL_VM();
 	old_source_id = vm->sourceId;
 	fth_current_file = fname;
 	CELL_VOIDP_SET(&vm->sourceId, name);
 	fth_add_loaded_files(name);
 
-	for (i = 0; i < len; i++) {
-		fth_current_line = i + 1;
-		FICL_STRING_SET_FROM_CSTRING(s,
-		    fth_string_ref(fth_array_fast_ref(content, i)));
-		status = ficlVmExecuteString(vm, s);
+	fth_current_line = 0;
+
+	while ((len = fth_line_reader_next(rd)) > 0) {
+		fth_current_line++;
+		FICL_STRING_SET_POINTER(s, rd->line);
+		FICL_STRING_SET_LENGTH(s, len);
+		status = fth_execute_string(vm, s);
 
 		switch (status) {
 		case FICL_VM_STATUS_INNER_EXIT:
@@ -1108,16 +1230,22 @@ load_file(const char *name, const char *caller)
 			continue;
 			break;
 		case FICL_VM_STATUS_SKIP_FILE:
+			load_pop();
+			fth_load_cache_end(unit, 1);
 			FINISH_LOAD();
 			return (FTH_TRUE);
 			break;
 		case FICL_VM_STATUS_USER_EXIT:
+			load_pop();
+			fth_load_cache_end(unit, 0);
 			FINISH_LOAD();
 			fth_exit(EXIT_SUCCESS);
 			break;
 		default:
 			fs = fth_make_string_format("%S at line %ld",
 			    fth_current_file, fth_current_line);
+			load_pop();
+			fth_load_cache_end(unit, 0);
 			FINISH_LOAD();
 			fth_throw(ficl_ans_real_exc((int) status),
 			    "%s: can't load file %S", caller, fs);
@@ -1127,9 +1255,11 @@ load_file(const char *name, const char *caller)
 		}
 	}
 
+	load_pop();
 	CELL_INT_SET(&vm->sourceId, -1);
 	FICL_STRING_SET_FROM_CSTRING(s, "");
 	ficlVmExecuteString(vm, s);
+	fth_load_cache_end(unit, 1);
 
 	if (!fth_hook_empty_p(after_load_hook))
 		fth_run_hook(after_load_hook, 1, fname);
@@ -1295,7 +1425,10 @@ fth_require_file(const char *name)
 	if (FTH_STRING_P(fth_find_file(fs)))
 		return (FTH_TRUE);
 
-	return (fth_load_file(name));
+	require_p = 1;
+	fs = fth_load_file(name);
+	require_p = 0;
+	return (fs);
 }
 
 static void
@@ -2818,6 +2951,7 @@ See also exec."
 	proc_or_xt = fth_pop_ficl_cell(vm);
 	proc = proc_from_proc_or_xt(proc_or_xt, 0, 0, 0);
 	FTH_ASSERT_ARGS(FTH_PROC_P(proc), proc, FTH_ARG1, "a proc");
+	fth_port_flush_output();
 	pid = fork();
 
 	if (pid == -1)
@@ -2851,6 +2985,7 @@ See also fork."
 	cmd = fth_pop_ficl_cell(vm);
 	FTH_ASSERT_ARGS(FTH_STRING_P(cmd) || FTH_ARRAY_P(cmd),
 	    cmd, FTH_ARG1, "a string or an array of strings");
+	fth_port_flush_output();
 
 	/* cmd == string: execute shell expansion */
 	if (FTH_STRING_P(cmd)) {
@@ -3477,6 +3612,8 @@ See atexit(3) for more information."
 		fth_array_push(fth_at_exit_procs, proc);
 	else
 		fth_at_exit_procs = fth_make_array_var(1, proc);
+
+	fth_load_cache_taint();
 }
 
 static void
@@ -3758,27 +3895,6 @@ forth_init(void)
 	if (atexit(run_at_exit) == -1)
 		FTH_SYSTEM_ERROR_THROW(atexit);
 
-	/* Load Ficl source files. */
-	{
-		char           *sf[] = {
-			"softcore.fr",
-			"ifbrack.fr",
-			"prefix.fr",
-			"ficl.fr",
-			"jhlocal.fr",
-			"marker.fr",
-			"fileaccess.fr",
-			"assert.fs",
-			"compat.fs",
-			NULL};
-		char          **softcore = sf;
-
-		while (*softcore) {
-			fth_var_set(fth_last_exception, FTH_FALSE);
-			fth_require_file(*softcore++);
-		}
-	}
-
 	/* constants */
 	fth_define_constant("cell", sizeof(ficlCell), NULL);
 	fth_define_constant("float", sizeof(ficlFloat), NULL);
@@ -4004,39 +4120,70 @@ forth_init(void)
 	FTH_SET_CONSTANT(SIGTHR);	/* Thread interrupt. */
 #endif
 
-	/* >array, >assoc, >list, >hash */
-	loop_begin = FICL_WORD_NAME_REF("begin");
-	loop_until = FICL_WORD_NAME_REF("until");
-	set_begin_paren = ficlDictionaryAppendPrimitive(dict,
-	    "(set-begin)", ficl_set_begin_paren, FICL_WORD_DEFAULT);
-	set_end_paren = ficlDictionaryAppendPrimitive(dict,
-	    "(set-end)", ficl_set_end_paren, FICL_WORD_DEFAULT);
-	FTH_PRI1("#(", ficl_begin_array, NULL);
-	FTH_PRI1("array(", ficl_begin_array, NULL);
-	FTH_PRI1("#a(", ficl_begin_assoc, NULL);
-	FTH_PRI1("assoc(", ficl_begin_assoc, NULL);
-	FTH_PRI1("'(", ficl_begin_list, NULL);
-	FTH_PRI1("list(", ficl_begin_list, NULL);
-	FTH_PRI1("'a(", ficl_begin_alist, NULL);
-	FTH_PRI1("alist(", ficl_begin_alist, NULL);
-	FTH_PRI1("#{", ficl_begin_hash, NULL);
-	FTH_PRI1("hash{", ficl_begin_hash, NULL);
-	FTH_PRI1(")", ficl_values_end, NULL);
-	FTH_PRI1("}", ficl_values_end, NULL);
-
-	/* each/map */
-	FTH_PRI1("(set-each-loop)", ficl_set_each_loop_paren,
-	    h_set_each_l_paren);
-	FTH_PRI1("(set-map-loop)", ficl_set_each_loop_paren,
-	    h_set_map_l_paren);
-	FTH_PRI1("(set-map!-loop)", ficl_set_map_loop_paren,
-	    h_set_map_l_paren);
-	FTH_PRI1("(reset-each)", ficl_reset_each_paren, h_re_each_paren);
-	FTH_PRI1("(reset-map)", ficl_reset_map_paren, h_re_map_paren);
-	FTH_PRI1("(fetch)", ficl_fetch_paren, h_fetch_paren);
-	FTH_PRI1("(store)", ficl_store_paren, h_store_paren);
-
-	fth_require_file("fth.fs");
+	/*
+	 * Load Ficl and Fth source files or restore the dictionary they
+	 * create from an image (see image.c).
+	 */
+	if (!fth_image_load()) {
+		char           *sf[] = {
+			"softcore.fr",
+			"ifbrack.fr",
+			"prefix.fr",
+			"ficl.fr",
+			"jhlocal.fr",
+			"marker.fr",
+			"fileaccess.fr",
+			"assert.fs",
+			"compat.fs",
+			NULL};
+		char          **softcore = sf;
+
+		while (*softcore) {
+			fth_var_set(fth_last_exception, FTH_FALSE);
+			fth_require_file(*softcore++);
+		}
+
+		/* >array, >assoc, >list, >hash */
+		loop_begin = FICL_WORD_NAME_REF("begin");
+		loop_until = FICL_WORD_NAME_REF("until");
+		set_begin_paren = ficlDictionaryAppendPrimitive(dict,
+		    "(set-begin)", ficl_set_begin_paren, FICL_WORD_DEFAULT);
+		set_end_paren = ficlDictionaryAppendPrimitive(dict,
+		    "(set-end)", ficl_set_end_paren, FICL_WORD_DEFAULT);
+		FTH_PRI1("#(", ficl_begin_array, NULL);
+		FTH_PRI1("array(", ficl_begin_array, NULL);
+		FTH_PRI1("#a(", ficl_begin_assoc, NULL);
+		FTH_PRI1("assoc(", ficl_begin_assoc, NULL);
+		FTH_PRI1("'(", ficl_begin_list, NULL);
+		FTH_PRI1("list(", ficl_begin_list, NULL);
+		FTH_PRI1("'a(", ficl_begin_alist, NULL);
+		FTH_PRI1("alist(", ficl_begin_alist, NULL);
+		FTH_PRI1("#{", ficl_begin_hash, NULL);
+		FTH_PRI1("hash{", ficl_begin_hash, NULL);
+		FTH_PRI1(")", ficl_values_end, NULL);
+		FTH_PRI1("}", ficl_values_end, NULL);
+
+		/* each/map */
+		FTH_PRI1("(set-each-loop)", ficl_set_each_loop_paren,
+		    h_set_each_l_paren);
+		FTH_PRI1("(set-map-loop)", ficl_set_each_loop_paren,
+		    h_set_map_l_paren);
+		FTH_PRI1("(set-map!-loop)", ficl_set_map_loop_paren,
+		    h_set_map_l_paren);
+		FTH_PRI1("(reset-each)", ficl_reset_each_paren,
+		    h_re_each_paren);
+		FTH_PRI1("(reset-map)", ficl_reset_map_paren, h_re_map_paren);
+		FTH_PRI1("(fetch)", ficl_fetch_paren, h_fetch_paren);
+		FTH_PRI1("(store)", ficl_store_paren, h_store_paren);
+
+		fth_require_file("fth.fs");
+	} else {
+		/* the image contains the words above */
+		loop_begin = FICL_WORD_NAME_REF("begin");
+		loop_until = FICL_WORD_NAME_REF("until");
+		set_begin_paren = FICL_WORD_NAME_REF("(set-begin)");
+		set_end_paren = FICL_WORD_NAME_REF("(set-end)");
+	}
 #if defined(HAVE_TZSET)
 	tzset();
 #endif
@@ -878,6 +878,34 @@ ll_equal_p(FTH self, FTH obj)
 	return (BOOL_TO_FTH(FTH_LONG_OBJECT(self) == FTH_LONG_OBJECT(obj)));
 }
 
+/*
+ * FNV-1a over the bytes of a number; unlike fth_hash_bytes it doesn't
+ * stop at '\0'.
+ */
+static ficlUnsigned
+number_hash_bytes(const void *p, size_t len)
+{
+	const unsigned char *s;
+	ficlUnsigned 	h;
+
+	h = 2166136261UL;
+
+	for (s = p; len > 0; s++, len--) {
+		h ^= *s;
+		h *= 16777619UL;
+	}
+	return (h);
+}
+
+static FTH
+ll_hash(FTH self)
+{
+	ficl2Integer 	d;
+
+	d = FTH_LONG_OBJECT(self);
+	return (FTH_HASH_ID_TO_FIX(number_hash_bytes(&d, sizeof(d))));
+}
+
 FTH
 fth_make_llong(ficl2Integer d)
 {
@@ -1832,6 +1860,22 @@ fl_equal_p(FTH self, FTH obj)
 	return (BOOL_TO_FTH(FTH_FLOAT_OBJECT(self) == FTH_FLOAT_OBJECT(obj)));
 }
 
+static ficlUnsigned
+float_hash(ficlFloat f)
+{
+	/* 0.0 and -0.0 are equal but differ in their sign bit. */
+	if (f == 0.0)
+		f = 0.0;
+
+	return (number_hash_bytes(&f, sizeof(f)));
+}
+
+static FTH
+fl_hash(FTH self)
+{
+	return (FTH_HASH_ID_TO_FIX(float_hash(FTH_FLOAT_OBJECT(self))));
+}
+
 /*
  * Return a FTH float object from F.
  */
@@ -2203,6 +2247,14 @@ cp_equal_p(FTH self, FTH obj)
 		FTH_COMPLEX_IMAG(self) == FTH_COMPLEX_IMAG(obj)));
 }
 
+static FTH
+cp_hash(FTH self)
+{
+	return (FTH_HASH_ID_TO_FIX(fth_hash_combine(
+	    float_hash(FTH_COMPLEX_REAL(self)),
+	    float_hash(FTH_COMPLEX_IMAG(self)))));
+}
+
 #endif				/* HAVE_COMPLEX */
 
 static void
@@ -4511,6 +4563,7 @@ init_number_types(void)
 	fth_set_object_to_string(llong_tag, ll_to_string);
 	fth_set_object_copy(llong_tag, ll_copy);
 	fth_set_object_equal_p(llong_tag, ll_equal_p);
+	fth_set_object_hash(llong_tag, ll_hash);
 
 	/* init float */
 	float_tag = make_object_number_type(FTH_STR_FLOAT,
@@ -4519,6 +4572,7 @@ init_number_types(void)
 	fth_set_object_to_string(float_tag, fl_to_string);
 	fth_set_object_copy(float_tag, fl_copy);
 	fth_set_object_equal_p(float_tag, fl_equal_p);
+	fth_set_object_hash(float_tag, fl_hash);
 
 #if HAVE_COMPLEX
 	/* complex */
@@ -4528,6 +4582,7 @@ init_number_types(void)
 	fth_set_object_to_string(complex_tag, cp_to_string);
 	fth_set_object_copy(complex_tag, cp_copy);
 	fth_set_object_equal_p(complex_tag, cp_equal_p);
+	fth_set_object_hash(complex_tag, cp_hash);
 #endif				/* HAVE_COMPLEX */
 
 #if HAVE_BN
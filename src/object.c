@@ -56,6 +56,7 @@ typedef enum {
 #define FTH_VALUE_REF_P(Obj)	FTH_INSTANCE_REF_OBJ(Obj)->value_ref
 #define FTH_VALUE_SET_P(Obj)	FTH_INSTANCE_REF_OBJ(Obj)->value_set
 #define FTH_EQUAL_P_P(Obj)	FTH_INSTANCE_REF_OBJ(Obj)->equal_p
+#define FTH_HASH_ID_P(Obj)	FTH_INSTANCE_REF_OBJ(Obj)->hash
 #define FTH_LENGTH_P(Obj)	FTH_INSTANCE_REF_OBJ(Obj)->length
 
 #define FTH_INSPECT(Obj)	(*FTH_INSPECT_P(Obj))(Obj)
@@ -67,31 +68,129 @@ typedef enum {
 #define FTH_VALUE_SET(Obj, Idx, Val) 					\
 	(*FTH_VALUE_SET_P(Obj))(Obj, Idx, Val)
 #define FTH_EQUAL_P(Obj1, Obj2)	(*FTH_EQUAL_P_P(Obj1))(Obj1, Obj2)
+#define FTH_HASH_ID(Obj)	(*FTH_HASH_ID_P(Obj))(Obj)
 #define FTH_LENGTH(Obj)		(*FTH_LENGTH_P(Obj))(Obj)
 
 #define OBJ_CHUNK_SIZE		64
 #define GC_CHUNK_SIZE		(1024 * 8)
 #define GC_MAX_OBJECTS		(GC_CHUNK_SIZE * 4)
+#define GC_MAJOR_INTERVAL	8	/* minor collections per major one */
+#define GC_SWEEP_STEP		8	/* slots swept per allocation */
+#define GC_IMMORTAL_INTERVAL	4	/* major collections per rebuild */
+#define GC_PAUSE_BUCKETS	5	/* < 0.1, 1, 10, 100 ms and more */
 
 #define GC_FREED		1
-#define GC_MARK			2
 #define GC_PROTECT		4
 #define GC_PERMANENT		8
 
-#define GC_MARK_SET(inst)	((inst)->gc_mark |=  GC_MARK)
-#define GC_MARK_CLR(inst)	((inst)->gc_mark &= ~GC_MARK)
-#define GC_PROTECT_SET(inst)	((inst)->gc_mark |=  GC_PROTECT)
-#define GC_PROTECT_CLR(inst)	((inst)->gc_mark &= ~GC_PROTECT)
-#define GC_PERMANENT_SET(inst)	((inst)->gc_mark |=  GC_PERMANENT)
-#define GC_ANY_MARK_P(inst)	((inst)->gc_mark  >  GC_FREED)
-#define GC_MARKED_P(inst)	((inst)->gc_mark  &  GC_MARK)
+/*
+ * Instances live in slabs of GC_CHUNK_SIZE entries.  The gc-mark
+ * flags are kept in a bitmap beside each slab, indexed by
+ * FInstance->slot.
+ */
+#define GC_MARK_BITS		(sizeof(ficlUnsigned) * 8)
+#define GC_MARK_WORD(inst)						\
+	inst_slabs[(inst)->slot / GC_CHUNK_SIZE].marks[			\
+	    ((inst)->slot % GC_CHUNK_SIZE) / GC_MARK_BITS]
+#define GC_MARK_BIT(inst)						\
+	((ficlUnsigned) 1 << ((inst)->slot % GC_MARK_BITS))
+
+#define GC_YOUNG_SET(inst)						\
+	(inst_slabs[(inst)->slot / GC_CHUNK_SIZE].young[			\
+	    ((inst)->slot % GC_CHUNK_SIZE) / GC_MARK_BITS] |=		\
+	    GC_MARK_BIT(inst))
+
+#define GC_MARK_SET(inst)	(GC_MARK_WORD(inst) |=  GC_MARK_BIT(inst))
+#define GC_MARK_CLR(inst)	(GC_MARK_WORD(inst) &= ~GC_MARK_BIT(inst))
+#define GC_PINNED_WORD(inst)						\
+	inst_slabs[(inst)->slot / GC_CHUNK_SIZE].pinned[		\
+	    ((inst)->slot % GC_CHUNK_SIZE) / GC_MARK_BITS]
+#define GC_PINNED_CLR(inst)	(GC_PINNED_WORD(inst) &= ~GC_MARK_BIT(inst))
+#define GC_PLAIN_WORD(inst)						\
+	inst_slabs[(inst)->slot / GC_CHUNK_SIZE].plain[			\
+	    ((inst)->slot % GC_CHUNK_SIZE) / GC_MARK_BITS]
+#define GC_PLAIN_SET(inst)	(GC_PLAIN_WORD(inst) |=  GC_MARK_BIT(inst))
+#define GC_PLAIN_CLR(inst)	(GC_PLAIN_WORD(inst) &= ~GC_MARK_BIT(inst))
+#define GC_PROTECT_SET(inst) do {					\
+	(inst)->gc_mark |= GC_PROTECT;					\
+	GC_PINNED_WORD(inst) |= GC_MARK_BIT(inst);			\
+} while (0)
+#define GC_PROTECT_CLR(inst) do {					\
+	(inst)->gc_mark &= ~GC_PROTECT;					\
+									\
+	if (!GC_PERMANENT_P(inst))					\
+		GC_PINNED_CLR(inst);					\
+} while (0)
+#define GC_PERMANENT_SET(inst) do {					\
+	(inst)->gc_mark |= GC_PERMANENT;				\
+	inst_slabs[(inst)->slot / GC_CHUNK_SIZE].permanent[		\
+	    ((inst)->slot % GC_CHUNK_SIZE) / GC_MARK_BITS] |=		\
+	    GC_MARK_BIT(inst);						\
+	GC_PINNED_WORD(inst) |= GC_MARK_BIT(inst);			\
+} while (0)
+#define GC_MARKED_P(inst)	(GC_MARK_WORD(inst) &   GC_MARK_BIT(inst))
+#define GC_IMMORTAL_P(inst)						\
+	(inst_slabs[(inst)->slot / GC_CHUNK_SIZE].immortal[		\
+	    ((inst)->slot % GC_CHUNK_SIZE) / GC_MARK_BITS] &		\
+	    GC_MARK_BIT(inst))
 #define GC_PROTECTED_P(inst)	((inst)->gc_mark  &  GC_PROTECT)
 #define GC_PERMANENT_P(inst)	((inst)->gc_mark  &  GC_PERMANENT)
 
-#define GC_FREED_SET(inst)	((inst)->gc_mark  = GC_FREED)
+/* Index of the lowest set bit of the nonzero mark word BITS. */
+#if defined(__GNUC__)
+#define GC_FIRST_BIT(bits)	((ficlUnsigned) __builtin_ctzl(bits))
+#define GC_BIT_COUNT(bits)	__builtin_popcountl(bits)
+#else
+#define GC_FIRST_BIT(bits)	gc_first_bit(bits)
+#define GC_BIT_COUNT(bits)	gc_bit_count(bits)
+#endif
+
+#define GC_FREED_SET(inst) do {						\
+	(inst)->gc_mark = GC_FREED;					\
+	GC_PINNED_CLR(inst);						\
+} while (0)
 #define GC_FREED_P(inst)	((inst)->gc_mark == GC_FREED)
 
+typedef struct {
+	FInstance      *insts;	/* GC_CHUNK_SIZE instances */
+	ficlUnsigned 	marks[GC_CHUNK_SIZE / GC_MARK_BITS];
+	ficlUnsigned 	young[GC_CHUNK_SIZE / GC_MARK_BITS];	/* new */
+	ficlUnsigned 	aged[GC_CHUNK_SIZE / GC_MARK_BITS];	/* 1 gc old */
+	ficlUnsigned 	touched[GC_CHUNK_SIZE / GC_MARK_BITS];	/* last gc */
+	ficlUnsigned 	live[GC_CHUNK_SIZE / GC_MARK_BITS];	/* to sweep */
+	ficlUnsigned 	permanent[GC_CHUNK_SIZE / GC_MARK_BITS];
+	ficlUnsigned 	pinned[GC_CHUNK_SIZE / GC_MARK_BITS];	/* gc_mark */
+	ficlUnsigned 	plain[GC_CHUNK_SIZE / GC_MARK_BITS];	/* no free */
+	ficlUnsigned 	pooled[GC_CHUNK_SIZE / GC_MARK_BITS];	/* dead plain */
+	ficlUnsigned 	immortal[GC_CHUNK_SIZE / GC_MARK_BITS];	/* reachable */
+} FSlab;
+
+/*
+ * The slab registry maps address regions to slabs.  A region is not
+ * larger than a slab, so it overlaps at most two slabs.
+ */
+typedef struct {
+	ficlUnsigned 	region;	/* address >> inst_region_shift */
+	FInstance      *base[2];
+} FSlabRegion;
+
 #define gc_frame_level		FTH_FICL_VM()->gc_frame_level
+/* gc-statistics, times in seconds */
+typedef struct {
+	ficlUnsigned 	minor;		/* collections */
+	ficlUnsigned 	major;
+	ficlUnsigned 	pauses[GC_PAUSE_BUCKETS];
+	double 		pause;
+	double 		pause_last;
+	double 		pause_max;
+	double 		mark;
+	double 		mark_last;
+	double 		sweep;
+	double 		sweep_last;
+	ficlInteger 	live;		/* instances in use */
+	ficlInteger 	live_max;
+} FGcStats;
+
 #define GC_FRAME_WORD(Idx)	FTH_FICL_VM()->gc_word[Idx]
 #define GC_FRAME_INST(Idx)	FTH_FICL_VM()->gc_inst[Idx]
 #define GC_FRAME_CURRENT_WORD()	GC_FRAME_WORD(gc_frame_level)
@@ -153,8 +252,29 @@ static void 	ficl_third_object_set(ficlVm *);
 static void 	ficl_true_p(ficlVm *);
 static void 	ficl_undef_p(ficlVm *);
 static void 	ficl_xmobj_p(ficlVm *);
+static void 	gc_add_slab(void);
+static void 	gc_account_pause(double);
+static void 	gc_account_phases(double, double);
+static void 	gc_immortal_trace(int);
+static int 	gc_major(int);
+static void 	gc_mark_roots(void);
+static int 	gc_minor(void);
 static FInstance *gc_next_instance(void);
 static FInstance *gc_run(void);
+static int 	gc_sweep(int);
+static double 	gc_time(void);
+#if !defined(__GNUC__)
+static int 	gc_bit_count(ficlUnsigned);
+static ficlUnsigned gc_first_bit(ficlUnsigned);
+#endif
+static FInstance *gc_pool_next(void);
+static int 	gc_pool_add(FSlab *, int, ficlUnsigned);
+static void 	gc_pool_settle(void);
+static void 	gc_touched_set(void);
+static FSlabRegion *inst_region_find(ficlUnsigned);
+static void 	inst_region_add(ficlUnsigned, FInstance *);
+static int 	inst_slab_member_p(FInstance *);
+static void 	inst_slab_register(FInstance *);
 static FTH	print_object(FTH, fth_inspect_type_t);
 static int	xmobj_p(FTH);
 static FTH	xmobj_to_string(FTH);
@@ -178,6 +298,7 @@ gc-protect          ( obj -- obj )\n\
 gc-protected-objects ( -- ary )\n\
 gc-protected?       ( obj -- f )\n\
 gc-run              ( -- )\n\
+gc-statistics       ( -- hash )\n\
 gc-stats            ( -- )\n\
 gc-unmark           ( obj -- obj )\n\
 gc-unprotect        ( obj -- obj )\n\
@@ -199,6 +320,7 @@ set-object-copy     ( xt obj -- )\n\
 set-object-dump     ( xt obj -- )\n\
 set-object-equal-p  ( xt obj -- )\n\
 set-object-free     ( xt obj -- )\n\
+set-object-hash     ( xt obj -- )\n\
 set-object-inspect  ( xt obj -- )\n\
 set-object-length   ( xt obj -- )\n\
 set-object-mark     ( xt obj -- )\n\
@@ -460,10 +582,30 @@ static FObject **obj_types;
 static int 	last_object = 0;
 
 static FInstance *inst_free_list = NULL;
-static FInstance *inst_minmem = (void *) 1;
-static FInstance *inst_maxmem = NULL;
-static FInstance **instances;
+static FSlab   *inst_slabs;
+static int 	inst_slab_count = 0;
 static int 	last_instance = 0;
+static int 	gc_minor_count = 0;	/* minor collections since major */
+static int 	gc_major_p = 0;		/* next collection is a major one */
+static int 	gc_sweep_slot = 0;	/* incremental sweep position */
+static int 	gc_sweep_end = 0;
+static ficlUnsigned gc_pool_word = 0;	/* first pool word in use */
+static ficlInteger gc_pool_count = 0;	/* pooled instances */
+static int 	gc_immortal_count = 0;	/* majors since immortal rebuild */
+static int 	gc_immortal_tracing = 0;	/* fth_gc_mark() target */
+static int 	gc_immortal_traced = 0;	/* stats of last collection */
+static int 	gc_immortal_skipped = 0;
+static FGcStats gc_stats;
+static FSlabRegion *inst_regions;
+static ficlUnsigned inst_regions_size = 0;	/* power of 2 */
+static ficlUnsigned inst_regions_length = 0;
+static int 	inst_region_shift = 0;
+static FInstance *inst_minmem = NULL;	/* bounds of all slabs */
+static FInstance *inst_maxmem = NULL;
+static FInstance *inst_last_base = NULL;	/* slab of last lookup */
+
+#define INSTANCE_REF(Idx)						\
+	(&inst_slabs[(Idx) / GC_CHUNK_SIZE].insts[(Idx) % GC_CHUNK_SIZE])
 
 #define OBJECT_P(Obj)		(((FTH)(Obj)) & ~FTH_NIL)
 
@@ -471,10 +613,21 @@ static int 	last_instance = 0;
 	(FTH_OBJECT_REF(Obj) >= obj_minmem &&				\
 	 FTH_OBJECT_REF(Obj) <= obj_maxmem)
 
+#define INST_SLOT_P(Inst, Base)						\
+	((Base) != NULL &&						\
+	 (Inst) >= (Base) && (Inst) < (Base) + GC_CHUNK_SIZE &&		\
+	 (((char *) (Inst) - (char *) (Base)) % sizeof(FInstance)) == 0)
+
+/*
+ * The inlined bounds test rejects fixnums and most other non-instance
+ * cells, and most lookups hit the same slab as the previous one.
+ * inst_slab_member_p() decides with the slab registry for the rest.
+ */
 #define INSTANCE_P(Obj)							\
 	(FTH_INSTANCE_REF(Obj) >= inst_minmem &&			\
-	 FTH_INSTANCE_REF(Obj) <= inst_maxmem &&			\
-	 OBJECT_TYPE_P(FTH_INSTANCE_REF_OBJ(Obj)) &&			\
+	 FTH_INSTANCE_REF(Obj) < inst_maxmem &&				\
+	 (INST_SLOT_P(FTH_INSTANCE_REF(Obj), inst_last_base) ||		\
+	  inst_slab_member_p(FTH_INSTANCE_REF(Obj))) &&			\
 	 !GC_FREED_P(FTH_INSTANCE_REF(Obj)))
 
 #define OBJECT_MARK(Inst)						\
@@ -487,6 +640,8 @@ static int 	last_instance = 0;
 	else								\
 		FTH_FREE((Inst)->gen);					\
 									\
+	(Inst)->obj->freed++;						\
+	gc_stats.live--;						\
 	GC_FREED_SET(Inst);						\
 	(Inst)->gen = NULL;						\
 	(Inst)->obj = NULL;						\
@@ -496,15 +651,271 @@ static int 	last_instance = 0;
 	inst_free_list = (Inst);					\
 } while (0)
 
+/* Spread consecutive regions over the registry (Fibonacci hashing). */
+#define INST_REGION_HASH(Region)	((Region) * 2654435761UL)
+
+/*
+ * Return the registry entry of REGION or the empty entry where it
+ * belongs.
+ */
+static FSlabRegion *
+inst_region_find(ficlUnsigned region)
+{
+	ficlUnsigned 	i, mask;
+	FSlabRegion    *r;
+
+	mask = inst_regions_size - 1;
+
+	for (i = INST_REGION_HASH(region) & mask;; i = (i + 1) & mask) {
+		r = &inst_regions[i];
+
+		if (r->base[0] == NULL || r->region == region)
+			return (r);
+	}
+	/* NOTREACHED */
+}
+
+/*
+ * Return 1 if INST points to the start of an instance slot of one of
+ * the slabs; one registry probe and at most two bounds checks.
+ */
+static int
+inst_slab_member_p(FInstance *inst)
+{
+	FSlabRegion    *r;
+
+	r = inst_region_find((ficlUnsigned) inst >> inst_region_shift);
+
+	if (INST_SLOT_P(inst, r->base[0]))
+		inst_last_base = r->base[0];
+	else if (INST_SLOT_P(inst, r->base[1]))
+		inst_last_base = r->base[1];
+	else
+		return (0);
+	return (1);
+}
+
+static void
+inst_region_add(ficlUnsigned region, FInstance *base)
+{
+	FSlabRegion    *r;
+
+	r = inst_region_find(region);
+
+	if (r->base[0] == NULL) {
+		r->region = region;
+		r->base[0] = base;
+		inst_regions_length++;
+	} else
+		r->base[1] = base;
+}
+
+/*
+ * Enter all regions covered by the slab at BASE, grow the registry
+ * at half load.
+ */
+static void
+inst_slab_register(FInstance *base)
+{
+	ficlUnsigned 	first, last, i;
+
+	if (inst_region_shift == 0) {
+		size_t 		bytes;
+
+		bytes = GC_CHUNK_SIZE * sizeof(FInstance);
+
+		while (((size_t) 2 << inst_region_shift) <= bytes)
+			inst_region_shift++;
+	}
+	first = (ficlUnsigned) base >> inst_region_shift;
+	last = (ficlUnsigned) (base + GC_CHUNK_SIZE - 1) >> inst_region_shift;
+
+	if (2 * (inst_regions_length + (last - first + 1)) >
+	    inst_regions_size) {
+		FSlabRegion    *old;
+		ficlUnsigned 	old_size;
+
+		old = inst_regions;
+		old_size = inst_regions_size;
+		inst_regions_size = old_size == 0 ? 64 : old_size * 2;
+		inst_regions = FTH_CALLOC(inst_regions_size,
+		    sizeof(FSlabRegion));
+		inst_regions_length = 0;
+
+		for (i = 0; i < old_size; i++)
+			if (old[i].base[0] != NULL) {
+				inst_region_add(old[i].region, old[i].base[0]);
+
+				if (old[i].base[1] != NULL)
+					inst_region_add(old[i].region,
+					    old[i].base[1]);
+			}
+		FTH_FREE(old);
+	}
+	for (i = first; i <= last; i++)
+		inst_region_add(i, base);
+
+	if (inst_minmem == NULL || inst_minmem > base)
+		inst_minmem = base;
+
+	if (inst_maxmem < base + GC_CHUNK_SIZE)
+		inst_maxmem = base + GC_CHUNK_SIZE;
+}
+
 #if 0
 #define FTH_DEBUG 1
 #endif
 
+#if !defined(__GNUC__)
+static ficlUnsigned
+gc_first_bit(ficlUnsigned bits)
+{
+	ficlUnsigned 	j;
+
+	for (j = 0; !(bits & ((ficlUnsigned) 1 << j)); j++)
+		/* empty */ ;
+	return (j);
+}
+
+static int
+gc_bit_count(ficlUnsigned bits)
+{
+	int 		n;
+
+	for (n = 0; bits != 0; bits &= bits - 1)
+		n++;
+	return (n);
+}
+#endif
+
+/*
+ * Plain instances have nothing to free, neither a GEN nor a free
+ * function; these are floats and the other boxed numbers, by far the
+ * most frequently created instances.  The collections don't free the
+ * dead ones one by one, they only set their bits in the POOLED bitmaps
+ * and the instances aren't touched again until gc_pool_next() hands
+ * them out.  Add BITS of word W of SLAB to the pool and return the
+ * number of added instances.
+ */
+static int
+gc_pool_add(FSlab *slab, int w, ficlUnsigned bits)
+{
+	int 		n;
+	ficlUnsigned 	word;
+
+	n = GC_BIT_COUNT(bits);
+	slab->pooled[w] |= bits;
+	gc_pool_count += n;
+	gc_stats.live -= n;
+	word = (ficlUnsigned) (slab - inst_slabs) *
+	    (GC_CHUNK_SIZE / GC_MARK_BITS) + (ficlUnsigned) w;
+
+	if (gc_pool_word > word)
+		gc_pool_word = word;
+	return (n);
+}
+
+/*
+ * Return the first instance of the pool or NULL if the pool is empty.
+ */
 static FInstance *
-gc_run(void)
+gc_pool_next(void)
 {
-	int 		i, freed;
-	FInstance      *inst, *free_inst = NULL;
+	FSlab          *slab;
+	FInstance      *inst;
+	ficlUnsigned 	j, *bits;
+
+	while (gc_pool_count > 0) {
+		slab = &inst_slabs[gc_pool_word /
+		    (GC_CHUNK_SIZE / GC_MARK_BITS)];
+		bits = &slab->pooled[gc_pool_word %
+		    (GC_CHUNK_SIZE / GC_MARK_BITS)];
+
+		if (*bits == 0) {
+			gc_pool_word++;
+			continue;
+		}
+		j = GC_FIRST_BIT(*bits);
+		*bits &= *bits - 1;
+		gc_pool_count--;
+		inst = &slab->insts[(gc_pool_word %
+		    (GC_CHUNK_SIZE / GC_MARK_BITS)) * GC_MARK_BITS + j];
+		inst->obj->freed++;
+		return (inst);
+	}
+	return (NULL);
+}
+
+/*
+ * Free the pooled instances the usual way, so that the object-type
+ * statistics are exact and gc_free_all() sees them as freed.
+ */
+static void
+gc_pool_settle(void)
+{
+	FInstance      *inst;
+
+	while ((inst = gc_pool_next()) != NULL) {
+		GC_FREED_SET(inst);
+		inst->obj = NULL;
+		inst->next = inst_free_list;
+		inst_free_list = inst;
+	}
+	gc_pool_word = 0;
+}
+
+static double
+gc_time(void)
+{
+#if defined(HAVE_GETTIMEOFDAY)
+	struct timeval 	tv;
+
+	if (gettimeofday(&tv, NULL) == 0)
+		return ((double) tv.tv_sec + (double) tv.tv_usec * 1e-6);
+#endif
+	return (0.0);
+}
+
+/*
+ * Add a collection pause to gc-statistics.  Incremental sweep steps
+ * during allocation aren't timed, that would cost more than the steps
+ * themselves.
+ */
+static void
+gc_account_pause(double pause)
+{
+	int 		i;
+	double 		limit;
+
+	gc_stats.pause += pause;
+	gc_stats.pause_last = pause;
+
+	if (gc_stats.pause_max < pause)
+		gc_stats.pause_max = pause;
+
+	for (i = 0, limit = 1e-4; i < GC_PAUSE_BUCKETS - 1 && pause >= limit;
+	    i++, limit *= 10.0)
+		/* empty */ ;
+	gc_stats.pauses[i]++;
+}
+
+static void
+gc_account_phases(double mark, double sweep)
+{
+	gc_stats.mark += mark;
+	gc_stats.mark_last = mark;
+	gc_stats.sweep += sweep;
+	gc_stats.sweep_last = sweep;
+}
+
+/*
+ * Mark instances on the data stack and in the gc frames.
+ */
+static void
+gc_mark_roots(void)
+{
+	int 		i;
+	FInstance      *inst;
 	ficlStack      *stack;
 #if defined(FTH_DEBUG)
 	int 		stk_marked, frm_marked;
@@ -513,7 +924,6 @@ gc_run(void)
 	fprintf(stderr, "\\ gc[%02d:%06d]: marking ... ",
 	    gc_frame_level, last_instance);
 #endif
-	freed = 0;
 	stack = FTH_FICL_STACK();
 
 	/* Mark possible instances on stack. */
@@ -528,21 +938,19 @@ gc_run(void)
 		}
 	}
 
-	/* Mark collected instances. */
+	/*
+	 * Mark collected instances.  Immortal ones are kept anyway and
+	 * a mark would make gc_immortal_trace() trace them again.
+	 */
 	for (i = 0; i <= gc_frame_level; i++)
 		for (inst = GC_FRAME_INST(i); inst; inst = inst->next) {
+			if (GC_IMMORTAL_P(inst))
+				continue;
 #if defined(FTH_DEBUG)
 			frm_marked++;
 #endif
 			GC_MARK_SET(inst);
 		}
-
-	/* Mark elements of already marked sequences (array etc). */
-	for (i = 1, inst = instances[0];
-	    i < last_instance;
-	    inst = instances[i++])
-		if (GC_ANY_MARK_P(inst) && inst->obj->mark)
-			(*inst->obj->mark) ((FTH) inst);
 #if defined(FTH_DEBUG)
 	if (stk_marked)
 		fprintf(stderr, "(stack %d) ", stk_marked);
@@ -551,60 +959,438 @@ gc_run(void)
 		fprintf(stderr, "(frame %d) ", frm_marked);
 
 	fprintf(stderr, "done (%d)\n", stk_marked + frm_marked);
-	fprintf(stderr, "\\ gc[%02d:%06d]: freeing ... ",
-	    gc_frame_level, last_instance);
 #endif
-	/* Free all unmarked instances. */
-	for (i = 1, inst = instances[0];
-	    i < last_instance;
-	    inst = instances[i++]) {
-		if (GC_FREED_P(inst))
+}
+
+/*
+ * Sweep up to COUNT instance slots of a pending major collection.
+ * An instance survives if it was marked in gc_major(), if it was
+ * touched since then, or if it's protected.  Permanent and immortal
+ * instances are part of the live bitmaps.  Return the number of freed
+ * instances.
+ */
+static int
+gc_sweep(int count)
+{
+	int 		freed;
+
+	freed = 0;
+
+	while (gc_sweep_slot < gc_sweep_end && count-- > 0) {
+		FSlab          *slab;
+		FInstance      *inst;
+		ficlUnsigned 	bits, bit;
+		int 		j, w;
+
+		slab = &inst_slabs[gc_sweep_slot / GC_CHUNK_SIZE];
+		j = gc_sweep_slot % GC_CHUNK_SIZE;
+		w = j / GC_MARK_BITS;
+		bits = slab->live[w] | slab->marks[w] | slab->pooled[w];
+		gc_sweep_slot++;
+
+		/* Skip entirely live words of the bitmap. */
+		if (bits == ~(ficlUnsigned) 0 && j % GC_MARK_BITS == 0) {
+			gc_sweep_slot += GC_MARK_BITS - 1;
 			continue;
-		if (GC_ANY_MARK_P(inst)) {
-			GC_MARK_CLR(inst);
+		}
+		bit = (ficlUnsigned) 1 << (j % GC_MARK_BITS);
+
+		if (bits & bit)
+			continue;
+		if (slab->plain[w] & bit) {
+			if (!(slab->pinned[w] & bit))
+				freed += gc_pool_add(slab, w, bit);
 			continue;
 		}
+		inst = &slab->insts[j];
+
+		if (inst->gc_mark != 0)
+			continue;
 		OBJECT_FREE(inst);
 		freed++;
 	}
+	return (freed);
+}
+
+/*
+ * Remember the instances touched since the last collection except
+ * the ones created since then, see gc_minor().
+ */
+static void
+gc_touched_set(void)
+{
+	int 		i;
+	ficlUnsigned 	w;
+
+	for (i = 0; i < inst_slab_count; i++) {
+		FSlab          *slab;
+
+		slab = &inst_slabs[i];
+
+		for (w = 0; w < GC_CHUNK_SIZE / GC_MARK_BITS; w++)
+			slab->touched[w] = slab->marks[w] & ~slab->young[w];
+	}
+}
+
+/*
+ * Permanent instances and everything reachable from them form the
+ * immortal space; the IMMORTAL bitmaps hold it.  Immortal instances
+ * are neither swept nor traced by the collections.  Only the ones
+ * touched since the last collection are traced again, the touch marks
+ * serve as remembered set: an instance stored into an immortal one
+ * becomes immortal as well.  Instances dropped from immortal ones stay
+ * until the bitmaps are rebuilt from the permanent instances, if
+ * REBUILD_P, every GC_IMMORTAL_INTERVAL major collections.
+ *
+ * Expects the marks set before tracing in the LIVE bitmaps and adds
+ * the immortal space to the marks.
+ */
+static void
+gc_immortal_trace(int rebuild_p)
+{
+	int 		i;
+	ficlUnsigned 	w, bits;
+	FInstance      *inst;
+
+	gc_immortal_traced = gc_immortal_skipped = 0;
+
+	if (rebuild_p)
+		for (i = 0; i < inst_slab_count; i++)
+			memset(inst_slabs[i].immortal, 0,
+			    sizeof(inst_slabs[i].immortal));
+	gc_immortal_tracing = 1;
+
+	for (i = 0; i < inst_slab_count; i++) {
+		FSlab          *slab;
+
+		slab = &inst_slabs[i];
+
+		for (w = 0; w < GC_CHUNK_SIZE / GC_MARK_BITS; w++) {
+			if (rebuild_p)
+				bits = slab->permanent[w];
+			else
+				bits = slab->live[w] &
+				    (slab->permanent[w] | slab->immortal[w]);
+
+			while (bits != 0) {
+				ficlUnsigned 	j;
+
+				for (j = 0; !(bits & ((ficlUnsigned) 1 << j)); j++)
+					/* empty */ ;
+				bits &= ~((ficlUnsigned) 1 << j);
+
+				/* Already reached from another one. */
+				if (rebuild_p &&
+				    (slab->immortal[w] & ((ficlUnsigned) 1 << j)))
+					continue;
+				inst = &slab->insts[w * GC_MARK_BITS + j];
+				slab->immortal[w] |= (ficlUnsigned) 1 << j;
+				gc_immortal_traced++;
+				OBJECT_MARK(inst);
+			}
+		}
+	}
+	gc_immortal_tracing = 0;
+
+	for (i = 0; i < inst_slab_count; i++) {
+		FSlab          *slab;
+
+		slab = &inst_slabs[i];
+
+		for (w = 0; w < GC_CHUNK_SIZE / GC_MARK_BITS; w++) {
+			slab->immortal[w] |= slab->permanent[w];
+			slab->marks[w] |= slab->immortal[w];
+
+			for (bits = slab->immortal[w]; bits != 0;
+			    bits &= bits - 1)
+				gc_immortal_skipped++;
+		}
+	}
+	gc_immortal_skipped = FICL_MAX(gc_immortal_skipped - gc_immortal_traced, 0);
+}
+
+/*
+ * Major collection: mark everything reachable, move the marks into
+ * the live bitmaps and start a new cycle of touch marks.  The sweep
+ * runs incrementally in gc_next_instance() unless SWEEP_ALL_P.
+ * Return the number of instances freed right away.
+ */
+static int
+gc_major(int sweep_all_p)
+{
+	int 		i, freed;
+	FInstance      *inst;
+	double 		t0, t1, t2;
+
+	t0 = gc_time();
+	gc_sweep(last_instance);
+	t1 = gc_time();
+	gc_mark_roots();
+
+	gc_touched_set();
+
+	for (i = 0; i < inst_slab_count; i++)
+		memcpy(inst_slabs[i].live, inst_slabs[i].marks,
+		    sizeof(inst_slabs[i].live));
+
+	if (sweep_all_p || gc_immortal_count == 0) {
+		gc_immortal_trace(1);
+		gc_immortal_count = GC_IMMORTAL_INTERVAL;
+	} else
+		gc_immortal_trace(0);
+	gc_immortal_count--;
+
+	/*
+	 * Mark elements of the marked and protected sequences (array
+	 * etc).  Instances marked while tracing are already done.
+	 */
+	for (i = 0; i < inst_slab_count; i++) {
+		FSlab          *slab;
+		int 		j, len;
+
+		slab = &inst_slabs[i];
+		len = FICL_MIN(last_instance - i * GC_CHUNK_SIZE,
+		    GC_CHUNK_SIZE);
+
+		for (j = 0; j < len; j++) {
+			ficlUnsigned 	bit, w;
+
+			w = (ficlUnsigned) j / GC_MARK_BITS;
+
+			if (slab->immortal[w] == ~(ficlUnsigned) 0) {
+				j += GC_MARK_BITS - 1;
+				continue;
+			}
+			bit = (ficlUnsigned) 1 << (j % GC_MARK_BITS);
+
+			if (slab->immortal[w] & bit)
+				continue;
+			inst = &slab->insts[j];
+
+			if (GC_FREED_P(inst))
+				continue;
+			if ((slab->live[w] & bit) || inst->gc_mark != 0)
+				OBJECT_MARK(inst);
+		}
+	}
+
+	t2 = gc_time();
+
+	for (i = 0; i < inst_slab_count; i++) {
+		FSlab          *slab;
+
+		slab = &inst_slabs[i];
+		memcpy(slab->live, slab->marks, sizeof(slab->live));
+		memcpy(slab->aged, slab->young, sizeof(slab->aged));
+		memset(slab->marks, 0, sizeof(slab->marks));
+		memset(slab->young, 0, sizeof(slab->young));
+	}
+	gc_minor_count = 0;
+	gc_major_p = 0;
+	gc_sweep_slot = 0;
+	gc_sweep_end = last_instance;
 #if defined(FTH_DEBUG)
-	fprintf(stderr, "done (%d)\n", freed);
+	fprintf(stderr, "\\ gc[%02d:%06d]: freeing ... ",
+	    gc_frame_level, last_instance);
 #endif
-	free_inst = inst_free_list;
+	freed = 0;
 
-	if (freed > GC_CHUNK_SIZE && free_inst)
-		inst_free_list = inst_free_list->next;
+	if (sweep_all_p)
+		freed = gc_sweep(last_instance);
 	else
-		free_inst = NULL;
-
-	return (free_inst);
+		/* Sweep until there is enough to hand out. */
+		while (freed <= GC_CHUNK_SIZE && gc_sweep_slot < gc_sweep_end)
+			freed += gc_sweep(GC_CHUNK_SIZE);
+#if defined(FTH_DEBUG)
+	fprintf(stderr, "done (%d)\n", freed);
+#endif
+	gc_stats.major++;
+	gc_account_phases(t2 - t1, (t1 - t0) + (gc_time() - t2));
+	return (freed);
 }
 
-void
-gc_free_all(void)
+/*
+ * Minor collection.  Every instance is marked when created and so
+ * survives the first collection; the minor collection frees the
+ * unreachable instances of the generation before, the aged ones.
+ *
+ * An older instance can only refer to an aged one if something was
+ * stored into it since the aged one was created, and every store
+ * checks its container with fth_instance_*_p() which sets the mark
+ * bit.  The mark bits of this and of the last collection (touched)
+ * are therefore the remembered set; only those instances and the
+ * protected young and aged ones are traced, see gc_immortal_trace()
+ * for the permanent ones.  Dead plain instances go to the pool, see
+ * gc_pool_add().  Return the number of freed instances.
+ */
+static int
+gc_minor(void)
 {
-	int 		i, last;
+	int 		i, freed;
+	FInstance      *inst;
+	double 		t0, t1;
 
-	simple_array_free(last_frames);
+	t0 = gc_time();
+	gc_mark_roots();
+
+	/*
+	 * LIVE is free while no sweep is pending; keep the marks set
+	 * before tracing there.
+	 */
+	for (i = 0; i < inst_slab_count; i++)
+		memcpy(inst_slabs[i].live, inst_slabs[i].marks,
+		    sizeof(inst_slabs[i].live));
+
+	gc_immortal_trace(0);
+
+	for (i = 0; i < inst_slab_count; i++) {
+		FSlab          *slab;
+		ficlUnsigned 	w, bits;
+		int 		len;
+
+		slab = &inst_slabs[i];
+		len = FICL_MIN(last_instance - i * GC_CHUNK_SIZE,
+		    GC_CHUNK_SIZE);
+
+		/*
+		 * Young and aged instances are only traced if pinned,
+		 * so the dead ones (most of them) aren't touched here.
+		 */
+		for (w = 0; w * GC_MARK_BITS < (ficlUnsigned) len; w++) {
+			bits = (slab->live[w] | slab->touched[w] |
+			    ((slab->young[w] | slab->aged[w]) &
+			    slab->pinned[w])) & ~slab->immortal[w];
+
+			while (bits != 0) {
+				ficlUnsigned 	j;
+
+				j = GC_FIRST_BIT(bits);
+				bits &= bits - 1;
+				inst = &slab->insts[w * GC_MARK_BITS + j];
+
+				if (GC_FREED_P(inst))
+					continue;
+				if (inst->obj->mark)
+					(*inst->obj->mark) ((FTH) inst);
+			}
+		}
+	}
+	t1 = gc_time();
+	freed = 0;
+
+	for (i = 0; i < inst_slab_count; i++) {
+		FSlab          *slab;
+		ficlUnsigned 	w, bits, plain;
+
+		slab = &inst_slabs[i];
+
+		for (w = 0; w < GC_CHUNK_SIZE / GC_MARK_BITS; w++) {
+			bits = slab->aged[w] & ~slab->marks[w];
+			plain = bits & slab->plain[w] & ~slab->pinned[w];
+
+			if (plain != 0)
+				freed += gc_pool_add(slab, (int) w, plain);
+			bits &= ~slab->plain[w];
 
-	if (instances != NULL) {
-		for (i = 0; i < last_instance; i++) {
-			if (!GC_FREED_P(instances[i]))
-				OBJECT_FREE(instances[i]);
-			FTH_FREE(instances[i]);
+			while (bits != 0) {
+				ficlUnsigned 	j;
+
+				j = GC_FIRST_BIT(bits);
+				bits &= bits - 1;
+				inst = &slab->insts[w * GC_MARK_BITS + j];
+
+				if (inst->gc_mark != 0)
+					continue;
+				OBJECT_FREE(inst);
+				freed++;
+			}
+		}
+		for (w = 0; w < GC_CHUNK_SIZE / GC_MARK_BITS; w++)
+			slab->touched[w] = slab->live[w] & ~slab->young[w];
+		memcpy(slab->aged, slab->young, sizeof(slab->aged));
+		memset(slab->marks, 0, sizeof(slab->marks));
+		memset(slab->young, 0, sizeof(slab->young));
+	}
+	gc_minor_count++;
+	gc_stats.minor++;
+	gc_account_phases(t1 - t0, gc_time() - t1);
+	return (freed);
+}
+
+/*
+ * Called by gc_next_instance() if the free list is empty.  Finish a
+ * pending sweep, then run a minor collection or every
+ * GC_MAJOR_INTERVAL collections, or if the last minor one didn't
+ * yield enough, a major one.  Return a free instance or NULL if the
+ * heap should grow.
+ */
+static FInstance *
+gc_run(void)
+{
+	int 		freed;
+	FInstance      *free_inst;
+	double 		t0;
+
+	t0 = gc_time();
+	gc_stats.live_max = FICL_MAX(gc_stats.live_max, gc_stats.live);
+	freed = gc_sweep(last_instance);
+
+	if (freed <= GC_CHUNK_SIZE) {
+		if (gc_major_p || gc_minor_count >= GC_MAJOR_INTERVAL)
+			freed = gc_major(0);
+		else {
+			freed = gc_minor();
+
+			/*
+			 * Don't follow up with a major collection right
+			 * away, it would free the instances which just
+			 * lost their creation mark.
+			 */
+			gc_major_p = (freed <= GC_CHUNK_SIZE);
 		}
+	}
+	gc_account_pause(gc_time() - t0);
+	free_inst = NULL;
+
+	if (freed > GC_CHUNK_SIZE) {
+		free_inst = inst_free_list;
 
-		if (last_instance % GC_CHUNK_SIZE != 0)
-			last = (last_instance / GC_CHUNK_SIZE) + 1;
+		if (free_inst != NULL)
+			inst_free_list = inst_free_list->next;
 		else
-			last = last_instance / GC_CHUNK_SIZE;
+			free_inst = gc_pool_next();
+	}
+	return (free_inst);
+}
 
-		last *= GC_CHUNK_SIZE;
+void
+gc_free_all(void)
+{
+	int 		i, last;
 
-		for (i = last_instance; i < last; i++)
-			FTH_FREE(instances[i]);
+	simple_array_free(last_frames);
 
-		FTH_FREE(instances);
+	if (inst_slabs != NULL) {
+		gc_pool_settle();
+
+		for (i = 0; i < last_instance; i++)
+			if (!GC_FREED_P(INSTANCE_REF(i)))
+				OBJECT_FREE(INSTANCE_REF(i));
+
+		for (i = 0; i < inst_slab_count; i++)
+			FTH_FREE(inst_slabs[i].insts);
+
+		FTH_FREE(inst_slabs);
+		FTH_FREE(inst_regions);
+		inst_slabs = NULL;
+		inst_regions = NULL;
+		inst_regions_size = inst_regions_length = 0;
+		inst_minmem = inst_maxmem = inst_last_base = NULL;
+		inst_slab_count = 0;
+		last_instance = 0;
+		gc_sweep_slot = gc_sweep_end = 0;
+		gc_pool_word = 0;
+		gc_pool_count = 0;
 	}
 	if (obj_types != NULL) {
 		if (last_object % OBJ_CHUNK_SIZE != 0)
@@ -629,8 +1415,13 @@ ficl_gc_run(ficlVm *vm)
 gc-run\n\
 Run garbage collection immediately.\n\
 See also gc-stats."
+	double 		t0;
+
 	(void) vm;
-	gc_run();
+	t0 = gc_time();
+	gc_stats.live_max = FICL_MAX(gc_stats.live_max, gc_stats.live);
+	gc_major(1);
+	gc_account_pause(gc_time() - t0);
 }
 
 static int 	fth_gc_on_p;
@@ -649,6 +1440,8 @@ gc-stats =>\n\
 \\     insts:  53895\n\
 \\    buffer:  57617\n\
 \\  gc stack:      0\n\
+\\  immortal:   9214\n\
+\\   skipped:   9170\n\
 Print garbage collection statistics.\n\
 PERMANENT: permanent protected objects like constants\n\
 PROTECTED: temporary protected objects like gc-protected\n\
@@ -657,16 +1450,18 @@ PROTECTED: temporary protected objects like gc-protected\n\
     INSTS: all other nonfreed objects\n\
    BUFFER: size of entire allocated buffer-array\n\
  GC STACK: stack frame level\n\
-See also gc-run."
+ IMMORTAL: permanent objects and all objects reachable from them\n\
+  SKIPPED: immortal objects the last gc neither traced nor swept\n\
+See also gc-run and gc-statistics."
 	int 		i, permanent, protected, marked, freed, rest;
 	FInstance      *inst;
 
 	(void) vm;
 	permanent = protected = marked = freed = rest = 0;
 
-	for (i = 1, inst = instances[0];
-	    i < last_instance;
-	    inst = instances[i++]) {
+	for (i = 0; i < last_instance; i++) {
+		inst = INSTANCE_REF(i);
+
 		if (GC_MARKED_P(inst))
 			marked++;
 		else if (GC_PERMANENT_P(inst))
@@ -686,8 +1481,11 @@ See also gc-run."
 	fth_printf("\\    marked: %6d\n", marked);
 	fth_printf("\\     freed: %6d\n", freed);
 	fth_printf("\\     insts: %6d\n", rest);
-	fth_printf("\\    buffer: %6d\n", last_instance - 1);
-	fth_printf("\\  gc stack: %6d", gc_frame_level);
+	fth_printf("\\    buffer: %6d\n", last_instance);
+	fth_printf("\\  gc stack: %6d\n", gc_frame_level);
+	fth_printf("\\  immortal: %6d\n",
+	    gc_immortal_traced + gc_immortal_skipped);
+	fth_printf("\\   skipped: %6d", gc_immortal_skipped);
 
 	if (CELL_INT_REF(&FTH_FICL_VM()->sourceId))
 		fth_print("\n");
@@ -764,11 +1562,12 @@ See also gc-permanent-objects."
 
 	ary = fth_make_empty_array();
 
-	for (i = 1, inst = instances[0];
-	    i < last_instance;
-	    inst = instances[i++])
+	for (i = 0; i < last_instance; i++) {
+		inst = INSTANCE_REF(i);
+
 		if (GC_PROTECTED_P(inst))
 			fth_array_push(ary, (FTH) inst);
+	}
 
 	ficlStackPushFTH(vm->dataStack, ary);
 }
@@ -786,11 +1585,12 @@ See also gc-protected-objects."
 
 	ary = fth_make_empty_array();
 
-	for (i = 1, inst = instances[0];
-	    i < last_instance;
-	    inst = instances[i++])
+	for (i = 0; i < last_instance; i++) {
+		inst = INSTANCE_REF(i);
+
 		if (GC_PERMANENT_P(inst))
 			fth_array_push(ary, (FTH) inst);
+	}
 
 	ficlStackPushFTH(vm->dataStack, ary);
 }
@@ -820,10 +1620,32 @@ See also gc-on."
 	return (FTH_FALSE);
 }
 
+/*
+ * Mark OBJ and, unless it's already marked, its elements.  The gc
+ * traces all instances marked before it started itself, so the
+ * shortcut keeps marking linear and terminates on cyclic structures.
+ */
 void
 fth_gc_mark(FTH obj)
 {
-	if (INSTANCE_P(obj)) {
+	if (gc_immortal_tracing) {
+		FInstance      *inst;
+		ficlUnsigned   *word;
+
+		if (!INSTANCE_P(obj))
+			return;
+		inst = FTH_INSTANCE_REF(obj);
+		word = &inst_slabs[inst->slot / GC_CHUNK_SIZE].immortal[
+		    (inst->slot % GC_CHUNK_SIZE) / GC_MARK_BITS];
+
+		if (!(*word & GC_MARK_BIT(inst))) {
+			*word |= GC_MARK_BIT(inst);
+			gc_immortal_traced++;
+			OBJECT_MARK(inst);
+		}
+		return;
+	}
+	if (INSTANCE_P(obj) && !GC_MARKED_P(FTH_INSTANCE_REF(obj))) {
 		GC_MARK_SET(FTH_INSTANCE_REF(obj));
 		OBJECT_MARK(FTH_INSTANCE_REF(obj));
 	}
@@ -928,11 +1750,85 @@ fth_gc_protect_set(FTH out, FTH in)
 FTH
 fth_gc_permanent(FTH obj)
 {
-	if (INSTANCE_P(obj))
+	if (INSTANCE_P(obj)) {
 		GC_PERMANENT_SET(FTH_INSTANCE_REF(obj));
+		/* The next collection adds its elements to the immortals. */
+		GC_MARK_SET(FTH_INSTANCE_REF(obj));
+	}
 	return (obj);
 }
 
+#define GC_STATS_SET(Hash, Name, Value)					\
+	fth_hash_set(Hash, fth_symbol(Name), Value)
+
+FTH
+fth_gc_statistics(void)
+{
+#define h_gc_statistics "( -- hash )  return gc statistics\n\
+gc-statistics => #{ 'minor-collections => 12 'pause-total => 0.0431 ... }\n\
+Return hash of garbage collection statistics.  \
+Times are in seconds and sums since start.\n\
+MINOR-COLLECTIONS, MAJOR-COLLECTIONS: number of collections\n\
+PAUSE-TOTAL, PAUSE-LAST, PAUSE-MAX: collection pauses\n\
+PAUSE-HISTOGRAM: array of the number of pauses \
+below 0.1, 1, 10, 100 ms and above\n\
+MARK-TOTAL, MARK-LAST: time spent marking\n\
+SWEEP-TOTAL, SWEEP-LAST: time spent sweeping in collections\n\
+LIVE, LIVE-MAX: instances in use now and at most\n\
+HEAP-INSTANCES, HEAP-BYTES: size of the instance heap \
+(it never shrinks, so it's its high-water mark too)\n\
+IMMORTAL: permanent instances and the ones reachable from them\n\
+TYPES: hash of object-type names and arrays of \
+allocated, freed and live instances of each type\n\
+See also gc-stats."
+	FTH 		hs, types, ary;
+	int 		i;
+
+	hs = fth_make_hash();
+	GC_STATS_SET(hs, "minor-collections", fth_make_unsigned(gc_stats.minor));
+	GC_STATS_SET(hs, "major-collections", fth_make_unsigned(gc_stats.major));
+	GC_STATS_SET(hs, "pause-total", fth_make_float(gc_stats.pause));
+	GC_STATS_SET(hs, "pause-last", fth_make_float(gc_stats.pause_last));
+	GC_STATS_SET(hs, "pause-max", fth_make_float(gc_stats.pause_max));
+	ary = fth_make_array_len((ficlInteger) GC_PAUSE_BUCKETS);
+
+	for (i = 0; i < GC_PAUSE_BUCKETS; i++)
+		fth_array_set(ary, (ficlInteger) i,
+		    fth_make_unsigned(gc_stats.pauses[i]));
+
+	GC_STATS_SET(hs, "pause-histogram", ary);
+	GC_STATS_SET(hs, "mark-total", fth_make_float(gc_stats.mark));
+	GC_STATS_SET(hs, "mark-last", fth_make_float(gc_stats.mark_last));
+	GC_STATS_SET(hs, "sweep-total", fth_make_float(gc_stats.sweep));
+	GC_STATS_SET(hs, "sweep-last", fth_make_float(gc_stats.sweep_last));
+	GC_STATS_SET(hs, "live", fth_make_int(gc_stats.live));
+	GC_STATS_SET(hs, "live-max",
+	    fth_make_int(FICL_MAX(gc_stats.live_max, gc_stats.live)));
+	GC_STATS_SET(hs, "heap-instances", fth_make_int(last_instance));
+	GC_STATS_SET(hs, "heap-bytes", fth_make_unsigned((ficlUnsigned)
+	    inst_slab_count * GC_CHUNK_SIZE * sizeof(FInstance)));
+	GC_STATS_SET(hs, "immortal",
+	    fth_make_int(gc_immortal_traced + gc_immortal_skipped));
+	types = fth_make_hash();
+	gc_pool_settle();
+
+	for (i = 0; i < last_object; i++) {
+		FObject        *obj;
+
+		obj = obj_types[i];
+
+		if (obj->allocated == 0)
+			continue;
+		fth_hash_set(types, fth_make_string(obj->name),
+		    fth_make_array_var(3,
+			fth_make_unsigned(obj->allocated),
+			fth_make_unsigned(obj->freed),
+			fth_make_unsigned(obj->allocated - obj->freed)));
+	}
+	GC_STATS_SET(hs, "types", types);
+	return (hs);
+}
+
 /* === OBJECT-TYPE === */
 
 int
@@ -955,8 +1851,8 @@ See also make-object-type."
 	ficlStackPushBoolean(vm->dataStack, OBJECT_TYPE_P(obj));
 }
 
-FTH
-make_object_type(const char *name, fobj_t type)
+static FObject *
+new_object_type(const char *name, fobj_t type)
 {
 	FObject        *current;
 
@@ -985,6 +1881,15 @@ make_object_type(const char *name, fobj_t type)
 
 	current->type = type;
 	fth_strcpy(current->name, sizeof(current->name), name);
+	return (current);
+}
+
+FTH
+make_object_type(const char *name, fobj_t type)
+{
+	FObject        *current;
+
+	current = new_object_type(name, type);
 	/*-
 	 * constant with class definition, e.g. "fth-Mus":
 	 * 10 make-oscil  fth-Mus   instance-of? => #t
@@ -1015,6 +1920,7 @@ make_object_type_from(const char *name, fobj_t type, FTH obj)
 	current->value_ref = base->value_ref;
 	current->value_set = base->value_set;
 	current->equal_p = base->equal_p;
+	current->hash = base->hash;
 	current->length = base->length;
 	current->mark = base->mark;
 	current->free = base->free;
@@ -1026,6 +1932,7 @@ make_object_type_from(const char *name, fobj_t type, FTH obj)
 	current->value_ref_proc = base->value_ref_proc;
 	current->value_set_proc = base->value_set_proc;
 	current->equal_p_proc = base->equal_p_proc;
+	current->hash_proc = base->hash_proc;
 	current->length_proc = base->length_proc;
 	current->mark_proc = base->mark_proc;
 	current->free_proc = base->free_proc;
@@ -1052,6 +1959,46 @@ fth_make_object_type_from(const char *name, FTH base)
 	return (make_object_type_from(name, object_type_counter++, base));
 }
 
+/*
+ * Return the index of object-type OBJ in the table of all object
+ * types or -1 if OBJ isn't an object-type.  Used by image.c.
+ */
+int
+fth_object_type_index(FTH obj)
+{
+	int 		i;
+
+	if (OBJECT_TYPE_P(obj))
+		for (i = 0; i < last_object; i++)
+			if (obj_types[i] == FTH_OBJECT_REF(obj))
+				return (i);
+	return (-1);
+}
+
+/*
+ * Return object-type at INDEX or 0 if there is none.
+ */
+FTH
+fth_object_type_ref(int index)
+{
+	if (index >= 0 && index < last_object)
+		return ((FTH) obj_types[index]);
+	return (0);
+}
+
+/*
+ * Re-create object-type NAME at INDEX like fth_make_object_type() but
+ * without constant fth-NAME and feature NAME; an image restores them
+ * with the dictionary.  Return 0 if INDEX isn't the next free one.
+ */
+FTH
+fth_object_type_restore(int index, const char *name)
+{
+	if (index != last_object)
+		return (0);
+	return ((FTH) new_object_type(name, object_type_counter++));
+}
+
 static void
 ficl_make_object_type(ficlVm *vm)
 {
@@ -1127,6 +2074,39 @@ fth_instance_ref_gen(FTH obj)
 
 /* === INSTANCE === */
 
+/*
+ * Allocate a new slab of GC_CHUNK_SIZE instances in one piece.
+ */
+static void
+gc_add_slab(void)
+{
+	FSlab          *slab;
+	FInstance      *insts;
+	int 		i;
+
+	insts = FTH_CALLOC(GC_CHUNK_SIZE, sizeof(FInstance));
+
+	for (i = 0; i < GC_CHUNK_SIZE; i++) {
+		insts[i].gc_mark = GC_FREED;
+		insts[i].slot = inst_slab_count * GC_CHUNK_SIZE + i;
+	}
+	inst_slabs = FTH_REALLOC(inst_slabs,
+	    sizeof(FSlab) * (size_t) (inst_slab_count + 1));
+	slab = &inst_slabs[inst_slab_count++];
+	slab->insts = insts;
+	memset(slab->marks, 0, sizeof(slab->marks));
+	memset(slab->young, 0, sizeof(slab->young));
+	memset(slab->aged, 0, sizeof(slab->aged));
+	memset(slab->touched, 0, sizeof(slab->touched));
+	memset(slab->live, 0, sizeof(slab->live));
+	memset(slab->permanent, 0, sizeof(slab->permanent));
+	memset(slab->pinned, 0, sizeof(slab->pinned));
+	memset(slab->plain, 0, sizeof(slab->plain));
+	memset(slab->pooled, 0, sizeof(slab->pooled));
+	memset(slab->immortal, 0, sizeof(slab->immortal));
+	inst_slab_register(insts);
+}
+
 static FInstance *
 gc_next_instance(void)
 {
@@ -1134,39 +2114,28 @@ gc_next_instance(void)
 
 	current = NULL;
 
+	if (gc_sweep_slot < gc_sweep_end)
+		gc_sweep(GC_SWEEP_STEP);
+
 	if (last_instance && (last_instance % GC_MAX_OBJECTS) == 0) {
 		current = inst_free_list;
 		if (current != NULL)
 			inst_free_list = inst_free_list->next;
+		else if ((current = gc_pool_next()) != NULL)
+			/* empty */ ;
 		else if (fth_gc_on_p && !fth_signal_caught_p)
 			current = gc_run();
 		else
 			current = NULL;
 	}
 	if (current == NULL) {
-		if (last_instance % GC_CHUNK_SIZE == 0) {
-			int 		i, size;
-
-			size = GC_CHUNK_SIZE + last_instance;
-			instances = FTH_REALLOC(instances,
-			    sizeof(FInstance *) * (size_t) size);
-
-			for (i = last_instance; i < size; i++) {
-				instances[i] = FTH_CALLOC(1, sizeof(FInstance));
-				instances[i]->gc_mark = GC_FREED;
-			}
-
-			if (last_instance == 0)
-				inst_minmem = *instances;
-		}
-		current = instances[last_instance++];
+		if (last_instance % GC_CHUNK_SIZE == 0)
+			gc_add_slab();
+		current = INSTANCE_REF(last_instance);
+		last_instance++;
 	}
-	if (inst_minmem > current)
-		inst_minmem = current;
-
-	if (inst_maxmem < current)
-		inst_maxmem = current;
-
+	GC_YOUNG_SET(current);
+	gc_stats.live++;
 	return (current);
 }
 
@@ -1231,13 +2200,21 @@ fth_make_instance(FTH obj, void *gen)
 	inst->type = FTH_T;
 	inst->gen = gen;
 	inst->obj = FTH_OBJECT_REF(obj);
+	inst->obj->allocated++;
 	inst->properties = FTH_FALSE;
 	inst->values = FTH_FALSE;
 	inst->debug_hook = FTH_FALSE;
-	inst->changed_p = 1;
+	inst->changed_p = FTH_CHANGED_ALL;
+	inst->hash_id = 0;
 	inst->extern_p = (FTH_OBJECT_TYPE(obj) >= FTH_LAST_ENTRY_T);
 	inst->cycle = 0;
-	inst->gc_mark = GC_MARK;
+	inst->gc_mark = 0;
+	GC_MARK_SET(inst);
+
+	if (gen == NULL && inst->obj->free == NULL)
+		GC_PLAIN_SET(inst);
+	else
+		GC_PLAIN_CLR(inst);
 	inst->next = GC_FRAME_CURRENT_INST();
 	GC_FRAME_CURRENT_INST() = inst;
 	return ((FTH) inst);
@@ -1496,6 +2473,7 @@ SET_OBJECT_FUNC1(copy)
 SET_OBJECT_FUNC2(value_ref)
 SET_OBJECT_FUNC3(value_set)
 SET_OBJECT_FUNC2(equal_p)
+SET_OBJECT_FUNC1(hash)
 SET_OBJECT_FUNC1(length)
 SET_OBJECT_FUNCV(mark)
 SET_OBJECT_FUNCV(free)
@@ -1540,6 +2518,13 @@ See examples/site-lib/enved.fs for examples."
 Set XT as OBJECT-EQUAL? function for OBJ type.\n\
 See examples/site-lib/enved.fs for examples."
 
+#define h_set_hash "( xt obj -- )  set XT as hash-id function\n\
+<'> enved-hash fth-enved set-object-hash\n\
+Set XT as HASH-ID function for OBJ type.  \
+XT must return an integer and objects which are OBJECT-EQUAL? \
+must return the same value.\n\
+See examples/site-lib/enved.fs for examples."
+
 #define h_set_length "( xt obj -- )  set XT as object-length function\n\
 <'> enved-length fth-enved set-object-length\n\
 Set XT as OBJECT-LENGTH function for OBJ type.\n\
@@ -1705,14 +2690,96 @@ xmobj_to_string(FTH obj)
 
 /* === Object Functions === */
 
+/*
+ * FNV-1a over at most LEN bytes of STR, stopping at the first '\0'
+ * like str_equal_p's strcmp(3) does.  If LEN < 0, hash up to '\0'.
+ */
+ficlUnsigned
+fth_hash_bytes(const char *str, ficlInteger len)
+{
+	ficlUnsigned 	h;
+
+	h = 2166136261UL;
+
+	if (str == NULL)
+		return (h);
+
+	for (; len != 0 && *str != '\0'; str++, len--) {
+		h ^= (unsigned char) *str;
+		h *= 16777619UL;
+	}
+	return (h);
+}
+
+/*
+ * Order dependent mixing of two hash values (boost's hash_combine).
+ */
+ficlUnsigned
+fth_hash_combine(ficlUnsigned seed, ficlUnsigned h)
+{
+	return (seed ^ (h + 0x9e3779b9UL + (seed << 6) + (seed >> 2)));
+}
+
+/*
+ * Set if a hash id computation touched a mutable instance; such an id
+ * can't be cached in the containing instance because a change of the
+ * nested object doesn't reach the container's changed_p.
+ */
+static int 	hash_id_volatile_p;
+
+static ficlUnsigned
+instance_hash_id(FTH obj)
+{
+	FInstance      *inst;
+	FTH 		res;
+	ficlUnsigned 	h;
+	int 		saved_p, volatile_p;
+
+	inst = FTH_INSTANCE_REF(obj);
+
+	if (!inst->extern_p && !(inst->changed_p & FTH_CHANGED_HASH)) {
+		if (!FTH_NUMBER_T_P(obj))
+			hash_id_volatile_p = 1;
+		return (inst->hash_id);
+	}
+	saved_p = hash_id_volatile_p;
+
+	if (FTH_HASH_ID_P(obj) != NULL) {
+		hash_id_volatile_p = 0;
+		res = FTH_HASH_ID(obj);
+		volatile_p = hash_id_volatile_p;
+
+		if (FTH_FIXNUM_P(res))
+			h = (ficlUnsigned) FIX_TO_INT(res);
+		else if (FTH_INTEGER_P(res))
+			h = (ficlUnsigned) fth_int_ref(res);
+		else
+			h = (ficlUnsigned) FIX_TO_INT(fth_hash_id(res));
+
+		if (!inst->extern_p && !volatile_p) {
+			inst->hash_id = h;
+			inst->changed_p &= ~FTH_CHANGED_HASH;
+		}
+	} else if (FTH_EQUAL_P_P(obj) == NULL)
+		/* Without equal_p, equality is identity. */
+		h = (ficlUnsigned) obj >> 3;
+	else
+		h = fth_hash_bytes(fth_to_c_string(obj), -1L);
+
+	hash_id_volatile_p = saved_p || !FTH_NUMBER_T_P(obj);
+	return (h);
+}
+
 FTH
 fth_hash_id(FTH obj)
 {
 #define h_hash_id "( obj -- id )  return hash id\n\
-\"hello\" hash-id => 3583\n\
-\"hello\" hash-id => 3583\n\
-Return hash id computed from string representation of OBJ.  \
-Objects with the same content have the same ID.\n\
+\"hello\" hash-id => 1460560186469985451\n\
+\"hello\" hash-id => 1460560186469985451\n\
+Return hash id of OBJ.  \
+Objects which are OBJECT-EQUAL? have the same ID.  \
+Object types may provide their own function with set-object-hash; \
+other objects are hashed by their string representation.\n\
 See also object-id."
 	if (FTH_FIXNUM_P(obj))
 		return (INT_TO_FIX(obj));
@@ -1720,14 +2787,9 @@ See also object-id."
 	if (FICL_WORD_DEFINED_P(obj))
 		return (INT_TO_FIX(FICL_WORD_REF(obj)->hash));
 
-	if (fth_instance_p(obj)) {
-		char           *str;
-		ficlString 	s;
+	if (fth_instance_p(obj))
+		return (FTH_HASH_ID_TO_FIX(instance_hash_id(obj)));
 
-		str = fth_to_c_string(obj);
-		FICL_STRING_SET_FROM_CSTRING(s, str);
-		return (INT_TO_FIX(ficlHashCode(s)));
-	}
 	return ((FTH) ((ficlInteger) obj | FIXNUM_FLAG));
 }
 
@@ -2025,9 +3087,9 @@ Return OBJ as array."
 		GC_MARK_SET(FTH_INSTANCE_REF(obj));
 		inst = FTH_INSTANCE_REF(obj);
 
-		if (inst->changed_p || inst->extern_p) {
+		if ((inst->changed_p & FTH_CHANGED_VALUES) || inst->extern_p) {
 			inst->values = FTH_TO_ARRAY(obj);
-			inst->changed_p = 0;
+			inst->changed_p &= ~FTH_CHANGED_VALUES;
 		}
 		return (inst->values);
 	}
@@ -2958,6 +4020,8 @@ init_object(void)
 	/* gc */
 	FTH_PRI1("gc-run", ficl_gc_run, h_gc_run);
 	FTH_PRI1("gc-stats", ficl_gc_stats, h_gc_stats);
+	FTH_PROC("gc-statistics", fth_gc_statistics, 0, 0, 0,
+	    h_gc_statistics);
 	FTH_PRI1("gc-marked?", ficl_gc_marked_p, h_gc_marked_p);
 	FTH_PRI1("gc-protected?", ficl_gc_protected_p, h_gc_protected_p);
 	FTH_PRI1("gc-permanent?", ficl_gc_permanent_p, h_gc_permanent_p);
@@ -2995,6 +4059,7 @@ init_object(void)
 	FTH_PRI1("set-object-value-ref", ficl_set_value_ref, h_set_value_ref);
 	FTH_PRI1("set-object-value-set", ficl_set_value_set, h_set_value_set);
 	FTH_PRI1("set-object-equal-p", ficl_set_equal_p, h_set_equal_p);
+	FTH_PRI1("set-object-hash", ficl_set_hash, h_set_hash);
 	FTH_PRI1("set-object-length", ficl_set_length, h_set_length);
 	FTH_PRI1("set-object-mark", ficl_set_mark, h_set_mark);
 	FTH_PRI1("set-object-free", ficl_set_free, h_set_free);
@@ -62,6 +62,7 @@ static void 	ficl_port_close(ficlVm *);
 static void 	ficl_port_closed_p(ficlVm *);
 static void 	ficl_port_display(ficlVm *);
 static void 	ficl_port_flush(ficlVm *);
+static void 	ficl_port_flush_policy(ficlVm *);
 static void 	ficl_port_getc(ficlVm *);
 static void 	ficl_port_gets(ficlVm *);
 static void 	ficl_port_input_p(ficlVm *);
@@ -71,6 +72,7 @@ static void 	ficl_port_putc(ficlVm *);
 static void 	ficl_port_puts(ficlVm *);
 static void 	ficl_port_puts_format(ficlVm *);
 static void 	ficl_port_to_string(ficlVm *);
+static void 	ficl_set_port_flush_policy(ficlVm *);
 static void 	ficl_with_error_to_port(ficlVm *);
 static void 	ficl_with_input_from_port(ficlVm *);
 static void 	ficl_with_input_port(ficlVm *);
@@ -102,6 +104,7 @@ port-close              ( prt -- )\n\
 port-closed?            ( obj -- f )\n\
 port-display            ( prt obj -- )\n\
 port-flush              ( prt -- )\n\
+port-flush-policy       ( -- sym )\n\
 port-getc               ( prt -- c )\n\
 port-gets               ( prt -- str )\n\
 port-input?             ( obj -- f )\n\
@@ -113,6 +116,7 @@ port-read alias for port-gets\n\
 port-write alias for port-puts\n\
 port-write-format alias for port-puts-format\n\
 port?                   ( obj -- f )\n\
+set-port-flush-policy   ( sym -- old )\n\
 with-error-to-port      ( obj :key args -- )\n\
 with-input-from-port    ( obj :key args -- str )\n\
 with-input-port         ( obj :key args -- str )\n\
@@ -566,9 +570,14 @@ See also port-puts and port-puts-format."
 void
 fth_port_puts(FTH port, const char *str)
 {
-	if (FTH_FALSE_P(port))
+	if (FTH_FALSE_P(port)) {
 		port = ficlVmGetPortOut(FTH_FICL_VM());
+		fth_io_write(port, str);
 
+		if (fth_port_flush_p(str))
+			FTH_IO_FLUSH(port);
+		return;
+	}
 	if (FTH_IO_P(port)) {
 		fth_io_write_and_flush(port, str);
 		return;
@@ -617,9 +626,10 @@ See also port-putc and port-puts."
 void
 fth_port_display(FTH port, FTH obj)
 {
-	if (FTH_FALSE_P(port))
-		port = ficlVmGetPortOut(FTH_FICL_VM());
-
+	if (FTH_FALSE_P(port)) {
+		fth_port_puts(port, fth_to_c_string(obj));
+		return;
+	}
 	if (FTH_IO_P(port)) {
 		fth_io_write_and_flush(port, fth_to_c_string(obj));
 		return;
@@ -668,13 +678,16 @@ Return content of PRT object as string if available, otherwise #f."
 }
 
 /*
- * Flush PORT; if PORT is FTH_FALSE, do nothing.
+ * Flush PORT; if PORT is FTH_FALSE, flush the current output and error
+ * ports.
  */
 void
 fth_port_flush(FTH port)
 {
-	if (FTH_FALSE_P(port))
+	if (FTH_FALSE_P(port)) {
+		fth_port_flush_output();
 		return;
+	}
 	fth_io_flush(port);
 }
 
@@ -682,8 +695,10 @@ static void
 ficl_port_flush(ficlVm *vm)
 {
 #define h_port_flush "( prt -- )  flush PRT\n\
-#f port-flush \\ does nothing\n\
-File and IO ports flush their streams, other kind of ports do nothing."
+#f port-flush \\ flush current output and error port\n\
+File and IO ports flush their streams, other kind of ports do nothing.  \
+If PRT is #f, flush the current output and error port.\n\
+See also port-flush-policy."
 	FTH_STACK_CHECK(vm, 1, 0);
 	fth_port_flush(fth_pop_ficl_cell(vm));
 }
@@ -1018,6 +1033,120 @@ with-output-to-port."
 	fth_io_close(fth_set_io_stderr(old_io));
 }
 
+/* --- flush policy of the output ports --- */
+
+enum {
+	PORT_FLUSH_ALWAYS,	/* after each write */
+	PORT_FLUSH_LINE,	/* after each newline */
+	PORT_FLUSH_FULL		/* if the stream buffer is full */
+};
+
+static const char *port_flush_names[] = {
+	"always",
+	"line",
+	"full"
+};
+
+static int 	port_flush_policy = PORT_FLUSH_ALWAYS;
+
+/*
+ * Return 1 if the output port has to be flushed after writing STR,
+ * otherwise 0.
+ */
+int
+fth_port_flush_p(const char *str)
+{
+	switch (port_flush_policy) {
+	case PORT_FLUSH_FULL:
+		return (0);
+	case PORT_FLUSH_LINE:
+		return (strchr(str, '\n') != NULL);
+	case PORT_FLUSH_ALWAYS:
+	default:
+		return (1);
+	}
+}
+
+/*
+ * Flush the current output and error port.  Called before reading
+ * from stdin, before starting other processes, and at exit.
+ */
+void
+fth_port_flush_output(void)
+{
+	ficlVm         *vm;
+	FTH 		io;
+
+	vm = FTH_FICL_VM();
+
+	if (vm == NULL)
+		return;
+
+	io = ficlVmGetPortOut(vm);
+
+	if (FTH_IO_P(io) && !FTH_IO_CLOSED_P(io))
+		FTH_IO_FLUSH(io);
+
+	io = ficlVmGetPortErr(vm);
+
+	if (FTH_IO_P(io) && !FTH_IO_CLOSED_P(io))
+		FTH_IO_FLUSH(io);
+}
+
+static void
+ficl_port_flush_policy(ficlVm *vm)
+{
+#define h_port_flush_policy "( -- sym )  return flush policy\n\
+port-flush-policy => 'full\n\
+Return the flush policy of the current output and error port:\n\
+'always   flush after each write\n\
+'line     flush after each newline\n\
+'full     flush only if the buffer is full, before reading from stdin,\n\
+          before starting other processes, on port-flush and at exit\n\
+The default is 'line if stdout is a terminal, otherwise 'full.\n\
+See also set-port-flush-policy and port-flush."
+	ficlStackPushFTH(vm->dataStack,
+	    fth_symbol(port_flush_names[port_flush_policy]));
+}
+
+static void
+ficl_set_port_flush_policy(ficlVm *vm)
+{
+#define h_set_port_flush_policy "( sym -- old )  set flush policy\n\
+'always set-port-flush-policy => 'full\n\
+Set the flush policy of the current output and error port to SYM, \
+one of 'always, 'line, 'full or 'auto and return the old policy.  \
+'auto chooses 'line if stdout is a terminal, otherwise 'full.\n\
+See also port-flush-policy and port-flush."
+	FTH 		sym, old;
+	char           *name;
+	int 		i;
+
+	FTH_STACK_CHECK(vm, 1, 1);
+	sym = fth_pop_ficl_cell(vm);
+	FTH_ASSERT_ARGS(FTH_SYMBOL_P(sym), sym, FTH_ARG1, "a symbol");
+	old = fth_symbol(port_flush_names[port_flush_policy]);
+	name = fth_symbol_ref(sym);
+
+	if (strcmp(name, "auto") == 0)
+		i = isatty(STDOUT_FILENO) ? PORT_FLUSH_LINE : PORT_FLUSH_FULL;
+	else {
+		for (i = PORT_FLUSH_FULL; i > 0; i--)
+			if (strcmp(name, port_flush_names[i]) == 0)
+				break;
+
+		if (strcmp(name, port_flush_names[i]) != 0) {
+			FTH_ASSERT_ARGS(0, sym, FTH_ARG1,
+			    "'always, 'line, 'full or 'auto");
+			/* NOTREACHED */
+			return;
+		}
+	}
+	fth_port_flush_output();
+	port_flush_policy = i;
+	ficlStackPushFTH(vm->dataStack, old);
+}
+
 /* --- in- and output callbacks --- */
 
 in_cb 		fth_read_hook;
@@ -1029,6 +1158,7 @@ default_read_cb(ficlVm *vm)
 {
 	FTH 		io;
 
+	fth_port_flush_output();
 	io = ficlVmGetPortIn(vm);
 	return (FTH_IO_READ_LINE(io));
 }
@@ -1040,7 +1170,9 @@ default_print_cb(ficlVm *vm, char *str)
 
 	io = ficlVmGetPortOut(vm);
 	FTH_IO_WRITE_LINE(io, str);
-	FTH_IO_FLUSH(io);
+
+	if (fth_port_flush_p(str))
+		FTH_IO_FLUSH(io);
 }
 
 static void
@@ -1048,9 +1180,13 @@ default_error_cb(ficlVm *vm, char *str)
 {
 	FTH 		io;
 
+	/* keep the order if both go to the same file */
+	FTH_IO_FLUSH(ficlVmGetPortOut(vm));
 	io = ficlVmGetPortErr(vm);
 	FTH_IO_WRITE_LINE(io, str);
-	FTH_IO_FLUSH(io);
+
+	if (fth_port_flush_p(str))
+		FTH_IO_FLUSH(io);
 }
 
 /* char *(*out_cb)(ficlVm *vm); */
@@ -1101,6 +1237,8 @@ init_port(void)
 {
 #define MPFF(Name, Args) fth_make_proc_from_func(NULL, Name, 0, Args, 0, 0)
 #define MPFVF(Name, Args) fth_make_proc_from_vfunc(NULL, Name, Args, 0, 0)
+	port_flush_policy = isatty(STDOUT_FILENO) ?
+	    PORT_FLUSH_LINE : PORT_FLUSH_FULL;
 	gn_read_char = MPFF(soft_read_char, 0);
 	gn_write_char = MPFVF(soft_write_char, 1);
 	gn_read_line = MPFF(soft_read_line, 0);
@@ -1125,6 +1263,10 @@ init_port(void)
 	FTH_PRI1("port-display", ficl_port_display, h_port_display);
 	FTH_PRI1("port->string", ficl_port_to_string, h_port_to_string);
 	FTH_PRI1("port-flush", ficl_port_flush, h_port_flush);
+	FTH_PRI1("port-flush-policy", ficl_port_flush_policy,
+	    h_port_flush_policy);
+	FTH_PRI1("set-port-flush-policy", ficl_set_port_flush_policy,
+	    h_set_port_flush_policy);
 	FTH_PRI1("port-close", ficl_port_close, h_port_close);
 	FTH_PRI1("with-input-port", ficl_with_input_port, h_with_iport);
 	FTH_PRI1("with-output-port", ficl_with_output_port, h_with_oport);
@@ -632,8 +632,14 @@ fth_basic_printf(void *port, int type, const char *sstr)
 		(*fth_error_hook) ((ficlVm *) port, str);
 		break;
 	case PORT_FILE:
+		if (port == stderr)
+			fflush(stdout);
+
 		len = fputs(str, (FILE *) port);
-		fflush(port);
+
+		if ((port != stdout && port != stderr) ||
+		    fth_port_flush_p(str))
+			fflush(port);
 		break;
 	case PORT_IO:
 	default:
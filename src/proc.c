@@ -60,6 +60,13 @@ static void 	ficl_xt_p(ficlVm *);
 static FTH	execute_proc(ficlVm *, ficlWord *, int, const char *);
 static void 	ficl_args_keys_paren_co(ficlVm *);
 static void 	ficl_args_optional_paren_co(ficlVm *);
+static void 	ficl_args_default_p_paren_co(ficlVm *);
+static void 	ficl_args_default_paren_co(ficlVm *);
+static void 	ficl_args_eval_paren_co(ficlVm *);
+static int 	default_compile_p(ficlVm *, FTH);
+static ficlCell *compile_branch0(ficlDictionary *);
+static void 	compile_resolve(ficlDictionary *, ficlCell *);
+static void 	compile_arg_defaults(ficlVm *, FTH);
 static void 	ficl_begin_definition(ficlVm *);
 static void 	ficl_constant(ficlVm *);
 static void 	ficl_defined_p(ficlVm *);
@@ -1925,25 +1932,54 @@ See also <{, get-optkey, get-optarg, get-optkeys."
 
 static ficlWord *args_keys_paren;
 static ficlWord *args_optional_paren;
+static ficlWord *args_default_p_paren;
+static ficlWord *args_default_paren;
+static ficlWord *args_eval_paren;
 static ficlWord *local_paren;
 
-#define FICL_EVAL_STRING_AND_THROW(Vm, Buffer) do {			\
-	int		status;						\
-									\
-	status = ficlVmEvaluate(Vm, fth_string_ref(Buffer));		\
-	if (status == FICL_VM_STATUS_ERROR_EXIT)			\
-		ficlVmThrowError(Vm, "can't execute %S", Buffer);	\
-} while (0)
-
 #define FTH_OPTKEY_ERROR_THROW(Desc)					\
 	fth_throw(FTH_OPTKEY_ERROR, "%s: wrong optkey array, %S",	\
 	    RUNNING_WORD(), Desc)
 
+/*-
+ * Keyword and optional arguments of <{ ... }> (see
+ * ficl_extended_args_co_im() below) compile to
+ *
+ *	keys req (args-keys)       \ push one value or undef per key
+ *	if
+ *	  idx (args-default?) if DEFAULT idx (args-default) then
+ *	  ...
+ *	then
+ *	n req (args-optional)      \ push undef for missing optionals
+ *	if
+ *	  idx (args-default?) if DEFAULT idx (args-default) then
+ *	  ...
+ *	then
+ *
+ * KEYS is an array of key names replaced by their keywords on the
+ * first call; interning them while compiling would add words to the
+ * dictionary in the middle of the definition.  DEFAULT is the compiled
+ * source of a default value; it only runs if the argument is missing
+ * or undef.  The outer if skips all defaults if no argument is undef.
+ */
+
+#define ARGS_KEYS_LEN	32
+
+/*
+ * ( key-args... keys req -- vals... f )
+ *
+ * Scan the stack once for keywords in KEYS.  The first occurrence of a
+ * key and the value above it are removed from the stack.  Push the
+ * values in order of KEYS, undef for missing keys, and a flag, true if
+ * one of the values is undef.
+ */
 static void
 ficl_args_keys_paren_co(ficlVm *vm)
 {
-	FTH 		keys;
+	FTH 		keys, tmp;
 	ficlInteger 	req, i, len;
+	ficlCell       *top, *cell, val;
+	char 		hits[ARGS_KEYS_LEN], *hit;
 
 	FTH_STACK_CHECK(vm, 2, 0);
 	req = ficlStackPopInteger(vm->dataStack);
@@ -1951,79 +1987,282 @@ ficl_args_keys_paren_co(ficlVm *vm)
 	FTH_ASSERT_ARGS(FTH_ARRAY_P(keys), keys, FTH_ARG1, "an array");
 	len = fth_array_length(keys);
 	FTH_STACK_CHECK(vm, req, len);
+	hit = (len > ARGS_KEYS_LEN) ? FTH_CALLOC(len, sizeof(char)) : hits;
 
 	for (i = 0; i < len; i++) {
-		FTH 		key, val, arg, tmp;
-		int 		j, depth;
+		tmp = fth_array_fast_ref(keys, i);
 
-		arg = fth_array_fast_ref(keys, i);
+		/* keys are interned on the first call, see above */
+		if (!FTH_KEYWORD_P(tmp))
+			fth_array_fast_set(keys, i,
+			    fth_keyword(fth_string_ref(tmp)));
 
-		if (fth_array_length(arg) != 2)
-			FTH_OPTKEY_ERROR_THROW(keys);
+		hit[i] = 0;
+		ficlStackPushFTH(vm->dataStack, FTH_UNDEF);
+	}
 
-		key = fth_keyword(fth_string_ref(fth_array_ref(arg, 0L)));
-		val = fth_array_ref(arg, 1L);
-		FICL_EVAL_STRING_AND_THROW(vm, val);
-		depth = FTH_STACK_DEPTH(vm);
+	/* a key needs its value above it, so start below the top */
+	top = vm->dataStack->top;
 
-		for (j = 2; j < depth; j++) {
-			tmp = STACK_FTH_INDEX_REF(vm->dataStack, j);
+	for (cell = top - len - 1; cell >= vm->dataStack->base; cell--) {
+		tmp = CELL_FTH_REF(cell);
 
-			if (FTH_KEYWORD_P(tmp) && tmp == key) {
-				ficlStackRoll(vm->dataStack, j);
-				ficlStackDrop(vm->dataStack, 1);
-				ficlStackRoll(vm->dataStack, j - 1);
+		if (!FTH_KEYWORD_P(tmp))
+			continue;
 
-				/*
-				 * If user specified undef, drop that and use
-				 * default value.
-				 */
-				tmp = STACK_FTH_INDEX_REF(vm->dataStack, 0);
+		for (i = 0; i < len; i++)
+			if (!hit[i] && tmp == fth_array_fast_ref(keys, i))
+				break;
 
-				if (!FTH_UNDEF_P(tmp))
-					ficlStackRoll(vm->dataStack, 1);
+		if (i == len)
+			continue;
 
-				ficlStackDrop(vm->dataStack, 1);
-				break;
-			}
-		}
+		hit[i] = 1;
+		val = cell[1];
+		memmove(cell, cell + 2, (size_t) (top - cell - 1) *
+		    sizeof(ficlCell));
+		top -= 2;
+		vm->dataStack->top = top;
+		top[-(len - 1 - i)] = val;
 	}
+
+	if (hit != hits)
+		FTH_FREE(hit);
+
+	for (i = 0; i < len; i++)
+		if (FTH_UNDEF_P(CELL_FTH_REF(top - i)))
+			break;
+
+	ficlStackPushBoolean(vm->dataStack, i < len);
 }
 
+/*
+ * ( opt-args... n req -- opt-args... f )
+ *
+ * Push undef for each of the N optional arguments not on the stack and
+ * a flag, true if one of them is undef.
+ */
 static void
 ficl_args_optional_paren_co(ficlVm *vm)
 {
-	FTH 		defs, fs, tmp;
-	ficlInteger 	req, pos, i, j, len, depth;
+	ficlInteger 	req, len, depth, i;
 
 	FTH_STACK_CHECK(vm, 2, 0);
 	req = ficlStackPopInteger(vm->dataStack);
-	defs = fth_pop_ficl_cell(vm);
-	len = fth_array_length(defs);
+	len = ficlStackPopInteger(vm->dataStack);
+	FTH_STACK_CHECK(vm, req, len);
+	depth = FTH_STACK_DEPTH(vm) - req;
 
-	if (len == 0)
+	if (depth < len) {
+		for (; depth < len; depth++)
+			ficlStackPushFTH(vm->dataStack, FTH_UNDEF);
+
+		ficlStackPushBoolean(vm->dataStack, 1);
 		return;
+	}
 
-	FTH_STACK_CHECK(vm, req, len);
-	depth = FTH_STACK_DEPTH(vm) - req;
+	for (i = 0; i < len; i++)
+		if (FTH_UNDEF_P(STACK_FTH_INDEX_REF(vm->dataStack, i)))
+			break;
 
-	if (depth > len)
-		depth = len;
+	ficlStackPushBoolean(vm->dataStack, i < len);
+}
 
-	for (i = 0, j = depth - 1, pos = req; i < len; i++, j--, pos++) {
-		/* Replace undef with evaled default values. */
-		if (FTH_UNDEF_P(STACK_FTH_INDEX_REF(vm->dataStack, j))) {
-			fs = fth_array_fast_ref(defs, i);
-			FICL_EVAL_STRING_AND_THROW(vm, fs);
-			tmp = ficlStackPopFTH(vm->dataStack);
-			STACK_FTH_INDEX_SET(vm->dataStack, j, tmp);
+/* ( idx -- f )  true if the argument IDX cells below the top is undef */
+static void
+ficl_args_default_p_paren_co(ficlVm *vm)
+{
+	ficlInteger 	idx;
+
+	idx = ficlStackPopInteger(vm->dataStack);
+	ficlStackPushBoolean(vm->dataStack,
+	    FTH_UNDEF_P(STACK_FTH_INDEX_REF(vm->dataStack, idx)));
+}
+
+/* ( val idx -- )  replace the argument IDX cells below the top by VAL */
+static void
+ficl_args_default_paren_co(ficlVm *vm)
+{
+	ficlInteger 	idx;
+	ficlCell 	val;
+
+	idx = ficlStackPopInteger(vm->dataStack);
+	val = ficlStackPop(vm->dataStack);
+	vm->dataStack->top[-idx] = val;
+}
+
+/* ( str -- val )  evaluate default source STR when called */
+static void
+ficl_args_eval_paren_co(ficlVm *vm)
+{
+	FTH 		fs;
+	int 		status;
+
+	fs = ficlStackPopFTH(vm->dataStack);
+	status = ficlVmEvaluate(vm, fth_string_ref(fs));
+
+	if (status == FICL_VM_STATUS_ERROR_EXIT)
+		ficlVmThrowError(vm, "can't execute %S", fs);
+}
+
+/*
+ * Return 1 if every token of the default source FS is a known word, a
+ * prefixed token, or a number.  Compiling anything else would abort
+ * the enclosing definition, e.g. a word defined later in the file.
+ */
+static int
+default_compile_p(ficlVm *vm, FTH fs)
+{
+	ficlSystem     *sys;
+	ficlHash       *hash;
+	ficlWord       *word, *prefixes;
+	ficlString 	s;
+	ficlUnsigned 	i, state;
+	ficlInteger 	depth;
+	char           *p;
+	int 		flag;
+
+	sys = vm->callback.system;
+	prefixes = ficlSystemLookup(sys, "<prefixes>");
+	p = fth_string_ref(fs);
+
+	for (;;) {
+		while (isspace((int) *p))
+			p++;
+
+		if (*p == '\0')
+			return (1);
+
+		s.text = p;
+
+		while (*p != '\0' && !isspace((int) *p))
+			p++;
+
+		s.length = (ficlUnsigned) (p - s.text);
+
+		if (sys->localsCount > 0)
+			word = ficlSystemLookupLocal(sys, s);
+		else
+			word = ficlDictionaryLookup(sys->dictionary, s);
+
+		if (word != NULL)
+			continue;
+
+		flag = 0;
+
+		if (prefixes != NULL) {
+			hash = (ficlHash *) CELL_VOIDP_REF(prefixes->param);
+
+			for (i = 0; !flag && i < hash->size; i++)
+				for (word = hash->table[i];
+				    word != NULL; word = word->link)
+					if (word->length <= s.length &&
+					    ficlStrincmp(s.text, word->name,
+					    word->length) == 0) {
+						flag = 1;
+						break;
+					}
 		}
-		/* Missing args filled with evaled default values. */
-		if (FTH_STACK_DEPTH(vm) <= pos) {
-			fs = fth_array_fast_ref(defs, i);
-			FICL_EVAL_STRING_AND_THROW(vm, fs);
+
+		if (flag)
+			continue;
+
+		/* parse in interpret state, which only pushes the number */
+		depth = FTH_STACK_DEPTH(vm);
+		state = vm->state;
+		vm->state = FICL_VM_STATE_INTERPRET;
+		flag = ficl_parse_number(vm, s);
+		vm->state = state;
+		ficlStackDrop(vm->dataStack, (int) (FTH_STACK_DEPTH(vm) - depth));
+
+		if (!flag)
+			return (0);
+	}
+	/* NOTREACHED */
+}
+
+static ficlCell *
+compile_branch0(ficlDictionary *dict)
+{
+	ficlCell       *patch;
+
+	ficlDictionaryCompileInstruction(dict,
+	    ficlInstructionBranch0ParenWithCheck);
+	ficlDictionaryCompileBarrier(dict);
+	patch = dict->here;
+	ficlDictionaryAppendUnsigned(dict, 1);
+	return (patch);
+}
+
+static void
+compile_resolve(ficlDictionary *dict, ficlCell *patch)
+{
+	CELL_INT_SET(patch, dict->here - patch);
+	ficlDictionaryCompileBarrier(dict);
+}
+
+/*
+ * Compile "if IDX (args-default?) if DEF IDX (args-default) then ...
+ * then" for each DEF in DEFS, the sources of the default values.  A
+ * DEF which can't be compiled now is evaluated when called instead.
+ */
+static void
+compile_arg_defaults(ficlVm *vm, FTH defs)
+{
+	ficlDictionary *dict;
+	ficlCell       *patch, *outer;
+	ficlInteger 	i, len, idx;
+	ficlUnsigned 	u;
+	FTH 		fs;
+	int 		status, restart;
+
+	len = fth_array_length(defs);
+
+	if (len == 0) {
+		/* drop the flag */
+		ficlDictionaryCompileInstruction(FTH_FICL_DICT(),
+		    ficlInstructionDrop);
+		return;
+	}
+
+	dict = FTH_FICL_DICT();
+	u = (ficlUnsigned) ficlInstructionLiteralParen;
+	outer = compile_branch0(dict);
+
+	for (i = 0; i < len; i++) {
+		fs = fth_array_fast_ref(defs, i);
+		idx = len - 1 - i;
+		ficlDictionaryAppendUnsigned(dict, u);
+		ficlDictionaryAppendInteger(dict, idx);
+		ficlDictionaryAppendPointer(dict, args_default_p_paren);
+		patch = compile_branch0(dict);
+
+		if (default_compile_p(vm, fs)) {
+			/*
+			 * <{ may be restarted on the next input line; the
+			 * nested interpreter must not take that for its own
+			 * restart.
+			 */
+			restart = vm->restart;
+			vm->restart = 0;
+			status = ficlVmEvaluate(vm, fth_string_ref(fs));
+			vm->restart = restart;
+
+			if (status != FICL_VM_STATUS_OUT_OF_TEXT)
+				ficlVmThrowError(vm, "can't compile %S", fs);
+		} else {
+			ficlDictionaryAppendUnsigned(dict, u);
+			ficlDictionaryAppendFTH(dict, fs);
+			ficlDictionaryAppendPointer(dict, args_eval_paren);
 		}
+
+		ficlDictionaryAppendUnsigned(dict, u);
+		ficlDictionaryAppendInteger(dict, idx);
+		ficlDictionaryAppendPointer(dict, args_default_paren);
+		compile_resolve(dict, patch);
 	}
+
+	compile_resolve(dict, outer);
 }
 
 static void
@@ -2228,13 +2467,15 @@ See also <{}>, get-optkey, get-optart, get-optkeys, get-optargs."
 					fth_string_sformat(arg2, " %s", s);
 				} while (in_lst);
 			}
-			fth_array_push(keys, fth_make_array_var(2, arg1, arg2));
+			fth_array_push(keys, arg1);
+			fth_array_push(defs, arg2);
 		}
 
 		/*-
 		 * keys postpone literal
 		 * req postpone literal
 		 * postpone (args-keys)
+		 * and the defaults
 		 */
 		ficlDictionaryAppendUnsigned(dict, u);
 		ficlDictionaryAppendFTH(dict, keys);
@@ -2243,8 +2484,12 @@ See also <{}>, get-optkey, get-optart, get-optkeys, get-optargs."
 		ficlDictionaryAppendPointer(dict, args_keys_paren);
 		keyslen = fth_array_length(keys);
 
+		compile_arg_defaults(vm, defs);
+
 		for (i = 0; i < keyslen; i++)
 			ficlVmExecuteXT(vm, local_paren);
+
+		defs = fth_make_empty_array();
 	}
 
 	/*
@@ -2288,16 +2533,19 @@ See also <{}>, get-optkey, get-optart, get-optkeys, get-optargs."
 		}
 
 		/*-
-		 * defs postpone literal
+		 * defslen postpone literal
 		 * req postpone literal
 		 * postpone (args-optional)
+		 * and the defaults
 		 */
+		defslen = fth_array_length(defs);
 		ficlDictionaryAppendUnsigned(dict, u);
-		ficlDictionaryAppendFTH(dict, defs);
+		ficlDictionaryAppendInteger(dict, defslen);
 		ficlDictionaryAppendUnsigned(dict, u);
 		ficlDictionaryAppendInteger(dict, req);
 		ficlDictionaryAppendPointer(dict, args_optional_paren);
-		defslen = fth_array_length(defs);
+
+		compile_arg_defaults(vm, defs);
 
 		for (i = 0; i < defslen; i++)
 			ficlVmExecuteXT(vm, local_paren);
@@ -2332,15 +2580,12 @@ static char 	locals_dummy[] = " ___dummy___ ";
 void
 ficl_init_locals(ficlVm *vm, ficlDictionary *dict)
 {
-	ficlUnsigned	u;
-
 	/*-
 	 * 0 postpone literal ( dummy value for dummy variable )
 	 * s" ___dummy___" (local)
 	 * 0 0 (local)
 	 */
-	u = (ficlUnsigned) ficlInstructionLiteralParen;
-	ficlDictionaryAppendUnsigned(dict, u);
+	ficlDictionaryCompileInstruction(dict, ficlInstructionLiteralParen);
 	ficlDictionaryAppendUnsigned(dict, 0UL);
 	push_forth_string(vm, locals_dummy);
 	ficlVmExecuteXT(vm, local_paren);
@@ -3016,6 +3261,12 @@ init_proc(void)
 	    ficl_args_keys_paren_co, NULL);
 	args_optional_paren = FTH_PRIM_CO("(args-optional)",
 	    ficl_args_optional_paren_co, NULL);
+	args_default_p_paren = FTH_PRIM_CO("(args-default?)",
+	    ficl_args_default_p_paren_co, NULL);
+	args_default_paren = FTH_PRIM_CO("(args-default)",
+	    ficl_args_default_paren_co, NULL);
+	args_eval_paren = FTH_PRIM_CO("(args-eval)",
+	    ficl_args_eval_paren_co, NULL);
 
 	/* redefinition of colon (:) */
 	FTH_PRIMITIVE_SET(":", ficl_begin_definition,
@@ -112,6 +112,7 @@ static void 	ficl_string_p(ficlVm *);
 static void 	ficl_string_ref(ficlVm *);
 static void 	ficl_string_replace(ficlVm *);
 static void 	ficl_string_replace_bang(ficlVm *);
+static void 	ficl_string_reserve(ficlVm *);
 static void 	ficl_string_reverse(ficlVm *);
 static void 	ficl_string_reverse_bang(ficlVm *);
 static void 	ficl_string_set(ficlVm *);
@@ -126,10 +127,14 @@ static FString *make_string_len(ficlInteger);
 static FTH	str_dump(FTH);
 static FTH	str_equal_p(FTH, FTH);
 static void 	str_free(FTH);
+static void 	str_grow(FTH, ficlInteger);
+static FTH	str_hash(FTH);
 static FTH	str_inspect(FTH);
 static FTH	str_length(FTH);
 static FTH	str_ref(FTH, FTH);
+static void 	str_resize(FTH, ficlInteger);
 static FTH	str_set(FTH, FTH, FTH);
+static void 	str_shrink(FTH);
 static FTH	str_to_array(FTH);
 static FTH	str_to_string(FTH);
 
@@ -182,6 +187,7 @@ string-push         ( str str-or-else -- str' )\n\
 string-ref          ( str idx -- val )\n\
 string-replace      ( str1 c1 c2 -- str2 )\n\
 string-replace!     ( str c1 c2 -- str' )\n\
+string-reserve      ( str len -- str' )\n\
 string-reverse      ( str1 -- str2 )\n\
 string-reverse!     ( str -- str' )\n\
 string-set!         ( str idx val -- )\n\
@@ -290,6 +296,13 @@ str_equal_p(FTH self, FTH obj)
 	return (BOOL_TO_FTH(strcmp(s, o) == 0));
 }
 
+static FTH
+str_hash(FTH self)
+{
+	return (FTH_HASH_ID_TO_FIX(fth_hash_bytes(FTH_STRING_DATA(self),
+	    FTH_STRING_LENGTH(self))));
+}
+
 static FTH
 str_length(FTH self)
 {
@@ -400,6 +413,48 @@ make_string_len(ficlInteger len)
 	return (s);
 }
 
+static void
+str_resize(FTH fs, ficlInteger len)
+{
+	if (len > MAX_SEQ_LENGTH)
+		FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, len, "too long");
+
+	FTH_STRING_BUF_LENGTH(fs) = len;
+	FTH_STRING_BUF(fs) = FTH_REALLOC(FTH_STRING_BUF(fs), (size_t) len);
+	FTH_STRING_DATA(fs) = FTH_STRING_BUF(fs) + FTH_STRING_TOP(fs);
+}
+
+/*
+ * Make room for NEW_BUF_LEN chars including top and '\0'.
+ */
+static void
+str_grow(FTH fs, ficlInteger new_buf_len)
+{
+	ficlInteger 	len;
+
+	if (new_buf_len <= FTH_STRING_BUF_LENGTH(fs))
+		return;
+
+	len = GROW_SEQ_LENGTH(FTH_STRING_BUF_LENGTH(fs), new_buf_len);
+
+	if (len > MAX_SEQ_LENGTH)
+		len = NEW_SEQ_LENGTH(new_buf_len);
+
+	str_resize(fs, len);
+}
+
+static void
+str_shrink(FTH fs)
+{
+	ficlInteger 	len;
+
+	len = SHRINK_SEQ_LENGTH(FTH_STRING_BUF_LENGTH(fs),
+	    FTH_STRING_TOP(fs) + FTH_STRING_LENGTH(fs) + 1);
+
+	if (len < FTH_STRING_BUF_LENGTH(fs))
+		str_resize(fs, len);
+}
+
 static FTH
 make_string_instance(FString *s)
 {
@@ -1238,7 +1293,7 @@ s1 => \"foo 10\"\n\
 Append string representation of VALUE to STRING \
 and return changed string object.\n\
 See also string-pop, string-unshift, string-shift."
-	ficlInteger 	new_buf_len, l, sl, al;
+	ficlInteger 	sl, al;
 	size_t 		st;
 	char           *b;
 
@@ -1252,19 +1307,7 @@ See also string-pop, string-unshift, string-shift."
 
 	sl = FTH_STRING_LENGTH(fs);
 	al = FTH_STRING_LENGTH(add);
-	new_buf_len = FTH_STRING_TOP(fs) + sl + al + 1;
-
-	if (new_buf_len > FTH_STRING_BUF_LENGTH(fs)) {
-		l = NEW_SEQ_LENGTH(new_buf_len);
-
-		if (l > MAX_SEQ_LENGTH)
-			FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, l, "too long");
-
-		FTH_STRING_BUF_LENGTH(fs) = l;
-		st = (size_t) l;
-		FTH_STRING_BUF(fs) = FTH_REALLOC(FTH_STRING_BUF(fs), st);
-		FTH_STRING_DATA(fs) = FTH_STRING_BUF(fs) + FTH_STRING_TOP(fs);
-	}
+	str_grow(fs, FTH_STRING_TOP(fs) + sl + al + 1);
 	st = (size_t) FTH_STRING_LENGTH(add);
 	b = FTH_STRING_DATA(add);
 	memmove(FTH_STRING_DATA(fs) + sl, b, st);
@@ -1274,6 +1317,44 @@ See also string-pop, string-unshift, string-shift."
 	return (fs);
 }
 
+/*-
+ * FTH fs = fth_make_string("");
+ * fth_string_reserve(fs, 1024);		=> "" (room for 1024 chars)
+ */
+FTH
+fth_string_reserve(FTH fs, ficlInteger len)
+{
+	FTH_ASSERT_ARGS(FTH_STRING_P(fs), fs, FTH_ARG1, "a string");
+
+	if (len < 0)
+		FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG2, len, "negative");
+
+	if (FTH_STRING_TOP(fs) + len + 1 > FTH_STRING_BUF_LENGTH(fs))
+		str_resize(fs, NEW_SEQ_LENGTH(FTH_STRING_TOP(fs) + len + 1));
+
+	return (fs);
+}
+
+static void
+ficl_string_reserve(ficlVm *vm)
+{
+#define h_string_reserve "( str len -- str' )  make room for LEN chars\n\
+\"\" 65536 string-reserve value s1\n\
+s1 length => 0\n\
+Make room for at least LEN characters in STR \
+so that appending up to LEN characters doesn't reallocate.  \
+STR's length and content don't change.  \
+Raise an OUT-OF-RANGE exception if LEN < 0.\n\
+See also string-push."
+	ficlInteger 	len;
+	FTH 		fs;
+
+	FTH_STACK_CHECK(vm, 2, 1);
+	len = ficlStackPopInteger(vm->dataStack);
+	fs = fth_pop_ficl_cell(vm);
+	ficlStackPushFTH(vm->dataStack, fth_string_reserve(fs, len));
+}
+
 /*-
  * FTH fs = fth_make_string("foo");
  * fth_string_pop(fs);				=> 111 ('o')
@@ -1293,7 +1374,6 @@ s1 string-pop => #f\n\
 Remove and return last character.  \
 If STR is empty, return #f.\n\
 See also string-push, string-unshift, string-shift."
-	ficlInteger 	l;
 	FTH 		c;
 
 	c = FTH_FALSE;
@@ -1302,17 +1382,10 @@ See also string-push, string-unshift, string-shift."
 	if (FTH_STRING_LENGTH(fs) == 0)
 		return (c);
 
-	/* - 1 (length--) + 1 ('\0') */
-	l = NEW_SEQ_LENGTH(FTH_STRING_TOP(fs) + FTH_STRING_LENGTH(fs));
 	FTH_STRING_LENGTH(fs)--;
 	c = CHAR_TO_FTH(FTH_STRING_DATA(fs)[FTH_STRING_LENGTH(fs)]);
 	FTH_STRING_DATA(fs)[FTH_STRING_LENGTH(fs)] = '\0';
-
-	if (l < FTH_STRING_BUF_LENGTH(fs)) {
-		FTH_STRING_BUF_LENGTH(fs) = l;
-		FTH_STRING_BUF(fs) = FTH_REALLOC(FTH_STRING_BUF(fs), (size_t)l);
-		FTH_STRING_DATA(fs) = FTH_STRING_BUF(fs) + FTH_STRING_TOP(fs);
-	}
+	str_shrink(fs);
 	FTH_INSTANCE_CHANGED(fs);
 	return (c);
 }
@@ -1333,7 +1406,7 @@ s1 => \"10 foo\"\n\
 Prepends string representation of VALUE to STRING \
 and return changed string object.\n\
 See also string-push, string-pop, string-shift."
-	ficlInteger 	l , new_top, new_len, new_buf_len, al;
+	ficlInteger 	new_top, new_len, new_buf_len, al;
 	char           *b;
 	size_t 		st;
 
@@ -1352,34 +1425,13 @@ See also string-push, string-pop, string-shift."
 
 	if (new_top < 1) {
 		new_top = FTH_STRING_BUF_LENGTH(fs) / 3;
-		new_buf_len = new_top + new_len + 1;
-
-		if (new_buf_len > FTH_STRING_BUF_LENGTH(fs)) {
-			l = NEW_SEQ_LENGTH(new_buf_len);
-
-			if (l > MAX_SEQ_LENGTH)
-				FTH_OUT_OF_BOUNDS_ERROR(1, l, "too long");
-			FTH_STRING_BUF_LENGTH(fs) = l;
-			st = (size_t) l;
-			FTH_STRING_BUF(fs) =
-			    FTH_REALLOC(FTH_STRING_BUF(fs), st);
-			FTH_STRING_DATA(fs) =
-			    FTH_STRING_BUF(fs) + FTH_STRING_TOP(fs);
-		}
+		str_grow(fs, new_top + new_len + 1);
 		b = FTH_STRING_DATA(fs);
 		st = (size_t) FTH_STRING_LENGTH(fs);
 		memmove(FTH_STRING_BUF(fs) + new_top + al, b, st);
-	} else if (new_buf_len > FTH_STRING_BUF_LENGTH(fs)) {
-		l = NEW_SEQ_LENGTH(new_buf_len);
-
-		if (l > MAX_SEQ_LENGTH)
-			FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, l, "too long");
+	} else
+		str_grow(fs, new_buf_len);
 
-		FTH_STRING_BUF_LENGTH(fs) = l;
-		st = (size_t) l;
-		FTH_STRING_BUF(fs) = FTH_REALLOC(FTH_STRING_BUF(fs), st);
-		FTH_STRING_DATA(fs) = FTH_STRING_BUF(fs) + FTH_STRING_TOP(fs);
-	}
 	FTH_STRING_TOP(fs) = new_top;
 	FTH_STRING_LENGTH(fs) = new_len;
 	b = FTH_STRING_DATA(add);
@@ -1410,7 +1462,6 @@ s1 string-shift => #f\n\
 Remove and return first character.  \
 If STR is empty, return #f.\n\
 See also string-push, string-pop, string-unshift."
-	ficlInteger 	l;
 	size_t 		st;
 	char           *b;
 	FTH 		c;
@@ -1429,17 +1480,10 @@ See also string-push, string-pop, string-unshift."
 		st = (size_t) FTH_STRING_LENGTH(fs);
 		memmove(FTH_STRING_BUF(fs) + FTH_STRING_TOP(fs), b, st);
 	}
-	/* - 1 (length--) + 1 ('\0') */
-	l = NEW_SEQ_LENGTH(FTH_STRING_TOP(fs) + FTH_STRING_LENGTH(fs));
 	FTH_STRING_LENGTH(fs)--;
 	FTH_STRING_TOP(fs)++;
-
-	if (l < FTH_STRING_BUF_LENGTH(fs)) {
-		FTH_STRING_BUF_LENGTH(fs) = l;
-		st = (size_t) l;
-		FTH_STRING_BUF(fs) = FTH_REALLOC(FTH_STRING_BUF(fs), st);
-	}
 	FTH_STRING_DATA(fs) = FTH_STRING_BUF(fs) + FTH_STRING_TOP(fs);
+	str_shrink(fs);
 	FTH_INSTANCE_CHANGED(fs);
 	return (c);
 }
@@ -1523,7 +1567,7 @@ See also string-reverse."
 FTH
 fth_string_insert(FTH fs, ficlInteger idx, FTH ins)
 {
-	ficlInteger 	sl, il, rl, new_buf_len, l;
+	ficlInteger 	sl, il, rl;
 	size_t 		st;
 
 	FTH_ASSERT_ARGS(FTH_STRING_P(fs), fs, FTH_ARG1, "a string");
@@ -1548,19 +1592,7 @@ fth_string_insert(FTH fs, ficlInteger idx, FTH ins)
 		return (fs);
 
 	rl = sl + il + 1;
-	new_buf_len = FTH_STRING_TOP(fs) + rl;
-
-	if (new_buf_len > FTH_STRING_BUF_LENGTH(fs)) {
-		l = NEW_SEQ_LENGTH(new_buf_len);
-
-		if (l > MAX_SEQ_LENGTH)
-			FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, l, "too long");
-
-		FTH_STRING_BUF_LENGTH(fs) = l;
-		st = (size_t) l;
-		FTH_STRING_BUF(fs) = FTH_REALLOC(FTH_STRING_BUF(fs), st);
-		FTH_STRING_DATA(fs) = FTH_STRING_BUF(fs) + FTH_STRING_TOP(fs);
-	}
+	str_grow(fs, FTH_STRING_TOP(fs) + rl);
 	st = (size_t) (sl - idx);
 	memmove(FTH_STRING_DATA(fs) + idx + il, FTH_STRING_DATA(fs) + idx, st);
 	st = (size_t) il;
@@ -1599,7 +1631,6 @@ Raise an OUT-OF-RANGE exception if index is not in range of string."
 FTH
 fth_string_delete(FTH fs, ficlInteger idx)
 {
-	ficlInteger 	l;
 	size_t 		st;
 	FTH 		c;
 
@@ -1623,17 +1654,10 @@ fth_string_delete(FTH fs, ficlInteger idx)
 
 	c = CHAR_TO_FTH(FTH_STRING_DATA(fs)[idx]);
 	FTH_STRING_LENGTH(fs)--;
-	l = NEW_SEQ_LENGTH(FTH_STRING_TOP(fs) + FTH_STRING_LENGTH(fs) + 1);
-
-	if (l < FTH_STRING_BUF_LENGTH(fs)) {
-		FTH_STRING_BUF_LENGTH(fs) = l;
-		st = (size_t) l;
-		FTH_STRING_BUF(fs) = FTH_REALLOC(FTH_STRING_BUF(fs), st);
-		FTH_STRING_DATA(fs) = FTH_STRING_BUF(fs) + FTH_STRING_TOP(fs);
-	}
 	st = (size_t) (FTH_STRING_LENGTH(fs) - idx);
 	memmove(FTH_STRING_DATA(fs) + idx, FTH_STRING_DATA(fs) + idx + 1, st);
 	FTH_STRING_DATA(fs)[FTH_STRING_LENGTH(fs)] = '\0';
+	str_shrink(fs);
 	FTH_INSTANCE_CHANGED(fs);
 	return (c);
 }
@@ -2168,7 +2192,7 @@ FTH
 fth_string_replace(FTH fs, FTH from, FTH to)
 {
 	char           *tmp, *b, *cf, *ct;
-	ficlInteger 	i, l, lf, lt;
+	ficlInteger 	i, lf, lt;
 	size_t 		st;
 
 	FTH_ASSERT_ARGS(FTH_STRING_P(fs), fs, FTH_ARG1, "a string");
@@ -2221,20 +2245,11 @@ fth_string_replace(FTH fs, FTH from, FTH to)
 		memmove(tmp, tmp + lf, st);
 
 		/* insert */
-		st = FTH_STRING_TOP(fs) + FTH_STRING_LENGTH(fs) + lt + 1;
-		l = NEW_SEQ_LENGTH(st);
-
-		if (l > MAX_SEQ_LENGTH)
-			FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, l, "too long");
-
-		if (l > FTH_STRING_BUF_LENGTH(fs)) {
-			FTH_STRING_BUF_LENGTH(fs) = l;
-			st = (size_t) l;
-			FTH_STRING_BUF(fs) =
-			    FTH_REALLOC(FTH_STRING_BUF(fs), st);
-			FTH_STRING_DATA(fs) =
-			    FTH_STRING_BUF(fs) + FTH_STRING_TOP(fs);
-		}
+		str_grow(fs, FTH_STRING_TOP(fs) + FTH_STRING_LENGTH(fs) +
+		    lt + 1);
+		/* realloc may have moved the buffer */
+		b = FTH_STRING_DATA(fs);
+		tmp = b + i;
 		st = (size_t) (FTH_STRING_LENGTH(fs) - i);
 		memmove(FTH_STRING_DATA(fs) + i + lt, b + i, st);
 		st = (size_t) lt;
@@ -2571,6 +2586,7 @@ init_string_type(void)
 	fth_set_object_value_ref(string_tag, str_ref);
 	fth_set_object_value_set(string_tag, str_set);
 	fth_set_object_equal_p(string_tag, str_equal_p);
+	fth_set_object_hash(string_tag, str_hash);
 	fth_set_object_length(string_tag, str_length);
 	fth_set_object_free(string_tag, str_free);
 }
@@ -2624,6 +2640,7 @@ init_string(void)
 	FTH_PROC("string-push", fth_string_push, 2, 0, 0, h_string_push);
 	FTH_PROC("<<", fth_string_push, 2, 0, 0, h_string_push);
 	FTH_PROC("string-pop", fth_string_pop, 1, 0, 0, h_string_pop);
+	FTH_PRI1("string-reserve", ficl_string_reserve, h_string_reserve);
 	FTH_PROC("string-unshift", fth_string_unshift, 2, 0, 0, h_str_unshift);
 	FTH_PROC("string-shift", fth_string_shift, 1, 0, 0, h_string_shift);
 	FTH_PROC("string-append", fth_string_append, 2, 0, 0, h_string_append);
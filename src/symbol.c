@@ -44,7 +44,7 @@ static void 	ficl_symbol_p(ficlVm *);
 static void 	ficl_symbol_paren(ficlVm *);
 static int	fth_any_symbol_p(const char *, int);
 static FTH	fth_make_symbol(FTH);
-static FTH	make_symbol(const char *, const char *, char, int);
+static FTH	make_symbol(const char *, const char *, char, int, int *);
 
 /* keyword */
 static void 	ficl_create_keyword(ficlVm *);
@@ -185,24 +185,144 @@ Return #t if OBJ is a symbol, otherwise #f."
 	ficlStackPushBoolean(vm->dataStack, FTH_SYMBOL_P(obj));
 }
 
+/*
+ * Symbols, keywords and exceptions are constants in the dictionary
+ * whose names carry a prefix char.  The intern table maps prefix and
+ * name to the word, independent of the search order, so an existing
+ * one is found without allocating or walking the dictionary hash.
+ * Names are compared case insensitive like ficlHashLookup() does.
+ */
+typedef struct {
+	ficlWord       *word;
+	unsigned int 	hash;
+} FIntern;
+
+static FIntern *intern_table;
+static size_t 	intern_size;	/* power of 2 */
+static size_t 	intern_count;
+
+static unsigned int intern_hash(char, const char *, size_t *);
+static void 	intern_insert(ficlWord *, unsigned int);
+static ficlWord *intern_lookup(char, const char *, size_t, unsigned int);
+static void 	intern_resize(size_t);
+
+/* FNV-1a over the lower case prefix and name. */
+static unsigned int
+intern_hash(char prefix, const char *name, size_t *len)
+{
+	const unsigned char *s;
+	unsigned int 	h;
+
+	h = (2166136261U ^ (unsigned char)prefix) * 16777619U;
+
+	for (s = (const unsigned char *)name; *s != '\0'; s++)
+		h = (h ^ (unsigned int)tolower(*s)) * 16777619U;
+
+	*len = (size_t)(s - (const unsigned char *)name);
+	return (h);
+}
+
+static ficlWord *
+intern_lookup(char prefix, const char *name, size_t len, unsigned int hash)
+{
+	FIntern        *e;
+	size_t 		i, mask;
+
+	if (intern_size == 0)
+		return (NULL);
+
+	mask = intern_size - 1;
+
+	for (i = hash & mask; (e = &intern_table[i])->word != NULL;
+	    i = (i + 1) & mask)
+		if (e->hash == hash &&
+		    e->word->length == len + 1 &&
+		    e->word->name[0] == prefix &&
+		    ficlStrincmp(e->word->name + 1, name, len) == 0)
+			return (e->word);
+
+	return (NULL);
+}
+
+static void
+intern_resize(size_t size)
+{
+	FIntern        *old;
+	size_t 		i, old_size;
+
+	old = intern_table;
+	old_size = intern_size;
+	intern_table = FTH_CALLOC(size, sizeof(FIntern));
+	intern_size = size;
+	intern_count = 0;
+
+	for (i = 0; i < old_size; i++)
+		if (old[i].word != NULL)
+			intern_insert(old[i].word, old[i].hash);
+
+	FTH_FREE(old);
+}
+
+static void
+intern_insert(ficlWord *word, unsigned int hash)
+{
+	size_t 		i, mask;
+
+	/* keep the load factor below 3/4 */
+	if ((intern_count + 1) * 4 > intern_size * 3)
+		intern_resize(intern_size == 0 ? 512 : intern_size * 2);
+
+	mask = intern_size - 1;
+
+	for (i = hash & mask; intern_table[i].word != NULL; i = (i + 1) & mask)
+		/* empty */ ;
+
+	intern_table[i].word = word;
+	intern_table[i].hash = hash;
+	intern_count++;
+}
+
 static FTH
-make_symbol(const char *name, const char *message, char prefix, int kind)
+make_symbol(const char *name, const char *message, char prefix, int kind,
+    int *old_kind)
 {
-	char           *sname;
+	char 		sname[FICL_NAME_LENGTH + 2];
 	ficlWord       *word;
+	unsigned int 	hash;
+	size_t 		len;
 
 	if (name == NULL || *name == '\0') {
 		FTH_ASSERT_STRING(0);
 		return (FTH_FALSE);
 	}
-	sname = (*name != prefix) ?
-	    fth_format("%c%s", prefix, name) :
-	    FTH_STRDUP(name);
-
-	word = ficlDictionarySetConstant(FTH_FICL_DICT(), sname, 0L);
-	FTH_FREE(sname);
-
+	if (*name == prefix)
+		name++;
+
+	hash = intern_hash(prefix, name, &len);
+	word = intern_lookup(prefix, name, len, hash);
+
+	if (word == NULL) {
+		if (len < FICL_NAME_LENGTH) {
+			snprintf(sname, sizeof(sname), "%c%s", prefix, name);
+			word = ficlDictionarySetConstant(FTH_FICL_DICT(),
+			    sname, 0L);
+
+			if (word != NULL)
+				intern_insert(word, hash);
+		} else {
+			char           *lname;
+
+			/* too long for the table; ficl truncates it */
+			lname = fth_format("%c%s", prefix, name);
+			word = ficlDictionarySetConstant(FTH_FICL_DICT(),
+			    lname, 0L);
+			FTH_FREE(lname);
+		}
+	}
 	if (word != NULL) {
+		if (old_kind != NULL)
+			*old_kind = word->kind;
+
 		word->kind = kind;
 		CELL_VOIDP_SET(word->param, word);
 
@@ -222,7 +342,7 @@ make_symbol(const char *name, const char *message, char prefix, int kind)
 FTH
 fth_symbol(const char *name)
 {
-	return (make_symbol(name, NULL, SYMBOL_PREFIX, FW_SYMBOL));
+	return (make_symbol(name, NULL, SYMBOL_PREFIX, FW_SYMBOL, NULL));
 }
 
 static void
@@ -356,7 +476,7 @@ Return #t if OBJ is a keyword, otherwise #f."
 FTH
 fth_keyword(const char *name)
 {
-	return (make_symbol(name, NULL, KEYWORD_PREFIX, FW_KEYWORD));
+	return (make_symbol(name, NULL, KEYWORD_PREFIX, FW_KEYWORD, NULL));
 }
 
 static void
@@ -511,10 +631,14 @@ FTH
 fth_make_exception(const char *name, const char *message)
 {
 	FTH 		ex;
+	int 		old_kind;
 
-	ex = make_symbol(name, message, SYMBOL_PREFIX, FW_EXCEPTION);
+	ex = make_symbol(name, message, SYMBOL_PREFIX, FW_EXCEPTION,
+	    &old_kind);
 
-	if (!fth_array_member_p(exception_list, ex))
+	/* An existing exception is already in the list. */
+	if (old_kind != FW_EXCEPTION &&
+	    !fth_array_member_p(exception_list, ex))
 		fth_array_push(exception_list, ex);
 
 	return (ex);
@@ -749,6 +873,192 @@ ficl_ans_real_exc(int exc)
 	return (FTH_FALSE);
 }
 
+/*
+ * Names of the predefined symbols, keywords and exceptions in the
+ * order of the FTH_PRE_* constants in fth-lib.h.
+ */
+static struct {
+	const char     *name;
+	char 		prefix;
+	int 		kind;
+} predefined_names[FTH_PRE_LAST] = {
+	{"documentation", SYMBOL_PREFIX, FW_SYMBOL},
+	{"last-message", SYMBOL_PREFIX, FW_SYMBOL},
+	{"message", SYMBOL_PREFIX, FW_SYMBOL},
+	{"source", SYMBOL_PREFIX, FW_SYMBOL},
+	{"trace-var-hook", SYMBOL_PREFIX, FW_SYMBOL},
+	{"close", KEYWORD_PREFIX, FW_KEYWORD},
+	{"command", KEYWORD_PREFIX, FW_KEYWORD},
+	{"count", KEYWORD_PREFIX, FW_KEYWORD},
+	{"domain", KEYWORD_PREFIX, FW_KEYWORD},
+	{"fam", KEYWORD_PREFIX, FW_KEYWORD},
+	{"filename", KEYWORD_PREFIX, FW_KEYWORD},
+	{"flush", KEYWORD_PREFIX, FW_KEYWORD},
+	{"if-exists", KEYWORD_PREFIX, FW_KEYWORD},
+	{"initial-element", KEYWORD_PREFIX, FW_KEYWORD},
+	{"n", KEYWORD_PREFIX, FW_KEYWORD},
+	{"port", KEYWORD_PREFIX, FW_KEYWORD},
+	{"port-name", KEYWORD_PREFIX, FW_KEYWORD},
+	{"range", KEYWORD_PREFIX, FW_KEYWORD},
+	{"read-char", KEYWORD_PREFIX, FW_KEYWORD},
+	{"read-line", KEYWORD_PREFIX, FW_KEYWORD},
+	{"reps", KEYWORD_PREFIX, FW_KEYWORD},
+	{"socket", KEYWORD_PREFIX, FW_KEYWORD},
+	{"soft-port", KEYWORD_PREFIX, FW_KEYWORD},
+	{"start", KEYWORD_PREFIX, FW_KEYWORD},
+	{"string", KEYWORD_PREFIX, FW_KEYWORD},
+	{"whence", KEYWORD_PREFIX, FW_KEYWORD},
+	{"write-char", KEYWORD_PREFIX, FW_KEYWORD},
+	{"write-line", KEYWORD_PREFIX, FW_KEYWORD},
+	{STR_BAD_ARITY, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_BAD_SYNTAX, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_BIGNUM_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_CATCH_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_EVAL_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_FICL_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_FORTH_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_LOAD_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_MATH_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_NO_MEMORY_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_NULL_STRING, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_OPTKEY_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_OUT_OF_RANGE, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_REGEXP_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_SIGNAL_CAUGHT, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_SOCKET_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_SO_FILE_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_SYSTEM_ERROR, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_WRONG_NUMBER_OF_ARGS, SYMBOL_PREFIX, FW_EXCEPTION},
+	{STR_WRONG_TYPE_ARG, SYMBOL_PREFIX, FW_EXCEPTION},
+};
+
+FTH 		fth_predefined[FTH_PRE_LAST];
+
+/*
+ * Called by the FTH_PREDEFINED() macro if the cached handle is not
+ * set or doesn't have the expected kind anymore.
+ */
+FTH
+fth_predefined_ref(int idx)
+{
+	const char     *name;
+
+	if (idx < 0 || idx >= FTH_PRE_LAST)
+		return (FTH_FALSE);
+
+	name = predefined_names[idx].name;
+
+	if (predefined_names[idx].kind == FW_EXCEPTION)
+		fth_predefined[idx] = fth_exception(name);
+	else
+		fth_predefined[idx] = make_symbol(name, NULL,
+		    predefined_names[idx].prefix, predefined_names[idx].kind,
+		    NULL);
+
+	return (fth_predefined[idx]);
+}
+
+/*
+ * Return ANS or Ficl exception EXC, a FICL_VM_STATUS_* value, from
+ * the lists filled in init_symbol().
+ */
+FTH
+ficl_ans_exception(int exc)
+{
+	FTH 		ex;
+
+	ex = ficl_ans_real_exc(exc);
+
+	if (FTH_EXCEPTION_P(ex))
+		return (ex);
+
+	return (fth_exception(ficl_ans_exc_name(exc)));
+}
+
+/*
+ * Called by forget, forget-wid, a negative allot and an aborted
+ * definition; removes all interned words and cached handles at or
+ * above WHERE.  Addresses outside the main dictionary are ignored.
+ */
+void
+fth_symbol_forget(void *where)
+{
+	FIntern        *old;
+	size_t 		i, old_size;
+	int 		j;
+
+	if (FTH_FICL_VAR() == NULL ||
+	    (ficlCell *)where < FTH_FICL_DICT()->base ||
+	    (ficlCell *)where > FTH_FICL_DICT()->base + FTH_FICL_DICT()->size)
+		return;
+
+	for (j = 0; j < FTH_PRE_LAST; j++)
+		if ((void *)fth_predefined[j] >= where)
+			fth_predefined[j] = 0;
+
+	for (j = 0; j < FICL_VM_STATUS_LAST_ANS; j++)
+		if ((void *)ans_exc_list[j] >= where)
+			ans_exc_list[j] = FTH_FALSE;
+
+	for (j = 0; j < FICL_VM_STATUS_LAST_FICL; j++)
+		if ((void *)ficl_exc_list[j] >= where)
+			ficl_exc_list[j] = FTH_FALSE;
+
+	if (intern_count == 0)
+		return;
+
+	old = intern_table;
+	old_size = intern_size;
+	intern_table = FTH_CALLOC(old_size, sizeof(FIntern));
+	intern_count = 0;
+
+	for (i = 0; i < old_size; i++)
+		if (old[i].word != NULL && (void *)old[i].word < where)
+			intern_insert(old[i].word, old[i].hash);
+
+	FTH_FREE(old);
+}
+
+/*
+ * Return an array of the interned words in [FROM, TO); image.c saves
+ * them with a dictionary image.
+ */
+FTH
+fth_symbol_interned(void *from, void *to)
+{
+	FTH 		words;
+	size_t 		i;
+
+	words = fth_make_empty_array();
+
+	for (i = 0; i < intern_size; i++)
+		if ((void *)intern_table[i].word >= from &&
+		    (void *)intern_table[i].word < to)
+			fth_array_push(words, (FTH) intern_table[i].word);
+
+	return (words);
+}
+
+/*
+ * Intern WORD of a restored dictionary image again and add it to
+ * *exception-list* if it's an exception.
+ */
+void
+fth_symbol_restore(ficlWord *word)
+{
+	unsigned int 	hash;
+	size_t 		len;
+
+	hash = intern_hash(word->name[0], word->name + 1, &len);
+
+	if (intern_lookup(word->name[0], word->name + 1, len, hash) == NULL)
+		intern_insert(word, hash);
+
+	if (word->kind == FW_EXCEPTION &&
+	    !fth_array_member_p(exception_list, (FTH) word))
+		fth_array_push(exception_list, (FTH) word);
+}
+
 void
 init_symbol(void)
 {
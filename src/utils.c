@@ -47,6 +47,9 @@ static void	ficl_cold(ficlVm *);
 static void	ficl_ps_cb(ficlVm *);
 #endif
 static void	ficl_repl_cb(ficlVm *);
+#if !defined(_WIN32)
+static int	execute_toplevel(ficlVm *, int, void *);
+#endif
 static void    *fixup_null_alloc(size_t, const char *);
 static int	get_pos_from_buffer(ficlVm *, char *);
 static ficlString parse_input_buffer_0(ficlVm *, int pos);
@@ -262,23 +265,80 @@ fth_getenv(const char *name, char *def)
 
 /* === Eval and Execute Wrapper === */
 
+enum {
+	EXECUTE_EVAL,
+	EXECUTE_STRING,
+	EXECUTE_XT
+};
+
 #if !defined(_WIN32)
+/*
+ * The signal handler jumps to fth_sig_toplevel.  Saving the signal
+ * mask there costs a system call, so only the outermost call sets it;
+ * calls nested in it (callbacks of array-each, sort, hooks, procs
+ * etc.) run without.  Interrupts are delivered by the inner
+ * interpreter, see fth_signal_deliver(); faults land in the outermost
+ * call.  If an exception leaves the outermost call, ficlVmThrow()
+ * resets fth_toplevel_p.
+ */
+static int
+execute_toplevel(ficlVm *vm, int kind, void *arg)
+{
+	volatile int 	status, sig, level;
+	jmp_buf        *volatile outside;
+	void           *volatile loading;
+
+	status = FICL_VM_STATUS_OUT_OF_TEXT;
+	outside = vm->exceptionHandler;
+	level = vm->gc_frame_level;
+	loading = fth_load_mark();
+	fth_toplevel_catch = outside;
+	sig = sigsetjmp(fth_sig_toplevel, 1);
+
+	if (sig == 0) {
+		fth_toplevel_p = 1;
+
+		switch (kind) {
+		case EXECUTE_EVAL:
+			status = ficlVmEvaluate(vm, (char *) arg);
+			break;
+		case EXECUTE_STRING:
+			status = ficlVmExecuteString(vm, *(ficlString *) arg);
+			break;
+		case EXECUTE_XT:
+		default:
+			status = ficlVmExecuteXT(vm, (ficlWord *) arg);
+			break;
+		}
+	} else {
+		/* Back from the depths, drop what was left there. */
+		fth_toplevel_p = 0;
+		fth_signal_pending = 0;
+		vm->exceptionHandler = outside;
+		vm->gc_frame_level = level;
+		signal_check(sig);
+		fth_load_unwind(loading);
+	}
+	fth_toplevel_p = 0;
+	return (status);
+}
+
 /* Evaluate input lines. */
 int
 fth_evaluate(ficlVm *vm, const char *buffer)
 {
-	volatile int 	status, sig;
+	int 		status;
 
 	status = FICL_VM_STATUS_OUT_OF_TEXT;
 
 	if (buffer != NULL) {
 		gc_push(vm->runningWord);
-		sig = sigsetjmp(fth_sig_toplevel, 1);
 
-		if (sig == 0)
+		if (fth_toplevel_p)
 			status = ficlVmEvaluate(vm, (char *) buffer);
 		else
-			signal_check(sig);
+			status = execute_toplevel(vm, EXECUTE_EVAL,
+			    (void *) buffer);
 
 		gc_pop();
 	}
@@ -289,24 +349,33 @@ fth_evaluate(ficlVm *vm, const char *buffer)
 int
 fth_execute_xt(ficlVm *vm, ficlWord *word)
 {
-	volatile int 	status, sig;
+	int 		status;
 
 	status = FICL_VM_STATUS_OUT_OF_TEXT;
 
 	if (word != NULL) {
 		gc_push(word);
-		sig = sigsetjmp(fth_sig_toplevel, 1);
 
-		if (sig == 0)
+		if (fth_toplevel_p)
 			status = ficlVmExecuteXT(vm, word);
 		else
-			signal_check(sig);
+			status = execute_toplevel(vm, EXECUTE_XT, word);
 
 		gc_pop();
 	}
 	return (status);
 }
 
+/* Interpret one line of a file. */
+int
+fth_execute_string(ficlVm *vm, ficlString s)
+{
+	if (fth_toplevel_p)
+		return (ficlVmExecuteString(vm, s));
+
+	return (execute_toplevel(vm, EXECUTE_STRING, &s));
+}
+
 #else				/* _WIN32 */
 
 int
@@ -334,6 +403,12 @@ fth_execute_xt(ficlVm *vm, ficlWord *word)
 
 	return (status);
 }
+
+int
+fth_execute_string(ficlVm *vm, ficlString s)
+{
+	return (ficlVmExecuteString(vm, s));
+}
 #endif				/* _WIN32 */
 
 /* === Utilities === */
@@ -1733,6 +1808,7 @@ get_line(char *prompt, char *dummy)
 
 	buf = utils_readline_buffer;
 	buf[0] = '\0';
+	fth_port_flush_output();
 	fgets(buf, BUFSIZ, stdin);
 
 	if (*buf == '\0')	/* Ctrl-D */
@@ -1879,6 +1955,7 @@ fth_repl(int argc, char **argv)
 		}
 #endif
 #if defined(HAVE_LIBTECLA)
+		fth_port_flush_output();
 		line = gl_get_line(gl, prompt, err_line, -1);
 
 		if (line == NULL) {
@@ -39,6 +39,7 @@
  * $FTH_HISTORY_LENGTH		100
  * $FTH_FTHPATH			""
  * $FTH_LIBPATH			""
+ * $FTH_LOAD_CACHE		unset (see *load-cache*)
  *
  * $FTH_DICTIONARY_SIZE		1024 * 1024
  * $FTH_STACK_SIZE		1024 * 8
@@ -51,6 +52,7 @@
 #define FTH_ENV_HIST_LEN	"FTH_HISTORY_LENGTH"
 #define FTH_ENV_FTHPATH		"FTH_FTHPATH"
 #define FTH_ENV_LIBPATH		"FTH_LIBPATH"
+#define FTH_ENV_LOAD_CACHE	"FTH_LOAD_CACHE"
 
 #define FTH_ENV_DICTIONARY_SIZE	"FTH_DICTIONARY_SIZE"
 #define FTH_ENV_STACK_SIZE	"FTH_STACK_SIZE"
@@ -135,6 +137,9 @@ typedef struct {
 #if defined(HAVE_SYS_UIO_H)
 #include <sys/uio.h>
 #endif
+#if defined(HAVE_SIGNAL_H)
+#include <signal.h>
+#endif
 
 #if !defined(HAVE_STRUCT_SOCKADDR_UN) || defined(_WIN32)
 #define HAVE_SOCKET		0
@@ -253,6 +258,7 @@ void		init_hash_type(void);
 void		init_io_type(void);
 void		init_hook_type(void);
 void		init_string_type(void);
+void		init_vector_type(void);
 void		init_regexp_type(void);
 void		init_number_types(void);
 #if HAVE_BN
@@ -271,24 +277,63 @@ void		init_string(void);
 void		init_regexp(void);
 void		init_symbol(void);
 void		init_utils(void);
+void		init_vector(void);
+void		init_image(void);
 
 /* array.c */
 /* Next two have no bound checks! */
 FTH		fth_array_fast_set(FTH, ficlInteger, FTH);
 FTH		fth_array_fast_ref(FTH, ficlInteger);
+int		fth_array_type_ref(FTH);
+void		fth_array_type_set(FTH, int);
+
+/* hash.c */
+int		fth_hash_flat_p(FTH);
+
+/* image.c */
+int		fth_image_load(void);
+int		fth_image_save(void);
+void		fth_image_set(const char *, int);
+int		fth_load_cache_begin(const char *, void **);
+void		fth_load_cache_end(void *, int);
 
 /* io.c */
 FTH		make_io_base(int);
 
+#define FTH_LOAD_BLOCK_SIZE	8192	/* load_file() */
+#define FTH_LOOP_BLOCK_SIZE	65536	/* fth -n, -p, -i */
+
+typedef struct {
+	int 		fd;
+	char           *line;		/* current line, '\0'-terminated */
+	size_t 		size;		/* allocated size of line */
+	char           *block;
+	size_t 		block_size;
+	char           *pos;		/* unread part of block */
+	char           *end;
+	off_t 		remain;		/* bytes left to read or -1 */
+} FLineReader;
+
+FLineReader    *fth_line_reader_open(const char *, size_t);
+void		fth_line_reader_range(FLineReader *, off_t, off_t);
+size_t		fth_line_reader_next(FLineReader *);
+void		fth_line_reader_close(FLineReader *);
+
 /* misc.c */
 void		forth_init(void);
 void		forth_init_before_load(void);
 extern int	fth_signal_caught_p;
 #if !defined(_WIN32)
 extern sigjmp_buf fth_sig_toplevel;
+extern int	fth_toplevel_p;
+extern jmp_buf *fth_toplevel_catch;
+extern volatile sig_atomic_t fth_signal_pending;
+void		fth_signal_deliver(ficlVm *);
 void		signal_check(int);
 #endif
 void		fth_reset_loop_and_depth(void);
+void           *fth_load_mark(void);
+void		fth_load_unwind(void *);
 
 /* numbers.c */
 int		ficl_parse_number(ficlVm *, ficlString);
@@ -303,6 +348,13 @@ int		ficl_parse_ratio(ficlVm *, ficlString);
 /* object.c */
 FTH		make_object_type(const char *, fobj_t);
 FTH		make_object_type_from(const char *, fobj_t, FTH);
+int		fth_object_type_index(FTH);
+FTH		fth_object_type_ref(int);
+FTH		fth_object_type_restore(int, const char *);
+ficlUnsigned	fth_hash_bytes(const char *, ficlInteger);
+ficlUnsigned	fth_hash_combine(ficlUnsigned, ficlUnsigned);
+/* Hash value as returned by object hash functions and hash-id. */
+#define FTH_HASH_ID_TO_FIX(H)	INT_TO_FIX((FTH)(H) & FIXNUM_MAX)
 
 void 		gc_free_all(void);
 void 		gc_push(ficlWord *);
@@ -313,6 +365,8 @@ void 		fth_show_backtrace(int);
 
 /* port.c */
 FTH		io_keyword_args_ref(int);
+int		fth_port_flush_p(const char *);
+void		fth_port_flush_output(void);
 
 /* proc.c */
 FTH		fth_word_dump(FTH);
@@ -330,6 +384,9 @@ FTH		fth_string_split_2(FTH, FTH);
 
 /* symbol.c */
 FTH		ficl_ans_real_exc(int);
+void		fth_symbol_forget(void *);
+FTH		fth_symbol_interned(void *, void *);
+void		fth_symbol_restore(ficlWord *);
 
 /* utils.c */
 simple_array   *make_simple_array(int);
@@ -350,6 +407,7 @@ simple_array   *simple_array_clear(simple_array *);
 void		simple_array_free(simple_array *);
 FTH		simple_array_to_array(simple_array *);
 
+int		fth_execute_string(ficlVm *, ficlString);
 void		push_forth_string(ficlVm *, char *);
 
 char           *parse_input_buffer(ficlVm *, char *);
@@ -0,0 +1,1616 @@
+/*-
+ * Copyright (c) 2005-2018 Michael Scholz <mi-scholz@users.sourceforge.net>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * @(#)vector.c	1.1 10/18/26
+ */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "fth.h"
+#include "utils.h"
+
+/*
+ * The SIMD kernels are compiled with target attributes and chosen at
+ * run time, so the binary still runs on CPUs without AVX2.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define VEC_X86		1
+#define VEC_SSE2	__attribute__((__target__("sse2")))
+#define VEC_AVX2	__attribute__((__target__("avx2")))
+#endif
+
+/* === VECTOR === */
+
+static FTH 	f64_vector_tag;
+static FTH 	i64_vector_tag;
+
+/*
+ * Contiguous vectors of doubles (f64-vector) or 64-bit integers
+ * (i64-vector); both object types share the functions below.
+ */
+typedef struct {
+	ficlInteger 	length;
+	void           *data;
+} FVector;
+
+#define FTH_VECTOR_OBJECT(Obj)	FTH_INSTANCE_REF_GEN(Obj, FVector)
+#define FTH_VECTOR_LENGTH(Obj)	FTH_VECTOR_OBJECT(Obj)->length
+#define FTH_VECTOR_F64(Obj)	((ficlFloat *) FTH_VECTOR_OBJECT(Obj)->data)
+#define FTH_VECTOR_I64(Obj)	((ficl2Integer *) FTH_VECTOR_OBJECT(Obj)->data)
+#define FTH_VECTOR_F64_TYPE_P(Obj)					\
+	(FTH_INSTANCE_TYPE(Obj) == FTH_F64_VECTOR_T)
+
+#define FTH_VECTOR_P(Obj)	(FTH_F64_VECTOR_P(Obj) || FTH_I64_VECTOR_P(Obj))
+
+/*
+ * Kernels.  MIN and MAX expect LEN > 0 and return NaN if the vector
+ * contains a NaN.
+ */
+typedef struct {
+	const char     *name;
+	void		(*f64_add) (ficlFloat *, const ficlFloat *, ficlInteger);
+	void		(*f64_scale) (ficlFloat *, ficlFloat, ficlInteger);
+	void		(*f64_fill) (ficlFloat *, ficlFloat, ficlInteger);
+	ficlFloat	(*f64_dot) (const ficlFloat *, const ficlFloat *,
+			    ficlInteger);
+	ficlFloat	(*f64_sum) (const ficlFloat *, ficlInteger);
+	ficlFloat	(*f64_min) (const ficlFloat *, ficlInteger);
+	ficlFloat	(*f64_max) (const ficlFloat *, ficlInteger);
+	void		(*i64_add) (ficl2Integer *, const ficl2Integer *,
+			    ficlInteger);
+	ficl2Integer	(*i64_sum) (const ficl2Integer *, ficlInteger);
+	ficl2Integer	(*i64_min) (const ficl2Integer *, ficlInteger);
+	ficl2Integer	(*i64_max) (const ficl2Integer *, ficlInteger);
+} FVecKernels;
+
+static ficlFloat c_f64_dot(const ficlFloat *, const ficlFloat *,
+		    ficlInteger);
+static void	c_f64_add(ficlFloat *, const ficlFloat *, ficlInteger);
+static void	c_f64_fill(ficlFloat *, ficlFloat, ficlInteger);
+static ficlFloat c_f64_max(const ficlFloat *, ficlInteger);
+static ficlFloat c_f64_min(const ficlFloat *, ficlInteger);
+static void	c_f64_scale(ficlFloat *, ficlFloat, ficlInteger);
+static ficlFloat c_f64_sum(const ficlFloat *, ficlInteger);
+static void	c_i64_add(ficl2Integer *, const ficl2Integer *, ficlInteger);
+static ficl2Integer c_i64_max(const ficl2Integer *, ficlInteger);
+static ficl2Integer c_i64_min(const ficl2Integer *, ficlInteger);
+static ficl2Integer c_i64_sum(const ficl2Integer *, ficlInteger);
+static void	ficl_f64_vector_p(ficlVm *);
+static void	ficl_f64_vector_ref(ficlVm *);
+static void	ficl_f64_vector_set(ficlVm *);
+static void	ficl_i64_vector_p(ficlVm *);
+static void	ficl_i64_vector_ref(ficlVm *);
+static void	ficl_i64_vector_set(ficlVm *);
+static void	ficl_make_f64_vector(ficlVm *);
+static void	ficl_make_i64_vector(ficlVm *);
+static void	ficl_set_vector_kernels(ficlVm *);
+static void	ficl_vector_kernels(ficlVm *);
+static void	ficl_vector_length(ficlVm *);
+static void	ficl_vector_p(ficlVm *);
+static FTH	make_vector(FTH, ficlInteger);
+static FTH	vec_copy(FTH);
+static FTH	vec_dump(FTH);
+static FTH	vec_equal_p(FTH, FTH);
+static void	vec_free(FTH);
+static FTH	vec_hash(FTH);
+static FTH	vec_inspect(FTH);
+static void	vec_kernels_init(void);
+static FTH	vec_length(FTH);
+static FTH	vec_ref(FTH, FTH);
+static FTH	vec_set(FTH, FTH, FTH);
+static FTH	vec_to_array(FTH);
+static FTH	vec_to_string(FTH);
+
+#define h_list_of_vector_functions "\
+*** VECTOR PRIMITIVES ***\n\
+array->f64-vector   ( ary -- vec )\n\
+array->i64-vector   ( ary -- vec )\n\
+f64-vector-ref      ( vec idx -- r )\n\
+f64-vector-set!     ( vec idx r -- )\n\
+f64-vector?         ( obj -- f )\n\
+i64-vector-ref      ( vec idx -- n )\n\
+i64-vector-set!     ( vec idx n -- )\n\
+i64-vector?         ( obj -- f )\n\
+make-f64-vector     ( len :key initial-element 0.0 -- vec )\n\
+make-i64-vector     ( len :key initial-element 0 -- vec )\n\
+set-vector-kernels  ( sym -- old )\n\
+vector->array       ( vec -- ary )\n\
+vector-add!         ( vec1 vec2 -- vec1' )\n\
+vector-copy         ( vec1 -- vec2 )\n\
+vector-dot          ( vec1 vec2 -- x )\n\
+vector-fill         ( vec x -- vec' )\n\
+vector-kernels      ( -- sym )\n\
+vector-length       ( vec -- len )\n\
+vector-max          ( vec -- x )\n\
+vector-min          ( vec -- x )\n\
+vector-scale!       ( vec x -- vec' )\n\
+vector-sum          ( vec -- x )\n\
+vector?             ( obj -- f )"
+
+/* --- kernels --- */
+
+static void
+c_f64_add(ficlFloat *dst, const ficlFloat *src, ficlInteger len)
+{
+	ficlInteger 	i;
+
+	for (i = 0; i < len; i++)
+		dst[i] += src[i];
+}
+
+static void
+c_f64_scale(ficlFloat *dst, ficlFloat x, ficlInteger len)
+{
+	ficlInteger 	i;
+
+	for (i = 0; i < len; i++)
+		dst[i] *= x;
+}
+
+static void
+c_f64_fill(ficlFloat *dst, ficlFloat x, ficlInteger len)
+{
+	ficlInteger 	i;
+
+	for (i = 0; i < len; i++)
+		dst[i] = x;
+}
+
+static ficlFloat
+c_f64_dot(const ficlFloat *a, const ficlFloat *b, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	x;
+
+	x = 0.0;
+
+	for (i = 0; i < len; i++)
+		x += a[i] * b[i];
+
+	return (x);
+}
+
+static ficlFloat
+c_f64_sum(const ficlFloat *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	x;
+
+	x = 0.0;
+
+	for (i = 0; i < len; i++)
+		x += a[i];
+
+	return (x);
+}
+
+static ficlFloat
+c_f64_min(const ficlFloat *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	x;
+
+	x = a[0];
+
+	for (i = 1; i < len; i++)
+		if (a[i] < x || fth_isnan(a[i]))
+			x = a[i];
+
+	return (x);
+}
+
+static ficlFloat
+c_f64_max(const ficlFloat *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	x;
+
+	x = a[0];
+
+	for (i = 1; i < len; i++)
+		if (a[i] > x || fth_isnan(a[i]))
+			x = a[i];
+
+	return (x);
+}
+
+static void
+c_i64_add(ficl2Integer *dst, const ficl2Integer *src, ficlInteger len)
+{
+	ficlInteger 	i;
+
+	for (i = 0; i < len; i++)
+		dst[i] += src[i];
+}
+
+static ficl2Integer
+c_i64_sum(const ficl2Integer *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficl2Integer 	x;
+
+	x = 0;
+
+	for (i = 0; i < len; i++)
+		x += a[i];
+
+	return (x);
+}
+
+static ficl2Integer
+c_i64_min(const ficl2Integer *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficl2Integer 	x;
+
+	x = a[0];
+
+	for (i = 1; i < len; i++)
+		if (a[i] < x)
+			x = a[i];
+
+	return (x);
+}
+
+static ficl2Integer
+c_i64_max(const ficl2Integer *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficl2Integer 	x;
+
+	x = a[0];
+
+	for (i = 1; i < len; i++)
+		if (a[i] > x)
+			x = a[i];
+
+	return (x);
+}
+
+static FVecKernels c_kernels = {
+	"c",
+	c_f64_add, c_f64_scale, c_f64_fill, c_f64_dot, c_f64_sum,
+	c_f64_min, c_f64_max,
+	c_i64_add, c_i64_sum, c_i64_min, c_i64_max
+};
+
+#if defined(VEC_X86)
+/*
+ * SSE2 handles two doubles or integers per instruction, AVX2 four.
+ * The loops go over full registers, the C kernels do the rest.  Sums
+ * and dot products use two accumulators and so add in a different
+ * order than the C kernels.
+ */
+static void VEC_SSE2
+sse2_f64_add(ficlFloat *dst, const ficlFloat *src, ficlInteger len)
+{
+	ficlInteger 	i;
+
+	for (i = 0; i + 2 <= len; i += 2)
+		_mm_storeu_pd(dst + i,
+		    _mm_add_pd(_mm_loadu_pd(dst + i), _mm_loadu_pd(src + i)));
+
+	c_f64_add(dst + i, src + i, len - i);
+}
+
+static void VEC_SSE2
+sse2_f64_scale(ficlFloat *dst, ficlFloat x, ficlInteger len)
+{
+	ficlInteger 	i;
+	__m128d 	k;
+
+	k = _mm_set1_pd(x);
+
+	for (i = 0; i + 2 <= len; i += 2)
+		_mm_storeu_pd(dst + i, _mm_mul_pd(_mm_loadu_pd(dst + i), k));
+
+	c_f64_scale(dst + i, x, len - i);
+}
+
+static void VEC_SSE2
+sse2_f64_fill(ficlFloat *dst, ficlFloat x, ficlInteger len)
+{
+	ficlInteger 	i;
+	__m128d 	k;
+
+	k = _mm_set1_pd(x);
+
+	for (i = 0; i + 2 <= len; i += 2)
+		_mm_storeu_pd(dst + i, k);
+
+	c_f64_fill(dst + i, x, len - i);
+}
+
+static ficlFloat VEC_SSE2
+sse2_f64_dot(const ficlFloat *a, const ficlFloat *b, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	r[2];
+	__m128d 	s0, s1;
+
+	s0 = s1 = _mm_setzero_pd();
+
+	for (i = 0; i + 4 <= len; i += 4) {
+		s0 = _mm_add_pd(s0,
+		    _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+		s1 = _mm_add_pd(s1,
+		    _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+	}
+	_mm_storeu_pd(r, _mm_add_pd(s0, s1));
+	return (r[0] + r[1] + c_f64_dot(a + i, b + i, len - i));
+}
+
+static ficlFloat VEC_SSE2
+sse2_f64_sum(const ficlFloat *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	r[2];
+	__m128d 	s0, s1;
+
+	s0 = s1 = _mm_setzero_pd();
+
+	for (i = 0; i + 4 <= len; i += 4) {
+		s0 = _mm_add_pd(s0, _mm_loadu_pd(a + i));
+		s1 = _mm_add_pd(s1, _mm_loadu_pd(a + i + 2));
+	}
+	_mm_storeu_pd(r, _mm_add_pd(s0, s1));
+	return (r[0] + r[1] + c_f64_sum(a + i, len - i));
+}
+
+/*
+ * MINPD and MAXPD don't propagate NaNs, they are collected in NAN and
+ * decide at the end.
+ */
+static ficlFloat VEC_SSE2
+sse2_f64_min(const ficlFloat *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	r[2], x;
+	__m128d 	m, v, nan;
+
+	if (len < 2)
+		return (a[0]);
+
+	m = _mm_loadu_pd(a);
+	nan = _mm_cmpunord_pd(m, m);
+
+	for (i = 2; i + 2 <= len; i += 2) {
+		v = _mm_loadu_pd(a + i);
+		nan = _mm_or_pd(nan, _mm_cmpunord_pd(v, v));
+		m = _mm_min_pd(m, v);
+	}
+	if (_mm_movemask_pd(nan) != 0)
+		return (NAN);
+
+	_mm_storeu_pd(r, m);
+	x = FICL_MIN(r[0], r[1]);
+	return (i < len ? FICL_MIN(x, c_f64_min(a + i, len - i)) : x);
+}
+
+static ficlFloat VEC_SSE2
+sse2_f64_max(const ficlFloat *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	r[2], x;
+	__m128d 	m, v, nan;
+
+	if (len < 2)
+		return (a[0]);
+
+	m = _mm_loadu_pd(a);
+	nan = _mm_cmpunord_pd(m, m);
+
+	for (i = 2; i + 2 <= len; i += 2) {
+		v = _mm_loadu_pd(a + i);
+		nan = _mm_or_pd(nan, _mm_cmpunord_pd(v, v));
+		m = _mm_max_pd(m, v);
+	}
+	if (_mm_movemask_pd(nan) != 0)
+		return (NAN);
+
+	_mm_storeu_pd(r, m);
+	x = FICL_MAX(r[0], r[1]);
+	return (i < len ? FICL_MAX(x, c_f64_max(a + i, len - i)) : x);
+}
+
+static void VEC_SSE2
+sse2_i64_add(ficl2Integer *dst, const ficl2Integer *src, ficlInteger len)
+{
+	ficlInteger 	i;
+	__m128i 	v;
+
+	for (i = 0; i + 2 <= len; i += 2) {
+		v = _mm_add_epi64(_mm_loadu_si128((const __m128i *) (dst + i)),
+		    _mm_loadu_si128((const __m128i *) (src + i)));
+		_mm_storeu_si128((__m128i *) (dst + i), v);
+	}
+	c_i64_add(dst + i, src + i, len - i);
+}
+
+static ficl2Integer VEC_SSE2
+sse2_i64_sum(const ficl2Integer *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficl2Integer 	r[2];
+	__m128i 	s;
+
+	s = _mm_setzero_si128();
+
+	for (i = 0; i + 2 <= len; i += 2)
+		s = _mm_add_epi64(s,
+		    _mm_loadu_si128((const __m128i *) (a + i)));
+
+	_mm_storeu_si128((__m128i *) r, s);
+	return (r[0] + r[1] + c_i64_sum(a + i, len - i));
+}
+
+static void VEC_AVX2
+avx2_f64_add(ficlFloat *dst, const ficlFloat *src, ficlInteger len)
+{
+	ficlInteger 	i;
+
+	for (i = 0; i + 4 <= len; i += 4)
+		_mm256_storeu_pd(dst + i, _mm256_add_pd(_mm256_loadu_pd(dst + i),
+		    _mm256_loadu_pd(src + i)));
+
+	c_f64_add(dst + i, src + i, len - i);
+}
+
+static void VEC_AVX2
+avx2_f64_scale(ficlFloat *dst, ficlFloat x, ficlInteger len)
+{
+	ficlInteger 	i;
+	__m256d 	k;
+
+	k = _mm256_set1_pd(x);
+
+	for (i = 0; i + 4 <= len; i += 4)
+		_mm256_storeu_pd(dst + i,
+		    _mm256_mul_pd(_mm256_loadu_pd(dst + i), k));
+
+	c_f64_scale(dst + i, x, len - i);
+}
+
+static void VEC_AVX2
+avx2_f64_fill(ficlFloat *dst, ficlFloat x, ficlInteger len)
+{
+	ficlInteger 	i;
+	__m256d 	k;
+
+	k = _mm256_set1_pd(x);
+
+	for (i = 0; i + 4 <= len; i += 4)
+		_mm256_storeu_pd(dst + i, k);
+
+	c_f64_fill(dst + i, x, len - i);
+}
+
+static ficlFloat VEC_AVX2
+avx2_f64_dot(const ficlFloat *a, const ficlFloat *b, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	r[4];
+	__m256d 	s0, s1;
+
+	s0 = s1 = _mm256_setzero_pd();
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(a + i),
+		    _mm256_loadu_pd(b + i)));
+		s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4),
+		    _mm256_loadu_pd(b + i + 4)));
+	}
+	_mm256_storeu_pd(r, _mm256_add_pd(s0, s1));
+	return ((r[0] + r[1]) + (r[2] + r[3]) +
+	    c_f64_dot(a + i, b + i, len - i));
+}
+
+static ficlFloat VEC_AVX2
+avx2_f64_sum(const ficlFloat *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	r[4];
+	__m256d 	s0, s1;
+
+	s0 = s1 = _mm256_setzero_pd();
+
+	for (i = 0; i + 8 <= len; i += 8) {
+		s0 = _mm256_add_pd(s0, _mm256_loadu_pd(a + i));
+		s1 = _mm256_add_pd(s1, _mm256_loadu_pd(a + i + 4));
+	}
+	_mm256_storeu_pd(r, _mm256_add_pd(s0, s1));
+	return ((r[0] + r[1]) + (r[2] + r[3]) + c_f64_sum(a + i, len - i));
+}
+
+static ficlFloat VEC_AVX2
+avx2_f64_min(const ficlFloat *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	r[4], x;
+	__m256d 	m, v, nan;
+
+	if (len < 4)
+		return (c_f64_min(a, len));
+
+	m = _mm256_loadu_pd(a);
+	nan = _mm256_cmp_pd(m, m, _CMP_UNORD_Q);
+
+	for (i = 4; i + 4 <= len; i += 4) {
+		v = _mm256_loadu_pd(a + i);
+		nan = _mm256_or_pd(nan, _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+		m = _mm256_min_pd(m, v);
+	}
+	if (_mm256_movemask_pd(nan) != 0)
+		return (NAN);
+
+	_mm256_storeu_pd(r, m);
+	x = FICL_MIN(FICL_MIN(r[0], r[1]), FICL_MIN(r[2], r[3]));
+	return (i < len ? FICL_MIN(x, c_f64_min(a + i, len - i)) : x);
+}
+
+static ficlFloat VEC_AVX2
+avx2_f64_max(const ficlFloat *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficlFloat 	r[4], x;
+	__m256d 	m, v, nan;
+
+	if (len < 4)
+		return (c_f64_max(a, len));
+
+	m = _mm256_loadu_pd(a);
+	nan = _mm256_cmp_pd(m, m, _CMP_UNORD_Q);
+
+	for (i = 4; i + 4 <= len; i += 4) {
+		v = _mm256_loadu_pd(a + i);
+		nan = _mm256_or_pd(nan, _mm256_cmp_pd(v, v, _CMP_UNORD_Q));
+		m = _mm256_max_pd(m, v);
+	}
+	if (_mm256_movemask_pd(nan) != 0)
+		return (NAN);
+
+	_mm256_storeu_pd(r, m);
+	x = FICL_MAX(FICL_MAX(r[0], r[1]), FICL_MAX(r[2], r[3]));
+	return (i < len ? FICL_MAX(x, c_f64_max(a + i, len - i)) : x);
+}
+
+static void VEC_AVX2
+avx2_i64_add(ficl2Integer *dst, const ficl2Integer *src, ficlInteger len)
+{
+	ficlInteger 	i;
+	__m256i 	v;
+
+	for (i = 0; i + 4 <= len; i += 4) {
+		v = _mm256_add_epi64(
+		    _mm256_loadu_si256((const __m256i *) (dst + i)),
+		    _mm256_loadu_si256((const __m256i *) (src + i)));
+		_mm256_storeu_si256((__m256i *) (dst + i), v);
+	}
+	c_i64_add(dst + i, src + i, len - i);
+}
+
+static ficl2Integer VEC_AVX2
+avx2_i64_sum(const ficl2Integer *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficl2Integer 	r[4];
+	__m256i 	s;
+
+	s = _mm256_setzero_si256();
+
+	for (i = 0; i + 4 <= len; i += 4)
+		s = _mm256_add_epi64(s,
+		    _mm256_loadu_si256((const __m256i *) (a + i)));
+
+	_mm256_storeu_si256((__m256i *) r, s);
+	return (r[0] + r[1] + r[2] + r[3] + c_i64_sum(a + i, len - i));
+}
+
+static ficl2Integer VEC_AVX2
+avx2_i64_min(const ficl2Integer *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficl2Integer 	r[4], x;
+	__m256i 	m, v;
+
+	if (len < 4)
+		return (c_i64_min(a, len));
+
+	m = _mm256_loadu_si256((const __m256i *) a);
+
+	for (i = 4; i + 4 <= len; i += 4) {
+		v = _mm256_loadu_si256((const __m256i *) (a + i));
+		m = _mm256_blendv_epi8(m, v, _mm256_cmpgt_epi64(m, v));
+	}
+	_mm256_storeu_si256((__m256i *) r, m);
+	x = c_i64_min(r, 4L);
+	return (i < len ? FICL_MIN(x, c_i64_min(a + i, len - i)) : x);
+}
+
+static ficl2Integer VEC_AVX2
+avx2_i64_max(const ficl2Integer *a, ficlInteger len)
+{
+	ficlInteger 	i;
+	ficl2Integer 	r[4], x;
+	__m256i 	m, v;
+
+	if (len < 4)
+		return (c_i64_max(a, len));
+
+	m = _mm256_loadu_si256((const __m256i *) a);
+
+	for (i = 4; i + 4 <= len; i += 4) {
+		v = _mm256_loadu_si256((const __m256i *) (a + i));
+		m = _mm256_blendv_epi8(m, v, _mm256_cmpgt_epi64(v, m));
+	}
+	_mm256_storeu_si256((__m256i *) r, m);
+	x = c_i64_max(r, 4L);
+	return (i < len ? FICL_MAX(x, c_i64_max(a + i, len - i)) : x);
+}
+
+/* SSE2 has no 64-bit integer compare. */
+static FVecKernels sse2_kernels = {
+	"sse2",
+	sse2_f64_add, sse2_f64_scale, sse2_f64_fill, sse2_f64_dot,
+	sse2_f64_sum, sse2_f64_min, sse2_f64_max,
+	sse2_i64_add, sse2_i64_sum, c_i64_min, c_i64_max
+};
+
+static FVecKernels avx2_kernels = {
+	"avx2",
+	avx2_f64_add, avx2_f64_scale, avx2_f64_fill, avx2_f64_dot,
+	avx2_f64_sum, avx2_f64_min, avx2_f64_max,
+	avx2_i64_add, avx2_i64_sum, avx2_i64_min, avx2_i64_max
+};
+#endif				/* VEC_X86 */
+
+static FVecKernels *vec_kernels = &c_kernels;
+static FVecKernels *vec_kernels_best = &c_kernels;
+
+static void
+vec_kernels_init(void)
+{
+#if defined(VEC_X86)
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2"))
+		vec_kernels_best = &avx2_kernels;
+	else if (__builtin_cpu_supports("sse2"))
+		vec_kernels_best = &sse2_kernels;
+#endif
+	vec_kernels = vec_kernels_best;
+}
+
+static void
+ficl_vector_kernels(ficlVm *vm)
+{
+#define h_vector_kernels "( -- sym )  return vector kernels\n\
+vector-kernels => 'avx2\n\
+Return the kernels used by the vector functions, one of 'avx2, 'sse2 \
+or 'c.  The best ones the CPU supports are chosen at startup.\n\
+See also set-vector-kernels."
+	FTH_STACK_CHECK(vm, 0, 1);
+	ficlStackPushFTH(vm->dataStack, fth_symbol(vec_kernels->name));
+}
+
+static void
+ficl_set_vector_kernels(ficlVm *vm)
+{
+#define h_set_vector_kernels "( sym -- old )  set vector kernels\n\
+'c set-vector-kernels => 'avx2\n\
+Set the kernels used by the vector functions to SYM, one of 'avx2, \
+'sse2, 'c or 'auto and return the old ones.  'auto chooses the best \
+ones the CPU supports.  \
+Raise WRONG-TYPE-ARG exception if the CPU doesn't support SYM.\n\
+See also vector-kernels."
+	FTH 		sym, old;
+	char           *name;
+	FVecKernels    *k;
+
+	FTH_STACK_CHECK(vm, 1, 1);
+	sym = fth_pop_ficl_cell(vm);
+	FTH_ASSERT_ARGS(FTH_SYMBOL_P(sym), sym, FTH_ARG1, "a symbol");
+	old = fth_symbol(vec_kernels->name);
+	name = fth_symbol_ref(sym);
+	k = NULL;
+
+	if (strcmp(name, "auto") == 0)
+		k = vec_kernels_best;
+	else if (strcmp(name, "c") == 0)
+		k = &c_kernels;
+#if defined(VEC_X86)
+	else if (strcmp(name, "sse2") == 0 && vec_kernels_best != &c_kernels)
+		k = &sse2_kernels;
+	else if (strcmp(name, "avx2") == 0 && vec_kernels_best == &avx2_kernels)
+		k = &avx2_kernels;
+#endif
+
+	if (k == NULL) {
+		FTH_ASSERT_ARGS(0, sym, FTH_ARG1,
+		    "kernels supported by the CPU");
+		/* NOTREACHED */
+		return;
+	}
+	vec_kernels = k;
+	ficlStackPushFTH(vm->dataStack, old);
+}
+
+/* --- object type --- */
+
+#define VECTOR_ASSERT(Obj, Pos)						\
+	FTH_ASSERT_ARGS(FTH_VECTOR_P(Obj), Obj, Pos, "a vector")
+
+/* Check that VEC2 matches VEC1 in type and length. */
+#define VECTOR_ASSERT_PAIR(Vec1, Vec2) do {				\
+	VECTOR_ASSERT(Vec1, FTH_ARG1);					\
+	FTH_ASSERT_ARGS(FTH_VECTOR_P(Vec2) &&				\
+	    FTH_INSTANCE_TYPE(Vec1) == FTH_INSTANCE_TYPE(Vec2) &&	\
+	    FTH_VECTOR_LENGTH(Vec1) == FTH_VECTOR_LENGTH(Vec2),		\
+	    Vec2, FTH_ARG2, "a vector of the same type and length");	\
+} while (0)
+
+/* Box element IDX of vector VEC. */
+#define VECTOR_BOX(Vec, Idx)						\
+	(FTH_VECTOR_F64_TYPE_P(Vec) ?					\
+	    fth_make_float(FTH_VECTOR_F64(Vec)[Idx]) :			\
+	    fth_make_long_long(FTH_VECTOR_I64(Vec)[Idx]))
+
+static FTH
+vec_inspect(FTH self)
+{
+	ficlInteger 	i, len;
+	FTH 		fs;
+
+	len = FTH_VECTOR_LENGTH(self);
+
+	if (len == 0)
+		return (fth_make_string_format("%s empty",
+		    FTH_INSTANCE_NAME(self)));
+
+	fs = fth_make_string_format("%s[%ld]:", FTH_INSTANCE_NAME(self), len);
+
+	/* Negative fth_print_length shows all entries! */
+	if (fth_print_length >= 0 && len > fth_print_length)
+		len = FICL_MIN(len, fth_print_length);
+
+	for (i = 0; i < len; i++)
+		fth_string_sformat(fs, " %M", VECTOR_BOX(self, i));
+
+	if (len < FTH_VECTOR_LENGTH(self))
+		fth_string_sformat(fs, " ...");
+
+	return (fs);
+}
+
+static FTH
+vec_to_string(FTH self)
+{
+	ficlInteger 	i, len;
+	FTH 		fs;
+
+	len = FTH_VECTOR_LENGTH(self);
+
+	if (fth_print_length >= 0 && len > fth_print_length)
+		len = FICL_MIN(len, fth_print_length);
+
+	fs = fth_make_string_format("#%s(",
+	    FTH_VECTOR_F64_TYPE_P(self) ? "f64" : "i64");
+
+	if (len > 0) {
+		for (i = 0; i < len; i++)
+			fth_string_sformat(fs, " %M", VECTOR_BOX(self, i));
+
+		if (len < FTH_VECTOR_LENGTH(self))
+			fth_string_sformat(fs, " ...");
+
+		fth_string_sformat(fs, " ");
+	}
+	return (fth_string_sformat(fs, ")"));
+}
+
+static FTH
+vec_dump(FTH self)
+{
+	ficlInteger 	i;
+	FTH 		fs;
+
+	fs = fth_make_string("#(");
+
+	for (i = 0; i < FTH_VECTOR_LENGTH(self); i++)
+		fth_string_sformat(fs, " %D ", VECTOR_BOX(self, i));
+
+	return (fth_string_sformat(fs, ") array->%s",
+	    FTH_INSTANCE_NAME(self)));
+}
+
+static FTH
+vec_to_array(FTH self)
+{
+	ficlInteger 	i, len;
+	FTH 		ary;
+
+	len = FTH_VECTOR_LENGTH(self);
+	ary = fth_make_array_len(len);
+
+	for (i = 0; i < len; i++)
+		fth_array_fast_set(ary, i, VECTOR_BOX(self, i));
+
+	return (ary);
+}
+
+static FTH
+vec_copy(FTH self)
+{
+	FTH 		new;
+	size_t 		size;
+
+	new = make_vector(FTH_VECTOR_F64_TYPE_P(self) ?
+	    f64_vector_tag : i64_vector_tag, FTH_VECTOR_LENGTH(self));
+	size = (size_t) FTH_VECTOR_LENGTH(self) *
+	    (FTH_VECTOR_F64_TYPE_P(self) ?
+	    sizeof(ficlFloat) : sizeof(ficl2Integer));
+
+	if (size > 0)
+		memcpy(FTH_VECTOR_OBJECT(new)->data,
+		    FTH_VECTOR_OBJECT(self)->data, size);
+
+	return (new);
+}
+
+static FTH
+vec_ref(FTH self, FTH fidx)
+{
+	ficlInteger 	idx;
+
+	idx = FTH_INT_REF(fidx);
+
+	if (idx < 0 || idx >= FTH_VECTOR_LENGTH(self))
+		FTH_OUT_OF_BOUNDS(FTH_ARG2, idx);
+
+	return (VECTOR_BOX(self, idx));
+}
+
+static FTH
+vec_set(FTH self, FTH fidx, FTH value)
+{
+	ficlInteger 	idx;
+
+	idx = FTH_INT_REF(fidx);
+
+	if (idx < 0 || idx >= FTH_VECTOR_LENGTH(self))
+		FTH_OUT_OF_BOUNDS(FTH_ARG2, idx);
+
+	if (FTH_VECTOR_F64_TYPE_P(self))
+		FTH_VECTOR_F64(self)[idx] = fth_float_ref(value);
+	else
+		FTH_VECTOR_I64(self)[idx] = fth_long_long_ref(value);
+
+	FTH_INSTANCE_CHANGED(self);
+	return (value);
+}
+
+static FTH
+vec_equal_p(FTH self, FTH obj)
+{
+	ficlInteger 	i, len;
+
+	if (self == obj)
+		return (FTH_TRUE);
+
+	len = FTH_VECTOR_LENGTH(self);
+
+	if (FTH_INSTANCE_TYPE(self) != FTH_INSTANCE_TYPE(obj) ||
+	    len != FTH_VECTOR_LENGTH(obj))
+		return (FTH_FALSE);
+
+	if (FTH_VECTOR_F64_TYPE_P(self)) {
+		for (i = 0; i < len; i++)
+			if (FTH_VECTOR_F64(self)[i] != FTH_VECTOR_F64(obj)[i])
+				return (FTH_FALSE);
+	} else {
+		for (i = 0; i < len; i++)
+			if (FTH_VECTOR_I64(self)[i] != FTH_VECTOR_I64(obj)[i])
+				return (FTH_FALSE);
+	}
+	return (FTH_TRUE);
+}
+
+static FTH
+vec_hash(FTH self)
+{
+	ficlInteger 	i, len;
+	ficlUnsigned 	h, u;
+
+	len = FTH_VECTOR_LENGTH(self);
+	h = (ficlUnsigned) len;
+
+	for (i = 0; i < len; i++) {
+		if (FTH_VECTOR_F64_TYPE_P(self)) {
+			ficlFloat 	f;
+
+			/* 0.0 and -0.0 are equal */
+			f = FTH_VECTOR_F64(self)[i] + 0.0;
+			memcpy(&u, &f, sizeof(u));
+		} else
+			u = (ficlUnsigned) FTH_VECTOR_I64(self)[i];
+
+		h = fth_hash_combine(h, u);
+	}
+	return (FTH_HASH_ID_TO_FIX(h));
+}
+
+static FTH
+vec_length(FTH self)
+{
+	return (fth_make_int(FTH_VECTOR_LENGTH(self)));
+}
+
+static void
+vec_free(FTH self)
+{
+	FTH_FREE(FTH_VECTOR_OBJECT(self)->data);
+	FTH_FREE(FTH_VECTOR_OBJECT(self));
+}
+
+/*
+ * Return a new vector of type TAG with LEN zeroed elements.
+ */
+static FTH
+make_vector(FTH tag, ficlInteger len)
+{
+	FVector        *v;
+
+	if (len < 0)
+		FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, len, "negative");
+
+	if (len > MAX_SEQ_LENGTH)
+		FTH_OUT_OF_BOUNDS_ERROR(FTH_ARG1, len, "too long");
+
+	v = FTH_MALLOC(sizeof(FVector));
+	v->length = len;
+	v->data = FTH_CALLOC((size_t) FICL_MAX(len, 1), sizeof(ficlFloat) >
+	    sizeof(ficl2Integer) ? sizeof(ficlFloat) : sizeof(ficl2Integer));
+	return (fth_make_instance(tag, v));
+}
+
+/*
+ * Return a new f64-vector of length LEN with all elements set to INIT.
+ */
+FTH
+fth_make_f64_vector(ficlInteger len, ficlFloat init)
+{
+	FTH 		vec;
+
+	vec = make_vector(f64_vector_tag, len);
+
+	if (init != 0.0)
+		(*vec_kernels->f64_fill) (FTH_VECTOR_F64(vec), init, len);
+
+	return (vec);
+}
+
+/*
+ * Return a new i64-vector of length LEN with all elements set to INIT.
+ */
+FTH
+fth_make_i64_vector(ficlInteger len, ficl2Integer init)
+{
+	ficlInteger 	i;
+	FTH 		vec;
+
+	vec = make_vector(i64_vector_tag, len);
+
+	if (init != 0)
+		for (i = 0; i < len; i++)
+			FTH_VECTOR_I64(vec)[i] = init;
+
+	return (vec);
+}
+
+/*
+ * If OBJ is a vector, return its length, otherwise -1.
+ */
+ficlInteger
+fth_vector_length(FTH obj)
+{
+	if (FTH_VECTOR_P(obj))
+		return (FTH_VECTOR_LENGTH(obj));
+	return (-1);
+}
+
+/*
+ * Return the element array of f64-vector VEC; it stays valid until VEC
+ * is collected.
+ */
+ficlFloat      *
+fth_f64_vector_data(FTH vec)
+{
+	FTH_ASSERT_ARGS(FTH_F64_VECTOR_P(vec), vec, FTH_ARG1, "an f64-vector");
+	return (FTH_VECTOR_F64(vec));
+}
+
+ficl2Integer   *
+fth_i64_vector_data(FTH vec)
+{
+	FTH_ASSERT_ARGS(FTH_I64_VECTOR_P(vec), vec, FTH_ARG1, "an i64-vector");
+	return (FTH_VECTOR_I64(vec));
+}
+
+static void
+ficl_vector_p(ficlVm *vm)
+{
+#define h_vector_p "( obj -- f )  test if OBJ is a vector\n\
+3 make-f64-vector vector? => #t\n\
+#( 1 2 )          vector? => #f\n\
+Return #t if OBJ is an f64-vector or an i64-vector, otherwise #f.\n\
+See also f64-vector? and i64-vector?."
+	FTH 		obj;
+
+	FTH_STACK_CHECK(vm, 1, 1);
+	obj = fth_pop_ficl_cell(vm);
+	ficlStackPushBoolean(vm->dataStack, FTH_VECTOR_P(obj));
+}
+
+static void
+ficl_f64_vector_p(ficlVm *vm)
+{
+#define h_f64_vector_p "( obj -- f )  test if OBJ is an f64-vector\n\
+3 make-f64-vector f64-vector? => #t\n\
+3 make-i64-vector f64-vector? => #f\n\
+Return #t if OBJ is an f64-vector, otherwise #f.\n\
+See also i64-vector? and vector?."
+	FTH 		obj;
+
+	FTH_STACK_CHECK(vm, 1, 1);
+	obj = fth_pop_ficl_cell(vm);
+	ficlStackPushBoolean(vm->dataStack, FTH_F64_VECTOR_P(obj));
+}
+
+static void
+ficl_i64_vector_p(ficlVm *vm)
+{
+#define h_i64_vector_p "( obj -- f )  test if OBJ is an i64-vector\n\
+3 make-i64-vector i64-vector? => #t\n\
+3 make-f64-vector i64-vector? => #f\n\
+Return #t if OBJ is an i64-vector, otherwise #f.\n\
+See also f64-vector? and vector?."
+	FTH 		obj;
+
+	FTH_STACK_CHECK(vm, 1, 1);
+	obj = fth_pop_ficl_cell(vm);
+	ficlStackPushBoolean(vm->dataStack, FTH_I64_VECTOR_P(obj));
+}
+
+static void
+ficl_make_f64_vector(ficlVm *vm)
+{
+#define h_make_f64_vector "( len :key initial-element 0.0 -- vec )  vector\n\
+3                      make-f64-vector => #f64( 0.0 0.0 0.0 )\n\
+3 :initial-element 0.5 make-f64-vector => #f64( 0.5 0.5 0.5 )\n\
+Return f64-vector of length LEN, a contiguous vector of doubles, \
+filled with keyword INITIAL-ELEMENT values.  \
+INITIAL-ELEMENT defaults to 0.0 if not specified.  \
+Raise OUT-OF-RANGE exception if LEN < 0.\n\
+See also make-i64-vector and array->f64-vector."
+	FTH 		size, init;
+
+	init = fth_get_optkey(FTH_KEYWORD_INIT, FTH_FALSE);
+	FTH_STACK_CHECK(vm, 1, 1);
+	size = fth_pop_ficl_cell(vm);
+	FTH_ASSERT_ARGS(FTH_INTEGER_P(size), size, FTH_ARG1, "an integer");
+	ficlStackPushFTH(vm->dataStack, fth_make_f64_vector(FTH_INT_REF(size),
+	    FTH_FALSE_P(init) ? 0.0 : fth_float_ref(init)));
+}
+
+static void
+ficl_make_i64_vector(ficlVm *vm)
+{
+#define h_make_i64_vector "( len :key initial-element 0 -- vec )  vector\n\
+3                    make-i64-vector => #i64( 0 0 0 )\n\
+3 :initial-element 7 make-i64-vector => #i64( 7 7 7 )\n\
+Return i64-vector of length LEN, a contiguous vector of 64-bit \
+integers, filled with keyword INITIAL-ELEMENT values.  \
+INITIAL-ELEMENT defaults to 0 if not specified.  \
+Raise OUT-OF-RANGE exception if LEN < 0.\n\
+See also make-f64-vector and array->i64-vector."
+	FTH 		size, init;
+
+	init = fth_get_optkey(FTH_KEYWORD_INIT, FTH_FALSE);
+	FTH_STACK_CHECK(vm, 1, 1);
+	size = fth_pop_ficl_cell(vm);
+	FTH_ASSERT_ARGS(FTH_INTEGER_P(size), size, FTH_ARG1, "an integer");
+	ficlStackPushFTH(vm->dataStack, fth_make_i64_vector(FTH_INT_REF(size),
+	    FTH_FALSE_P(init) ? 0 : fth_long_long_ref(init)));
+}
+
+/*
+ * Return a new f64-vector with the elements of ARRAY converted to
+ * floats.
+ */
+FTH
+fth_array_to_f64_vector(FTH array)
+{
+#define h_array_to_f64_vector "( ary -- vec )  return f64-vector\n\
+#( 0 1 2 ) array->f64-vector => #f64( 0.0 1.0 2.0 )\n\
+Return new f64-vector with the elements of ARY converted to floats.\n\
+See also array->i64-vector and vector->array."
+	ficlInteger 	i, len;
+	FTH 		vec;
+
+	FTH_ASSERT_ARGS(FTH_ARRAY_P(array), array, FTH_ARG1, "an array");
+	len = fth_array_length(array);
+	vec = make_vector(f64_vector_tag, len);
+
+	for (i = 0; i < len; i++)
+		FTH_VECTOR_F64(vec)[i] =
+		    fth_float_ref(fth_array_fast_ref(array, i));
+
+	return (vec);
+}
+
+/*
+ * Return a new i64-vector with the elements of ARRAY converted to
+ * integers.
+ */
+FTH
+fth_array_to_i64_vector(FTH array)
+{
+#define h_array_to_i64_vector "( ary -- vec )  return i64-vector\n\
+#( 0 1 2 ) array->i64-vector => #i64( 0 1 2 )\n\
+Return new i64-vector with the elements of ARY converted to integers.\n\
+See also array->f64-vector and vector->array."
+	ficlInteger 	i, len;
+	FTH 		vec;
+
+	FTH_ASSERT_ARGS(FTH_ARRAY_P(array), array, FTH_ARG1, "an array");
+	len = fth_array_length(array);
+	vec = make_vector(i64_vector_tag, len);
+
+	for (i = 0; i < len; i++)
+		FTH_VECTOR_I64(vec)[i] =
+		    fth_long_long_ref(fth_array_fast_ref(array, i));
+
+	return (vec);
+}
+
+FTH
+fth_vector_to_array(FTH vec)
+{
+#define h_vector_to_array "( vec -- ary )  return array\n\
+#( 0 1 2 ) array->f64-vector vector->array => #( 0.0 1.0 2.0 )\n\
+Return new array with the elements of VEC.\n\
+See also array->f64-vector and array->i64-vector."
+	VECTOR_ASSERT(vec, FTH_ARG1);
+	return (vec_to_array(vec));
+}
+
+FTH
+fth_vector_copy(FTH vec)
+{
+#define h_vector_copy "( vec1 -- vec2 )  duplicate vector\n\
+#( 0 1 2 ) array->i64-vector value v1\n\
+v1 vector-copy value v2\n\
+v1 v2 equal? => #t\n\
+Return copy of VEC1."
+	VECTOR_ASSERT(vec, FTH_ARG1);
+	return (vec_copy(vec));
+}
+
+static void
+ficl_vector_length(ficlVm *vm)
+{
+#define h_vector_length "( obj -- len )  return vector length\n\
+3 make-f64-vector vector-length => 3\n\
+5                 vector-length => -1\n\
+If OBJ is a vector, return its length, otherwise -1."
+	FTH_STACK_CHECK(vm, 1, 1);
+	ficlStackPushInteger(vm->dataStack,
+	    fth_vector_length(fth_pop_ficl_cell(vm)));
+}
+
+ficlFloat
+fth_f64_vector_ref(FTH vec, ficlInteger idx)
+{
+	FTH_ASSERT_ARGS(FTH_F64_VECTOR_P(vec), vec, FTH_ARG1, "an f64-vector");
+
+	if (idx < 0)
+		idx += FTH_VECTOR_LENGTH(vec);
+
+	if (idx < 0 || idx >= FTH_VECTOR_LENGTH(vec))
+		FTH_OUT_OF_BOUNDS(FTH_ARG2, idx);
+
+	return (FTH_VECTOR_F64(vec)[idx]);
+}
+
+void
+fth_f64_vector_set(FTH vec, ficlInteger idx, ficlFloat x)
+{
+	FTH_ASSERT_ARGS(FTH_F64_VECTOR_P(vec), vec, FTH_ARG1, "an f64-vector");
+
+	if (idx < 0)
+		idx += FTH_VECTOR_LENGTH(vec);
+
+	if (idx < 0 || idx >= FTH_VECTOR_LENGTH(vec))
+		FTH_OUT_OF_BOUNDS(FTH_ARG2, idx);
+
+	FTH_VECTOR_F64(vec)[idx] = x;
+	FTH_INSTANCE_CHANGED(vec);
+}
+
+ficl2Integer
+fth_i64_vector_ref(FTH vec, ficlInteger idx)
+{
+	FTH_ASSERT_ARGS(FTH_I64_VECTOR_P(vec), vec, FTH_ARG1, "an i64-vector");
+
+	if (idx < 0)
+		idx += FTH_VECTOR_LENGTH(vec);
+
+	if (idx < 0 || idx >= FTH_VECTOR_LENGTH(vec))
+		FTH_OUT_OF_BOUNDS(FTH_ARG2, idx);
+
+	return (FTH_VECTOR_I64(vec)[idx]);
+}
+
+void
+fth_i64_vector_set(FTH vec, ficlInteger idx, ficl2Integer n)
+{
+	FTH_ASSERT_ARGS(FTH_I64_VECTOR_P(vec), vec, FTH_ARG1, "an i64-vector");
+
+	if (idx < 0)
+		idx += FTH_VECTOR_LENGTH(vec);
+
+	if (idx < 0 || idx >= FTH_VECTOR_LENGTH(vec))
+		FTH_OUT_OF_BOUNDS(FTH_ARG2, idx);
+
+	FTH_VECTOR_I64(vec)[idx] = n;
+	FTH_INSTANCE_CHANGED(vec);
+}
+
+static void
+ficl_f64_vector_ref(ficlVm *vm)
+{
+#define h_f64_vector_ref "( vec idx -- r )  return element at IDX\n\
+#( 0.5 1.5 ) array->f64-vector 1 f64-vector-ref => 1.5\n\
+Return element at position IDX.  \
+Negative index counts from backward.  \
+Raise OUT-OF-RANGE exception if IDX is not in VEC's range."
+	ficlInteger 	idx;
+	FTH 		vec;
+
+	FTH_STACK_CHECK(vm, 2, 1);
+	idx = ficlStackPopInteger(vm->dataStack);
+	vec = fth_pop_ficl_cell(vm);
+	ficlStackPushFloat(vm->dataStack, fth_f64_vector_ref(vec, idx));
+}
+
+static void
+ficl_f64_vector_set(ficlVm *vm)
+{
+#define h_f64_vector_set "( vec idx r -- )  set element at IDX\n\
+2 make-f64-vector value v\n\
+v 1 0.5 f64-vector-set!\n\
+v => #f64( 0.0 0.5 )\n\
+Store R, converted to a float, at position IDX.  \
+Negative index counts from backward.  \
+Raise OUT-OF-RANGE exception if IDX is not in VEC's range."
+	ficlFloat 	x;
+	ficlInteger 	idx;
+	FTH 		vec;
+
+	FTH_STACK_CHECK(vm, 3, 0);
+	x = ficlStackPopFloat(vm->dataStack);
+	idx = ficlStackPopInteger(vm->dataStack);
+	vec = fth_pop_ficl_cell(vm);
+	fth_f64_vector_set(vec, idx, x);
+}
+
+static void
+ficl_i64_vector_ref(ficlVm *vm)
+{
+#define h_i64_vector_ref "( vec idx -- n )  return element at IDX\n\
+#( 10 20 ) array->i64-vector 1 i64-vector-ref => 20\n\
+Return element at position IDX.  \
+Negative index counts from backward.  \
+Raise OUT-OF-RANGE exception if IDX is not in VEC's range."
+	ficlInteger 	idx;
+	FTH 		vec;
+
+	FTH_STACK_CHECK(vm, 2, 1);
+	idx = ficlStackPopInteger(vm->dataStack);
+	vec = fth_pop_ficl_cell(vm);
+	fth_push_ficl_cell(vm, fth_make_long_long(fth_i64_vector_ref(vec, idx)));
+}
+
+static void
+ficl_i64_vector_set(ficlVm *vm)
+{
+#define h_i64_vector_set "( vec idx n -- )  set element at IDX\n\
+2 make-i64-vector value v\n\
+v 1 20 i64-vector-set!\n\
+v => #i64( 0 20 )\n\
+Store N, converted to an integer, at position IDX.  \
+Negative index counts from backward.  \
+Raise OUT-OF-RANGE exception if IDX is not in VEC's range."
+	ficl2Integer 	n;
+	ficlInteger 	idx;
+	FTH 		vec;
+
+	FTH_STACK_CHECK(vm, 3, 0);
+	n = fth_long_long_ref(fth_pop_ficl_cell(vm));
+	idx = ficlStackPopInteger(vm->dataStack);
+	vec = fth_pop_ficl_cell(vm);
+	fth_i64_vector_set(vec, idx, n);
+}
+
+/* --- kernel functions --- */
+
+/*
+ * Add the elements of VEC2 to those of VEC1 and return VEC1.
+ */
+FTH
+fth_vector_add(FTH vec1, FTH vec2)
+{
+#define h_vector_add "( vec1 vec2 -- vec1' )  add vectors\n\
+#( 1 2 ) array->f64-vector value v1\n\
+v1 #( 10 20 ) array->f64-vector vector-add! => #f64( 11.0 22.0 )\n\
+Add the elements of VEC2 to those of VEC1 and return VEC1.  \
+Both must be vectors of the same type and length."
+	VECTOR_ASSERT_PAIR(vec1, vec2);
+
+	if (FTH_VECTOR_F64_TYPE_P(vec1))
+		(*vec_kernels->f64_add) (FTH_VECTOR_F64(vec1),
+		    FTH_VECTOR_F64(vec2), FTH_VECTOR_LENGTH(vec1));
+	else
+		(*vec_kernels->i64_add) (FTH_VECTOR_I64(vec1),
+		    FTH_VECTOR_I64(vec2), FTH_VECTOR_LENGTH(vec1));
+
+	FTH_INSTANCE_CHANGED(vec1);
+	return (vec1);
+}
+
+/*
+ * Multiply the elements of VEC with X and return VEC.
+ */
+FTH
+fth_vector_scale(FTH vec, FTH x)
+{
+#define h_vector_scale "( vec x -- vec' )  scale vector\n\
+#( 1 2 ) array->f64-vector 0.5 vector-scale! => #f64( 0.5 1.0 )\n\
+Multiply the elements of VEC with X and return VEC.  \
+X is converted to the element type of VEC."
+	ficlInteger 	i, len;
+	ficl2Integer 	n;
+
+	VECTOR_ASSERT(vec, FTH_ARG1);
+	FTH_ASSERT_ARGS(FTH_NUMBER_P(x), x, FTH_ARG2, "a number");
+	len = FTH_VECTOR_LENGTH(vec);
+
+	if (FTH_VECTOR_F64_TYPE_P(vec))
+		(*vec_kernels->f64_scale) (FTH_VECTOR_F64(vec),
+		    fth_float_ref(x), len);
+	else {
+		n = fth_long_long_ref(x);
+
+		for (i = 0; i < len; i++)
+			FTH_VECTOR_I64(vec)[i] *= n;
+	}
+	FTH_INSTANCE_CHANGED(vec);
+	return (vec);
+}
+
+/*
+ * Set all elements of VEC to X and return VEC.
+ */
+FTH
+fth_vector_fill(FTH vec, FTH x)
+{
+#define h_vector_fill "( vec x -- vec' )  fill vector\n\
+3 make-i64-vector 7 vector-fill => #i64( 7 7 7 )\n\
+Set all elements of VEC to X and return VEC.  \
+X is converted to the element type of VEC."
+	ficlInteger 	i, len;
+	ficl2Integer 	n;
+
+	VECTOR_ASSERT(vec, FTH_ARG1);
+	FTH_ASSERT_ARGS(FTH_NUMBER_P(x), x, FTH_ARG2, "a number");
+	len = FTH_VECTOR_LENGTH(vec);
+
+	if (FTH_VECTOR_F64_TYPE_P(vec))
+		(*vec_kernels->f64_fill) (FTH_VECTOR_F64(vec),
+		    fth_float_ref(x), len);
+	else {
+		n = fth_long_long_ref(x);
+
+		for (i = 0; i < len; i++)
+			FTH_VECTOR_I64(vec)[i] = n;
+	}
+	FTH_INSTANCE_CHANGED(vec);
+	return (vec);
+}
+
+/*
+ * Return the dot product of VEC1 and VEC2.
+ */
+FTH
+fth_vector_dot(FTH vec1, FTH vec2)
+{
+#define h_vector_dot "( vec1 vec2 -- x )  return dot product\n\
+#( 1 2 ) array->f64-vector #( 3 4 ) array->f64-vector vector-dot => 11.0\n\
+Return the dot product of VEC1 and VEC2, a float for f64-vectors and \
+an integer for i64-vectors.  \
+Both must be vectors of the same type and length.  \
+The SIMD kernels add in a different order than the 'c kernels, so \
+float results may differ in the last bits."
+	ficlInteger 	i, len;
+	ficl2Integer 	n;
+
+	VECTOR_ASSERT_PAIR(vec1, vec2);
+	len = FTH_VECTOR_LENGTH(vec1);
+
+	if (FTH_VECTOR_F64_TYPE_P(vec1))
+		return (fth_make_float((*vec_kernels->f64_dot)
+		    (FTH_VECTOR_F64(vec1), FTH_VECTOR_F64(vec2), len)));
+
+	n = 0;
+
+	for (i = 0; i < len; i++)
+		n += FTH_VECTOR_I64(vec1)[i] * FTH_VECTOR_I64(vec2)[i];
+
+	return (fth_make_long_long(n));
+}
+
+/*
+ * Return the sum of the elements of VEC.
+ */
+FTH
+fth_vector_sum(FTH vec)
+{
+#define h_vector_sum "( vec -- x )  return sum\n\
+#( 1 2 3 ) array->i64-vector vector-sum => 6\n\
+Return the sum of the elements of VEC, a float for f64-vectors and \
+an integer for i64-vectors.  \
+See vector-dot for the order of float additions."
+	VECTOR_ASSERT(vec, FTH_ARG1);
+
+	if (FTH_VECTOR_F64_TYPE_P(vec))
+		return (fth_make_float((*vec_kernels->f64_sum)
+		    (FTH_VECTOR_F64(vec), FTH_VECTOR_LENGTH(vec))));
+
+	return (fth_make_long_long((*vec_kernels->i64_sum)
+	    (FTH_VECTOR_I64(vec), FTH_VECTOR_LENGTH(vec))));
+}
+
+/*
+ * Return the smallest element of VEC or #f if VEC is empty.
+ */
+FTH
+fth_vector_min(FTH vec)
+{
+#define h_vector_min "( vec -- x )  return smallest element\n\
+#( 3 1 2 ) array->i64-vector vector-min => 1\n\
+Return the smallest element of VEC or #f if VEC is empty.  \
+If an f64-vector contains a NaN, return NaN.\n\
+See also vector-max."
+	VECTOR_ASSERT(vec, FTH_ARG1);
+
+	if (FTH_VECTOR_LENGTH(vec) == 0)
+		return (FTH_FALSE);
+
+	if (FTH_VECTOR_F64_TYPE_P(vec))
+		return (fth_make_float((*vec_kernels->f64_min)
+		    (FTH_VECTOR_F64(vec), FTH_VECTOR_LENGTH(vec))));
+
+	return (fth_make_long_long((*vec_kernels->i64_min)
+	    (FTH_VECTOR_I64(vec), FTH_VECTOR_LENGTH(vec))));
+}
+
+/*
+ * Return the largest element of VEC or #f if VEC is empty.
+ */
+FTH
+fth_vector_max(FTH vec)
+{
+#define h_vector_max "( vec -- x )  return largest element\n\
+#( 3 1 2 ) array->i64-vector vector-max => 3\n\
+Return the largest element of VEC or #f if VEC is empty.  \
+If an f64-vector contains a NaN, return NaN.\n\
+See also vector-min."
+	VECTOR_ASSERT(vec, FTH_ARG1);
+
+	if (FTH_VECTOR_LENGTH(vec) == 0)
+		return (FTH_FALSE);
+
+	if (FTH_VECTOR_F64_TYPE_P(vec))
+		return (fth_make_float((*vec_kernels->f64_max)
+		    (FTH_VECTOR_F64(vec), FTH_VECTOR_LENGTH(vec))));
+
+	return (fth_make_long_long((*vec_kernels->i64_max)
+	    (FTH_VECTOR_I64(vec), FTH_VECTOR_LENGTH(vec))));
+}
+
+void
+init_vector_type(void)
+{
+	/* f64-vector */
+	f64_vector_tag = make_object_type(FTH_STR_F64_VECTOR,
+	    FTH_F64_VECTOR_T);
+	fth_set_object_inspect(f64_vector_tag, vec_inspect);
+	fth_set_object_to_string(f64_vector_tag, vec_to_string);
+	fth_set_object_dump(f64_vector_tag, vec_dump);
+	fth_set_object_to_array(f64_vector_tag, vec_to_array);
+	fth_set_object_copy(f64_vector_tag, vec_copy);
+	fth_set_object_value_ref(f64_vector_tag, vec_ref);
+	fth_set_object_value_set(f64_vector_tag, vec_set);
+	fth_set_object_equal_p(f64_vector_tag, vec_equal_p);
+	fth_set_object_hash(f64_vector_tag, vec_hash);
+	fth_set_object_length(f64_vector_tag, vec_length);
+	fth_set_object_free(f64_vector_tag, vec_free);
+	/* i64-vector */
+	i64_vector_tag = make_object_type_from(FTH_STR_I64_VECTOR,
+	    FTH_I64_VECTOR_T, f64_vector_tag);
+	vec_kernels_init();
+}
+
+void
+init_vector(void)
+{
+	fth_set_object_apply(f64_vector_tag, (void *) vec_ref, 1, 0, 0);
+	fth_set_object_apply(i64_vector_tag, (void *) vec_ref, 1, 0, 0);
+	FTH_PRI1("vector?", ficl_vector_p, h_vector_p);
+	FTH_PRI1("f64-vector?", ficl_f64_vector_p, h_f64_vector_p);
+	FTH_PRI1("i64-vector?", ficl_i64_vector_p, h_i64_vector_p);
+	FTH_PRI1("make-f64-vector", ficl_make_f64_vector, h_make_f64_vector);
+	FTH_PRI1("make-i64-vector", ficl_make_i64_vector, h_make_i64_vector);
+	FTH_PROC("array->f64-vector", fth_array_to_f64_vector, 1, 0, 0,
+	    h_array_to_f64_vector);
+	FTH_PROC("array->i64-vector", fth_array_to_i64_vector, 1, 0, 0,
+	    h_array_to_i64_vector);
+	FTH_PROC("vector->array", fth_vector_to_array, 1, 0, 0,
+	    h_vector_to_array);
+	FTH_PROC("vector-copy", fth_vector_copy, 1, 0, 0, h_vector_copy);
+	FTH_PRI1("vector-length", ficl_vector_length, h_vector_length);
+	FTH_PRI1("f64-vector-ref", ficl_f64_vector_ref, h_f64_vector_ref);
+	FTH_PRI1("f64-vector-set!", ficl_f64_vector_set, h_f64_vector_set);
+	FTH_PRI1("i64-vector-ref", ficl_i64_vector_ref, h_i64_vector_ref);
+	FTH_PRI1("i64-vector-set!", ficl_i64_vector_set, h_i64_vector_set);
+	FTH_PROC("vector-add!", fth_vector_add, 2, 0, 0, h_vector_add);
+	FTH_PROC("vector-scale!", fth_vector_scale, 2, 0, 0, h_vector_scale);
+	FTH_PROC("vector-fill", fth_vector_fill, 2, 0, 0, h_vector_fill);
+	FTH_PROC("vector-dot", fth_vector_dot, 2, 0, 0, h_vector_dot);
+	FTH_PROC("vector-sum", fth_vector_sum, 1, 0, 0, h_vector_sum);
+	FTH_PROC("vector-min", fth_vector_min, 1, 0, 0, h_vector_min);
+	FTH_PROC("vector-max", fth_vector_max, 1, 0, 0, h_vector_max);
+	FTH_PRI1("vector-kernels", ficl_vector_kernels, h_vector_kernels);
+	FTH_PRI1("set-vector-kernels", ficl_set_vector_kernels,
+	    h_set_vector_kernels);
+	FTH_ADD_FEATURE_AND_INFO(FTH_STR_VECTOR, h_list_of_vector_functions);
+}
+
+/*
+ * vector.c ends here
+ */
@@ -43,6 +43,31 @@ require test-utils.fs
 	array= not
 ;
 
+\ Keys whose hash ids all collide.
+"hkey" make-object-type constant fth-hkey
+#( "hkey-name" ) create-instance-struct make-hkey-instance
+
+: make-hkey { name -- key }
+	fth-hkey make-hkey-instance { key }
+	key name hkey-name!
+	key
+;
+
+: hkey-equal? { self obj -- f }
+	obj fth-hkey instance-of? if
+		self hkey-name@ obj hkey-name@ string=
+	else
+		#f
+	then
+;
+
+: hkey-hash ( self -- id )   drop 7 ;
+: hkey->string ( self -- str )   hkey-name@ ;
+
+<'> hkey-equal?  fth-hkey set-object-equal-p
+<'> hkey-hash    fth-hkey set-object-hash
+<'> hkey->string fth-hkey set-object->string
+
 : array-test ( -- )
 	nil         { ary }
 	nil nil nil { a1 a2 a3 }
@@ -149,6 +174,24 @@ require test-utils.fs
 	-1 +loop ( ary ) each to x
 		i x <> "array-unshift [%d]: %s\n" #( i x ) test-expr-format
 	end-each
+	\ array-reserve, large arrays
+	#() 1000 array-reserve to ary
+	ary length 0<> "array-reserve (length)" test-expr
+	#() -1 <'> array-reserve 'out-of-range nil fth-catch car 'out-of-range <>
+	    "array-reserve -1" test-expr
+	10000 0 do
+		ary i array-push drop
+		ary i array-unshift drop
+	loop
+	ary length 20000 <> "10000 array-push/unshift (length)" test-expr
+	ary 0 array-ref 9999 <> "10000 array-unshift (first)" test-expr
+	ary 10000 array-ref 0<> "10000 array-push (first)" test-expr
+	ary -1 array-ref 9999 <> "10000 array-push (last)" test-expr
+	9995 0 do
+		ary array-pop drop
+		ary array-shift drop
+	loop
+	ary #( 4 3 2 1 0 0 1 2 3 4 ) array<> "9995 array-pop/shift" test-expr
 	\ array-reverse(!)
 	#( 0 1 2 ) array-reverse #( 2 1 0 ) array<> "array-reverse" test-expr
 	#( 0 1 2 ) to a1
@@ -289,6 +332,21 @@ require test-utils.fs
 	    "array-assoc-remove! 0" test-expr
 	ass 1 array-assoc-remove! #a( 'd 10 ) array<>
 	    "array-assoc-remove! 1" test-expr
+	\ colliding hash ids
+	#() "a" make-hkey 1 assoc "b" make-hkey 2 assoc 'c 3 assoc to ass
+	ass "c" make-hkey 4 assoc to ass
+	ass "a" make-hkey array-assoc-ref 1 <> "assoc collision a" test-expr
+	ass "b" make-hkey array-assoc-ref 2 <> "assoc collision b" test-expr
+	ass "c" make-hkey array-assoc-ref 4 <> "assoc collision c" test-expr
+	ass 'c array-assoc-ref 3 <> "assoc collision 'c" test-expr
+	ass "d" make-hkey array-assoc-ref "assoc collision d" test-expr
+	ass "b" make-hkey 20 array-assoc-set! to ass
+	ass "b" make-hkey array-assoc-ref 20 <> "assoc collision set!" test-expr
+	ass array-length 4 <> "assoc collision set! length" test-expr
+	ass "a" make-hkey array-assoc-remove! to ass
+	ass "a" make-hkey array-assoc-ref "assoc collision remove!" test-expr
+	ass "c" make-hkey array-assoc-ref 4 <> "assoc collision remove! c"
+	    test-expr
 ;
 
 *fth-test-count* 0 [do] array-test [loop]
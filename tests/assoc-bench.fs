@@ -0,0 +1,105 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)assoc-bench.fs	1.1 10/18/26
+
+\ Commentary:
+\
+\ Assoc arrays with string keys for 1e3 up to MAX-KEYS keys.  The keys
+\ are added in hash id order, so each assoc appends instead of moving
+\ the tail; ref looks up every key, miss as many absent keys, set!
+\ replaces every value.  MAX-KEYS defaults to 1e6, see bench-utils.fs.
+
+\ Code:
+
+require bench-utils.fs
+
+1000000 bench-count value max-keys
+
+: hash-id< <{ a b -- n }>
+	a hash-id { ia }
+	b hash-id { ib }
+	ia ib < if
+		-1
+	else
+		ia ib > if
+			1
+		else
+			0
+		then
+	then
+;
+
+: make-keys { len prefix -- ary }
+	len make-array map!
+		"%s%d" #( prefix i ) string-format
+	end-map <'> hash-id< array-sort
+;
+
+: bench-assoc { ass keys -- }
+	keys array-length 0 ?do
+		ass keys i array-ref i assoc drop
+	loop
+;
+
+: bench-ref { ass keys -- }
+	keys array-length 0 ?do
+		ass keys i array-ref array-assoc-ref drop
+	loop
+;
+
+: bench-set { ass keys -- }
+	keys array-length 0 ?do
+		ass keys i array-ref 0 array-assoc-set! drop
+	loop
+;
+
+: bench-assocs { len -- }
+	len "key-" make-keys { keys }
+	len "absent-" make-keys { absent }
+	#() { ass }
+	"%8d" #( len ) fth-print
+	ass keys <'> bench-assoc bench-column
+	ass keys <'> bench-ref bench-column
+	ass absent <'> bench-ref bench-column
+	ass keys <'> bench-set bench-column
+	cr
+;
+
+: assoc-bench ( -- )
+	"%8s  %8s  %8s  %8s  %8s\n"
+	    #( "keys" "assoc" "ref" "miss" "set!" ) fth-print
+	1000 { len }
+	begin
+		len max-keys <=
+	while
+		len bench-assocs
+		gc-run
+		len 10 * to len
+	repeat
+;
+
+assoc-bench
+
+\ assoc-bench.fs ends here
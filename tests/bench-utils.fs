@@ -0,0 +1,92 @@
+\ Copyright (c) 2006-2018 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)bench-utils.fs	1.1 10/18/26
+
+\ Commentary:
+\
+\ Common code of the *-bench.fs files.  They are not part of the
+\ testsuite and are run by hand from this directory:
+\
+\ fth -s NAME-bench.fs [ count ]
+\
+\ The optional COUNT (iterations, keys, elements ...) replaces the
+\ default of the file.
+
+\ Code:
+
+\ Return command line argument N or DEFAULT; *argv* 0 is the script.
+: bench-arg <{ n default -- val }>
+	*argv* length n > if
+		*argv* n array-ref
+	else
+		default
+	then
+;
+
+\ Return the first argument as number or DEFAULT.
+: bench-count ( default -- n )
+	1 swap bench-arg dup string? if
+		string->number
+	then
+;
+
+make-timer value bench-timer
+
+\ Execute XT, which may take arguments, and return its real time.
+: bench-time ( ?? xt -- secs )
+	bench-timer start-timer
+	execute
+	bench-timer stop-timer
+	bench-timer real-time@
+;
+
+\ Execute XT and print its time as a table column.
+: bench-column ( ?? xt -- )
+	bench-time { secs }
+	"  %8.3f" #( secs ) fth-print
+;
+
+\ Print the head for bench-line; UNIT is the rate or #f.
+: bench-header <{ unit -- }>
+	unit string? if
+		"%-24s  %8s  %8s\n" #( "test" "seconds" unit ) fth-print
+	else
+		"%-24s  %8s\n" #( "test" "seconds" ) fth-print
+	then
+;
+
+\ Execute XT and print NAME and its time.  If N is a number, N per
+\ second in millions follows.
+: bench-line <{ xt name n -- }>
+	"%-24s" #( name ) fth-print
+	xt bench-time { secs }
+	n number? if
+		"  %8.3f  %8.2f\n" #( secs n secs f/ 1e6 f/ ) fth-print
+	else
+		"  %8.3f\n" #( secs ) fth-print
+	then
+;
+
+\ bench-utils.fs ends here
@@ -0,0 +1,95 @@
+\ Copyright (c) 2006-2018 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)cache-test.fs	1.1 10/18/26
+
+require test-utils.fs
+
+\ The load cache is only used by new processes.  testsuite.at sets
+\ FTH_TEST_PROG to the fth command of the build tree; skip without.
+"FTH_TEST_PROG" getenv value cache-prog
+cache-prog string? not [if] 77 (bye) [then]
+
+"cache-test.d" value cache-dir
+
+: cache-path <{ name -- path }>
+	"%s/%s" #( cache-dir name ) string-format
+;
+
+\ Prints the changes of the tainted, stale, misses and hits statistics
+\ by requiring cache-lib.fs and the value of cache-word.
+#( ": cache-stat ( key -- n ) load-cache-statistics swap hash-ref ;\n"
+   "'hits cache-stat 'misses cache-stat 'stale cache-stat\n"
+   "'tainted cache-stat\n"
+   "require cache-lib.fs\n"
+   "'tainted cache-stat swap - . 'stale cache-stat swap - .\n"
+   "'misses cache-stat swap - . 'hits cache-stat swap - .\n"
+   "cache-word .\n" ) value cache-main
+
+: cache-run ( -- str )
+	"FTH_LOAD_CACHE=%s %s -I %s -s %s 2>&1"
+	    #( cache-dir cache-prog cache-dir "cache-main.fs" cache-path )
+	    string-format file-shell string-chomp
+;
+
+: cache-lib ( lines -- )
+	"cache-lib.fs" cache-path swap writelines
+;
+
+: cache-test ( -- )
+	"rm -rf " cache-dir $+ file-system drop
+	cache-dir 0o755 file-mkdir
+	"cache-main.fs" cache-path cache-main writelines
+	\ miss: written to the cache
+	#( ": cache-word 10 ;\n" ) cache-lib
+	cache-run { res }
+	res "0 0 1 0 10 " string<> "cache miss: %s" #( res ) test-expr-format
+	\ hit: restored from the cache
+	cache-run to res
+	res "0 0 0 1 10 " string<> "cache hit: %s" #( res ) test-expr-format
+	\ stale: the source file changed
+	#( ": cache-word 200 ;\n" ) cache-lib
+	cache-run to res
+	res "0 1 0 0 200 " string<> "cache stale: %s" #( res ) test-expr-format
+	cache-run to res
+	res "0 0 0 1 200 " string<> "cache hit (2): %s" #( res ) test-expr-format
+	\ tainted: changing an existing object isn't cached
+	cache-main array-copy { lines }
+	lines "#() value cache-ary\n" array-unshift drop
+	lines "cache-ary .\n" array-push drop
+	"cache-main.fs" cache-path lines writelines
+	#( "cache-ary 42 array-push drop\n" ": cache-word 30 ;\n" ) cache-lib
+	\ the outdated entry is removed
+	cache-run to res
+	res "1 1 0 0 30 #( 42 ) " string<>
+	    "cache taint: %s" #( res ) test-expr-format
+	cache-run to res
+	res "1 0 1 0 30 #( 42 ) " string<>
+	    "cache taint (2): %s" #( res ) test-expr-format
+	"rm -rf " cache-dir $+ file-system drop
+;
+
+cache-test
+
+\ cache-test.fs ends here
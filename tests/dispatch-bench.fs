@@ -0,0 +1,116 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)dispatch-bench.fs	1.1 10/18/26
+
+\ Commentary:
+\
+\ Speed of the inner interpreter, ficlVmInnerLoop(): counted and
+\ conditional loops, calls of colon words and words with locals.
+\ COUNT defaults to 1e7 iterations, see bench-utils.fs.
+
+\ Code:
+
+require bench-utils.fs
+
+10000000 bench-count value count
+
+: bench-do-loop ( -- )
+	0 count 0 do
+		i +
+	loop drop
+;
+
+: bench-begin-until ( -- )
+	count begin
+		1- dup 0=
+	until drop
+;
+
+: bench-stack ( -- )
+	1 2 count 0 do
+		over over swap rot 2drop
+	loop 2drop
+;
+
+: leaf ( n -- n' ) 1+ ;
+: twig ( n -- n' ) leaf leaf ;
+: branch ( n -- n' ) twig twig ;
+
+: bench-calls ( -- )
+	0 count 0 do
+		branch
+	loop drop
+;
+
+: fib ( n -- f )
+	dup 2 < if
+		exit
+	then
+	dup 1- recurse swap 2 - recurse +
+;
+
+: bench-recurse ( -- )
+	\ fib(32) needs about 7e6 calls.
+	count 10000000 / 1 max 0 do
+		32 fib drop
+	loop
+;
+
+: locals-sum { a b c -- n }
+	a b + c + { s }
+	s a - b - c -
+;
+
+: bench-locals ( -- )
+	count 0 do
+		i 1 2 locals-sum drop
+	loop
+;
+
+lambda: <{ a b c -- n }>
+	a b * c + { s }
+	s a + b + c +
+; proc->xt value lambda-xt
+
+: bench-lambda ( -- )
+	count 0 do
+		i 1 2 lambda-xt execute drop
+	loop
+;
+
+: dispatch-bench ( -- )
+	#f bench-header
+	<'> bench-do-loop "do loop" #f bench-line
+	<'> bench-begin-until "begin until" #f bench-line
+	<'> bench-stack "stack words" #f bench-line
+	<'> bench-calls "colon calls" #f bench-line
+	<'> bench-recurse "recursion (fib)" #f bench-line
+	<'> bench-locals "locals" #f bench-line
+	<'> bench-lambda "lambda with locals" #f bench-line
+;
+
+dispatch-bench
+
+\ dispatch-bench.fs ends here
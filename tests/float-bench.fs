@@ -0,0 +1,90 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\ @(#)float-bench.fs	1.1 10/18/26
+
+\ Commentary:
+\
+\ Float-heavy loops; every float operation creates a float instance.
+\ f-sum accumulates on the stack, f-horner evaluates a polynomial,
+\ f-filter runs a one-pole lowpass over an array of floats, and
+\ f-sin calls a libm function.  COUNT defaults to 1e6 iterations,
+\ see bench-utils.fs.
+
+\ Code:
+
+require bench-utils.fs
+
+1000000 bench-count value count
+
+1024 constant buffer-size
+buffer-size :initial-element 0.0 make-array value in-buffer
+buffer-size :initial-element 0.0 make-array value out-buffer
+
+: buffer-init ( -- )
+	buffer-size 0 do
+		in-buffer i  i s>f 0.1 f* fsin  array-set!
+	loop
+;
+
+buffer-init
+
+: bench-f-sum ( -- )
+	0.0 count 0 ?do
+		i s>f 0.5 f* f+
+	loop drop
+;
+
+: bench-f-horner ( -- )
+	count 0 ?do
+		i s>f 1e-6 f* { x }
+		x 0.5 f* 0.25 f+ x f* 0.125 f+ x f* 1.0 f+ drop
+	loop
+;
+
+: bench-f-filter ( -- )
+	0.0 count buffer-size / 0 ?do
+		buffer-size 0 do
+			0.9 f*  in-buffer i array-ref 0.1 f* f+
+			dup out-buffer i rot array-set!
+		loop
+	loop drop
+;
+
+: bench-f-sin ( -- )
+	count 0 ?do
+		i s>f fsin drop
+	loop
+;
+
+: float-bench ( -- )
+	"Mloops/s" bench-header
+	<'> bench-f-sum "f-sum" count bench-line
+	<'> bench-f-horner "f-horner" count bench-line
+	<'> bench-f-filter "f-filter" count bench-line
+	<'> bench-f-sin "f-sin" count bench-line
+;
+
+float-bench
+
+\ float-bench.fs ends here
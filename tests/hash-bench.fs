@@ -0,0 +1,81 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)hash-bench.fs	1.1 10/17/26
+
+\ Commentary:
+\
+\ Compare make-hash (bucket lists) with make-flat-hash (open addressing)
+\ for 1e3 up to MAX-KEYS keys.  MAX-KEYS defaults to 1e6, see
+\ bench-utils.fs.
+
+\ Code:
+
+require bench-utils.fs
+
+1000000 bench-count value max-keys
+
+: bench-set { hs len -- }
+	len 0 ?do
+		hs i i hash-set!
+	loop
+;
+
+: bench-ref { hs len -- }
+	len 0 ?do
+		hs i hash-ref drop
+	loop
+;
+
+: bench-delete { hs len -- }
+	len 0 ?do
+		hs i hash-delete! drop
+	loop
+;
+
+: bench-hash { name hs len -- }
+	"%-10s %8d" #( name len ) fth-print
+	hs len <'> bench-set bench-column
+	hs len <'> bench-ref bench-column
+	hs len <'> bench-delete bench-column
+	cr
+;
+
+: hash-bench ( -- )
+	"%-10s %8s  %8s  %8s  %8s\n"
+	    #( "hash" "keys" "set" "ref" "delete" ) fth-print
+	1000 { len }
+	begin
+		len max-keys <=
+	while
+		"make-hash" make-hash len bench-hash
+		"flat" make-flat-hash len bench-hash
+		gc-run
+		len 10 * to len
+	repeat
+;
+
+hash-bench
+
+\ hash-bench.fs ends here
@@ -28,6 +28,37 @@ require test-utils.fs
 
 lambda: <{ key val -- x }> val 10 + ; value hash-map-cb
 
+nil value each-hash
+0 value each-sum
+\ Delete the even keys while visiting them.
+lambda: <{ key val -- }>
+	each-sum key + to each-sum
+	key 2 mod 0= if
+		each-hash key hash-delete! drop
+	then
+; value hash-each-delete-cb
+
+\ Delete every key; the table shrinks after the walk.
+lambda: <{ key val -- }>
+	each-hash key hash-delete! drop
+; value hash-each-clear-cb
+
+: hash-each-clear ( -- )
+	each-hash hash-each-clear-cb hash-each
+	100 0 do
+		each-hash i i hash-set!
+	loop
+;
+
+: hash-each-delete ( hash -- )
+	to each-hash
+	1000 0 do
+		each-hash i i hash-set!
+	loop
+	0 to each-sum
+	each-hash hash-each-delete-cb hash-each
+;
+
 : test-noop ;
 
 : hash-test ( -- )
@@ -97,12 +128,75 @@ lambda: <{ key val -- x }> val 10 + ; value hash-map-cb
 	h1 hash-clear
 	h1 length 0<> "hash-clear (1)" test-expr
 	h1 #{} hash= not "hash-clear (2)" test-expr
+	\ growing and shrinking
+	make-hash to h1
+	1000 0 do
+		h1 i i 10 * hash-set!
+	loop
+	h1 length 1000 <> "hash grow (length)" test-expr
+	h1 999 hash-ref 9990 <> "hash grow (999)" test-expr
+	h1 0 hash-ref 0<> "hash grow (0)" test-expr
+	h1 hash-copy h1 hash= not "hash grow (hash=)" test-expr
+	1000 10 do
+		h1 i hash-delete! drop
+	loop
+	h1 length 10 <> "hash shrink (length)" test-expr
+	h1 9 hash-ref 90 <> "hash shrink (9)" test-expr
+	h1 10 hash-member? "hash shrink (10)" test-expr
+	h1 hash-keys array-length 10 <> "hash shrink (keys)" test-expr
+	\ flat hash (open addressing)
+	make-flat-hash to h2
+	1000 0 do
+		h2 i i 10 * hash-set!
+	loop
+	h2 length 1000 <> "flat hash grow (length)" test-expr
+	h2 999 hash-ref 9990 <> "flat hash grow (999)" test-expr
+	h2 hash-copy h2 hash= not "flat hash grow (hash=)" test-expr
+	1000 10 do
+		h2 i hash-delete! drop
+	loop
+	h2 h1 hash= not "flat hash shrink (hash=)" test-expr
+	h2 10 hash-member? "flat hash shrink (10)" test-expr
+	h2 5 hash-find #( 5 50 ) array= not "flat hash-find" test-expr
+	h2 "a" 1 hash-set!
+	h2 "a" hash-ref 1 <> "flat hash-ref (string)" test-expr
+	h2 hash-clear
+	h2 length 0<> "flat hash-clear" test-expr
 	\ hash-each|map
 	#{ 'foo 0 'bar 1 } to h1
 	h1 hash-map-cb hash-map to h2
 	#{ 'foo 10 'bar 11 } h2 hash= not "hash-map" test-expr
+	\ hash-delete! of the current key inside hash-each
+	make-hash hash-each-delete
+	each-sum 499500 <> "hash-each delete (sum)" test-expr
+	each-hash length 500 <> "hash-each delete (length)" test-expr
+	each-hash 999 hash-ref 999 <> "hash-each delete (999)" test-expr
+	hash-each-clear
+	each-hash length 100 <> "hash-each clear (length)" test-expr
+	each-hash 99 hash-ref 99 <> "hash-each clear (99)" test-expr
+	make-flat-hash hash-each-delete
+	each-sum 499500 <> "flat hash-each delete (sum)" test-expr
+	each-hash length 500 <> "flat hash-each delete (length)" test-expr
+	each-hash 998 hash-member? "flat hash-each delete (998)" test-expr
+	each-hash 999 hash-ref 999 <> "flat hash-each delete (999)" test-expr
+	hash-each-clear
+	each-hash length 100 <> "flat hash-each clear (length)" test-expr
+	each-hash 99 hash-ref 99 <> "flat hash-each clear (99)" test-expr
 	\ object-id (fixnums: x << 1 | 1)
 	10 object-id 10 1 lshift 1 or <> "object-id 10" test-expr
+	\ hash-id (equal objects have equal ids)
+	"hello" hash-id "hello" hash-id <> "hash-id (string)" test-expr
+	#( 0 "a" 1.5 ) hash-id #( 0 "a" 1.5 ) hash-id <>
+	    "hash-id (array)" test-expr
+	#{ 'a 0 'b 1 } hash-id #{ 'b 1 'a 0 } hash-id <>
+	    "hash-id (hash)" test-expr
+	0.0 hash-id -0.0 hash-id <> "hash-id (0.0)" test-expr
+	#( "a" ) { ary }
+	ary hash-id { id }
+	ary 0 array-ref "b" string-push drop
+	ary hash-id id = "hash-id (nested change)" test-expr
+	ary 1 array-push drop
+	ary hash-id #( "ab" 1 ) hash-id <> "hash-id (array-push)" test-expr
 	\ properties, property-ref|set!
 	"hello" { obj }
 	obj 'hey "joe" property-set!
@@ -0,0 +1,84 @@
+\ Copyright (c) 2006-2018 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)image-test.fs	1.1 10/18/26
+
+require test-utils.fs
+
+\ Images are saved and restored by new processes.  testsuite.at sets
+\ FTH_TEST_PROG to the fth command of the build tree; skip without.
+"FTH_TEST_PROG" getenv value image-prog
+image-prog string? not [if] 77 (bye) [then]
+
+"image-test.d" value image-dir
+
+: image-path <{ name -- path }>
+	"%s/%s" #( image-dir name ) string-format
+;
+
+: image-run <{ fmt args -- str }>
+	image-prog " " $+ fmt $+ " 2>&1" $+ args string-format file-shell
+;
+
+\ A bad image is reported and the source files are loaded instead.
+: image-fallback <{ img script info -- }>
+	"--image %s -s %s" #( img script ) image-run { res }
+	res "warning" string-member? not
+	    "%s: no warning: %s" #( info res ) test-expr-format
+	res "3 " string-index res string-length 2 - <>
+	    "%s: %s" #( info res ) test-expr-format
+;
+
+: image-test ( -- )
+	"rm -rf " image-dir $+ file-system drop
+	image-dir 0o755 file-mkdir
+	"fth.img" image-path { img }
+	"script.fs" image-path { script }
+	script #( "1 2 + .\n" ) writelines
+	\ --save-image
+	"--save-image %s" #( img ) image-run { res }
+	exit-status 0<> "--save-image: %s" #( res ) test-expr-format
+	img file-exists? not "--save-image: no image" test-expr
+	\ --image
+	"--image %s -s %s" #( img script ) image-run to res
+	res "3 " string<> "--image: %s" #( res ) test-expr-format
+	"--image %s -s array-test.fs" #( img ) image-run to res
+	res "" string<> "--image array-test.fs: %s" #( res ) test-expr-format
+	\ missing, truncated and corrupt images
+	"none.img" image-path script "missing image" image-fallback
+	"short.img" image-path { bad }
+	"head -c 64 %s > %s" #( img bad ) string-format file-system drop
+	bad script "truncated header" image-fallback
+	"head -c 100000 %s > %s" #( img bad ) string-format file-system drop
+	bad script "truncated image" image-fallback
+	"cp %s %s" #( img bad ) string-format file-system drop
+	"printf XXXXXXXX | dd of=%s bs=1 seek=5000 conv=notrunc 2>/dev/null"
+	    #( bad ) string-format file-system drop
+	bad script "corrupt image" image-fallback
+	"rm -rf " image-dir $+ file-system drop
+;
+
+image-test
+
+\ image-test.fs ends here
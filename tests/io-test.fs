@@ -126,6 +126,27 @@ exit-status [if] "pwd" [else] "pwd -P" [then] constant *io-test-pwd-cmd*
 			    "io-nopen not output? (r/w def socket)" test-expr
 			io io-close
 		then
+		\ buffered AF_UNIX socket io, line framing
+		"fth-test.sock" { name }
+		name file-exists? if
+			name file-delete
+		then
+		AF_UNIX SOCK_STREAM net-socket { sfd }
+		sfd name -1 AF_UNIX net-bind
+		sfd net-listen
+		AF_UNIX SOCK_STREAM net-socket name -1 AF_UNIX net-connect { cli }
+		sfd name AF_UNIX net-accept { srv }
+		cli "hello\nworld\n" io-write
+		cli io-flush
+		srv io-read "hello\n" string<> "socket io-read (1)" test-expr
+		srv io-read "world\n" string<> "socket io-read (2)" test-expr
+		srv "back" io-write
+		srv io-close
+		cli io-getc <char> b <> "socket io-getc" test-expr
+		cli io-read "ack" string<> "socket io-read (eof)" test-expr
+		cli io-eof? not "socket io-eof?" test-expr
+		cli io-close
+		name file-delete
 	;
 [else]
 	: socket-test ( -- ) ;
@@ -217,6 +217,16 @@ require test-utils.fs
 	l1 0 list-assoc-remove! to l1
 	2 3 7 20 nil acons acons to l2
 	l1 l2 list<> "list-assoc-remove!" test-expr
+	9 90 1 10 5 50 nil acons acons acons to l1
+	l1 1 list-assoc-ref 10 <> "acons unsorted (1)" test-expr
+	l1 5 list-assoc-ref 50 <> "acons unsorted (5)" test-expr
+	l1 9 list-assoc-ref 90 <> "acons unsorted (9)" test-expr
+	'a 1 nil acons to l1
+	'a 2 l1 acons to l1
+	'a 4 l1 acons to l1
+	l1 'a list-assoc-ref 4 <> "acons shadows older key" test-expr
+	l1 'a list-assoc-remove! to l1
+	l1 'a list-assoc-ref 2 <> "acons older key after remove" test-expr
 ;
 
 *fth-test-count* 0 [do] list-test [loop]
@@ -0,0 +1,84 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)lookup-bench.fs	1.1 10/18/26
+
+\ Commentary:
+\
+\ Dictionary lookup speed with the full fth library loaded, which fth
+\ does at startup (see *loaded-files*).  Looks up every word name of
+\ the dictionary, and the same names with an unknown suffix, COUNT
+\ times with sfind.  COUNT defaults to 1000 lookup rounds, see
+\ bench-utils.fs.
+
+\ Code:
+
+require bench-utils.fs
+
+1000 bench-count value count
+
+\ Keeps the strings alive while their addresses are in use.
+#() value names
+#() value addrs
+#() value lens
+
+: prepare-names { suffix -- }
+	"" apropos each ( name )
+		suffix string-append { name }
+		names name array-push drop
+		name string>$ { addr len }
+		addrs addr array-push drop
+		lens len array-push drop
+	end-each
+;
+
+: bench-sfind ( -- )
+	addrs length 0 ?do
+		addrs i array-ref lens i array-ref ( addr len )
+		count 0 ?do
+			2dup sfind 2drop
+		loop
+		2drop
+	loop
+;
+
+: bench-run { xt name len -- }
+	xt bench-time { secs }
+	"%-8s %8d  %8.3f\n" #( name len secs ) fth-print
+;
+
+: lookup-bench ( -- )
+	"%-8s %8s  %8s\n" #( "bench" "lookups" "time" ) fth-print
+	"" prepare-names
+	<'> bench-sfind "found" addrs length count * bench-run
+	#() to names
+	#() to addrs
+	#() to lens
+	"-nope" prepare-names
+	<'> bench-sfind "missed" addrs length count * bench-run
+;
+
+lookup-bench
+
+\ lookup-bench.fs ends here
@@ -0,0 +1,84 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)loop-bench.fs	1.1 10/18/26
+
+\ Commentary:
+\
+\ Throughput of the implicit-loop options (-n, -a, -p, -i, -j).  Writes a
+\ synthetic log file of LINES lines and runs FTH over it with several
+\ loop bodies, printing lines per second for each.  FTH needs the same
+\ environment (FTH_FTHPATH) as the calling fth.  LINES defaults to
+\ 500000, FTH to the fth in PATH, see bench-utils.fs.
+\
+\ Usage: fth -s loop-bench.fs [ lines [ fth ] ]
+
+\ Code:
+
+require bench-utils.fs
+
+500000 bench-count value lines
+2 "fth" bench-arg value fth-prog
+
+"/tmp/loop-bench.log" value log-file
+
+: make-log ( -- )
+	log-file io-open-write { io }
+	lines 0 ?do
+		io "10.0.%d.%d - - GET /path/%d/index.html 200 %d\n"
+		    #( i 256 mod i 7 mod i 1000 mod i 3 * ) io-write-format
+	loop
+	io io-close
+;
+
+: bench-system { cmd -- }
+	cmd file-system unless
+		"%s: exit status %d\n" #( cmd exit-status ) fth-print
+	then
+;
+
+: bench-run { name opts -- }
+	"%s %s %s > /dev/null" #( fth-prog opts log-file ) string-format { cmd }
+	cmd <'> bench-system bench-time { secs }
+	"%-10s %10d  %8.3f  %12.0f\n"
+	    #( name lines secs lines secs f/ ) fth-print
+;
+
+: loop-bench ( -- )
+	make-log
+	"%-10s %10s  %8s  %12s\n" #( "bench" "lines" "time" "lines/sec" )
+	    fth-print
+	"read"    "-ne ''"                             bench-run
+	"line"    "-ne '*line* string-length drop'"    bench-run
+	"split"   "-ane '*farray* 1 array-ref drop'"   bench-run
+	"nosplit" "-ane '*fnr* drop'"                  bench-run
+	"print"   "-pe ''"                             bench-run
+	"split-j4" "-j 4 -ane '*farray* 1 array-ref drop'" bench-run
+	"inplace" "-i -ale '*farray* 0 array-ref \"\\n\" $+'" bench-run
+	log-file file-delete
+;
+
+loop-bench
+
+\ loop-bench.fs ends here
@@ -35,6 +35,84 @@ require test-utils.fs
 	then
 ;
 
+#() value gc-test-ary
+make-hash value gc-test-hash
+#() constant gc-test-const		\ permanent
+
+\ Store new instances into old containers across many collections.
+: gc-test-fill ( -- )
+	#() to gc-test-ary
+	make-hash to gc-test-hash
+	50000 0 do
+		#( i "s" ) { a }
+		i 7 mod 0= if
+			gc-test-ary a array-push drop
+		then
+		i 13 mod 0= if
+			gc-test-hash i #( i "v" ) hash-set!
+		then
+		i 11 mod 0= if
+			gc-test-const a array-push drop
+		then
+		"tmp" i number->string string-push drop
+	loop
+;
+
+: gc-test ( -- )
+	gc-test-fill
+	gc-run
+	gc-test-ary length 7143 <> "gc (array length)" test-expr
+	gc-test-ary each { val }
+		val array? not if
+			"gc (array): %s?" #( val ) fth-display
+			leave
+		then
+		val 0 array-ref i 7 * <>
+		val 1 array-ref "s" string<> || if
+			"gc (array): %s?" #( val ) fth-display
+			leave
+		then
+	end-each
+	gc-test-hash length 3847 <> "gc (hash length)" test-expr
+	gc-test-hash 3846 13 * hash-ref #( 49998 "v" ) array= not
+	    "gc (hash-ref)" test-expr
+	gc-test-const length 4546 <> "gc (permanent length)" test-expr
+	gc-test-const 4545 array-ref #( 49995 "s" ) array= not
+	    "gc (permanent array-ref)" test-expr
+	gc-statistics { st }
+	st 'minor-collections hash-ref 0= "gc-statistics (minor)" test-expr
+	st 'pause-histogram hash-ref length 5 <>
+	    "gc-statistics (pause-histogram)" test-expr
+	st 'types hash-ref "array" hash-ref { vals }
+	vals 0 array-ref vals 1 array-ref - vals 2 array-ref <>
+	    "gc-statistics (types)" test-expr
+;
+
+\ Superinstructions (see ficlDictionaryCompileInstruction()).
+: fused-literal-ops ( n -- n1 n2 n3 f1 f2 f3 f4 )
+	{ n }
+	n 10 + n 1000 - n -3 * n 7 = n 5 <> n 1 < n 2 >
+;
+: fused-begin ( n -- n' ) 3 begin + dup 20 < while 3 repeat ;
+: fused-dup-if ( x -- x y ) dup if 1 else 2 then ;
+: fused-exit { n -- n' } n 0< if 0 exit then n 1+ ;
+
+\ Hashed wordlists grow with their population (see ficlHashInsertWord()).
+3 ficl-wordlist value grow-wid
+: make-grow-words ( -- )
+	get-current { cur }
+	grow-wid set-current
+	100 0 do
+		"%d constant grow-w%d" #( i i ) string-format string-eval
+	loop
+	cur set-current
+;
+make-grow-words
+: grow-ref ( n -- val|#f )
+	"grow-w%d" swap 1 >array string-format string>$
+	grow-wid search-wordlist if execute else #f then
+;
+
 : misc-test ( -- )
 	\ add-load-path
 	*load-path* "/tmp" array-member?
@@ -117,8 +195,24 @@ require test-utils.fs
 	3 make-array map
 		i f2*
 	end-map #( 0.0 2.0 4.0 ) array= not "map (array) i f2*" test-expr
+	\ superinstructions
+	7 fused-literal-ops 7 >array
+	#( 17 -993 -21 #t #t #f #t ) array= not "fused literal ops" test-expr
+	0 fused-begin 21 <> "fused begin (barrier)" test-expr
+	0 fused-dup-if 2 <> swap 0<> || "fused dup if (0)" test-expr
+	5 fused-dup-if 1 <> swap 5 <> || "fused dup if (5)" test-expr
+	1 2 over over 4 >array #( 1 2 1 2 ) array= not "over over" test-expr
+	-1 fused-exit 0<> "fused exit (-1)" test-expr
+	1 fused-exit 2 <> "fused exit (1)" test-expr
+	0 grow-ref 0<> "wordlist grow (0)" test-expr
+	99 grow-ref 99 <> "wordlist grow (99)" test-expr
+	"grow-w100" string>$ grow-wid search-wordlist
+	    "wordlist grow (100)" test-expr
 ;
 
 *fth-test-count* 0 [do] misc-test [loop]
 
+\ once, it runs through many collections itself
+gc-test
+
 \ misc-test.fs ends here
@@ -0,0 +1,78 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)object-bench.fs	1.1 10/17/26
+
+\ Commentary:
+\
+\ Time instance? (fth_instance_p) and object-equal? (fth_object_equal_p)
+\ dispatch on instances and on immediate values.  COUNT defaults to
+\ 1e6 iterations, see bench-utils.fs.
+
+\ Code:
+
+require bench-utils.fs
+
+1000000 bench-count value count
+
+\ keep some slabs alive so that the lookup has more than one to search
+#() value keep
+: fill-slabs ( -- )
+	100000 0 do
+		keep #( i ) array-push drop
+	loop
+;
+fill-slabs
+
+: bench-instance-p { obj len -- }
+	len 0 ?do
+		obj instance? drop
+	loop
+;
+
+: bench-equal-p { obj len -- }
+	len 0 ?do
+		obj obj object-equal? drop
+	loop
+;
+
+: bench-run { xt obj name -- }
+	obj count xt name #f bench-line
+;
+
+: object-bench ( -- )
+	#f bench-header
+	<'> bench-instance-p "hello"	"instance? (string)"	bench-run
+	<'> bench-instance-p keep 10 array-ref
+	    "instance? (old array)"	bench-run
+	<'> bench-instance-p 10		"instance? (fixnum)"	bench-run
+	<'> bench-instance-p here	"instance? (address)"	bench-run
+	<'> bench-equal-p "hello"	"object-equal? (string)" bench-run
+	<'> bench-equal-p #( 0 1 2 )	"object-equal? (array)"	bench-run
+	<'> bench-equal-p 10		"object-equal? (fixnum)" bench-run
+;
+
+object-bench
+
+\ object-bench.fs ends here
@@ -0,0 +1,77 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)optkey-bench.fs	1.1 10/18/26
+
+\ Commentary:
+\
+\ Calls of words with keyword and optional arguments (<{ :key ...
+\ :optional ... }>) with all arguments given and with the defaults.
+\ The defaults are a number, an array and a string literal.  COUNT
+\ defaults to 1e6 calls, see bench-utils.fs.
+
+\ Code:
+
+require bench-utils.fs
+
+1000000 bench-count value count
+
+: key-word <{ a :key b 10 c #( 1 2 ) d "str" -- }> a ;
+: opt-word <{ a :optional b 10 c #( 1 2 ) d "str" -- }> a ;
+
+: bench-key-defaults ( -- )
+	count 0 ?do
+		i key-word drop
+	loop
+;
+
+: bench-key-given ( -- )
+	count 0 ?do
+		:d 3 :c 2 :b 1 i key-word drop
+	loop
+;
+
+: bench-opt-defaults ( -- )
+	count 0 ?do
+		i opt-word drop
+	loop
+;
+
+: bench-opt-given ( -- )
+	count 0 ?do
+		i 1 2 3 opt-word drop
+	loop
+;
+
+: optkey-bench ( -- )
+	"Mcalls/s" bench-header
+	<'> bench-key-defaults "key-defaults" count bench-line
+	<'> bench-key-given "key-given" count bench-line
+	<'> bench-opt-defaults "optional-defaults" count bench-line
+	<'> bench-opt-given "optional-given" count bench-line
+;
+
+optkey-bench
+
+\ optkey-bench.fs ends here
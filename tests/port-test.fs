@@ -0,0 +1,86 @@
+\ Copyright (c) 2006-2018 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)port-test.fs	1.1 10/18/26
+
+require test-utils.fs
+
+\ testsuite.at sets FTH_TEST_PROG to the fth command of the build tree
+\ for the output order check in a new process.
+"FTH_TEST_PROG" getenv value port-prog
+
+"port-test.tmp" value port-script
+
+\ Output written before starting another process must come first even
+\ if stdout is a pipe, here the one of file-shell.
+: port-order <{ policy -- str }>
+	port-script #(
+	    "'%s set-port-flush-policy drop\n" #( policy ) string-format
+	    "\"a\" .$ cr\n"
+	    "system echo b\n"
+	    "\"c\" .$ cr\n"
+	    "\"echo d\" file-system drop\n"
+	    "\"e\" .$ cr\n" ) writelines
+	"%s -s %s 2>&1" #( port-prog port-script ) string-format file-shell
+	port-script file-delete
+;
+
+: port-test ( -- )
+	port-flush-policy { old }
+	#( 'always 'line 'full ) old array-member? not
+	    "port-flush-policy: %s" #( old ) test-expr-format
+	\ set-port-flush-policy
+	#( 'always 'line 'full ) each { sym }
+		sym set-port-flush-policy drop
+		sym set-port-flush-policy sym <>
+		    "set-port-flush-policy %s => old" #( sym ) test-expr-format
+		port-flush-policy sym <>
+		    "port-flush-policy after %s" #( sym ) test-expr-format
+	end-each
+	'auto set-port-flush-policy drop
+	#( 'line 'full ) port-flush-policy array-member? not
+	    "port-flush-policy after 'auto" test-expr
+	\ bad symbols
+	'full set-port-flush-policy drop
+	'bogus <'> set-port-flush-policy 'wrong-type-arg nil fth-catch
+	car 'wrong-type-arg <> "set-port-flush-policy 'bogus" test-expr
+	10 <'> set-port-flush-policy 'wrong-type-arg nil fth-catch
+	car 'wrong-type-arg <> "set-port-flush-policy 10" test-expr
+	port-flush-policy 'full <>
+	    "port-flush-policy after bad symbol" test-expr
+	old set-port-flush-policy drop
+	\ output order with stdout piped
+	port-prog string? if
+		#( 'always 'line 'full ) each { sym }
+			sym port-order { res }
+			res "a\nb\nc\nd\ne\n" string<>
+			    "output order (%s): %s" #( sym res )
+			    test-expr-format
+		end-each
+	then
+;
+
+port-test
+
+\ port-test.fs ends here
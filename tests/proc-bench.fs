@@ -0,0 +1,81 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)proc-bench.fs	1.1 10/18/26
+
+\ Commentary:
+\
+\ Calls of Forth procs from C: hash-each and hash-map call
+\ fth_proc_call() for every entry, run-proc goes through
+\ fth_proc_apply().  COUNT defaults to 1e7 calls, see bench-utils.fs.
+
+\ Code:
+
+require bench-utils.fs
+
+10000000 bench-count value count
+
+1000 constant hash-size
+make-hash value hs
+
+: hash-init ( -- )
+	hash-size 0 do
+		hs i i hash-set!
+	loop
+;
+
+hash-init
+
+lambda: <{ key val -- }> ; value each-cb
+lambda: <{ key val -- val }> val ; value map-cb
+lambda: <{ x -- x }> x ; value run-cb
+
+: bench-hash-each ( -- )
+	count hash-size / 0 ?do
+		hs each-cb hash-each
+	loop
+;
+
+: bench-hash-map ( -- )
+	count hash-size / 0 ?do
+		hs map-cb hash-map drop
+	loop
+;
+
+: bench-run-proc ( -- )
+	count 0 ?do
+		run-cb i run-proc drop
+	loop
+;
+
+: proc-bench ( -- )
+	"Mcalls/s" bench-header
+	<'> bench-hash-each "hash-each" count bench-line
+	<'> bench-hash-map "hash-map" count bench-line
+	<'> bench-run-proc "run-proc" count bench-line
+;
+
+proc-bench
+
+\ proc-bench.fs ends here
@@ -71,6 +71,17 @@ lambda: <{ val -- res }>
 	#( a b c d e )
 ;
 
+\ The defaults name words defined below.
+: later-key-test <{ a :key b later-default c 3 -- ary }>
+	#( a b c )
+;
+
+: later-optional-test <{ a :optional b later-default -- ary }>
+	#( a b )
+;
+
+: later-default ( -- n )   99 ;
+
 : proc-test ( -- )
 	nil nil { prc0 prc1 }
 	\ word?, proc?, thunk?, xt?, make-proc
@@ -204,6 +215,14 @@ lambda: <{ val -- res }>
 	val #( 3 4 5 6 7 )    array= not "get-optargs (3)" test-expr
 	rest1 1 <> "get-optargs (3) rest1" test-expr
 	rest2 2 <> "get-optargs (3) rest2" test-expr
+	\ <{ :key :optional }> defaults defined later
+	1 later-key-test #( 1 99 3 ) array= not "later :key default" test-expr
+	1 :b 5 later-key-test #( 1 5 3 ) array= not
+	    "later :key given" test-expr
+	1 later-optional-test #( 1 99 ) array= not
+	    "later :optional default" test-expr
+	1 2 later-optional-test #( 1 2 ) array= not
+	    "later :optional given" test-expr
 	\ trace-var, untrace-var
 	0 to *test-trace*
 	0 to *tmp-test-trace*
@@ -0,0 +1,104 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)seq-bench.fs	1.1 10/17/26
+
+\ Commentary:
+\
+\ Time array-push, array-unshift, string-push and string-unshift for
+\ 1e3 up to MAX-LEN elements, with and without array-reserve resp.
+\ string-reserve.  MAX-LEN defaults to 1e6, see bench-utils.fs.
+
+\ Code:
+
+require bench-utils.fs
+
+1000000 bench-count value max-len
+
+: ary-push { len -- }
+	#() { ary }
+	len 0 ?do
+		ary i array-push drop
+	loop
+;
+
+: ary-reserve-push { len -- }
+	#() len array-reserve { ary }
+	len 0 ?do
+		ary i array-push drop
+	loop
+;
+
+: ary-unshift { len -- }
+	#() { ary }
+	len 0 ?do
+		ary i array-unshift drop
+	loop
+;
+
+: str-push { len -- }
+	"" { str }
+	len 0 ?do
+		str "x" string-push drop
+	loop
+;
+
+: str-reserve-push { len -- }
+	"" len string-reserve { str }
+	len 0 ?do
+		str "x" string-push drop
+	loop
+;
+
+: str-unshift { len -- }
+	"" { str }
+	len 0 ?do
+		str "x" string-unshift drop
+	loop
+;
+
+: seq-bench ( -- )
+	"%8s  %8s  %8s  %8s  %8s  %8s  %8s\n"
+	    #( "len" "a-push" "a-rsrv" "a-unsh" "s-push" "s-rsrv" "s-unsh" )
+	    fth-print
+	1000 { len }
+	begin
+		len max-len <=
+	while
+		"%8d" #( len ) fth-print
+		len <'> ary-push bench-column
+		len <'> ary-reserve-push bench-column
+		len <'> ary-unshift bench-column
+		len <'> str-push bench-column
+		len <'> str-reserve-push bench-column
+		len <'> str-unshift bench-column
+		cr
+		gc-run
+		len 10 * to len
+	repeat
+;
+
+seq-bench
+
+\ seq-bench.fs ends here
@@ -0,0 +1,115 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)socket-bench.fs	1.1 10/17/26
+
+\ Commentary:
+\
+\ Throughput of socket IO: a client and an echo server on both ends
+\ of a local AF_UNIX connection in one process.  Lines go out in
+\ batches small enough for the socket buffer, so neither side blocks.
+\ COUNT defaults to 1e5 lines, see bench-utils.fs.
+
+\ Code:
+
+require bench-utils.fs
+
+100000 bench-count value count
+
+100 constant batch
+"/tmp/fth-socket-bench" constant sock-name
+63 <char> x make-string "\n" string-push constant sock-line
+
+make-timer value tm
+nil value cli
+nil value srv
+
+: sock-open ( -- )
+	sock-name file-exists? if
+		sock-name file-delete
+	then
+	AF_UNIX SOCK_STREAM net-socket { sfd }
+	sfd sock-name -1 AF_UNIX net-bind
+	sfd net-listen
+	AF_UNIX SOCK_STREAM net-socket sock-name -1 AF_UNIX net-connect to cli
+	sfd sock-name AF_UNIX net-accept to srv
+;
+
+: sock-close ( -- )
+	cli io-close
+	srv io-close
+	sock-name file-exists? if
+		sock-name file-delete
+	then
+;
+
+\ io-write and io-read
+: bench-lines ( -- )
+	count batch / 0 ?do
+		batch 0 do
+			cli sock-line io-write
+		loop
+		cli io-flush
+		batch 0 do
+			srv srv io-read io-write
+		loop
+		srv io-flush
+		batch 0 do
+			cli io-read drop
+		loop
+	loop
+;
+
+\ io-putc and io-getc
+: bench-chars ( -- )
+	count batch / 0 ?do
+		batch 0 do
+			cli <char> x io-putc
+		loop
+		cli io-flush
+		batch 0 do
+			srv srv io-getc io-putc
+		loop
+		srv io-flush
+		batch 0 do
+			cli io-getc drop
+		loop
+	loop
+;
+
+: bench-run { xt name size -- }
+	sock-open
+	xt name count size * 2* bench-line
+	sock-close
+;
+
+: socket-bench ( -- )
+	"MB/s" bench-header
+	<'> bench-lines "lines (64 bytes)" sock-line length bench-run
+	<'> bench-chars "chars" 1 bench-run
+;
+
+socket-bench
+
+\ socket-bench.fs ends here
@@ -0,0 +1,77 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)startup-bench.fs	1.1 10/18/26
+
+\ Commentary:
+\
+\ Startup time of fth with and without a dictionary image.  Saves an
+\ image with 'fth --save-image' and starts 'fth -Q -e ""' COUNT times
+\ loading the library files and COUNT times with --image.  FTH is the
+\ fth to start, it needs the same environment (FTH_FTHPATH) as the
+\ calling fth.  COUNT defaults to 100, FTH to the fth in PATH, see
+\ bench-utils.fs.
+\
+\ Usage: fth -s startup-bench.fs [ count [ fth ] ]
+
+\ Code:
+
+require bench-utils.fs
+
+100 bench-count value count
+2 "fth" bench-arg value fth-prog
+
+"/tmp/startup-bench.img" value image
+
+: bench-starts { cmd -- }
+	count 0 ?do
+		cmd file-system unless
+			"%s: exit status %d\n" #( cmd exit-status ) fth-print
+			leave
+		then
+	loop
+;
+
+: bench-run { name cmd -- }
+	cmd <'> bench-starts bench-time { secs }
+	"%-8s %8d  %8.3f  %8.3f\n"
+	    #( name count secs secs count f/ 1000e f* ) fth-print
+;
+
+: startup-bench ( -- )
+	"%s --save-image %s" #( fth-prog image ) string-format
+	file-system unless
+		"can't save %s\n" #( image ) fth-print
+		exit
+	then
+	"%-8s %8s  %8s  %8s\n" #( "bench" "starts" "time" "ms" ) fth-print
+	"files" "%s -Q -e \"\"" #( fth-prog ) string-format bench-run
+	"image" "%s -Q --image %s -e \"\"" #( fth-prog image )
+	    string-format bench-run
+	image file-delete
+;
+
+startup-bench
+
+\ startup-bench.fs ends here
@@ -138,6 +138,28 @@ require test-utils.fs
 	str #f string-split each ( x )
 		string->number i <> "string-unshift loop" test-expr
 	end-each
+	\ string-reserve, large strings
+	"" 1000 string-reserve to str
+	str length 0<> "string-reserve (length)" test-expr
+	"" -1 <'> string-reserve 'out-of-range nil fth-catch car 'out-of-range <>
+	    "string-reserve -1" test-expr
+	10000 0 do
+		str "ab" string-push drop
+		str "c" string-unshift drop
+	loop
+	str length 30000 <> "10000 string-push/unshift (length)" test-expr
+	str 0 string-ref <char> c <> "10000 string-unshift (first)" test-expr
+	str -1 string-ref <char> b <> "10000 string-push (last)" test-expr
+	str "ab" "x" string-replace! drop
+	str length 20000 <> "string-replace! (grow)" test-expr
+	str "x" "yz" string-replace! drop
+	str length 30000 <> "string-replace! (shrink)" test-expr
+	str -2 string-ref <char> y <> "string-replace! (y)" test-expr
+	19999 0 do
+		str string-pop drop
+	loop
+	str 9999 0 do string-shift drop str loop drop
+	str "cy" string<> "string-pop/shift" test-expr
 	\ string-append, string-reverse(!)
 	"foo" to s1
 	"bar" to s2
@@ -25,6 +25,15 @@
 \ @(#)symbol-test.fs	1.14 1/12/15
 
 require test-utils.fs
+require marker.fr
+
+\ A symbol interned after a marker must not survive the marker; the
+\ space it used is handed out again by MARKED-FILLER.
+marker symbol-marker
+'marked-sym drop
+symbol-marker
+'marked-sym value marked-sym
+: marked-filler ( -- ) 1 2 3 4 5 6 7 8 9 10 + + + + + + + + + drop ;
 
 : symbol-test ( -- )
 	\ symbol?
@@ -45,6 +54,14 @@ require test-utils.fs
 	sym symbol? not "make-symbol" test-expr
 	\ symbol-name
 	sym symbol-name "hello" string<> "symbol-name" test-expr
+	\ interned symbols
+	"hello" make-symbol sym <> "make-symbol (interned)" test-expr
+	"'hello" make-symbol sym <> "make-symbol (prefix)" test-expr
+	'HELLO sym <> "make-symbol (case)" test-expr
+	"hello" make-keyword sym = "make-symbol (keyword)" test-expr
+	marked-sym symbol? not "symbol? (marker)" test-expr
+	marked-sym symbol-name "marked-sym" string<>
+	    "symbol-name (marker)" test-expr
 	\ keyword?
 	:test keyword? not "keyword? (1)" test-expr
 	"test" keyword? "keyword? (2)" test-expr
@@ -78,6 +95,9 @@ require test-utils.fs
 	e1 e1 exception= not "e1 e1 exception=" test-expr
 	e1 e2 exception= not "e1 e2 exception=" test-expr
 	e1 e3 exception=     "e1 e3 exception=" test-expr
+	*exception-list* array-length
+	*exception-list* array-uniq array-length <>
+	    "exception-list (uniq)" test-expr
 	\ make-exception, symbol->exception
 	'foo symbol->exception { ex }
 	ex exception? not "'foo exception?" test-expr
@@ -0,0 +1,178 @@
+\ Copyright (c) 2006-2016 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)vector-bench.fs	1.1 10/18/26
+
+\ Commentary:
+\
+\ Vector kernels against the equivalent array code.  The array rows
+\ loop over arrays of floats, the other rows run the f64-vector words
+\ with every kernel set the CPU supports.  The array rows repeat their
+\ operation 10 times, the vector rows 1000 times.  Scaling is by -1.0
+\ to keep the values away from denormals.  COUNT, the vector length,
+\ defaults to 1e5 elements, see bench-utils.fs.
+
+\ Code:
+
+require bench-utils.fs
+
+100000 bench-count value count
+
+10 constant array-reps
+1000 constant vector-reps
+count make-array value ary-a
+
+: array-init ( -- )
+	ary-a map!
+		i s>f 1e-3 f* fsin
+	end-map drop
+;
+
+array-init
+ary-a array-copy value ary-b
+ary-a array->f64-vector value vec-a
+ary-b array->f64-vector value vec-b
+
+: bench-array-fill ( -- )
+	array-reps 0 do
+		ary-a 0.5 array-fill
+	loop
+;
+
+: bench-array-add ( -- )
+	array-reps 0 do
+		count 0 do
+			ary-a i  ary-a i array-ref ary-b i array-ref f+  array-set!
+		loop
+	loop
+;
+
+: bench-array-scale ( -- )
+	array-reps 0 do
+		count 0 do
+			ary-a i  ary-a i array-ref -1.0 f*  array-set!
+		loop
+	loop
+;
+
+: bench-array-dot ( -- )
+	array-reps 0 do
+		0.0 count 0 do
+			ary-a i array-ref ary-b i array-ref f* f+
+		loop drop
+	loop
+;
+
+: bench-array-sum ( -- )
+	array-reps 0 do
+		0.0 count 0 do
+			ary-a i array-ref f+
+		loop drop
+	loop
+;
+
+: bench-array-max ( -- )
+	array-reps 0 do
+		ary-a 0 array-ref count 1 do
+			ary-a i array-ref fmax
+		loop drop
+	loop
+;
+
+: bench-vector-fill ( -- )
+	vector-reps 0 do
+		vec-a 0.5 vector-fill drop
+	loop
+;
+
+: bench-vector-add ( -- )
+	vector-reps 0 do
+		vec-a vec-b vector-add! drop
+	loop
+;
+
+: bench-vector-scale ( -- )
+	vector-reps 0 do
+		vec-a -1.0 vector-scale! drop
+	loop
+;
+
+: bench-vector-dot ( -- )
+	vector-reps 0 do
+		vec-a vec-b vector-dot drop
+	loop
+;
+
+: bench-vector-sum ( -- )
+	vector-reps 0 do
+		vec-a vector-sum drop
+	loop
+;
+
+: bench-vector-max ( -- )
+	vector-reps 0 do
+		vec-a vector-max drop
+	loop
+;
+
+: bench-run { xt reps name -- }
+	xt name count reps * bench-line
+;
+
+\ Kernels supported by this CPU.
+: vector-kernel-list ( -- ary )
+	vector-kernels { best }
+	#( 'c ) { ary }
+	best 'c <> if
+		ary 'sse2 array-push drop
+	then
+	best 'avx2 = if
+		ary 'avx2 array-push drop
+	then
+	ary
+;
+
+: vector-bench-op { axt vxt name -- }
+	axt array-reps "array " name $+ bench-run
+	vector-kernel-list each { k }
+		k set-vector-kernels drop
+		vxt vector-reps
+		    "vector %s %s" #( name k symbol-name ) string-format bench-run
+	end-each
+	'auto set-vector-kernels drop
+;
+
+: vector-bench ( -- )
+	"Melems/s" bench-header
+	<'> bench-array-fill <'> bench-vector-fill "fill" vector-bench-op
+	<'> bench-array-add <'> bench-vector-add "add" vector-bench-op
+	<'> bench-array-scale <'> bench-vector-scale "scale" vector-bench-op
+	<'> bench-array-dot <'> bench-vector-dot "dot" vector-bench-op
+	<'> bench-array-sum <'> bench-vector-sum "sum" vector-bench-op
+	<'> bench-array-max <'> bench-vector-max "max" vector-bench-op
+;
+
+vector-bench
+
+\ vector-bench.fs ends here
@@ -0,0 +1,161 @@
+\ Copyright (c) 2006-2018 Michael Scholz <mi-scholz@users.sourceforge.net>
+\ All rights reserved.
+\
+\ Redistribution and use in source and binary forms, with or without
+\ modification, are permitted provided that the following conditions
+\ are met:
+\ 1. Redistributions of source code must retain the above copyright
+\    notice, this list of conditions and the following disclaimer.
+\ 2. Redistributions in binary form must reproduce the above copyright
+\    notice, this list of conditions and the following disclaimer in the
+\    documentation and/or other materials provided with the distribution.
+\
+\ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+\ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+\ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+\ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+\ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+\ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+\ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+\ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+\ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+\ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+\ SUCH DAMAGE.
+\
+\ @(#)vector-test.fs	1.1 10/18/26
+
+require test-utils.fs
+
+\ Kernels supported by this CPU; the results must not depend on them.
+: vector-kernel-list ( -- ary )
+	vector-kernels { best }
+	#( 'c ) { ary }
+	best 'c <> if
+		ary 'sse2 array-push drop
+	then
+	best 'avx2 = if
+		ary 'avx2 array-push drop
+	then
+	ary
+;
+
+\ 19 elements, more than two AVX2 steps and an odd rest.  The values
+\ are exact in any order of addition.
+: vector-data ( -- ary )
+	19 make-array map!
+		i 0.5 f* 4.0 f-
+	end-map
+;
+
+: vector-kernel-test ( -- )
+	vector-data { ary }
+	ary array->f64-vector { v1 }
+	ary array->f64-vector { v2 }
+	#( 3 -7 11 0 5 ) array->i64-vector { w }
+	nil { x }
+	\ f64 kernels
+	v1 vector-sum 9.5 f<> "vector-sum" test-expr
+	v1 vector-min -4.0 f<> "vector-min" test-expr
+	v1 vector-max 5.0 f<> "vector-max" test-expr
+	v1 v2 vector-dot 147.25 f<> "vector-dot" test-expr
+	v1 v2 vector-add! v1 <> "vector-add! returns vec1" test-expr
+	v1 -1 f64-vector-ref 10.0 f<> "vector-add!" test-expr
+	v1 0.5 vector-scale! drop
+	v1 v2 equal? not "vector-scale!" test-expr
+	v1 1.5 vector-fill vector-sum 28.5 f<> "vector-fill" test-expr
+	v1 17 nan f64-vector-set!
+	v1 vector-min nan? not "vector-min nan" test-expr
+	v1 vector-max nan? not "vector-max nan" test-expr
+	#( 2.0 1.0 ) array->f64-vector vector-min 1.0 f<>
+	    "vector-min short" test-expr
+	\ i64 kernels
+	w vector-sum 12 <> "i64 vector-sum" test-expr
+	w vector-min -7 <> "i64 vector-min" test-expr
+	w vector-max 11 <> "i64 vector-max" test-expr
+	w w vector-dot 204 <> "i64 vector-dot" test-expr
+	w w vector-copy vector-add! 2 i64-vector-ref 22 <>
+	    "i64 vector-add!" test-expr
+	w -2 vector-scale! 1 i64-vector-ref 28 <> "i64 vector-scale!" test-expr
+	w 1 vector-fill vector-sum 5 <> "i64 vector-fill" test-expr
+	9 :initial-element 1 make-i64-vector to x
+	x 8 -20 i64-vector-set!
+	x 3 20 i64-vector-set!
+	x vector-min -20 <> "i64 vector-min rest" test-expr
+	x vector-max 20 <> "i64 vector-max rest" test-expr
+;
+
+: vector-test ( -- )
+	nil nil { v w }
+	\ vector?, f64-vector?, i64-vector?
+	3 make-f64-vector to v
+	3 make-i64-vector to w
+	v vector? not "vector? f64" test-expr
+	w vector? not "vector? i64" test-expr
+	#( 0 1 ) vector? "vector? array" test-expr
+	v f64-vector? not "f64-vector?" test-expr
+	w f64-vector? "f64-vector? i64" test-expr
+	w i64-vector? not "i64-vector?" test-expr
+	\ make-f64-vector, make-i64-vector
+	v vector-length 3 <> "vector-length" test-expr
+	nil vector-length -1 <> "vector-length nil" test-expr
+	v 0 f64-vector-ref 0.0 f<> "make-f64-vector" test-expr
+	3 :initial-element 7 make-i64-vector to w
+	w -1 i64-vector-ref 7 <> "make-i64-vector :initial-element" test-expr
+	-1 <'> make-f64-vector 'out-of-range nil fth-catch car
+	    'out-of-range <> "make-f64-vector -1" test-expr
+	\ ref, set!
+	v 1 2 f64-vector-set!
+	v 1 f64-vector-ref 2.0 f<> "f64-vector-set! converts" test-expr
+	v -2 f64-vector-ref 2.0 f<> "f64-vector-ref negative" test-expr
+	v 3 <'> f64-vector-ref 'out-of-range nil fth-catch car
+	    'out-of-range <> "f64-vector-ref 3" test-expr
+	w <'> vector-sum #t nil fth-catch "vector-sum i64" test-expr
+	w 0 <'> f64-vector-ref 'wrong-type-arg nil fth-catch car
+	    'wrong-type-arg <> "f64-vector-ref i64" test-expr
+	w 0 1099511627776 i64-vector-set!
+	w 0 i64-vector-ref 1099511627776 <> "i64-vector-set! llong" test-expr
+	v 1 object-ref 2.0 f<> "object-ref" test-expr
+	w 1 object-ref 7 <> "object-ref i64" test-expr
+	v 2 4.5 object-set!
+	v 2 apply 4.5 f<> "apply" test-expr
+	\ conversion
+	v vector->array #( 0.0 2.0 4.5 ) array= not "vector->array" test-expr
+	#( 1 2 3 ) array->i64-vector vector->array #( 1 2 3 ) array= not
+	    "array->i64-vector" test-expr
+	v object-dump string-eval v equal? not "object-dump" test-expr
+	v object->string "#f64( 0.0 2.0 4.5 )" string<>
+	    "object->string" test-expr
+	0 make-i64-vector object->string "#i64()" string<>
+	    "object->string empty" test-expr
+	\ copy, equal?, hash
+	v vector-copy v equal? not "vector-copy" test-expr
+	v object-copy v equal? not "object-copy" test-expr
+	v object-copy v object-id = "object-copy new" test-expr
+	#( 1 2 ) array->f64-vector #( 1 2 ) array->i64-vector equal?
+	    "equal? f64 i64" test-expr
+	#{} { h }
+	h v 10 hash-set!
+	h v vector-copy hash-ref 10 <> "hash-ref vector key" test-expr
+	0 make-f64-vector vector-min "vector-min empty" test-expr
+	0 make-i64-vector vector-sum 0<> "vector-sum empty" test-expr
+	\ length mismatch
+	v 4 make-f64-vector <'> vector-add! 'wrong-type-arg nil fth-catch car
+	    'wrong-type-arg <> "vector-add! length" test-expr
+	v 3 make-i64-vector <'> vector-dot 'wrong-type-arg nil fth-catch car
+	    'wrong-type-arg <> "vector-dot type" test-expr
+	\ kernels
+	vector-kernels { best }
+	'none <'> set-vector-kernels 'wrong-type-arg nil fth-catch car
+	    'wrong-type-arg <> "set-vector-kernels 'none" test-expr
+	vector-kernel-list each { k }
+		k set-vector-kernels drop
+		vector-kernels k <> "set-vector-kernels" test-expr
+		vector-kernel-test
+	end-each
+	'auto set-vector-kernels drop
+	vector-kernels best <> "set-vector-kernels 'auto" test-expr
+;
+
+*fth-test-count* 0 [do] vector-test [loop]
+
+\ vector-test.fs ends here